@@ -12,6 +12,7 @@
 #include <fizz/client/PskCache.h>
 #include <fizz/protocol/Actions.h>
 #include <fizz/protocol/Params.h>
+#include <folly/futures/Future.h>
 
 namespace fizz {
 namespace client {
@@ -67,6 +68,19 @@ struct NewCachedPsk {
   CachedPsk psk;
 };
 
+/**
+ * Reports that the actions following this one may only be processed once
+ * verified completes. If verified completes with an exception the connection
+ * fails instead.
+ *
+ * Returned first when an AsyncCertificateVerifier has not yet finished
+ * verifying the server's certificates. FizzClient consumes this action; it is
+ * never passed to the visitor.
+ */
+struct WaitForVerification {
+  folly::Future<folly::Unit> verified;
+};
+
 using Action = boost::variant<
     DeliverAppData,
     WriteToSocket,
@@ -76,7 +90,8 @@ using Action = boost::variant<
     ReportError,
     MutateState,
     WaitForData,
-    NewCachedPsk>;
+    NewCachedPsk,
+    WaitForVerification>;
 // TODO use small_vector once we are sure it is portable.
 using Actions = std::vector<Action>;
 
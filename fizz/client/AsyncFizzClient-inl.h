@@ -76,10 +76,11 @@ void AsyncFizzClientT<SM>::connect(
 
   startTransportReads();
 
-  folly::Optional<CachedPsk> cachedPsk = folly::none;
+  std::shared_ptr<const CachedPsk> cachedPsk;
   if (pskIdentity) {
-    cachedPsk = fizzContext_->getPsk(*pskIdentity);
+    cachedPsk = fizzContext_->getSharedPsk(*pskIdentity);
   }
+  state_.executor() = transport_->getEventBase();
   fizzClient_.connect(
       fizzContext_,
       std::move(verifier),
@@ -117,6 +118,9 @@ void AsyncFizzClientT<SM>::connect(
       transport_->getUnderlyingTransport<folly::AsyncSocket>();
   if (underlyingSocket) {
     underlyingSocket->disableTransparentTls();
+    if (tcpFastOpen_) {
+      underlyingSocket->enableTFO();
+    }
     underlyingSocket->connect(
         this,
         connectAddr,
@@ -251,18 +255,40 @@ void AsyncFizzClientT<SM>::closeNow() {
 
 template <typename SM>
 void AsyncFizzClientT<SM>::connectSuccess() noexcept {
+  DelayedDestruction::DestructorGuard dg(this);
+
   startTransportReads();
 
-  folly::Optional<CachedPsk> cachedPsk = folly::none;
+  std::shared_ptr<const CachedPsk> cachedPsk;
   if (pskIdentity_) {
-    cachedPsk = fizzContext_->getPsk(*pskIdentity_);
+    cachedPsk = fizzContext_->getSharedPsk(*pskIdentity_);
   }
+
+  // With TFO the socket reports success before the SYN is sent, and the SYN
+  // carries whatever the first write contains.
+  if (tcpFastOpen_) {
+    fastOpenWrite_.emplace(folly::IOBufQueue::cacheChainLength());
+  }
+  state_.executor() = transport_->getEventBase();
   fizzClient_.connect(
       fizzContext_,
       std::move(verifier_),
       sni_,
       std::move(cachedPsk),
       extensions_);
+  flushFastOpenWrite();
+}
+
+template <typename SM>
+void AsyncFizzClientT<SM>::flushFastOpenWrite() {
+  if (!fastOpenWrite_) {
+    return;
+  }
+  auto data = fastOpenWrite_->move();
+  fastOpenWrite_ = folly::none;
+  if (data && !error()) {
+    transport_->writeChain(nullptr, std::move(data));
+  }
 }
 
 template <typename SM>
@@ -337,9 +363,21 @@ void AsyncFizzClientT<SM>::transportError(
 
 template <typename SM>
 void AsyncFizzClientT<SM>::transportDataAvailable() {
+  // The read record layer is replaced during the handshake and on key updates,
+  // so make sure the current one decrypts into the app's buffers if possible.
+  auto readRecordLayer = getState().readRecordLayer();
+  if (readRecordLayer) {
+    readRecordLayer->setDecryptionBufferProvider(this);
+  }
   fizzClient_.newTransportData();
 }
 
+template <typename SM>
+size_t AsyncFizzClientT<SM>::getBufferedHandshakeSize() const {
+  auto readRecordLayer = getState().readRecordLayer();
+  return readRecordLayer ? readRecordLayer->getUnparsedHandshakeDataSize() : 0;
+}
+
 template <typename SM>
 void AsyncFizzClientT<SM>::deliverAllErrors(
     const folly::AsyncSocketException& ex,
@@ -399,8 +437,21 @@ void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(DeliverAppData& data) {
 
 template <typename SM>
 void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(WriteToSocket& data) {
-  client_.transport_->writeChain(
-      data.callback, std::move(data.data), data.flags);
+  if (client_.fastOpenWrite_) {
+    client_.fastOpenWrite_->append(std::move(data.data));
+    if (!data.callback) {
+      return;
+    }
+    // The first write with a callback is early data from the application,
+    // send it along with everything held so far.
+    auto buf = client_.fastOpenWrite_->move();
+    client_.fastOpenWrite_ = folly::none;
+    auto flags = client_.getTransportWriteFlags(*buf, data.flags);
+    client_.transport_->writeChain(data.callback, std::move(buf), flags);
+    return;
+  }
+  auto flags = client_.getTransportWriteFlags(*data.data, data.flags);
+  client_.transport_->writeChain(data.callback, std::move(data.data), flags);
 }
 
 template <typename SM>
@@ -520,7 +571,7 @@ template <typename SM>
 void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(WaitForData&) {
   client_.fizzClient_.waitForData();
 
-  if (client_.callback_) {
+  if (client_.callback_ || client_.transportReadsPaused()) {
     // Make sure that the read callback is installed.
     client_.startTransportReads();
   }
@@ -540,6 +591,12 @@ void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(
   }
 }
 
+template <typename SM>
+void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(WaitForVerification&) {
+  // FizzClient waits on the verification itself.
+  LOG(DFATAL) << "unexpected WaitForVerification action";
+}
+
 template <typename SM>
 Buf AsyncFizzClientT<SM>::getEkm(
     folly::StringPiece label,
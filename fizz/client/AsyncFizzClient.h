@@ -121,6 +121,20 @@ class AsyncFizzClientT : public AsyncFizzBase,
     earlyDataRejectionPolicy_ = policy;
   }
 
+  /**
+   * Open the socket with TCP Fast Open when connecting to an address. The
+   * ClientHello and any early data written from the connect callback are
+   * coalesced into the first write, which the kernel places in the SYN, so
+   * a resumed connection can deliver its request without waiting for the TCP
+   * handshake. Falls back to a regular connect if TFO is unavailable.
+   *
+   * Only used by the connect() API taking a SocketAddress.
+   */
+  void setTcpFastOpen(bool enabled) {
+    CHECK(!callback_);
+    tcpFastOpen_ = enabled;
+  }
+
   /**
    * Internal state access for logging/testing.
    */
@@ -146,6 +160,8 @@ class AsyncFizzClientT : public AsyncFizzBase,
 
   void transportDataAvailable() override;
 
+  size_t getBufferedHandshakeSize() const override;
+
  private:
   void deliverAllErrors(
       const folly::AsyncSocketException& ex,
@@ -157,6 +173,8 @@ class AsyncFizzClientT : public AsyncFizzBase,
 
   folly::Optional<folly::AsyncSocketException> handleEarlyReject();
 
+  void flushFastOpenWrite();
+
   class ActionMoveVisitor : public boost::static_visitor<> {
    public:
     explicit ActionMoveVisitor(AsyncFizzClientT<SM>& client)
@@ -171,6 +189,7 @@ class AsyncFizzClientT : public AsyncFizzBase,
     void operator()(WaitForData&);
     void operator()(MutateState&);
     void operator()(NewCachedPsk&);
+    void operator()(WaitForVerification&);
 
    private:
     AsyncFizzClientT<SM>& client_;
@@ -213,6 +232,13 @@ class AsyncFizzClientT : public AsyncFizzBase,
   EarlyDataRejectionPolicy earlyDataRejectionPolicy_{
       EarlyDataRejectionPolicy::FatalConnectionError};
 
+  bool tcpFastOpen_{false};
+
+  // Only set while the ClientHello is being sent on a TCP Fast Open
+  // connection. Holds socket writes so that the ClientHello and the first
+  // early data write leave in a single write.
+  folly::Optional<folly::IOBufQueue> fastOpenWrite_;
+
   folly::AsyncTransport::ReplaySafetyCallback* replaySafetyCallback_{nullptr};
 
   // Set when using socket connect() API to later pass into the state machine
@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/ClientHelloTemplate.h>
+
+#include <fizz/record/Extensions.h>
+
+namespace fizz {
+namespace client {
+
+ClientHelloTemplate ClientHelloTemplate::make(
+    const std::vector<ProtocolVersion>& supportedVersions,
+    const std::vector<NamedGroup>& supportedGroups,
+    const std::vector<SignatureScheme>& supportedSigSchemes,
+    const std::vector<PskKeyExchangeMode>& supportedPskModes,
+    const std::vector<std::string>& supportedAlpns,
+    const std::vector<CertificateType>& supportedServerCertTypes,
+    const std::vector<CertificateType>& supportedClientCertTypes) {
+  ClientHelloTemplate chloTemplate;
+
+  SupportedVersions versions;
+  versions.versions = supportedVersions;
+  chloTemplate.supportedVersions = encodeExtension(std::move(versions));
+
+  SupportedGroups groups;
+  groups.named_group_list = supportedGroups;
+  chloTemplate.supportedGroups = encodeExtension(std::move(groups));
+
+  SignatureAlgorithms sigAlgs;
+  sigAlgs.supported_signature_algorithms = supportedSigSchemes;
+  chloTemplate.signatureAlgorithms = encodeExtension(std::move(sigAlgs));
+
+  if (!supportedAlpns.empty()) {
+    ProtocolNameList alpn;
+    for (const auto& protoName : supportedAlpns) {
+      ProtocolName proto;
+      proto.name = folly::IOBuf::copyBuffer(protoName);
+      alpn.protocol_name_list.push_back(std::move(proto));
+    }
+    chloTemplate.alpn = encodeExtension(std::move(alpn));
+  }
+
+  if (!supportedPskModes.empty()) {
+    PskKeyExchangeModes modes;
+    modes.modes = supportedPskModes;
+    chloTemplate.pskModes = encodeExtension(std::move(modes));
+  }
+
+  // Offering only X509 is the same as not sending the extension (RFC 7250).
+  const std::vector<CertificateType> x509Only = {CertificateType::X509};
+  if (!supportedServerCertTypes.empty() &&
+      supportedServerCertTypes != x509Only) {
+    ServerCertificateTypes serverCertTypes;
+    serverCertTypes.certificate_types = supportedServerCertTypes;
+    chloTemplate.serverCertTypes = encodeExtension(std::move(serverCertTypes));
+  }
+
+  if (!supportedClientCertTypes.empty() &&
+      supportedClientCertTypes != x509Only) {
+    ClientCertificateTypes clientCertTypes;
+    clientCertTypes.certificate_types = supportedClientCertTypes;
+    chloTemplate.clientCertTypes = encodeExtension(std::move(clientCertTypes));
+  }
+
+  return chloTemplate;
+}
+} // namespace client
+} // namespace fizz
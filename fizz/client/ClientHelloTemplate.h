@@ -0,0 +1,50 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+#include <folly/Optional.h>
+
+namespace fizz {
+namespace client {
+
+/**
+ * ClientHello extensions that only depend on the FizzClientContext. These are
+ * encoded once when the context is configured, and cloned into every
+ * ClientHello. Per-connection fields (random, legacy session id, key shares,
+ * server name, early data, cookie, PSK and binders) are still filled in on
+ * each connect.
+ */
+struct ClientHelloTemplate {
+  Extension supportedVersions;
+  Extension supportedGroups;
+  Extension signatureAlgorithms;
+  folly::Optional<Extension> alpn;
+  folly::Optional<Extension> pskModes;
+  folly::Optional<Extension> serverCertTypes;
+  folly::Optional<Extension> clientCertTypes;
+
+  static ClientHelloTemplate make(
+      const std::vector<ProtocolVersion>& supportedVersions,
+      const std::vector<NamedGroup>& supportedGroups,
+      const std::vector<SignatureScheme>& supportedSigSchemes,
+      const std::vector<PskKeyExchangeMode>& supportedPskModes,
+      const std::vector<std::string>& supportedAlpns,
+      const std::vector<CertificateType>& supportedServerCertTypes,
+      const std::vector<CertificateType>& supportedClientCertTypes);
+
+  /**
+   * Returns a copy of ext that shares the encoded data.
+   */
+  static Extension clone(const Extension& ext) {
+    return Extension{ext.extension_type, ext.extension_data->clone()};
+  }
+};
+} // namespace client
+} // namespace fizz
@@ -10,6 +10,7 @@
 
 #include <fizz/client/PskCache.h>
 #include <fizz/crypto/Utils.h>
+#include <fizz/protocol/AsyncCertificateVerifier.h>
 #include <fizz/protocol/CertificateVerifier.h>
 #include <fizz/protocol/Protocol.h>
 #include <fizz/protocol/StateMachine.h>
@@ -140,17 +141,37 @@ Actions ClientStateMachine::processConnect(
     std::shared_ptr<const FizzClientContext> context,
     std::shared_ptr<const CertificateVerifier> verifier,
     Optional<std::string> sni,
-    Optional<CachedPsk> cachedPsk,
+    std::shared_ptr<const CachedPsk> cachedPsk,
     const std::shared_ptr<ClientExtensions>& extensions) {
   Connect connect;
   connect.context = std::move(context);
   connect.sni = std::move(sni);
   connect.verifier = std::move(verifier);
   connect.extensions = extensions;
-  connect.cachedPsk = std::move(cachedPsk);
+  connect.sharedPsk = std::move(cachedPsk);
   return detail::processEvent(state, std::move(connect));
 }
 
+Actions ClientStateMachine::processConnect(
+    const State& state,
+    std::shared_ptr<const FizzClientContext> context,
+    std::shared_ptr<const CertificateVerifier> verifier,
+    Optional<std::string> sni,
+    Optional<CachedPsk> cachedPsk,
+    const std::shared_ptr<ClientExtensions>& extensions) {
+  std::shared_ptr<const CachedPsk> sharedPsk;
+  if (cachedPsk) {
+    sharedPsk = std::make_shared<const CachedPsk>(std::move(*cachedPsk));
+  }
+  return processConnect(
+      state,
+      std::move(context),
+      std::move(verifier),
+      std::move(sni),
+      std::move(sharedPsk),
+      extensions);
+}
+
 Actions ClientStateMachine::processSocketData(
     const State& state,
     folly::IOBufQueue& buf) {
@@ -272,32 +293,34 @@ Actions handleInvalidEvent(const State& state, Event event, Param param) {
 
 namespace sm {
 
-static folly::Optional<CachedPsk> validatePsk(
+static std::shared_ptr<const CachedPsk> validatePsk(
     const FizzClientContext& context,
-    folly::Optional<CachedPsk> psk) {
+    std::shared_ptr<const CachedPsk> psk) {
   if (!psk) {
-    return folly::none;
+    return nullptr;
   }
 
   if (std::chrono::system_clock::now() > psk->ticketExpirationTime) {
     VLOG(1) << "Ignoring expired cached psk";
-    return folly::none;
+    return nullptr;
   }
 
-  if (std::find(
+  // The version of external PSKs is negotiated by the handshake.
+  if (psk->type != PskType::External &&
+      std::find(
           context.getSupportedVersions().begin(),
           context.getSupportedVersions().end(),
           psk->version) == context.getSupportedVersions().end()) {
     VLOG(1) << "Ignoring cached psk with protocol version "
             << toString(psk->version);
-    return folly::none;
+    return nullptr;
   }
   if (std::find(
           context.getSupportedCiphers().begin(),
           context.getSupportedCiphers().end(),
           psk->cipher) == context.getSupportedCiphers().end()) {
     VLOG(1) << "Ignoring cached psk with cipher " << toString(psk->cipher);
-    return folly::none;
+    return nullptr;
   }
 
   return psk;
@@ -320,13 +343,9 @@ static ClientHello getClientHello(
     const Random& random,
     bool alternateSniCodePoint,
     const std::vector<CipherSuite>& supportedCiphers,
-    const std::vector<ProtocolVersion>& supportedVersions,
-    const std::vector<NamedGroup>& supportedGroups,
+    const ClientHelloTemplate& chloTemplate,
     const std::map<NamedGroup, std::unique_ptr<KeyExchange>>& shares,
-    const std::vector<SignatureScheme>& supportedSigSchemes,
-    const std::vector<PskKeyExchangeMode>& supportedPskModes,
     const folly::Optional<std::string>& hostname,
-    const std::vector<std::string>& supportedAlpns,
     const Optional<EarlyDataParams>& earlyDataParams,
     const Buf& legacySessionId,
     ClientExtensions* extensions,
@@ -338,13 +357,10 @@ static ClientHello getClientHello(
   chlo.cipher_suites = supportedCiphers;
   chlo.legacy_compression_methods.push_back(0x00);
 
-  SupportedVersions versions;
-  versions.versions = supportedVersions;
-  chlo.extensions.push_back(encodeExtension(std::move(versions)));
-
-  SupportedGroups groups;
-  groups.named_group_list = supportedGroups;
-  chlo.extensions.push_back(encodeExtension(std::move(groups)));
+  chlo.extensions.push_back(
+      ClientHelloTemplate::clone(chloTemplate.supportedVersions));
+  chlo.extensions.push_back(
+      ClientHelloTemplate::clone(chloTemplate.supportedGroups));
 
   ClientKeyShare keyShare;
   for (const auto& share : shares) {
@@ -355,9 +371,8 @@ static ClientHello getClientHello(
   }
   chlo.extensions.push_back(encodeExtension(std::move(keyShare)));
 
-  SignatureAlgorithms sigAlgs;
-  sigAlgs.supported_signature_algorithms = supportedSigSchemes;
-  chlo.extensions.push_back(encodeExtension(std::move(sigAlgs)));
+  chlo.extensions.push_back(
+      ClientHelloTemplate::clone(chloTemplate.signatureAlgorithms));
 
   if (hostname) {
     ServerNameList sni;
@@ -368,20 +383,23 @@ static ClientHello getClientHello(
     chlo.extensions.push_back(encodeExtension(std::move(sni)));
   }
 
-  if (!supportedAlpns.empty()) {
-    ProtocolNameList alpn;
-    for (const auto& protoName : supportedAlpns) {
-      ProtocolName proto;
-      proto.name = folly::IOBuf::copyBuffer(protoName);
-      alpn.protocol_name_list.push_back(std::move(proto));
-    }
-    chlo.extensions.push_back(encodeExtension(std::move(alpn)));
+  if (chloTemplate.alpn) {
+    chlo.extensions.push_back(ClientHelloTemplate::clone(*chloTemplate.alpn));
+  }
+
+  if (chloTemplate.pskModes) {
+    chlo.extensions.push_back(
+        ClientHelloTemplate::clone(*chloTemplate.pskModes));
   }
 
-  if (!supportedPskModes.empty()) {
-    PskKeyExchangeModes modes;
-    modes.modes = supportedPskModes;
-    chlo.extensions.push_back(encodeExtension(std::move(modes)));
+  if (chloTemplate.serverCertTypes) {
+    chlo.extensions.push_back(
+        ClientHelloTemplate::clone(*chloTemplate.serverCertTypes));
+  }
+
+  if (chloTemplate.clientCertTypes) {
+    chlo.extensions.push_back(
+        ClientHelloTemplate::clone(*chloTemplate.clientCertTypes));
   }
 
   if (earlyDataParams) {
@@ -408,11 +426,16 @@ static ClientPresharedKey getPskExtension(const CachedPsk& psk) {
   ClientPresharedKey pskExt;
   PskIdentity ident;
   ident.psk_identity = folly::IOBuf::copyBuffer(psk.psk);
-  ident.obfuscated_ticket_age =
-      std::chrono::duration_cast<std::chrono::milliseconds>(
-          std::chrono::system_clock::now() - psk.ticketIssueTime)
-          .count();
-  ident.obfuscated_ticket_age += psk.ticketAgeAdd;
+  if (psk.type == PskType::External) {
+    // External PSKs have no ticket age (RFC 8446 section 4.2.11).
+    ident.obfuscated_ticket_age = 0;
+  } else {
+    ident.obfuscated_ticket_age =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now() - psk.ticketIssueTime)
+            .count();
+    ident.obfuscated_ticket_age += psk.ticketAgeAdd;
+  }
   pskExt.identities.push_back(std::move(ident));
   PskBinder binder;
   size_t binderSize = getHashSize(getHashFunction(psk.cipher));
@@ -477,7 +500,7 @@ static Buf encodeAndAddBinders(
 
 static Optional<EarlyDataParams> getEarlyDataParams(
     const FizzClientContext& context,
-    const Optional<CachedPsk>& psk) {
+    const std::shared_ptr<const CachedPsk>& psk) {
   if (!context.getSendEarlyData()) {
     return folly::none;
   }
@@ -511,8 +534,12 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
 
   auto context = std::move(connect.context);
 
-  folly::Optional<CachedPsk> psk =
-      validatePsk(*context, std::move(connect.cachedPsk));
+  auto sharedPsk = std::move(connect.sharedPsk);
+  if (!sharedPsk && connect.cachedPsk) {
+    sharedPsk =
+        std::make_shared<const CachedPsk>(std::move(*connect.cachedPsk));
+  }
+  auto psk = validatePsk(*context, std::move(sharedPsk));
 
   auto random = context->getFactory()->makeRandom();
 
@@ -526,11 +553,26 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
           *psk->group) != context->getSupportedGroups().end()) {
     // key exchange done last time
     selectedShares = {*psk->group};
-  } else if (psk && !psk->group) {
+  } else if (psk && !psk->group && psk->type != PskType::External) {
     // psk_ke last time
     selectedShares = {};
   } else {
     selectedShares = context->getDefaultShares();
+    auto groupPreferenceCache = context->getGroupPreferenceCache();
+    if (groupPreferenceCache && connect.sni) {
+      auto learnedGroup = groupPreferenceCache->getGroup(*connect.sni);
+      if (learnedGroup &&
+          std::find(
+              context->getSupportedGroups().begin(),
+              context->getSupportedGroups().end(),
+              *learnedGroup) != context->getSupportedGroups().end() &&
+          std::find(
+              selectedShares.begin(), selectedShares.end(), *learnedGroup) ==
+              selectedShares.end()) {
+        // The server picked a group outside the default shares last time.
+        selectedShares = {*learnedGroup};
+      }
+    }
   }
 
   auto earlyDataParams = getEarlyDataParams(*context, psk);
@@ -550,13 +592,9 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
       random,
       context->getUseAlternateSniCodePoint(),
       context->getSupportedCiphers(),
-      context->getSupportedVersions(),
-      context->getSupportedGroups(),
+      context->getClientHelloTemplate(),
       keyExchangers,
-      context->getSupportedSigSchemes(),
-      context->getSupportedPskModes(),
       connect.sni,
-      context->getSupportedAlpns(),
       earlyDataParams,
       legacySessionId,
       connect.extensions.get());
@@ -772,7 +810,7 @@ struct NegotiatedPsk {
 
 static NegotiatedPsk negotiatePsk(
     const std::vector<PskKeyExchangeMode>& supportedPskModes,
-    const folly::Optional<CachedPsk>& attemptedPsk,
+    const std::shared_ptr<const CachedPsk>& attemptedPsk,
     const ServerHello& shlo,
     ProtocolVersion version,
     CipherSuite cipher,
@@ -797,7 +835,8 @@ static NegotiatedPsk negotiatePsk(
           "server accepted non-0 psk", AlertDescription::illegal_parameter);
     }
 
-    if (version != attemptedPsk->version) {
+    if (attemptedPsk->type != PskType::External &&
+        version != attemptedPsk->version) {
       throw FizzException(
           "different version in psk", AlertDescription::handshake_failure);
     }
@@ -823,6 +862,25 @@ static NegotiatedPsk negotiatePsk(
   }
 }
 
+static void recordSelectedGroup(
+    const State& state,
+    NamedGroup group,
+    KeyExchangeType keyExchangeType) {
+  auto groupPreferenceCache = state.context()->getGroupPreferenceCache();
+  if (!groupPreferenceCache || !state.sni()) {
+    return;
+  }
+
+  if (keyExchangeType == KeyExchangeType::OneRtt && !state.attemptedPsk()) {
+    const auto& defaultShares = state.context()->getDefaultShares();
+    if (std::find(defaultShares.begin(), defaultShares.end(), group) ==
+        defaultShares.end()) {
+      groupPreferenceCache->recordHelloRetryRequestAvoided();
+    }
+  }
+  groupPreferenceCache->putGroup(*state.sni(), group);
+}
+
 Actions
 EventHandler<ClientTypes, StateEnum::ExpectingServerHello, Event::ServerHello>::
     handle(const State& state, Param param) {
@@ -892,6 +950,8 @@ EventHandler<ClientTypes, StateEnum::ExpectingServerHello, Event::ServerHello>::
     std::tie(group, serverShare, kex) = std::move(*exchange);
     auto sharedSecret = kex->generateSharedSecret(serverShare->coalesce());
     scheduler->deriveHandshakeSecret(sharedSecret->coalesce());
+
+    recordSelectedGroup(state, *group, *keyExchangeType);
   } else {
     keyExchangeType = KeyExchangeType::None;
     scheduler->deriveHandshakeSecret();
@@ -1053,7 +1113,7 @@ Actions EventHandler<
   auto attemptedPsk = state.attemptedPsk();
   if (attemptedPsk &&
       getHashFunction(attemptedPsk->cipher) != getHashFunction(cipher)) {
-    attemptedPsk = folly::none;
+    attemptedPsk = nullptr;
   }
 
   // We move the current key exchangers in so getHrrKeyExchangers can either
@@ -1061,18 +1121,20 @@ Actions EventHandler<
   auto keyExchangers = getHrrKeyExchangers(
       *state.context()->getFactory(), std::move(*state.keyExchangers()), group);
 
+  auto groupPreferenceCache = state.context()->getGroupPreferenceCache();
+  if (group && groupPreferenceCache && state.sni()) {
+    groupPreferenceCache->recordHelloRetryRequest();
+    groupPreferenceCache->putGroup(*state.sni(), *group);
+  }
+
   auto chlo = getClientHello(
       *state.context()->getFactory(),
       state.clientRandom(),
       state.context()->getUseAlternateSniCodePoint(),
       state.context()->getSupportedCiphers(),
-      state.context()->getSupportedVersions(),
-      state.context()->getSupportedGroups(),
+      state.context()->getClientHelloTemplate(),
       keyExchangers,
-      state.context()->getSupportedSigSchemes(),
-      state.context()->getSupportedPskModes(),
       state.sni(),
-      state.context()->getSupportedAlpns(),
       folly::none,
       state.legacySessionId(),
       state.extensions(),
@@ -1178,6 +1240,26 @@ static void validateAcceptedEarly(
   }
 }
 
+template <typename SelectedType>
+static CertificateType negotiatedCertType(
+    const folly::Optional<SelectedType>& selected,
+    const std::vector<CertificateType>& supportedTypes) {
+  if (!selected) {
+    return CertificateType::X509;
+  }
+  if (std::find(
+          supportedTypes.begin(),
+          supportedTypes.end(),
+          selected->certificate_type) == supportedTypes.end()) {
+    throw FizzException(
+        folly::to<std::string>(
+            "server choose unsupported certificate type: ",
+            toString(selected->certificate_type)),
+        AlertDescription::illegal_parameter);
+  }
+  return selected->certificate_type;
+}
+
 Actions EventHandler<
     ClientTypes,
     StateEnum::ExpectingEncryptedExtensions,
@@ -1225,15 +1307,26 @@ Actions EventHandler<
     }
   }
 
+  auto serverCertType = negotiatedCertType(
+      getExtension<SelectedServerCertificateType>(ee.extensions),
+      state.context()->getSupportedServerCertTypes());
+  auto clientCertType = negotiatedCertType(
+      getExtension<SelectedClientCertificateType>(ee.extensions),
+      state.context()->getSupportedClientCertTypes());
+
   if (state.extensions()) {
     state.extensions()->onEncryptedExtensions(ee.extensions);
   }
 
   auto mutateState = [appProto = std::move(appProto),
-                      earlyDataType](State& newState) mutable {
+                      earlyDataType,
+                      serverCertType,
+                      clientCertType](State& newState) mutable {
     newState.alpn() = std::move(appProto);
     newState.requestedExtensions() = folly::none;
     newState.earlyDataType() = earlyDataType;
+    newState.serverCertType() = serverCertType;
+    newState.clientCertType() = clientCertType;
   };
 
   if (state.serverCert() != nullptr) {
@@ -1253,6 +1346,13 @@ getClientCert(const State& state, const std::vector<SignatureScheme>& schemes) {
   auto clientCert = state.context()->getClientCertificate();
   const auto& supportedSchemes = state.context()->getSupportedSigSchemes();
 
+  if (clientCert &&
+      clientCert->getCertificateType() != state.clientCertType()) {
+    VLOG(1) << "client cert is not of the negotiated certificate type "
+            << toString(state.clientCertType());
+    clientCert = nullptr;
+  }
+
   if (clientCert) {
     const auto certSchemes = clientCert->getSigSchemes();
     for (const auto& scheme : supportedSchemes) {
@@ -1336,6 +1436,13 @@ EventHandler<ClientTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
         AlertDescription::illegal_parameter);
   }
 
+  if (state.serverCertType() == CertificateType::RawPublicKey &&
+      certMsg.certificate_list.size() > 1) {
+    throw FizzException(
+        "raw public key certificate message with multiple entries",
+        AlertDescription::illegal_parameter);
+  }
+
   std::vector<std::shared_ptr<const PeerCert>> serverCerts;
   for (auto& certEntry : certMsg.certificate_list) {
     // We don't request any certificate-related extensions
@@ -1345,8 +1452,14 @@ EventHandler<ClientTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
           AlertDescription::illegal_parameter);
     }
 
-    serverCerts.emplace_back(state.context()->getFactory()->makePeerCert(
-        std::move(certEntry.cert_data)));
+    if (state.serverCertType() == CertificateType::RawPublicKey) {
+      serverCerts.emplace_back(
+          state.context()->getFactory()->makePeerRawPublicKey(
+              std::move(certEntry.cert_data)));
+    } else {
+      serverCerts.emplace_back(state.context()->getFactory()->makePeerCert(
+          std::move(certEntry.cert_data)));
+    }
   }
 
   if (serverCerts.empty()) {
@@ -1393,28 +1506,62 @@ Actions EventHandler<
       state.handshakeContext()->getHandshakeContext()->coalesce(),
       certVerify.signature->coalesce());
 
+  Optional<folly::Future<folly::Unit>> pendingVerification;
   if (state.verifier()) {
-    try {
-      state.verifier()->verify(state.unverifiedCertChain());
-    } catch (const FizzException&) {
-      std::rethrow_exception(std::current_exception());
-    } catch (const std::exception& e) {
-      throw FizzException(
-          folly::to<std::string>("verifier failure: ", e.what()),
-          AlertDescription::bad_certificate);
+    auto asyncVerifier =
+        dynamic_cast<const AsyncCertificateVerifier*>(state.verifier().get());
+    if (asyncVerifier) {
+      auto verified =
+          asyncVerifier->verifyFuture(state.unverifiedCertChain())
+              .onError([](folly::exception_wrapper ew) -> folly::Unit {
+                if (ew.is_compatible_with<FizzException>()) {
+                  ew.throw_exception();
+                }
+                throw FizzException(
+                    folly::to<std::string>(
+                        "verifier failure: ",
+                        ew.get_exception() ? ew.get_exception()->what()
+                                           : ew.what().toStdString()),
+                    AlertDescription::bad_certificate);
+              });
+      if (verified.isReady()) {
+        // Throws if verification already failed.
+        verified.value();
+      } else if (state.executor()) {
+        pendingVerification = std::move(verified).via(state.executor());
+      } else {
+        pendingVerification = std::move(verified);
+      }
+    } else {
+      try {
+        state.verifier()->verify(state.unverifiedCertChain());
+      } catch (const FizzException&) {
+        std::rethrow_exception(std::current_exception());
+      } catch (const std::exception& e) {
+        throw FizzException(
+            folly::to<std::string>("verifier failure: ", e.what()),
+            AlertDescription::bad_certificate);
+      }
     }
   }
 
   state.handshakeContext()->appendToTranscript(*certVerify.originalEncoding);
 
-  return actions(
+  MutateState saveCert(
       [sigScheme = certVerify.algorithm,
        serverCert = std::move(leaf)](State& newState) mutable {
         newState.sigScheme() = sigScheme;
         newState.serverCert() = std::move(serverCert);
         newState.unverifiedCertChain() = folly::none;
-      },
-      &Transition<StateEnum::ExpectingFinished>);
+      });
+  if (pendingVerification) {
+    return actions(
+        WaitForVerification{std::move(*pendingVerification)},
+        std::move(saveCert),
+        &Transition<StateEnum::ExpectingFinished>);
+  }
+  return actions(
+      std::move(saveCert), &Transition<StateEnum::ExpectingFinished>);
 }
 
 Actions
@@ -1566,6 +1713,12 @@ EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::Finished>::
         newState.earlyWriteRecordLayer() = nullptr;
         newState.clientHandshakeSecret() = folly::none;
         newState.serverHandshakeSecret() = folly::none;
+        // Release handshake material that is not needed once application
+        // data is flowing.
+        newState.handshakeContext() = nullptr;
+        newState.unverifiedCertChain() = folly::none;
+        newState.attemptedPsk() = nullptr;
+        newState.requestedExtensions() = folly::none;
         newState.resumptionSecret() = std::move(resumptionSecret);
         newState.exporterMasterSecret() = std::move(exporterMaster);
         newState.selectedClientCert() = nullptr;
@@ -30,6 +30,17 @@ class ClientStateMachine {
       std::shared_ptr<const FizzClientContext> context,
       std::shared_ptr<const CertificateVerifier> verifier,
       folly::Optional<std::string> sni,
+      std::shared_ptr<const CachedPsk> cachedPsk,
+      const std::shared_ptr<ClientExtensions>& extensions);
+
+  /**
+   * Same as above, for callers that own their copy of the PSK.
+   */
+  Actions processConnect(
+      const State& state,
+      std::shared_ptr<const FizzClientContext> context,
+      std::shared_ptr<const CertificateVerifier> verifier,
+      folly::Optional<std::string> sni,
       folly::Optional<CachedPsk> cachedPsk,
       const std::shared_ptr<ClientExtensions>& extensions);
 
@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/ExternalPskCache.h>
+
+namespace fizz {
+namespace client {
+
+CachedPsk ExternalPskCache::makeExternalPsk(
+    std::string pskIdentity,
+    std::string secret,
+    CipherSuite cipher) {
+  CachedPsk psk;
+  psk.psk = std::move(pskIdentity);
+  psk.secret = std::move(secret);
+  psk.type = PskType::External;
+  // The version is negotiated by the handshake, not fixed by the PSK.
+  psk.version = ProtocolVersion::tls_1_3;
+  psk.cipher = cipher;
+  psk.ticketAgeAdd = 0;
+  psk.ticketIssueTime = std::chrono::system_clock::time_point();
+  psk.ticketExpirationTime = std::chrono::system_clock::time_point::max();
+  return psk;
+}
+
+void ExternalPskCache::addExternalPsk(
+    const std::string& identity,
+    CachedPsk psk) {
+  CHECK(psk.type == PskType::External);
+  (*externalPsks_.wlock())[identity] = std::move(psk);
+}
+
+void ExternalPskCache::removeExternalPsk(const std::string& identity) {
+  externalPsks_.wlock()->erase(identity);
+}
+
+folly::Optional<CachedPsk> ExternalPskCache::getPsk(
+    const std::string& identity) {
+  if (resumptionCache_) {
+    auto psk = resumptionCache_->getPsk(identity);
+    if (psk) {
+      return psk;
+    }
+  }
+
+  auto externalPsks = externalPsks_.rlock();
+  auto it = externalPsks->find(identity);
+  if (it == externalPsks->end()) {
+    return folly::none;
+  }
+  return it->second;
+}
+
+std::shared_ptr<const CachedPsk> ExternalPskCache::getSharedPsk(
+    const std::string& identity) {
+  if (resumptionCache_) {
+    auto psk = resumptionCache_->getSharedPsk(identity);
+    if (psk) {
+      return psk;
+    }
+  }
+
+  auto externalPsks = externalPsks_.rlock();
+  auto it = externalPsks->find(identity);
+  if (it == externalPsks->end()) {
+    return nullptr;
+  }
+  return std::make_shared<const CachedPsk>(it->second);
+}
+
+void ExternalPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  if (resumptionCache_) {
+    resumptionCache_->putPsk(identity, std::move(psk));
+  }
+}
+
+void ExternalPskCache::removePsk(const std::string& identity) {
+  if (resumptionCache_) {
+    resumptionCache_->removePsk(identity);
+  }
+}
+} // namespace client
+} // namespace fizz
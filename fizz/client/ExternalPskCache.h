@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <folly/Synchronized.h>
+
+namespace fizz {
+namespace client {
+
+/**
+ * PSK cache holding PSKs provisioned out of band (external PSKs), for
+ * certificate-less handshakes with servers that have the same PSK in their
+ * ExternalPskStore.
+ *
+ * Resumption PSKs obtained from connections are stored in the wrapped cache
+ * (if any) and preferred over the external PSK for the same identity. An
+ * external PSK is never replaced or removed by the handshake, only by
+ * removeExternalPsk().
+ */
+class ExternalPskCache : public PskCache {
+ public:
+  explicit ExternalPskCache(std::shared_ptr<PskCache> resumptionCache = nullptr)
+      : resumptionCache_(std::move(resumptionCache)) {}
+  ~ExternalPskCache() override = default;
+
+  /**
+   * Builds a CachedPsk for an external PSK. pskIdentity is the identity sent
+   * to the server, cipher determines the hash used with the PSK.
+   */
+  static CachedPsk makeExternalPsk(
+      std::string pskIdentity,
+      std::string secret,
+      CipherSuite cipher = CipherSuite::TLS_AES_128_GCM_SHA256);
+
+  /**
+   * Provisions an external PSK, used for connections with the given identity
+   * (the pskIdentity passed to AsyncFizzClient::connect()).
+   */
+  void addExternalPsk(const std::string& identity, CachedPsk psk);
+
+  void removeExternalPsk(const std::string& identity);
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  std::shared_ptr<const CachedPsk> getSharedPsk(
+      const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+ private:
+  std::shared_ptr<PskCache> resumptionCache_;
+  folly::Synchronized<std::unordered_map<std::string, CachedPsk>> externalPsks_;
+};
+} // namespace client
+} // namespace fizz
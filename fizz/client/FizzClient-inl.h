@@ -14,7 +14,7 @@ void FizzClient<ActionMoveVisitor, SM>::connect(
     std::shared_ptr<const FizzClientContext> context,
     std::shared_ptr<const CertificateVerifier> verifier,
     folly::Optional<std::string> sni,
-    folly::Optional<CachedPsk> cachedPsk,
+    std::shared_ptr<const CachedPsk> cachedPsk,
     const std::shared_ptr<ClientExtensions>& extensions) {
   this->addProcessingActions(this->machine_.processConnect(
       this->state_,
@@ -25,6 +25,25 @@ void FizzClient<ActionMoveVisitor, SM>::connect(
       extensions));
 }
 
+template <typename ActionMoveVisitor, typename SM>
+void FizzClient<ActionMoveVisitor, SM>::connect(
+    std::shared_ptr<const FizzClientContext> context,
+    std::shared_ptr<const CertificateVerifier> verifier,
+    folly::Optional<std::string> sni,
+    folly::Optional<CachedPsk> cachedPsk,
+    const std::shared_ptr<ClientExtensions>& extensions) {
+  std::shared_ptr<const CachedPsk> sharedPsk;
+  if (cachedPsk) {
+    sharedPsk = std::make_shared<const CachedPsk>(std::move(*cachedPsk));
+  }
+  connect(
+      std::move(context),
+      std::move(verifier),
+      std::move(sni),
+      std::move(sharedPsk),
+      extensions);
+}
+
 template <typename ActionMoveVisitor, typename SM>
 void FizzClient<ActionMoveVisitor, SM>::connect(
     std::shared_ptr<const FizzClientContext> context,
@@ -55,7 +74,33 @@ Buf FizzClient<ActionMoveVisitor, SM>::getEarlyEkm(
 
 template <typename ActionMoveVisitor, typename SM>
 void FizzClient<ActionMoveVisitor, SM>::startActions(Actions actions) {
-  this->processActions(std::move(actions));
+  auto wait = actions.empty()
+      ? nullptr
+      : boost::get<WaitForVerification>(&actions.front());
+  if (!wait) {
+    this->processActions(std::move(actions));
+    return;
+  }
+
+  // The action guard stays held until the verification completes, so no
+  // other event is processed in between.
+  auto verified = std::move(wait->verified);
+  actions.erase(actions.begin());
+  std::move(verified).then(
+      [this, actions = std::move(actions)](
+          folly::Try<folly::Unit>&& result) mutable {
+        if (result.hasException()) {
+          std::string errorMsg = result.exception().what().toStdString();
+          folly::Optional<AlertDescription> alert =
+              AlertDescription::bad_certificate;
+          result.exception().with_exception([&](const FizzException& e) {
+            errorMsg = e.what();
+            alert = e.getAlert();
+          });
+          actions = detail::handleError(this->state_, errorMsg, alert);
+        }
+        this->processActions(std::move(actions));
+      });
 }
 } // namespace client
 } // namespace fizz
@@ -26,6 +26,13 @@ class FizzClient : public FizzBase<
   using FizzBase<FizzClient<ActionMoveVisitor, SM>, ActionMoveVisitor, SM>::
       FizzBase;
 
+  void connect(
+      std::shared_ptr<const FizzClientContext> context,
+      std::shared_ptr<const CertificateVerifier> verifier,
+      folly::Optional<std::string> sni,
+      std::shared_ptr<const CachedPsk> cachedPsk,
+      const std::shared_ptr<ClientExtensions>& extensions = nullptr);
+
   void connect(
       std::shared_ptr<const FizzClientContext> context,
       std::shared_ptr<const CertificateVerifier> verifier,
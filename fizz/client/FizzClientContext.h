@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <fizz/client/ClientHelloTemplate.h>
+#include <fizz/client/GroupPreferenceCache.h>
 #include <fizz/client/PskCache.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/Factory.h>
@@ -18,7 +20,9 @@ namespace client {
 
 class FizzClientContext {
  public:
-  FizzClientContext() : factory_(std::make_unique<Factory>()) {}
+  FizzClientContext() : factory_(std::make_unique<Factory>()) {
+    updateClientHelloTemplate();
+  }
   virtual ~FizzClientContext() = default;
 
   /**
@@ -26,6 +30,7 @@ class FizzClientContext {
    */
   void setSupportedVersions(std::vector<ProtocolVersion> versions) {
     supportedVersions_ = std::move(versions);
+    updateClientHelloTemplate();
   }
 
   const auto& getSupportedVersions() const {
@@ -48,6 +53,7 @@ class FizzClientContext {
    */
   void setSupportedSigSchemes(std::vector<SignatureScheme> schemes) {
     supportedSigSchemes_ = std::move(schemes);
+    updateClientHelloTemplate();
   }
 
   const auto& getSupportedSigSchemes() const {
@@ -59,6 +65,7 @@ class FizzClientContext {
    */
   void setSupportedGroups(std::vector<NamedGroup> groups) {
     supportedGroups_ = std::move(groups);
+    updateClientHelloTemplate();
   }
 
   const auto& getSupportedGroups() const {
@@ -80,6 +87,7 @@ class FizzClientContext {
    */
   void setSupportedPskModes(std::vector<PskKeyExchangeMode> modes) {
     supportedPskModes_ = std::move(modes);
+    updateClientHelloTemplate();
   }
 
   const auto& getSupportedPskModes() const {
@@ -91,6 +99,7 @@ class FizzClientContext {
    */
   void setSupportedAlpns(std::vector<std::string> protocols) {
     supportedAlpns_ = std::move(protocols);
+    updateClientHelloTemplate();
   }
 
   const auto& getSupportedAlpns() const {
@@ -108,6 +117,36 @@ class FizzClientContext {
     return clientCert_;
   }
 
+  /**
+   * Set the certificate types (RFC 7250) we accept from the server, in
+   * preference order. The server_certificate_type extension is only sent if
+   * this is something other than just X509. A raw public key is
+   * authenticated by the CertificateVerifier, typically by pinning
+   * PeerCert::getIdentity().
+   */
+  void setSupportedServerCertTypes(std::vector<CertificateType> types) {
+    supportedServerCertTypes_ = std::move(types);
+    updateClientHelloTemplate();
+  }
+
+  const auto& getSupportedServerCertTypes() const {
+    return supportedServerCertTypes_;
+  }
+
+  /**
+   * Set the certificate types (RFC 7250) we are able to authenticate with,
+   * in preference order. The client_certificate_type extension is only sent
+   * if this is something other than just X509.
+   */
+  void setSupportedClientCertTypes(std::vector<CertificateType> types) {
+    supportedClientCertTypes_ = std::move(types);
+    updateClientHelloTemplate();
+  }
+
+  const auto& getSupportedClientCertTypes() const {
+    return supportedClientCertTypes_;
+  }
+
   /**
    * Set the Psk Cache to use.
    */
@@ -123,6 +162,15 @@ class FizzClientContext {
     }
   }
 
+  std::shared_ptr<const CachedPsk> getSharedPsk(
+      const std::string& identity) const {
+    if (pskCache_) {
+      return pskCache_->getSharedPsk(identity);
+    } else {
+      return nullptr;
+    }
+  }
+
   void putPsk(const std::string& identity, CachedPsk psk) const {
     if (pskCache_) {
       pskCache_->putPsk(identity, std::move(psk));
@@ -135,6 +183,19 @@ class FizzClientContext {
     }
   }
 
+  /**
+   * Sets a cache of the key exchange group each server selected, used to pick
+   * the key share on later full handshakes with the same server name. Not set
+   * by default.
+   */
+  void setGroupPreferenceCache(std::shared_ptr<GroupPreferenceCache> cache) {
+    groupPreferenceCache_ = std::move(cache);
+  }
+
+  GroupPreferenceCache* getGroupPreferenceCache() const {
+    return groupPreferenceCache_.get();
+  }
+
   /**
    * Sets whether we should attempt to send early data.
    */
@@ -181,7 +242,27 @@ class FizzClientContext {
     return factory_.get();
   }
 
+  /**
+   * Pre-encoded ClientHello extensions, kept up to date with the supported
+   * versions, groups, signature schemes, psk modes, ALPNs and certificate
+   * types.
+   */
+  const ClientHelloTemplate& getClientHelloTemplate() const {
+    return clientHelloTemplate_;
+  }
+
  private:
+  void updateClientHelloTemplate() {
+    clientHelloTemplate_ = ClientHelloTemplate::make(
+        supportedVersions_,
+        supportedGroups_,
+        supportedSigSchemes_,
+        supportedPskModes_,
+        supportedAlpns_,
+        supportedServerCertTypes_,
+        supportedClientCertTypes_);
+  }
+
   std::unique_ptr<Factory> factory_;
 
   std::vector<ProtocolVersion> supportedVersions_ = {
@@ -203,14 +284,21 @@ class FizzClientContext {
       PskKeyExchangeMode::psk_dhe_ke,
       PskKeyExchangeMode::psk_ke};
   std::vector<std::string> supportedAlpns_;
+  std::vector<CertificateType> supportedServerCertTypes_ = {
+      CertificateType::X509};
+  std::vector<CertificateType> supportedClientCertTypes_ = {
+      CertificateType::X509};
   bool sendEarlyData_{false};
 
   bool compatMode_{false};
 
   std::shared_ptr<PskCache> pskCache_;
+  std::shared_ptr<GroupPreferenceCache> groupPreferenceCache_;
   std::shared_ptr<const SelfCert> clientCert_;
 
   bool useAlternateSniCodePoint_{false};
+
+  ClientHelloTemplate clientHelloTemplate_;
 };
 } // namespace client
 } // namespace fizz
@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/GroupPreferenceCache.h>
+
+namespace fizz {
+namespace client {
+
+GroupPreferenceCache::GroupPreferenceCache(size_t maxEntries)
+    : groups_(folly::EvictingCacheMap<std::string, NamedGroup>(
+          std::max<size_t>(maxEntries, 1))) {}
+
+folly::Optional<NamedGroup> GroupPreferenceCache::getGroup(
+    const std::string& serverName) {
+  auto groups = groups_.wlock();
+  auto result = groups->find(serverName);
+  if (result == groups->end()) {
+    return folly::none;
+  }
+  return result->second;
+}
+
+void GroupPreferenceCache::putGroup(
+    const std::string& serverName,
+    NamedGroup group) {
+  auto groups = groups_.wlock();
+  auto result = groups->findWithoutPromotion(serverName);
+  if (result != groups->end() && result->second == group) {
+    return;
+  }
+  groups->set(serverName, group);
+}
+
+GroupPreferenceCache::Stats GroupPreferenceCache::getStats() const {
+  Stats stats;
+  stats.helloRetryRequests =
+      helloRetryRequests_.load(std::memory_order_relaxed);
+  stats.helloRetryRequestsAvoided =
+      helloRetryRequestsAvoided_.load(std::memory_order_relaxed);
+  return stats;
+}
+} // namespace client
+} // namespace fizz
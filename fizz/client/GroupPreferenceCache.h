@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+#include <folly/Optional.h>
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
+
+#include <atomic>
+
+namespace fizz {
+namespace client {
+
+/**
+ * Remembers, per server name, the key exchange group the server selected
+ * (either in a ServerHello or a HelloRetryRequest). On the next full
+ * handshake with that server name, the client sends a key share for the
+ * remembered group instead of the default shares, so that a server that does
+ * not support the default shares does not have to send a HelloRetryRequest
+ * again.
+ *
+ * Connections resuming a PSK use the group stored with the PSK instead.
+ */
+class GroupPreferenceCache {
+ public:
+  struct Stats {
+    /**
+     * HelloRetryRequests received that asked for a different group.
+     */
+    uint64_t helloRetryRequests{0};
+    /**
+     * Handshakes where a remembered group outside the default shares was sent
+     * and accepted by the server without a HelloRetryRequest.
+     */
+    uint64_t helloRetryRequestsAvoided{0};
+  };
+
+  explicit GroupPreferenceCache(size_t maxEntries = 10000);
+
+  folly::Optional<NamedGroup> getGroup(const std::string& serverName);
+
+  void putGroup(const std::string& serverName, NamedGroup group);
+
+  void recordHelloRetryRequest() {
+    helloRetryRequests_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void recordHelloRetryRequestAvoided() {
+    helloRetryRequestsAvoided_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Stats getStats() const;
+
+ private:
+  folly::Synchronized<folly::EvictingCacheMap<std::string, NamedGroup>> groups_;
+  std::atomic<uint64_t> helloRetryRequests_{0};
+  std::atomic<uint64_t> helloRetryRequestsAvoided_{0};
+};
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/MultiTicketPskCache.h>
+
+namespace fizz {
+namespace client {
+
+MultiTicketPskCache::MultiTicketPskCache(Options options)
+    : options_(std::move(options)),
+      cache_(PskPoolMap(std::max<size_t>(options_.maxIdentities, 1))) {}
+
+folly::Optional<CachedPsk> MultiTicketPskCache::getPsk(
+    const std::string& identity) {
+  auto currentTime = now();
+  auto cacheMap = cache_.wlock();
+  auto result = cacheMap->find(identity);
+  if (result == cacheMap->end()) {
+    return folly::none;
+  }
+
+  auto& pool = result->second;
+  while (!pool.empty()) {
+    auto psk = std::move(pool.front());
+    pool.pop_front();
+    if (psk.ticketExpirationTime > currentTime) {
+      if (pool.empty()) {
+        cacheMap->erase(identity);
+      }
+      return std::move(psk);
+    }
+  }
+  cacheMap->erase(identity);
+  return folly::none;
+}
+
+void MultiTicketPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  auto cacheMap = cache_.wlock();
+  auto result = cacheMap->find(identity);
+  if (result == cacheMap->end()) {
+    std::deque<CachedPsk> pool;
+    pool.push_back(std::move(psk));
+    cacheMap->set(identity, std::move(pool));
+    return;
+  }
+
+  auto& pool = result->second;
+  pool.push_back(std::move(psk));
+  while (pool.size() > std::max<size_t>(options_.maxPsksPerIdentity, 1)) {
+    pool.pop_front();
+  }
+}
+
+void MultiTicketPskCache::removePsk(const std::string& identity) {
+  cache_.wlock()->erase(identity);
+}
+
+size_t MultiTicketPskCache::numPsks(const std::string& identity) {
+  auto cacheMap = cache_.rlock();
+  auto result = cacheMap->findWithoutPromotion(identity);
+  if (result == cacheMap->end()) {
+    return 0;
+  }
+  return result->second.size();
+}
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
+
+#include <deque>
+
+namespace fizz {
+namespace client {
+
+/**
+ * PSK cache that keeps a small pool of PSKs per identity and hands out each
+ * PSK only once. Combined with a server that issues several tickets per
+ * connection (see server::FixedTicketPolicy), this allows several concurrent
+ * connections to the same identity to all resume (and attempt early data)
+ * instead of racing for a single ticket.
+ *
+ * putPsk() adds to the identity's pool, dropping the oldest PSK once
+ * maxPsksPerIdentity is reached. getPsk() removes and returns the oldest PSK
+ * that has not expired. Identities are evicted least recently used first once
+ * maxIdentities is reached.
+ *
+ * removePsk() drops the identity's whole pool. It is called when a PSK turns
+ * out to be unusable (for example when its early data parameters no longer
+ * match), and the other tickets from the same connection share those
+ * parameters.
+ *
+ * Since every connection consumes a PSK, the pool only stays filled if the
+ * server issues at least one ticket per resumed connection.
+ */
+class MultiTicketPskCache : public PskCache {
+ public:
+  struct Options {
+    size_t maxIdentities{1000};
+    size_t maxPsksPerIdentity{4};
+  };
+
+  MultiTicketPskCache() : MultiTicketPskCache(Options()) {}
+  explicit MultiTicketPskCache(Options options);
+
+  ~MultiTicketPskCache() override = default;
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+  /**
+   * Number of PSKs currently pooled for identity.
+   */
+  size_t numPsks(const std::string& identity);
+
+ protected:
+  virtual std::chrono::system_clock::time_point now() const {
+    return std::chrono::system_clock::now();
+  }
+
+ private:
+  using PskPoolMap =
+      folly::EvictingCacheMap<std::string, std::deque<CachedPsk>>;
+
+  Options options_;
+  folly::Synchronized<PskPoolMap> cache_;
+};
+} // namespace client
+} // namespace fizz
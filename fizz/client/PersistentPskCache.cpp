@@ -0,0 +1,315 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/PersistentPskCache.h>
+
+#include <folly/Exception.h>
+#include <folly/FileUtil.h>
+#include <folly/hash/Checksum.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/system/MemoryMapping.h>
+
+#include <sys/stat.h>
+
+namespace fizz {
+namespace client {
+
+namespace {
+constexpr folly::StringPiece kMagic{"FIZZPSK1"};
+constexpr size_t kRecordHeaderSize = 2 * sizeof(uint32_t);
+
+enum class RecordType : uint8_t {
+  Put = 1,
+  Remove = 2,
+};
+} // namespace
+
+/**
+ * Record layout: payload length (4 bytes), CRC32C of the payload (4 bytes),
+ * payload. The payload is the record type, the identity and, for puts, the
+ * serialized PSK.
+ */
+static Buf makeRecord(
+    RecordType type,
+    const std::string& identity,
+    const Buf& serializedPsk = nullptr) {
+  auto payload = folly::IOBuf::create(64);
+  folly::io::Appender payloadAppender(payload.get(), 64);
+  fizz::detail::write(type, payloadAppender);
+  fizz::detail::writeBuf<uint16_t>(
+      folly::IOBuf::copyBuffer(identity), payloadAppender);
+  if (type == RecordType::Put) {
+    fizz::detail::writeBuf<uint32_t>(serializedPsk, payloadAppender);
+  }
+  payload->coalesce();
+
+  auto record = folly::IOBuf::create(kRecordHeaderSize + payload->length());
+  folly::io::Appender appender(record.get(), 0);
+  appender.writeBE<uint32_t>(payload->length());
+  appender.writeBE<uint32_t>(
+      folly::crc32c(payload->data(), payload->length()));
+  appender.push(payload->data(), payload->length());
+  return record;
+}
+
+PersistentPskCache::PersistentPskCache(std::string path, Options options)
+    : path_(std::move(path)),
+      options_(std::move(options)),
+      file_(path_, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600) {
+  if (!file_.try_lock()) {
+    throw std::runtime_error("psk cache file is in use: " + path_);
+  }
+  load();
+}
+
+void PersistentPskCache::load() {
+  struct stat st;
+  folly::checkUnixError(fstat(file_.fd(), &st), "fstat failed");
+  size_t size = st.st_size;
+
+  size_t validSize = 0;
+  if (size > 0) {
+    folly::MemoryMapping mapping(folly::File(file_.fd()), 0, size);
+    auto buf = folly::IOBuf::wrapBuffer(mapping.range());
+    folly::io::Cursor cursor(buf.get());
+
+    auto header = folly::StringPiece(mapping.range()).subpiece(
+        0, std::min(size, kMagic.size()));
+    if (!kMagic.startsWith(header)) {
+      // Refuse to touch a file we did not write, it may belong to someone
+      // else.
+      throw std::runtime_error("psk cache file has unknown format: " + path_);
+    }
+    if (size >= kMagic.size()) {
+      cursor.skip(kMagic.size());
+      validSize = kMagic.size();
+    }
+    // Otherwise the magic itself was torn while creating the file, so it is
+    // safe to start over.
+
+    while (validSize > 0 && cursor.canAdvance(kRecordHeaderSize)) {
+      auto length = cursor.readBE<uint32_t>();
+      auto crc = cursor.readBE<uint32_t>();
+      if (!cursor.canAdvance(length)) {
+        break;
+      }
+      auto payload = cursor.peekBytes().subpiece(0, length);
+      if (folly::crc32c(payload.data(), payload.size()) != crc) {
+        break;
+      }
+      cursor.skip(length);
+
+      try {
+        auto payloadBuf = folly::IOBuf::wrapBuffer(payload);
+        folly::io::Cursor payloadCursor(payloadBuf.get());
+        RecordType type;
+        fizz::detail::read(type, payloadCursor);
+        Buf identityBuf;
+        fizz::detail::readBuf<uint16_t>(identityBuf, payloadCursor);
+        auto identity = identityBuf->moveToFbString().toStdString();
+
+        auto existing = cache_.find(identity);
+        if (existing != cache_.end()) {
+          liveSize_ -= existing->second.recordSize;
+          cache_.erase(existing);
+        }
+        if (type == RecordType::Put) {
+          Buf serializedPsk;
+          fizz::detail::readBuf<uint32_t>(serializedPsk, payloadCursor);
+          auto recordSize = kRecordHeaderSize + length;
+          cache_.emplace(
+              std::move(identity),
+              Entry{deserializePsk(serializedPsk->coalesce()), recordSize});
+          liveSize_ += recordSize;
+        }
+      } catch (const std::exception& ex) {
+        LOG(WARNING) << "Invalid record in psk cache file " << path_ << ": "
+                     << ex.what();
+        break;
+      }
+      validSize = size - cursor.totalLength();
+    }
+  }
+
+  if (validSize == 0) {
+    folly::checkUnixError(ftruncate(file_.fd(), 0), "ftruncate failed");
+    folly::checkUnixError(
+        folly::writeFull(file_.fd(), kMagic.data(), kMagic.size()),
+        "write failed");
+    validSize = kMagic.size();
+  } else if (validSize < size) {
+    LOG(WARNING) << "Truncating psk cache file " << path_ << " from " << size
+                 << " to " << validSize << " bytes";
+    folly::checkUnixError(ftruncate(file_.fd(), validSize), "ftruncate failed");
+  }
+  fileSize_ = validSize;
+}
+
+folly::Optional<CachedPsk> PersistentPskCache::getPsk(
+    const std::string& identity) {
+  auto currentTime = now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto result = cache_.find(identity);
+  if (result == cache_.end()) {
+    return folly::none;
+  }
+  if (result->second.psk.ticketExpirationTime <= currentTime) {
+    // The record stays in the file until the next compaction.
+    liveSize_ -= result->second.recordSize;
+    cache_.erase(result);
+    return folly::none;
+  }
+  return result->second.psk;
+}
+
+void PersistentPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  auto record = makeRecord(
+      RecordType::Put,
+      identity,
+      serializePsk(psk, options_.certificateStorage));
+  auto recordSize = record->length();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!appendRecord(*record)) {
+    return;
+  }
+  auto existing = cache_.find(identity);
+  if (existing != cache_.end()) {
+    liveSize_ -= existing->second.recordSize;
+    existing->second = Entry{std::move(psk), recordSize};
+  } else {
+    cache_.emplace(identity, Entry{std::move(psk), recordSize});
+  }
+  liveSize_ += recordSize;
+  maybeCompactLocked();
+}
+
+void PersistentPskCache::removePsk(const std::string& identity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto existing = cache_.find(identity);
+  if (existing == cache_.end()) {
+    return;
+  }
+  bool written = appendRecord(*makeRecord(RecordType::Remove, identity));
+  liveSize_ -= existing->second.recordSize;
+  cache_.erase(existing);
+  if (written) {
+    maybeCompactLocked();
+  } else {
+    // The PSK is still in the file, rewrite it without it.
+    compactLocked();
+  }
+}
+
+void PersistentPskCache::compact() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  compactLocked();
+}
+
+bool PersistentPskCache::appendRecord(const folly::IOBuf& record) {
+  // The file is opened with O_APPEND, so this always lands at the end.
+  auto written = folly::writeFull(file_.fd(), record.data(), record.length());
+  if (written < 0 || static_cast<size_t>(written) != record.length()) {
+    LOG(ERROR) << "Failed to write to psk cache file " << path_ << ": "
+               << folly::errnoStr(errno);
+    // Drop whatever part of the record made it, later records would
+    // otherwise follow a torn one and be lost on the next load.
+    if (ftruncate(file_.fd(), fileSize_) != 0) {
+      LOG(ERROR) << "Failed to truncate psk cache file " << path_ << ": "
+                 << folly::errnoStr(errno);
+    }
+    return false;
+  }
+  if (options_.syncWrites) {
+    folly::fdatasyncNoInt(file_.fd());
+  }
+  fileSize_ += record.length();
+  return true;
+}
+
+void PersistentPskCache::maybeCompactLocked() {
+  auto recordsSize = fileSize_ - kMagic.size();
+  auto deadSize = recordsSize > liveSize_ ? recordsSize - liveSize_ : 0;
+  if (deadSize > options_.compactionThreshold) {
+    compactLocked();
+  }
+}
+
+static void syncParentDirectory(const std::string& path) {
+  auto slash = path.find_last_of('/');
+  std::string dir;
+  if (slash == std::string::npos) {
+    dir = ".";
+  } else if (slash == 0) {
+    dir = "/";
+  } else {
+    dir = path.substr(0, slash);
+  }
+  folly::File dirFile(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  folly::checkUnixError(folly::fsyncNoInt(dirFile.fd()), "fsync failed");
+}
+
+void PersistentPskCache::compactLocked() {
+  auto currentTime = now();
+  for (auto it = cache_.begin(); it != cache_.end();) {
+    if (it->second.psk.ticketExpirationTime <= currentTime) {
+      liveSize_ -= it->second.recordSize;
+      it = cache_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  auto tmpPath = path_ + ".tmp";
+  try {
+    folly::IOBufQueue queue;
+    queue.append(folly::IOBuf::copyBuffer(kMagic));
+    size_t liveSize = 0;
+    std::vector<std::pair<Entry*, size_t>> recordSizes;
+    for (auto& entry : cache_) {
+      auto record = makeRecord(
+          RecordType::Put,
+          entry.first,
+          serializePsk(entry.second.psk, options_.certificateStorage));
+      recordSizes.emplace_back(&entry.second, record->length());
+      liveSize += record->length();
+      queue.append(std::move(record));
+    }
+    auto data = queue.move();
+    data->coalesce();
+
+    // The new file is locked before it replaces the old one, so that no
+    // other cache can open it in between.
+    folly::File tmp(
+        tmpPath, O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0600);
+    if (!tmp.try_lock()) {
+      throw std::runtime_error("temporary file is in use");
+    }
+    folly::checkUnixError(
+        folly::writeFull(tmp.fd(), data->data(), data->length()),
+        "write failed");
+    folly::checkUnixError(folly::fsyncNoInt(tmp.fd()), "fsync failed");
+    folly::checkUnixError(
+        rename(tmpPath.c_str(), path_.c_str()), "rename failed");
+
+    file_ = std::move(tmp);
+    fileSize_ = data->length();
+    liveSize_ = liveSize;
+    for (auto& recordSize : recordSizes) {
+      recordSize.first->recordSize = recordSize.second;
+    }
+
+    // Make the rename itself durable.
+    syncParentDirectory(path_);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to compact psk cache file " << path_ << ": "
+               << ex.what();
+  }
+}
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <fizz/client/PskSerializationUtils.h>
+#include <folly/File.h>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace fizz {
+namespace client {
+
+/**
+ * PSK cache backed by a file, so that resumption state survives process
+ * restarts.
+ *
+ * The file is a log of put and remove records, each with a length and a
+ * CRC32C. At construction the file is memory mapped and replayed into an
+ * in-memory map, which then serves all lookups. A torn or corrupt tail (for
+ * example after a crash during a write) ends the replay and is truncated
+ * away. Updates append a record to the file. Construction throws if the
+ * file exists but was not written by a PersistentPskCache, rather than
+ * overwriting it.
+ *
+ * Once the file holds more than compactionThreshold bytes of superseded or
+ * expired records, it is rewritten with only the live PSKs into a temporary
+ * file that is then renamed over the original, so a crash during compaction
+ * leaves either the old or the new file in place.
+ *
+ * If an update can't be written, any partially written bytes are truncated
+ * away and the update is dropped from memory as well, so the file and the
+ * in-memory map always agree.
+ *
+ * Only one PersistentPskCache (in one process) may use a given file at a
+ * time. The file is locked with flock() and construction throws if it is
+ * already locked.
+ */
+class PersistentPskCache : public PskCache {
+ public:
+  struct Options {
+    PskCertificateStorage certificateStorage{PskCertificateStorage::X509};
+    size_t compactionThreshold{1024 * 1024};
+    /**
+     * Whether to fdatasync() after every update. Without it, recent updates
+     * may be lost on a machine crash (but not on a process crash).
+     */
+    bool syncWrites{false};
+  };
+
+  explicit PersistentPskCache(std::string path)
+      : PersistentPskCache(std::move(path), Options()) {}
+  PersistentPskCache(std::string path, Options options);
+
+  ~PersistentPskCache() override = default;
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+  /**
+   * Rewrites the file with only the PSKs that have not expired.
+   */
+  void compact();
+
+ protected:
+  virtual std::chrono::system_clock::time_point now() const {
+    return std::chrono::system_clock::now();
+  }
+
+ private:
+  struct Entry {
+    CachedPsk psk;
+    size_t recordSize;
+  };
+
+  void load();
+  bool appendRecord(const folly::IOBuf& record);
+  void compactLocked();
+  void maybeCompactLocked();
+
+  std::string path_;
+  Options options_;
+
+  std::mutex mutex_;
+  folly::File file_;
+  std::unordered_map<std::string, Entry> cache_;
+  size_t fileSize_{0};
+  size_t liveSize_{0};
+};
+} // namespace client
+} // namespace fizz
@@ -12,6 +12,7 @@
 #include <fizz/protocol/Types.h>
 #include <fizz/record/Types.h>
 #include <chrono>
+#include <memory>
 #include <unordered_map>
 
 namespace fizz {
@@ -45,6 +46,19 @@ class PskCache {
    */
   virtual folly::Optional<CachedPsk> getPsk(const std::string& identity) = 0;
 
+  /**
+   * Retrieve a PSK for the specified identity without copying it, if the
+   * cache supports that. The default implementation wraps getPsk().
+   */
+  virtual std::shared_ptr<const CachedPsk> getSharedPsk(
+      const std::string& identity) {
+    auto psk = getPsk(identity);
+    if (!psk) {
+      return nullptr;
+    }
+    return std::make_shared<const CachedPsk>(std::move(*psk));
+  }
+
   /**
    * Add a new PSK for identity to the cache.
    */
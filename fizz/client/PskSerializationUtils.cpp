@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/PskSerializationUtils.h>
+
+#include <folly/ssl/OpenSSLCertUtils.h>
+
+namespace fizz {
+namespace client {
+
+static constexpr uint8_t kPskSerializationVersion = 1;
+
+static void writeCert(
+    PskCertificateStorage storage,
+    const std::shared_ptr<const Cert>& cert,
+    folly::io::Appender& appender) {
+  Buf certBuf;
+  PskCertificateStorage selectedStorage;
+  if (!cert || storage == PskCertificateStorage::None) {
+    selectedStorage = PskCertificateStorage::None;
+  } else if (storage == PskCertificateStorage::X509 && cert->getX509()) {
+    selectedStorage = PskCertificateStorage::X509;
+    certBuf = folly::ssl::OpenSSLCertUtils::derEncode(*cert->getX509());
+  } else {
+    selectedStorage = PskCertificateStorage::IdentityOnly;
+    certBuf = folly::IOBuf::copyBuffer(cert->getIdentity());
+  }
+  fizz::detail::write(selectedStorage, appender);
+  if (selectedStorage != PskCertificateStorage::None) {
+    fizz::detail::writeBuf<uint16_t>(certBuf, appender);
+  }
+}
+
+static std::shared_ptr<const Cert> readCert(folly::io::Cursor& cursor) {
+  PskCertificateStorage storage;
+  fizz::detail::read(storage, cursor);
+  switch (storage) {
+    case PskCertificateStorage::None:
+      return nullptr;
+    case PskCertificateStorage::X509: {
+      Buf certBuf;
+      fizz::detail::readBuf<uint16_t>(certBuf, cursor);
+      return CertUtils::makePeerCert(std::move(certBuf));
+    }
+    case PskCertificateStorage::IdentityOnly: {
+      Buf ident;
+      fizz::detail::readBuf<uint16_t>(ident, cursor);
+      return std::make_shared<const IdentityCert>(
+          ident->moveToFbString().toStdString());
+    }
+  }
+  throw std::runtime_error("unknown certificate storage");
+}
+
+static uint64_t toMillis(std::chrono::system_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             time.time_since_epoch())
+      .count();
+}
+
+static std::chrono::system_clock::time_point fromMillis(uint64_t millis) {
+  return std::chrono::system_clock::time_point(
+      std::chrono::milliseconds(millis));
+}
+
+Buf serializePsk(const CachedPsk& psk, PskCertificateStorage storage) {
+  auto buf = folly::IOBuf::create(128);
+  folly::io::Appender appender(buf.get(), 128);
+
+  fizz::detail::write(kPskSerializationVersion, appender);
+  fizz::detail::writeBuf<uint16_t>(
+      folly::IOBuf::copyBuffer(psk.psk), appender);
+  fizz::detail::writeBuf<uint16_t>(
+      folly::IOBuf::copyBuffer(psk.secret), appender);
+  fizz::detail::write(static_cast<uint8_t>(psk.type), appender);
+  fizz::detail::write(psk.version, appender);
+  fizz::detail::write(psk.cipher, appender);
+  if (psk.group) {
+    fizz::detail::write(static_cast<uint8_t>(1), appender);
+    fizz::detail::write(*psk.group, appender);
+  } else {
+    fizz::detail::write(static_cast<uint8_t>(0), appender);
+  }
+  writeCert(storage, psk.serverCert, appender);
+  writeCert(storage, psk.clientCert, appender);
+  fizz::detail::write(psk.maxEarlyDataSize, appender);
+  if (psk.alpn) {
+    fizz::detail::writeBuf<uint8_t>(
+        folly::IOBuf::copyBuffer(*psk.alpn), appender);
+  } else {
+    fizz::detail::writeBuf<uint8_t>(nullptr, appender);
+  }
+  fizz::detail::write(psk.ticketAgeAdd, appender);
+  fizz::detail::write(toMillis(psk.ticketIssueTime), appender);
+  fizz::detail::write(toMillis(psk.ticketExpirationTime), appender);
+  return buf;
+}
+
+CachedPsk deserializePsk(folly::ByteRange serialized) {
+  auto buf = folly::IOBuf::wrapBuffer(serialized);
+  folly::io::Cursor cursor(buf.get());
+
+  uint8_t version;
+  fizz::detail::read(version, cursor);
+  if (version != kPskSerializationVersion) {
+    throw std::runtime_error("unsupported psk serialization version");
+  }
+
+  CachedPsk psk;
+  Buf pskBuf;
+  fizz::detail::readBuf<uint16_t>(pskBuf, cursor);
+  psk.psk = pskBuf->moveToFbString().toStdString();
+  Buf secretBuf;
+  fizz::detail::readBuf<uint16_t>(secretBuf, cursor);
+  psk.secret = secretBuf->moveToFbString().toStdString();
+  uint8_t type;
+  fizz::detail::read(type, cursor);
+  if (type != static_cast<uint8_t>(PskType::External) &&
+      type != static_cast<uint8_t>(PskType::Resumption)) {
+    throw std::runtime_error("invalid psk type");
+  }
+  psk.type = static_cast<PskType>(type);
+  fizz::detail::read(psk.version, cursor);
+  fizz::detail::read(psk.cipher, cursor);
+  uint8_t hasGroup;
+  fizz::detail::read(hasGroup, cursor);
+  if (hasGroup) {
+    NamedGroup group;
+    fizz::detail::read(group, cursor);
+    psk.group = group;
+  }
+  psk.serverCert = readCert(cursor);
+  psk.clientCert = readCert(cursor);
+  fizz::detail::read(psk.maxEarlyDataSize, cursor);
+  Buf alpnBuf;
+  fizz::detail::readBuf<uint8_t>(alpnBuf, cursor);
+  if (!alpnBuf->empty()) {
+    psk.alpn = alpnBuf->moveToFbString().toStdString();
+  }
+  fizz::detail::read(psk.ticketAgeAdd, cursor);
+  uint64_t issueTime;
+  fizz::detail::read(issueTime, cursor);
+  psk.ticketIssueTime = fromMillis(issueTime);
+  uint64_t expirationTime;
+  fizz::detail::read(expirationTime, cursor);
+  psk.ticketExpirationTime = fromMillis(expirationTime);
+
+  if (!cursor.isAtEnd()) {
+    throw std::runtime_error("trailing data after serialized psk");
+  }
+  return psk;
+}
+} // namespace client
+} // namespace fizz
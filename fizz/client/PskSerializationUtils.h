@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+
+namespace fizz {
+namespace client {
+
+/**
+ * How certificates in a CachedPsk are serialized. X509 stores the DER
+ * encoding (falling back to the identity for certificates without an X509
+ * representation), IdentityOnly stores only the certificate identity.
+ */
+enum class PskCertificateStorage : uint8_t {
+  None = 0,
+  X509 = 1,
+  IdentityOnly = 2,
+};
+
+/**
+ * Serializes psk into a compact binary encoding suitable for storing outside
+ * of the process.
+ */
+Buf serializePsk(
+    const CachedPsk& psk,
+    PskCertificateStorage storage = PskCertificateStorage::X509);
+
+/**
+ * Parses the output of serializePsk(). Throws on malformed input.
+ */
+CachedPsk deserializePsk(folly::ByteRange serialized);
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/ShardedPskCache.h>
+
+namespace fizz {
+namespace client {
+
+ShardedPskCache::ShardedPskCache(Options options) {
+  auto numShards = std::max<size_t>(options.numShards, 1);
+  shardCapacity_ = std::max<size_t>(options.capacity / numShards, 1);
+  for (size_t i = 0; i < numShards; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+std::shared_ptr<const CachedPsk> ShardedPskCache::getSharedPsk(
+    const std::string& identity) {
+  auto& shard = getShard(identity);
+  folly::SharedMutex::ReadHolder lock(shard.mutex);
+  auto result = shard.entries.find(identity);
+  if (result == shard.entries.end()) {
+    return nullptr;
+  }
+  result->second->lastAccess.store(accessTime(), std::memory_order_relaxed);
+  return result->second->psk;
+}
+
+folly::Optional<CachedPsk> ShardedPskCache::getPsk(
+    const std::string& identity) {
+  auto psk = getSharedPsk(identity);
+  if (!psk) {
+    return folly::none;
+  }
+  return *psk;
+}
+
+void ShardedPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  auto entry =
+      std::make_unique<Entry>(std::make_shared<CachedPsk>(std::move(psk)));
+  entry->lastAccess.store(accessTime(), std::memory_order_relaxed);
+
+  auto& shard = getShard(identity);
+  folly::SharedMutex::WriteHolder lock(shard.mutex);
+  auto result = shard.entries.find(identity);
+  if (result != shard.entries.end()) {
+    result->second = std::move(entry);
+    return;
+  }
+
+  if (shard.entries.size() >= shardCapacity_) {
+    auto oldest = shard.entries.begin();
+    for (auto it = shard.entries.begin(); it != shard.entries.end(); ++it) {
+      if (it->second->lastAccess.load(std::memory_order_relaxed) <
+          oldest->second->lastAccess.load(std::memory_order_relaxed)) {
+        oldest = it;
+      }
+    }
+    shard.entries.erase(oldest);
+  }
+  shard.entries.emplace(identity, std::move(entry));
+}
+
+void ShardedPskCache::removePsk(const std::string& identity) {
+  auto& shard = getShard(identity);
+  folly::SharedMutex::WriteHolder lock(shard.mutex);
+  shard.entries.erase(identity);
+}
+
+uint64_t ShardedPskCache::accessTime() {
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+ShardedPskCache::Shard& ShardedPskCache::getShard(const std::string& identity) {
+  return *shards_[std::hash<std::string>()(identity) % shards_.size()];
+}
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <folly/SharedMutex.h>
+
+#include <atomic>
+#include <unordered_map>
+
+namespace fizz {
+namespace client {
+
+/**
+ * Bounded PSK cache for clients that look up PSKs from many threads.
+ *
+ * Identities are hash partitioned into shards, each with its own reader-writer
+ * lock. Lookups only take the shard lock in shared mode: recency is tracked
+ * with a per-entry access time that is updated atomically, and used to evict
+ * the least recently used entry of a shard when it is full. This makes the
+ * LRU order approximate under concurrent access.
+ *
+ * getSharedPsk(), which the client uses, returns the cached PSK without copying
+ * it. getPsk() returns a copy.
+ */
+class ShardedPskCache : public PskCache {
+ public:
+  struct Options {
+    size_t capacity{10000};
+    size_t numShards{64};
+  };
+
+  ShardedPskCache() : ShardedPskCache(Options()) {}
+  explicit ShardedPskCache(Options options);
+
+  ~ShardedPskCache() override = default;
+
+  std::shared_ptr<const CachedPsk> getSharedPsk(
+      const std::string& identity) override;
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+ private:
+  struct Entry {
+    explicit Entry(std::shared_ptr<const CachedPsk> cachedPsk)
+        : psk(std::move(cachedPsk)) {}
+
+    std::shared_ptr<const CachedPsk> psk;
+    std::atomic<uint64_t> lastAccess{0};
+  };
+
+  struct Shard {
+    folly::SharedMutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries;
+  };
+
+  static uint64_t accessTime();
+
+  Shard& getShard(const std::string& identity);
+
+  size_t shardCapacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+} // namespace client
+} // namespace fizz
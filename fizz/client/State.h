@@ -14,6 +14,7 @@
 #include <fizz/protocol/KeyScheduler.h>
 #include <fizz/protocol/Types.h>
 #include <fizz/record/RecordLayer.h>
+#include <folly/Executor.h>
 
 namespace fizz {
 namespace client {
@@ -64,6 +65,14 @@ class State {
     return state_;
   }
 
+  /**
+   * The executor this connection is running on, if any. Asynchronous
+   * certificate verification resumes the handshake on it.
+   */
+  folly::Executor* executor() const {
+    return executor_;
+  }
+
   /**
    * The FizzClientContext used on this connection.
    */
@@ -171,6 +180,21 @@ class State {
     return alpn_;
   }
 
+  /**
+   * Certificate type (RFC 7250) the server authenticates with on this
+   * connection. X509 unless the server selected another type.
+   */
+  CertificateType serverCertType() const {
+    return serverCertType_;
+  }
+
+  /**
+   * Certificate type (RFC 7250) the server asked us to authenticate with.
+   */
+  CertificateType clientCertType() const {
+    return clientCertType_;
+  }
+
   /**
    * Server name that was sent in the SNI extensions.
    */
@@ -321,11 +345,12 @@ class State {
   }
 
   /**
-   * CachedPsk that we are attempting to use.
+   * CachedPsk that we are attempting to use. Shared with the PSK cache it came
+   * from, if the cache supports that.
    *
    * Should not be used outside of the state machine.
    */
-  const folly::Optional<CachedPsk>& attemptedPsk() const {
+  const std::shared_ptr<const CachedPsk>& attemptedPsk() const {
     return attemptedPsk_;
   }
 
@@ -421,6 +446,10 @@ class State {
     return earlyDataType_;
   }
 
+  auto& executor() {
+    return executor_;
+  }
+
   auto& earlyDataParams() {
     return earlyDataParams_;
   }
@@ -429,6 +458,14 @@ class State {
     return alpn_;
   }
 
+  auto& serverCertType() {
+    return serverCertType_;
+  }
+
+  auto& clientCertType() {
+    return clientCertType_;
+  }
+
   auto& sni() {
     return sni_;
   }
@@ -486,7 +523,13 @@ class State {
   }
 
  private:
+  // Small fields are kept together ahead of the pointers to avoid padding.
   StateEnum state_{StateEnum::Uninitialized};
+  CertificateType serverCertType_{CertificateType::X509};
+  CertificateType clientCertType_{CertificateType::X509};
+  bool sentCCS_{false};
+
+  folly::Executor* executor_{nullptr};
 
   std::shared_ptr<const FizzClientContext> context_;
 
@@ -522,7 +565,6 @@ class State {
 
   folly::Optional<Random> clientRandom_;
   folly::Optional<Buf> legacySessionId_;
-  bool sentCCS_{false};
   folly::Optional<Buf> encodedClientHello_;
   mutable folly::Optional<std::map<NamedGroup, std::unique_ptr<KeyExchange>>>
       keyExchangers_;
@@ -534,7 +576,7 @@ class State {
 
   folly::Optional<std::vector<std::shared_ptr<const PeerCert>>>
       unverifiedCertChain_;
-  folly::Optional<CachedPsk> attemptedPsk_;
+  std::shared_ptr<const CachedPsk> attemptedPsk_;
   folly::Optional<Buf> exporterMasterSecret_;
   std::shared_ptr<ClientExtensions> extensions_;
 };
@@ -10,12 +10,14 @@
 #include <gtest/gtest.h>
 
 #include <fizz/client/AsyncFizzClient.h>
+#include <fizz/client/ShardedPskCache.h>
 
 #include <fizz/client/test/Mocks.h>
 #include <fizz/protocol/test/Mocks.h>
 #include <folly/io/async/test/AsyncSocketTest.h>
 #include <folly/io/async/test/MockAsyncSocket.h>
 #include <folly/io/async/test/MockAsyncTransport.h>
+#include <folly/portability/Sockets.h>
 
 namespace fizz {
 namespace client {
@@ -181,6 +183,22 @@ TEST_F(AsyncFizzClientTest, TestConnect) {
   connect();
 }
 
+TEST_F(AsyncFizzClientTest, TestConnectSharedPsk) {
+  auto pskCache = std::make_shared<ShardedPskCache>();
+  CachedPsk psk;
+  psk.psk = "psk";
+  pskCache->putPsk(*pskIdentity_, std::move(psk));
+  context_->setPskCache(pskCache);
+
+  // The PSK is handed to the state machine without being copied.
+  auto cached = pskCache->getSharedPsk(*pskIdentity_);
+  expectTransportReadCallback();
+  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, cached, _))
+      .WillOnce(InvokeWithoutArgs([]() { return Actions(); }));
+  const auto sni = std::string("www.example.com");
+  client_->connect(&handshakeCallback_, nullptr, sni, pskIdentity_);
+}
+
 TEST_F(AsyncFizzClientTest, TestReadSingle) {
   connect();
   EXPECT_CALL(*machine_, _processSocketData(_, _))
@@ -280,6 +298,34 @@ TEST_F(AsyncFizzClientTest, TestWriteToSocket) {
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
 }
 
+TEST_F(AsyncFizzClientTest, TestWriteToSocketZeroCopy) {
+  completeHandshake();
+  client_->setReadCB(&readCallback_);
+
+  // Zero copy needs an AsyncSocket, and one supporting it, underneath.
+  AsyncSocket::UniquePtr tcpSocket(
+      new AsyncSocket(&evb_, ::socket(AF_INET, SOCK_STREAM, 0)));
+  EXPECT_CALL(*socket_, getWrappedTransport())
+      .WillRepeatedly(Return(tcpSocket.get()));
+  ASSERT_TRUE(client_->setZeroCopyWriteThreshold(100));
+
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        WriteToSocket write;
+        write.data = IOBuf::copyBuffer(std::string(100, 'x'));
+        return detail::actions(std::move(write), WaitForData());
+      }))
+      .WillOnce(InvokeWithoutArgs([]() {
+        WriteToSocket write;
+        write.data = IOBuf::copyBuffer(std::string(99, 'x'));
+        return detail::actions(std::move(write), WaitForData());
+      }));
+  EXPECT_CALL(*socket_, writeChain(_, _, WriteFlags::WRITE_MSG_ZEROCOPY));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("Data"));
+  EXPECT_CALL(*socket_, writeChain(_, _, WriteFlags::NONE));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("Data"));
+}
+
 TEST_F(AsyncFizzClientTest, TestMutateState) {
   completeHandshake();
   client_->setReadCB(&readCallback_);
@@ -432,6 +478,86 @@ TEST_F(AsyncFizzClientTest, TestSocketConnectWithOpenSocket) {
       pskIdentity_);
 }
 
+TEST_F(AsyncFizzClientTest, TestSocketConnectTcpFastOpen) {
+  MockConnectCallback cb;
+  EventBase evb;
+  MockAsyncSocket mockSocket(&evb);
+  EXPECT_CALL(*socket_, getWrappedTransport()).WillOnce(Return(&mockSocket));
+  EXPECT_CALL(mockSocket, connect_(_, _, _, _, _))
+      .WillOnce(Invoke([](AsyncSocket::ConnectCallback* connectCb,
+                          const SocketAddress&,
+                          int,
+                          const AsyncSocket::OptionMap&,
+                          const SocketAddress&) {
+        connectCb->connectSuccess();
+      }));
+  expectTransportReadCallback();
+  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        WriteToSocket write;
+        write.data = IOBuf::copyBuffer("ClientHello");
+        ReportEarlyHandshakeSuccess reportSuccess;
+        reportSuccess.maxEarlyDataSize = 1000;
+        return detail::actions(
+            std::move(write), std::move(reportSuccess), WaitForData());
+      }));
+  EXPECT_CALL(cb, _connectSuccess()).WillOnce(Invoke([this]() {
+    client_->writeChain(&writeCallback_, IOBuf::copyBuffer("HTTP GET"));
+  }));
+  EXPECT_CALL(*machine_, _processEarlyAppWrite(_, _))
+      .WillOnce(Invoke([](const State&, EarlyAppWrite& appWrite) {
+        WriteToSocket write;
+        write.callback = appWrite.callback;
+        write.data = std::move(appWrite.data);
+        return detail::actions(std::move(write));
+      }));
+
+  // The ClientHello and the early data go out in a single write.
+  auto expected = IOBuf::copyBuffer("ClientHelloHTTP GET");
+  EXPECT_CALL(*socket_, writeChain(&writeCallback_, BufMatches(expected), _));
+
+  client_->setTcpFastOpen(true);
+  client_->connect(
+      SocketAddress(),
+      &cb,
+      nullptr,
+      std::string("www.example.com"),
+      pskIdentity_);
+}
+
+TEST_F(AsyncFizzClientTest, TestSocketConnectTcpFastOpenNoEarlyData) {
+  MockConnectCallback cb;
+  EventBase evb;
+  MockAsyncSocket mockSocket(&evb);
+  EXPECT_CALL(*socket_, getWrappedTransport()).WillOnce(Return(&mockSocket));
+  EXPECT_CALL(mockSocket, connect_(_, _, _, _, _))
+      .WillOnce(Invoke([](AsyncSocket::ConnectCallback* connectCb,
+                          const SocketAddress&,
+                          int,
+                          const AsyncSocket::OptionMap&,
+                          const SocketAddress&) {
+        connectCb->connectSuccess();
+      }));
+  expectTransportReadCallback();
+  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        WriteToSocket write;
+        write.data = IOBuf::copyBuffer("ClientHello");
+        return detail::actions(std::move(write), WaitForData());
+      }));
+
+  auto expected = IOBuf::copyBuffer("ClientHello");
+  EXPECT_CALL(*socket_, writeChain(nullptr, BufMatches(expected), _));
+
+  client_->setTcpFastOpen(true);
+  client_->connect(
+      SocketAddress(),
+      &cb,
+      nullptr,
+      std::string("www.example.com"),
+      pskIdentity_);
+}
+
 TEST_F(AsyncFizzClientTest, TestApplicationProtocol) {
   completeHandshake();
   EXPECT_EQ(client_->getApplicationProtocol(), "h2");
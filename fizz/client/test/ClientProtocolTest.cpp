@@ -10,9 +10,11 @@
 #include <gtest/gtest.h>
 
 #include <fizz/client/ClientProtocol.h>
+#include <fizz/client/ExternalPskCache.h>
 #include <fizz/client/test/Mocks.h>
 #include <fizz/client/test/Utilities.h>
 #include <fizz/protocol/test/Matchers.h>
+#include <fizz/protocol/test/Mocks.h>
 #include <fizz/protocol/test/ProtocolTest.h>
 #include <fizz/protocol/test/TestMessages.h>
 #include <fizz/record/test/Mocks.h>
@@ -162,7 +164,7 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   void setupExpectingEncryptedExtensionsEarlySent() {
     setupExpectingEncryptedExtensions();
     setMockEarlyRecord();
-    state_.attemptedPsk() = getCachedPsk();
+    state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
     state_.pskType() = PskType::Resumption;
     state_.earlyDataType() = EarlyDataType::Attempted;
     state_.earlyDataParams() = getEarlyDataParams();
@@ -322,7 +324,7 @@ TEST_F(ClientProtocolTest, TestConnectFlow) {
   Random random;
   random.fill(0x44);
   EXPECT_EQ(*state_.clientRandom(), random);
-  EXPECT_FALSE(state_.attemptedPsk().hasValue());
+  EXPECT_FALSE(state_.attemptedPsk());
   EXPECT_EQ(*state_.earlyDataType(), EarlyDataType::NotAttempted);
   EXPECT_EQ(state_.earlyWriteRecordLayer().get(), nullptr);
   EXPECT_FALSE(state_.earlyDataParams().hasValue());
@@ -551,7 +553,7 @@ TEST_F(ClientProtocolTest, TestConnectNoHostNoPsk) {
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
-  EXPECT_FALSE(state_.attemptedPsk().hasValue());
+  EXPECT_FALSE(state_.attemptedPsk());
 }
 
 TEST_F(ClientProtocolTest, TestConnectPskBadVersion) {
@@ -564,7 +566,7 @@ TEST_F(ClientProtocolTest, TestConnectPskBadVersion) {
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
-  EXPECT_FALSE(state_.attemptedPsk().hasValue());
+  EXPECT_FALSE(state_.attemptedPsk());
 }
 
 TEST_F(ClientProtocolTest, TestConnectPskBadCipher) {
@@ -578,7 +580,82 @@ TEST_F(ClientProtocolTest, TestConnectPskBadCipher) {
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
-  EXPECT_FALSE(state_.attemptedPsk().hasValue());
+  EXPECT_FALSE(state_.attemptedPsk());
+}
+
+TEST_F(ClientProtocolTest, TestConnectExternalPsk) {
+  context_->setSupportedVersions({ProtocolVersion::tls_1_3_26});
+  Connect connect;
+  connect.context = context_;
+  connect.cachedPsk =
+      ExternalPskCache::makeExternalPsk("external", "externalsecret");
+  auto actions = detail::processEvent(state_, std::move(connect));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
+  EXPECT_EQ(state_.attemptedPsk()->type, PskType::External);
+  EXPECT_FALSE(state_.earlyDataParams().hasValue());
+
+  auto& encodedHello = *state_.encodedClientHello();
+  encodedHello->trimStart(4);
+  auto decodedHello = decode<ClientHello>(std::move(encodedHello));
+  auto keyShare = getExtension<ClientKeyShare>(decodedHello.extensions);
+  EXPECT_FALSE(keyShare->client_shares.empty());
+  auto pskExt = getExtension<ClientPresharedKey>(decodedHello.extensions);
+  EXPECT_EQ(pskExt->identities.size(), 1);
+  EXPECT_TRUE(IOBufEqualTo()(
+      pskExt->identities[0].psk_identity, IOBuf::copyBuffer("external")));
+  EXPECT_EQ(pskExt->identities[0].obfuscated_ticket_age, 0);
+}
+
+TEST_F(ClientProtocolTest, TestConnectCertificateTypes) {
+  context_->setSupportedServerCertTypes(
+      {CertificateType::RawPublicKey, CertificateType::X509});
+  context_->setSupportedClientCertTypes({CertificateType::RawPublicKey});
+  Connect connect;
+  connect.context = context_;
+  auto actions = detail::processEvent(state_, std::move(connect));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+
+  auto& encodedHello = *state_.encodedClientHello();
+  encodedHello->trimStart(4);
+  auto decodedHello = decode<ClientHello>(std::move(encodedHello));
+  auto serverTypes =
+      getExtension<ServerCertificateTypes>(decodedHello.extensions);
+  ASSERT_TRUE(serverTypes.hasValue());
+  EXPECT_EQ(
+      serverTypes->certificate_types,
+      std::vector<CertificateType>(
+          {CertificateType::RawPublicKey, CertificateType::X509}));
+  auto clientTypes =
+      getExtension<ClientCertificateTypes>(decodedHello.extensions);
+  ASSERT_TRUE(clientTypes.hasValue());
+  EXPECT_EQ(
+      clientTypes->certificate_types,
+      std::vector<CertificateType>({CertificateType::RawPublicKey}));
+  EXPECT_NE(
+      std::find(
+          state_.requestedExtensions()->begin(),
+          state_.requestedExtensions()->end(),
+          ExtensionType::server_certificate_type),
+      state_.requestedExtensions()->end());
+}
+
+TEST_F(ClientProtocolTest, TestConnectX509OnlyNoCertificateTypes) {
+  Connect connect;
+  connect.context = context_;
+  auto actions = detail::processEvent(state_, std::move(connect));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+
+  auto& encodedHello = *state_.encodedClientHello();
+  encodedHello->trimStart(4);
+  auto decodedHello = decode<ClientHello>(std::move(encodedHello));
+  EXPECT_FALSE(getExtension<ServerCertificateTypes>(decodedHello.extensions)
+                   .hasValue());
+  EXPECT_FALSE(getExtension<ClientCertificateTypes>(decodedHello.extensions)
+                   .hasValue());
 }
 
 TEST_F(ClientProtocolTest, TestConnectSeparatePskIdentity) {
@@ -594,6 +671,20 @@ TEST_F(ClientProtocolTest, TestConnectSeparatePskIdentity) {
   EXPECT_EQ(state_.attemptedPsk()->psk, psk.psk);
 }
 
+TEST_F(ClientProtocolTest, TestConnectSharedPsk) {
+  Connect connect;
+  connect.context = context_;
+  connect.sni = "www.hostname.com";
+  auto psk = std::make_shared<const CachedPsk>(getCachedPsk());
+  connect.sharedPsk = psk;
+  auto actions = detail::processEvent(state_, std::move(connect));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
+  // The PSK is used as is, not copied.
+  EXPECT_EQ(state_.attemptedPsk().get(), psk.get());
+}
+
 TEST_F(ClientProtocolTest, TestConnectPskIdentityWithoutSni) {
   Connect connect;
   connect.context = context_;
@@ -639,6 +730,36 @@ TEST_F(ClientProtocolTest, TestConnectNoAlpn) {
       *state_.encodedClientHello(), encodeHandshake(std::move(chlo))));
 }
 
+TEST_F(ClientProtocolTest, TestConnectContextUpdatedBetweenConnects) {
+  Connect connect;
+  connect.context = context_;
+  connect.sni = "www.hostname.com";
+  auto actions = detail::processEvent(state_, std::move(connect));
+  processStateMutations(actions);
+  EXPECT_TRUE(IOBufEqualTo()(
+      *state_.encodedClientHello(), encodeHandshake(getDefaultClientHello())));
+
+  // The pre-encoded extensions must follow changes to the context.
+  context_->setSupportedAlpns({});
+  State secondState;
+  Connect secondConnect;
+  secondConnect.context = context_;
+  secondConnect.sni = "www.hostname.com";
+  auto secondActions =
+      detail::processEvent(secondState, std::move(secondConnect));
+  for (auto& action : secondActions) {
+    try {
+      boost::get<MutateState>(action)(secondState);
+    } catch (const boost::bad_get&) {
+    }
+  }
+  auto chlo = getDefaultClientHello();
+  TestMessages::removeExtension(
+      chlo, ExtensionType::application_layer_protocol_negotiation);
+  EXPECT_TRUE(IOBufEqualTo()(
+      *secondState.encodedClientHello(), encodeHandshake(std::move(chlo))));
+}
+
 TEST_F(ClientProtocolTest, TestConnectExtension) {
   Connect connect;
   connect.context = context_;
@@ -733,6 +854,47 @@ TEST_F(ClientProtocolTest, TestConnectCachedGroup) {
   EXPECT_EQ(state_.keyExchangers()->at(NamedGroup::secp256r1).get(), mockKex);
 }
 
+TEST_F(ClientProtocolTest, TestConnectLearnedGroup) {
+  context_->setDefaultShares({NamedGroup::x25519});
+  auto groupPreferenceCache = std::make_shared<GroupPreferenceCache>();
+  groupPreferenceCache->putGroup("www.hostname.com", NamedGroup::secp256r1);
+  context_->setGroupPreferenceCache(groupPreferenceCache);
+  MockKeyExchange* mockKex;
+  EXPECT_CALL(*factory_, makeKeyExchange(NamedGroup::secp256r1))
+      .WillOnce(InvokeWithoutArgs([&mockKex]() {
+        auto ret = std::make_unique<MockKeyExchange>();
+        EXPECT_CALL(*ret, generateKeyPair());
+        EXPECT_CALL(*ret, getKeyShare()).WillOnce(InvokeWithoutArgs([]() {
+          return IOBuf::copyBuffer("p256share");
+        }));
+        mockKex = ret.get();
+        return ret;
+      }));
+
+  Connect connect;
+  connect.context = context_;
+  connect.sni = "www.hostname.com";
+  auto actions = detail::processEvent(state_, std::move(connect));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.keyExchangers()->size(), 1);
+  EXPECT_EQ(state_.keyExchangers()->at(NamedGroup::secp256r1).get(), mockKex);
+}
+
+TEST_F(ClientProtocolTest, TestConnectLearnedGroupOtherHost) {
+  auto groupPreferenceCache = std::make_shared<GroupPreferenceCache>();
+  groupPreferenceCache->putGroup("www.other.com", NamedGroup::secp256r1);
+  context_->setGroupPreferenceCache(groupPreferenceCache);
+
+  Connect connect;
+  connect.context = context_;
+  connect.sni = "www.hostname.com";
+  auto actions = detail::processEvent(state_, std::move(connect));
+  processStateMutations(actions);
+  EXPECT_EQ(state_.keyExchangers()->size(), 1);
+  EXPECT_EQ(state_.keyExchangers()->count(NamedGroup::x25519), 1);
+}
+
 TEST_F(ClientProtocolTest, TestConnectNoShares) {
   context_->setDefaultShares({});
   Connect connect;
@@ -988,7 +1150,7 @@ TEST_F(ClientProtocolTest, TestServerHelloAfterHrrFlow) {
 
 TEST_F(ClientProtocolTest, TestServerHelloPskFlow) {
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
   mockKeyScheduler_ = new MockKeyScheduler();
   mockHandshakeContext_ = new MockHandshakeContext();
   EXPECT_CALL(*factory_, makeKeyScheduler(CipherSuite::TLS_AES_128_GCM_SHA256))
@@ -1070,7 +1232,7 @@ TEST_F(ClientProtocolTest, TestServerHelloPskFlow) {
 
 TEST_F(ClientProtocolTest, TestServerHelloPskNoDhFlow) {
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
   mockKeyScheduler_ = new MockKeyScheduler();
   mockHandshakeContext_ = new MockHandshakeContext();
   EXPECT_CALL(*factory_, makeKeyScheduler(CipherSuite::TLS_AES_128_GCM_SHA256))
@@ -1149,7 +1311,7 @@ TEST_F(ClientProtocolTest, TestServerHelloPskNoDhFlow) {
 
 TEST_F(ClientProtocolTest, TestServerHelloPskAfterHrrFlow) {
   setupExpectingServerHelloAfterHrr();
-  state_.attemptedPsk() = getCachedPsk();
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
   mockKeyScheduler_ = new MockKeyScheduler();
   EXPECT_CALL(*factory_, makeKeyScheduler(CipherSuite::TLS_AES_128_GCM_SHA256))
       .WillOnce(InvokeWithoutArgs(
@@ -1226,9 +1388,32 @@ TEST_F(ClientProtocolTest, TestServerHello) {
   EXPECT_EQ(state_.state(), StateEnum::ExpectingEncryptedExtensions);
 }
 
+TEST_F(ClientProtocolTest, TestServerHelloRecordsGroup) {
+  setupExpectingServerHello();
+  context_->setDefaultShares({NamedGroup::x25519});
+  auto groupPreferenceCache = std::make_shared<GroupPreferenceCache>();
+  context_->setGroupPreferenceCache(groupPreferenceCache);
+  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  expectActions<MutateState>(actions);
+  EXPECT_EQ(
+      groupPreferenceCache->getGroup("www.hostname.com"), NamedGroup::x25519);
+  EXPECT_EQ(groupPreferenceCache->getStats().helloRetryRequestsAvoided, 0);
+}
+
+TEST_F(ClientProtocolTest, TestServerHelloLearnedGroupAvoidsHrr) {
+  setupExpectingServerHello();
+  context_->setDefaultShares({NamedGroup::secp256r1});
+  auto groupPreferenceCache = std::make_shared<GroupPreferenceCache>();
+  context_->setGroupPreferenceCache(groupPreferenceCache);
+  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  expectActions<MutateState>(actions);
+  EXPECT_EQ(groupPreferenceCache->getStats().helloRetryRequestsAvoided, 1);
+  EXPECT_EQ(groupPreferenceCache->getStats().helloRetryRequests, 0);
+}
+
 TEST_F(ClientProtocolTest, TestServerHelloPsk) {
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
   auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
   expectActions<MutateState>(actions);
   processStateMutations(actions);
@@ -1236,9 +1421,22 @@ TEST_F(ClientProtocolTest, TestServerHelloPsk) {
   EXPECT_EQ(state_.pskType(), PskType::Resumption);
 }
 
+TEST_F(ClientProtocolTest, TestServerHelloExternalPsk) {
+  setupExpectingServerHello();
+  auto psk = ExternalPskCache::makeExternalPsk("external", "externalsecret");
+  psk.version = ProtocolVersion::tls_1_2;
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(std::move(psk));
+  auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingEncryptedExtensions);
+  EXPECT_EQ(state_.pskType(), PskType::External);
+  EXPECT_EQ(state_.serverCert(), nullptr);
+}
+
 TEST_F(ClientProtocolTest, TestServerHelloPskRejected) {
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
   auto actions = detail::processEvent(state_, TestMessages::serverHello());
   expectActions<MutateState>(actions);
   processStateMutations(actions);
@@ -1347,7 +1545,7 @@ TEST_F(ClientProtocolTest, TestServerHelloPskAcceptedNotSent) {
 
 TEST_F(ClientProtocolTest, TestServerHelloOtherPskAccepted) {
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
   auto shlo = TestMessages::serverHello();
   ServerPresharedKey pskExt;
   pskExt.selected_identity = 1;
@@ -1358,8 +1556,9 @@ TEST_F(ClientProtocolTest, TestServerHelloOtherPskAccepted) {
 
 TEST_F(ClientProtocolTest, TestServerHelloPskDifferentHash) {
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
-  state_.attemptedPsk()->cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
+  auto psk = getCachedPsk();
+  psk.cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(std::move(psk));
   auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
   expectError(
       actions,
@@ -1369,8 +1568,9 @@ TEST_F(ClientProtocolTest, TestServerHelloPskDifferentHash) {
 
 TEST_F(ClientProtocolTest, TestServerHelloPskDifferentCompatibleCipher) {
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
-  state_.attemptedPsk()->cipher = CipherSuite::TLS_CHACHA20_POLY1305_SHA256;
+  auto psk = getCachedPsk();
+  psk.cipher = CipherSuite::TLS_CHACHA20_POLY1305_SHA256;
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(std::move(psk));
   auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
   expectActions<MutateState>(actions);
   processStateMutations(actions);
@@ -1381,7 +1581,7 @@ TEST_F(ClientProtocolTest, TestServerHelloPskDifferentCompatibleCipher) {
 TEST_F(ClientProtocolTest, TestServerHelloPskDheNotSupported) {
   context_->setSupportedPskModes({PskKeyExchangeMode::psk_ke});
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
   auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
   expectError(
       actions, AlertDescription::handshake_failure, "unsupported psk mode");
@@ -1400,7 +1600,7 @@ TEST_F(ClientProtocolTest, TestServerHelloExtensions) {
 TEST_F(ClientProtocolTest, TestServerHelloPskKeNotSupported) {
   context_->setSupportedPskModes({PskKeyExchangeMode::psk_dhe_ke});
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(getCachedPsk());
   auto shlo = TestMessages::serverHelloPsk();
   TestMessages::removeExtension(shlo, ExtensionType::key_share);
   auto actions = detail::processEvent(state_, std::move(shlo));
@@ -1528,7 +1728,7 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestFlow) {
 TEST_F(ClientProtocolTest, TestHelloRetryRequestPskFlow) {
   auto psk = getCachedPsk();
   setupExpectingServerHello();
-  state_.attemptedPsk() = psk;
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(psk);
   state_.clientRandom()->fill(0x66);
   auto mockHandshakeContext1 = new MockHandshakeContext();
   auto mockHandshakeContext2 = new MockHandshakeContext();
@@ -1623,16 +1823,30 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequest) {
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
 }
 
+TEST_F(ClientProtocolTest, TestHelloRetryRequestRecordsGroup) {
+  setupExpectingServerHello();
+  auto groupPreferenceCache = std::make_shared<GroupPreferenceCache>();
+  context_->setGroupPreferenceCache(groupPreferenceCache);
+  auto actions =
+      detail::processEvent(state_, TestMessages::helloRetryRequest());
+  expectActions<MutateState, WriteToSocket>(actions);
+  EXPECT_EQ(
+      groupPreferenceCache->getGroup("www.hostname.com"),
+      NamedGroup::secp256r1);
+  EXPECT_EQ(groupPreferenceCache->getStats().helloRetryRequests, 1);
+}
+
 TEST_F(ClientProtocolTest, TestHelloRetryRequestPskDifferentHash) {
   setupExpectingServerHello();
-  state_.attemptedPsk() = getCachedPsk();
-  state_.attemptedPsk()->cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
+  auto psk = getCachedPsk();
+  psk.cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(std::move(psk));
   auto actions =
       detail::processEvent(state_, TestMessages::helloRetryRequest());
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
-  EXPECT_FALSE(state_.attemptedPsk().hasValue());
+  EXPECT_FALSE(state_.attemptedPsk());
 }
 
 TEST_F(ClientProtocolTest, TestDoubleHelloRetryRequest) {
@@ -1783,6 +1997,48 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsAlpn) {
   EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificate);
 }
 
+TEST_F(ClientProtocolTest, TestEncryptedExtensionsRawPublicKey) {
+  context_->setSupportedAlpns({"h2"});
+  context_->setSupportedServerCertTypes(
+      {CertificateType::RawPublicKey, CertificateType::X509});
+  context_->setSupportedClientCertTypes({CertificateType::RawPublicKey});
+  setupExpectingEncryptedExtensions();
+  state_.requestedExtensions()->push_back(
+      ExtensionType::server_certificate_type);
+  state_.requestedExtensions()->push_back(
+      ExtensionType::client_certificate_type);
+  auto ee = TestMessages::encryptedExt();
+  SelectedServerCertificateType serverType;
+  serverType.certificate_type = CertificateType::RawPublicKey;
+  ee.extensions.push_back(encodeExtension(std::move(serverType)));
+  SelectedClientCertificateType clientType;
+  clientType.certificate_type = CertificateType::RawPublicKey;
+  ee.extensions.push_back(encodeExtension(std::move(clientType)));
+  auto actions = detail::processEvent(state_, std::move(ee));
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.serverCertType(), CertificateType::RawPublicKey);
+  EXPECT_EQ(state_.clientCertType(), CertificateType::RawPublicKey);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificate);
+}
+
+TEST_F(ClientProtocolTest, TestEncryptedExtensionsCertificateTypeUnsupported) {
+  context_->setSupportedAlpns({"h2"});
+  context_->setSupportedServerCertTypes({CertificateType::X509});
+  setupExpectingEncryptedExtensions();
+  state_.requestedExtensions()->push_back(
+      ExtensionType::server_certificate_type);
+  auto ee = TestMessages::encryptedExt();
+  SelectedServerCertificateType serverType;
+  serverType.certificate_type = CertificateType::RawPublicKey;
+  ee.extensions.push_back(encodeExtension(std::move(serverType)));
+  auto actions = detail::processEvent(state_, std::move(ee));
+  expectError(
+      actions,
+      AlertDescription::illegal_parameter,
+      "unsupported certificate type");
+}
+
 TEST_F(ClientProtocolTest, TestEncryptedExtensionsEmptyAlpn) {
   context_->setSupportedAlpns({"h2"});
   setupExpectingEncryptedExtensions();
@@ -1896,7 +2152,9 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyCipherMismatch) {
 TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyAlpnMismatch) {
   setupExpectingEncryptedExtensionsEarlySent();
   state_.earlyDataParams()->alpn = "h3";
-  state_.attemptedPsk()->alpn = "h3";
+  auto psk = getCachedPsk();
+  psk.alpn = "h3";
+  state_.attemptedPsk() = std::make_shared<CachedPsk>(std::move(psk));
   auto ee = TestMessages::encryptedExt();
   ee.extensions.push_back(encodeExtension(ServerEarlyData()));
   auto actions = detail::processEvent(state_, std::move(ee));
@@ -1944,6 +2202,39 @@ TEST_F(ClientProtocolTest, TestCertificate) {
   EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
 }
 
+TEST_F(ClientProtocolTest, TestCertificateRawPublicKey) {
+  setupExpectingCertificate();
+  state_.serverCertType() = CertificateType::RawPublicKey;
+  mockLeaf_ = std::make_shared<MockPeerCert>();
+  EXPECT_CALL(*factory_, _makePeerRawPublicKey(BufMatches("spki")))
+      .WillOnce(Return(mockLeaf_));
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry;
+  entry.cert_data = folly::IOBuf::copyBuffer("spki");
+  certificate.certificate_list.push_back(std::move(entry));
+  auto actions = detail::processEvent(state_, std::move(certificate));
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.unverifiedCertChain()->size(), 1);
+  EXPECT_EQ(state_.unverifiedCertChain()->at(0), mockLeaf_);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
+}
+
+TEST_F(ClientProtocolTest, TestCertificateRawPublicKeyMultiple) {
+  setupExpectingCertificate();
+  state_.serverCertType() = CertificateType::RawPublicKey;
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry1;
+  entry1.cert_data = folly::IOBuf::copyBuffer("spki1");
+  certificate.certificate_list.push_back(std::move(entry1));
+  CertificateEntry entry2;
+  entry2.cert_data = folly::IOBuf::copyBuffer("spki2");
+  certificate.certificate_list.push_back(std::move(entry2));
+  auto actions = detail::processEvent(state_, std::move(certificate));
+  expectError(
+      actions, AlertDescription::illegal_parameter, "multiple entries");
+}
+
 TEST_F(ClientProtocolTest, TestCertificateWithRequestContext) {
   setupExpectingCertificate();
   auto certificate = TestMessages::certificate();
@@ -2063,6 +2354,92 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyVerifierFailureOtherException) {
       actions, AlertDescription::bad_certificate, "verifier failure: no good");
 }
 
+TEST_F(ClientProtocolTest, TestCertificateVerifyAsyncVerifier) {
+  setupExpectingCertificateVerify();
+  auto asyncVerifier = std::make_shared<MockAsyncCertificateVerifier>();
+  state_.verifier() = asyncVerifier;
+  folly::Promise<folly::Unit> promise;
+  EXPECT_CALL(*asyncVerifier, verify(_)).Times(0);
+  EXPECT_CALL(*asyncVerifier, verifyFuture(_))
+      .WillOnce(Invoke(
+          [this, &promise](
+              const std::vector<std::shared_ptr<const PeerCert>>& certs) {
+            EXPECT_EQ(certs.size(), 2);
+            EXPECT_EQ(certs[0], mockLeaf_);
+            return promise.getFuture();
+          }));
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      appendToTranscript(BufMatches("certverifyencoding")));
+
+  auto actions =
+      detail::processEvent(state_, TestMessages::certificateVerify());
+  expectActions<WaitForVerification, MutateState>(actions);
+  auto wait = expectAction<WaitForVerification>(actions);
+  EXPECT_FALSE(wait.verified.isReady());
+  promise.setValue();
+  EXPECT_TRUE(wait.verified.isReady());
+  EXPECT_FALSE(wait.verified.hasException());
+
+  processStateMutations(actions);
+  EXPECT_EQ(state_.serverCert(), mockLeaf_);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+}
+
+TEST_F(ClientProtocolTest, TestCertificateVerifyAsyncVerifierComplete) {
+  setupExpectingCertificateVerify();
+  auto asyncVerifier = std::make_shared<MockAsyncCertificateVerifier>();
+  state_.verifier() = asyncVerifier;
+  EXPECT_CALL(*asyncVerifier, verifyFuture(_))
+      .WillOnce(Invoke([](const std::vector<std::shared_ptr<const PeerCert>>&) {
+        return folly::makeFuture();
+      }));
+  auto actions =
+      detail::processEvent(state_, TestMessages::certificateVerify());
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+}
+
+TEST_F(ClientProtocolTest, TestCertificateVerifyAsyncVerifierFailure) {
+  setupExpectingCertificateVerify();
+  auto asyncVerifier = std::make_shared<MockAsyncCertificateVerifier>();
+  state_.verifier() = asyncVerifier;
+  EXPECT_CALL(*asyncVerifier, verifyFuture(_))
+      .WillOnce(Invoke([](const std::vector<std::shared_ptr<const PeerCert>>&) {
+        return folly::makeFuture<folly::Unit>(std::runtime_error("no good"));
+      }));
+  auto actions =
+      detail::processEvent(state_, TestMessages::certificateVerify());
+  expectError(
+      actions, AlertDescription::bad_certificate, "verifier failure: no good");
+}
+
+TEST_F(ClientProtocolTest, TestCertificateVerifyAsyncVerifierPendingFailure) {
+  setupExpectingCertificateVerify();
+  auto asyncVerifier = std::make_shared<MockAsyncCertificateVerifier>();
+  state_.verifier() = asyncVerifier;
+  folly::Promise<folly::Unit> promise;
+  EXPECT_CALL(*asyncVerifier, verifyFuture(_))
+      .WillOnce(Invoke(
+          [&promise](const std::vector<std::shared_ptr<const PeerCert>>&) {
+            return promise.getFuture();
+          }));
+  auto actions =
+      detail::processEvent(state_, TestMessages::certificateVerify());
+  auto wait = expectAction<WaitForVerification>(actions);
+  promise.setException(std::runtime_error("no good"));
+  ASSERT_TRUE(wait.verified.hasException());
+  bool isFizzException = false;
+  wait.verified.getTry().exception().with_exception(
+      [&](const FizzException& ex) {
+        isFizzException = true;
+        EXPECT_EQ(ex.getAlert(), AlertDescription::bad_certificate);
+        EXPECT_THAT(ex.what(), HasSubstr("verifier failure: no good"));
+      });
+  EXPECT_TRUE(isFizzException);
+}
+
 TEST_F(ClientProtocolTest, TestCertificateRequestNoCert) {
   setupExpectingCertificate();
   auto certificateRequest = TestMessages::certificateRequest();
@@ -2180,6 +2557,21 @@ TEST_F(ClientProtocolTest, TestCertificateRequestMatch) {
   EXPECT_EQ(state_.clientAuthSigScheme(), SignatureScheme::rsa_pss_sha256);
 }
 
+TEST_F(ClientProtocolTest, TestCertificateRequestCertificateTypeMismatch) {
+  setupExpectingCertificateRequest();
+  state_.clientCertType() = CertificateType::RawPublicKey;
+  auto certificateRequest = TestMessages::certificateRequest();
+
+  EXPECT_CALL(*mockClientCert_, getCertificateType())
+      .WillRepeatedly(Return(CertificateType::X509));
+
+  auto actions = detail::processEvent(state_, std::move(certificateRequest));
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.clientAuthRequested(), ClientAuthType::RequestedNoMatch);
+  EXPECT_EQ(state_.selectedClientCert(), nullptr);
+}
+
 TEST_F(ClientProtocolTest, TestFinishedFlow) {
   setupExpectingFinished();
   doFinishedFlow(ClientAuthType::NotRequested);
@@ -2456,6 +2848,12 @@ TEST_F(ClientProtocolTest, TestFinished) {
   expectActions<MutateState, ReportHandshakeSuccess, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::Established);
+  EXPECT_EQ(state_.handshakeContext(), nullptr);
+  EXPECT_FALSE(state_.clientHandshakeSecret().hasValue());
+  EXPECT_FALSE(state_.serverHandshakeSecret().hasValue());
+  EXPECT_FALSE(state_.attemptedPsk());
+  EXPECT_FALSE(state_.requestedExtensions().hasValue());
+  EXPECT_FALSE(state_.unverifiedCertChain().hasValue());
 }
 
 TEST_F(ClientProtocolTest, TestFinishedExtraData) {
@@ -21,6 +21,10 @@ DEFINE_bool(
     "for the second one");
 DEFINE_bool(early, false, "send early data");
 DEFINE_bool(verify, false, "enable verification of server certificate chain");
+DEFINE_bool(
+    tfo,
+    false,
+    "use TCP Fast Open, sending the ClientHello (and early data) in the SYN");
 
 using namespace fizz;
 using namespace fizz::client;
@@ -42,8 +46,15 @@ class Connection : public AsyncSocket::ConnectCallback,
         verifier_(std::move(verifier)) {}
 
   void connect(const SocketAddress& addr) {
-    sock_ = AsyncSocket::UniquePtr(new AsyncSocket(evb_));
-    sock_->connect(this, addr);
+    if (FLAGS_tfo) {
+      transport_ = AsyncFizzClient::UniquePtr(
+          new AsyncFizzClient(evb_, clientContext_));
+      transport_->setTcpFastOpen(true);
+      transport_->connect(addr, this, verifier_, sni_, sni_);
+    } else {
+      sock_ = AsyncSocket::UniquePtr(new AsyncSocket(evb_));
+      sock_->connect(this, addr);
+    }
   }
 
   void close() {
@@ -59,6 +70,12 @@ class Connection : public AsyncSocket::ConnectCallback,
   }
 
   void connectSuccess() noexcept override {
+    if (transport_) {
+      // When the fizz client opened the socket, connect success is reported
+      // once the (early) handshake is done.
+      fizzHandshakeSuccess(transport_.get());
+      return;
+    }
     LOG(INFO) << "Connected";
     transport_ = AsyncFizzClient::UniquePtr(
         new AsyncFizzClient(std::move(sock_), clientContext_));
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/client/ExternalPskCache.h>
+#include <fizz/client/test/Utilities.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class ExternalPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    resumptionCache_ = std::make_shared<BasicPskCache>();
+    cache_ = std::make_unique<ExternalPskCache>(resumptionCache_);
+  }
+
+ protected:
+  std::shared_ptr<BasicPskCache> resumptionCache_;
+  std::unique_ptr<ExternalPskCache> cache_;
+};
+
+TEST_F(ExternalPskCacheTest, TestMakeExternalPsk) {
+  auto psk = ExternalPskCache::makeExternalPsk(
+      "ident", "secret", CipherSuite::TLS_AES_256_GCM_SHA384);
+  EXPECT_EQ(psk.psk, "ident");
+  EXPECT_EQ(psk.secret, "secret");
+  EXPECT_EQ(psk.type, PskType::External);
+  EXPECT_EQ(psk.cipher, CipherSuite::TLS_AES_256_GCM_SHA384);
+  EXPECT_EQ(psk.maxEarlyDataSize, 0);
+  EXPECT_FALSE(psk.group.hasValue());
+  EXPECT_GT(psk.ticketExpirationTime, std::chrono::system_clock::now());
+}
+
+TEST_F(ExternalPskCacheTest, TestExternalPsk) {
+  auto psk = ExternalPskCache::makeExternalPsk("ident", "secret");
+  cache_->addExternalPsk("service", psk);
+  auto cachedPsk = cache_->getPsk("service");
+  ASSERT_TRUE(cachedPsk);
+  pskEq(psk, *cachedPsk);
+  EXPECT_FALSE(cache_->getPsk("other"));
+
+  cache_->removeExternalPsk("service");
+  EXPECT_FALSE(cache_->getPsk("service"));
+}
+
+TEST_F(ExternalPskCacheTest, TestResumptionPreferred) {
+  auto external = ExternalPskCache::makeExternalPsk("ident", "secret");
+  cache_->addExternalPsk("service", external);
+
+  auto resumption = getTestPsk("ticket", std::chrono::system_clock::now());
+  cache_->putPsk("service", resumption);
+  EXPECT_TRUE(resumptionCache_->getPsk("service"));
+  pskEq(resumption, *cache_->getPsk("service"));
+
+  // Removing the resumption PSK falls back to the external PSK.
+  cache_->removePsk("service");
+  EXPECT_FALSE(resumptionCache_->getPsk("service"));
+  pskEq(external, *cache_->getPsk("service"));
+}
+
+TEST_F(ExternalPskCacheTest, TestNoResumptionCache) {
+  cache_ = std::make_unique<ExternalPskCache>();
+  auto external = ExternalPskCache::makeExternalPsk("ident", "secret");
+  cache_->addExternalPsk("service", external);
+  cache_->putPsk(
+      "service", getTestPsk("ticket", std::chrono::system_clock::now()));
+  pskEq(external, *cache_->getPsk("service"));
+  cache_->removePsk("service");
+  pskEq(external, *cache_->getPsk("service"));
+}
+} // namespace test
+} // namespace client
+} // namespace fizz
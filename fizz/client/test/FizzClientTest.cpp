@@ -33,6 +33,12 @@ class ActionMoveVisitor : public boost::static_visitor<> {
  public:
   template <typename T>
   void operator()(T&) {}
+
+  void operator()(ReportError& error) {
+    errors.push_back(error.error.what().toStdString());
+  }
+
+  std::vector<std::string> errors;
 };
 
 class TestFizzClient : public DelayedDestruction {
@@ -64,7 +70,7 @@ TEST_F(FizzClientTest, TestConnect) {
       _processConnect(_, _, _, _, _, _))
       .WillOnce(InvokeWithoutArgs([] { return Actions(); }));
   const auto sni = std::string("www.example.com");
-  fizzClient_->fizzClient_.connect(context_, nullptr, sni, folly::none);
+  fizzClient_->fizzClient_.connect(context_, nullptr, sni, nullptr);
 }
 
 TEST_F(FizzClientTest, TestConnectPskIdentity) {
@@ -78,7 +84,7 @@ TEST_F(FizzClientTest, TestConnectPskIdentity) {
                      std::shared_ptr<const FizzClientContext> context,
                      std::shared_ptr<const CertificateVerifier> verifier,
                      folly::Optional<std::string> sni,
-                     folly::Optional<CachedPsk> cachedPsk,
+                     std::shared_ptr<const CachedPsk> cachedPsk,
                      const std::shared_ptr<ClientExtensions>& extensions) {
             EXPECT_TRUE(cachedPsk);
             EXPECT_EQ(cachedPsk->psk, psk);
@@ -86,11 +92,76 @@ TEST_F(FizzClientTest, TestConnectPskIdentity) {
             return Actions();
           }));
   const auto sni = std::string("www.example.com");
-  CachedPsk cachedPsk;
-  cachedPsk.psk = psk;
+  auto cachedPsk = std::make_shared<CachedPsk>();
+  cachedPsk->psk = psk;
   fizzClient_->fizzClient_.connect(
       context_, nullptr, sni, std::move(cachedPsk));
 }
+
+TEST_F(FizzClientTest, TestConnectOptionalPsk) {
+  std::string psk("psk");
+  EXPECT_CALL(
+      *MockClientStateMachineInstance::instance,
+      _processConnect(_, _, _, _, _, _))
+      .WillOnce(
+          Invoke([psk](
+                     const State&,
+                     std::shared_ptr<const FizzClientContext> context,
+                     std::shared_ptr<const CertificateVerifier> verifier,
+                     folly::Optional<std::string> sni,
+                     std::shared_ptr<const CachedPsk> cachedPsk,
+                     const std::shared_ptr<ClientExtensions>& extensions) {
+            EXPECT_TRUE(cachedPsk);
+            EXPECT_EQ(cachedPsk->psk, psk);
+            return Actions();
+          }));
+  const auto sni = std::string("www.example.com");
+  folly::Optional<CachedPsk> cachedPsk = CachedPsk();
+  cachedPsk->psk = psk;
+  fizzClient_->fizzClient_.connect(
+      context_, nullptr, sni, std::move(cachedPsk));
+}
+
+TEST_F(FizzClientTest, TestConnectNoPsk) {
+  EXPECT_CALL(
+      *MockClientStateMachineInstance::instance,
+      _processConnect(_, _, _, _, IsNull(), _))
+      .WillOnce(InvokeWithoutArgs([] { return Actions(); }));
+  const auto sni = std::string("www.example.com");
+  fizzClient_->fizzClient_.connect(context_, nullptr, sni, folly::none);
+}
+
+TEST_F(FizzClientTest, TestWaitForVerification) {
+  folly::Promise<folly::Unit> promise;
+  EXPECT_CALL(
+      *MockClientStateMachineInstance::instance,
+      _processConnect(_, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([&promise] {
+        return detail::actions(WaitForVerification{promise.getFuture()});
+      }));
+  fizzClient_->fizzClient_.connect(context_, nullptr, folly::none, nullptr);
+  EXPECT_TRUE(fizzClient_->fizzClient_.actionProcessing());
+  promise.setValue();
+  EXPECT_FALSE(fizzClient_->fizzClient_.actionProcessing());
+  EXPECT_TRUE(fizzClient_->visitor_.errors.empty());
+}
+
+TEST_F(FizzClientTest, TestWaitForVerificationFailure) {
+  folly::Promise<folly::Unit> promise;
+  EXPECT_CALL(
+      *MockClientStateMachineInstance::instance,
+      _processConnect(_, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([&promise] {
+        return detail::actions(WaitForVerification{promise.getFuture()});
+      }));
+  fizzClient_->fizzClient_.connect(context_, nullptr, folly::none, nullptr);
+  EXPECT_TRUE(fizzClient_->fizzClient_.actionProcessing());
+  promise.setException(
+      FizzException("untrusted", AlertDescription::bad_certificate));
+  EXPECT_FALSE(fizzClient_->fizzClient_.actionProcessing());
+  ASSERT_EQ(fizzClient_->visitor_.errors.size(), 1);
+  EXPECT_THAT(fizzClient_->visitor_.errors[0], HasSubstr("untrusted"));
+}
 } // namespace test
 } // namespace client
 } // namespace fizz
@@ -26,14 +26,14 @@ class MockClientStateMachine : public ClientStateMachine {
           std::shared_ptr<const FizzClientContext> context,
           std::shared_ptr<const CertificateVerifier>,
           folly::Optional<std::string> host,
-          folly::Optional<CachedPsk> cachedPsk,
+          std::shared_ptr<const CachedPsk> cachedPsk,
           const std::shared_ptr<ClientExtensions>& extensions));
   Actions processConnect(
       const State& state,
       std::shared_ptr<const FizzClientContext> context,
       std::shared_ptr<const CertificateVerifier> verifier,
       folly::Optional<std::string> host,
-      folly::Optional<CachedPsk> cachedPsk,
+      std::shared_ptr<const CachedPsk> cachedPsk,
       const std::shared_ptr<ClientExtensions>& extensions) override {
     return *_processConnect(
         state, context, verifier, host, cachedPsk, extensions);
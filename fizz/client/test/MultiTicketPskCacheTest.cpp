@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/client/MultiTicketPskCache.h>
+#include <fizz/client/test/Utilities.h>
+#include <folly/Format.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class TestMultiTicketPskCache : public MultiTicketPskCache {
+ public:
+  using MultiTicketPskCache::MultiTicketPskCache;
+
+  std::chrono::system_clock::time_point now_{
+      std::chrono::system_clock::now()};
+
+ protected:
+  std::chrono::system_clock::time_point now() const override {
+    return now_;
+  }
+};
+
+class MultiTicketPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    MultiTicketPskCache::Options options;
+    options.maxIdentities = 2;
+    options.maxPsksPerIdentity = 3;
+    cache_ = std::make_unique<TestMultiTicketPskCache>(options);
+  }
+
+ protected:
+  CachedPsk getCachedPsk(std::string pskName) {
+    return getTestPsk(pskName, cache_->now_);
+  }
+
+  std::unique_ptr<TestMultiTicketPskCache> cache_;
+};
+
+TEST_F(MultiTicketPskCacheTest, TestEachPskHandedOutOnce) {
+  auto psk1 = getCachedPsk("psk 1");
+  auto psk2 = getCachedPsk("psk 2");
+  cache_->putPsk("fizz", psk1);
+  cache_->putPsk("fizz", psk2);
+  EXPECT_EQ(cache_->numPsks("fizz"), 2);
+
+  auto first = cache_->getPsk("fizz");
+  ASSERT_TRUE(first);
+  pskEq(psk1, *first);
+  auto second = cache_->getPsk("fizz");
+  ASSERT_TRUE(second);
+  pskEq(psk2, *second);
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_EQ(cache_->numPsks("fizz"), 0);
+}
+
+TEST_F(MultiTicketPskCacheTest, TestPoolLimit) {
+  for (int i : {1, 2, 3, 4}) {
+    cache_->putPsk("fizz", getCachedPsk(folly::sformat("psk {}", i)));
+  }
+  EXPECT_EQ(cache_->numPsks("fizz"), 3);
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "psk 2");
+}
+
+TEST_F(MultiTicketPskCacheTest, TestExpiredSkipped) {
+  cache_->putPsk("fizz", getCachedPsk("old"));
+  cache_->now_ += std::chrono::seconds(5);
+  cache_->putPsk("fizz", getCachedPsk("new"));
+  cache_->now_ += std::chrono::seconds(6);
+
+  auto psk = cache_->getPsk("fizz");
+  ASSERT_TRUE(psk);
+  EXPECT_EQ(psk->psk, "new");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(MultiTicketPskCacheTest, TestRemoveClearsPool) {
+  cache_->putPsk("fizz", getCachedPsk("psk 1"));
+  cache_->putPsk("fizz", getCachedPsk("psk 2"));
+  cache_->putPsk("other", getCachedPsk("psk 3"));
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "psk 1");
+  cache_->removePsk("fizz");
+  EXPECT_EQ(cache_->numPsks("fizz"), 0);
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_EQ(cache_->numPsks("other"), 1);
+}
+
+TEST_F(MultiTicketPskCacheTest, TestRemoveUnknown) {
+  cache_->removePsk("fizz");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(MultiTicketPskCacheTest, TestIdentityEviction) {
+  cache_->putPsk("a", getCachedPsk("psk a"));
+  cache_->putPsk("b", getCachedPsk("psk b"));
+  cache_->putPsk("c", getCachedPsk("psk c"));
+  EXPECT_EQ(cache_->numPsks("a"), 0);
+  EXPECT_EQ(cache_->numPsks("b"), 1);
+  EXPECT_EQ(cache_->numPsks("c"), 1);
+}
+} // namespace test
+} // namespace client
+} // namespace fizz
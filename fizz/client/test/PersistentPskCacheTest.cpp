@@ -0,0 +1,324 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/client/PersistentPskCache.h>
+#include <fizz/client/test/Utilities.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+#include <folly/ssl/OpenSSLCertUtils.h>
+
+#include <signal.h>
+#include <sys/resource.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class TestPersistentPskCache : public PersistentPskCache {
+ public:
+  using PersistentPskCache::PersistentPskCache;
+
+  std::chrono::system_clock::time_point now_{
+      std::chrono::system_clock::now()};
+
+ protected:
+  std::chrono::system_clock::time_point now() const override {
+    return now_;
+  }
+};
+
+class PersistentPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    path_ = (dir_.path() / "psks").string();
+    // Stored times have millisecond precision.
+    ticketTime_ = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()));
+  }
+
+ protected:
+  std::unique_ptr<TestPersistentPskCache> makeCache(
+      PersistentPskCache::Options options = PersistentPskCache::Options()) {
+    auto cache = std::make_unique<TestPersistentPskCache>(path_, options);
+    cache->now_ = ticketTime_;
+    return cache;
+  }
+
+  CachedPsk getCachedPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_);
+  }
+
+  size_t fileSize() {
+    std::string contents;
+    EXPECT_TRUE(readFile(path_.c_str(), contents));
+    return contents.size();
+  }
+
+  folly::test::TemporaryDirectory dir_;
+  std::string path_;
+  std::chrono::system_clock::time_point ticketTime_;
+};
+
+TEST_F(PersistentPskCacheTest, TestSerializeRoundTrip) {
+  auto psk = getCachedPsk();
+  psk.serverCert =
+      std::make_shared<PeerCertImpl<KeyType::P256>>(fizz::test::getCert(
+          fizz::test::kP256Certificate));
+  psk.clientCert = std::make_shared<IdentityCert>("client");
+  psk.group = folly::none;
+  psk.alpn = folly::none;
+
+  auto serialized = serializePsk(psk);
+  auto deserialized = deserializePsk(serialized->coalesce());
+  pskEq(psk, deserialized);
+  ASSERT_TRUE(deserialized.serverCert);
+  EXPECT_EQ(deserialized.serverCert->getIdentity(), "Fizz");
+  ASSERT_TRUE(deserialized.serverCert->getX509());
+  EXPECT_TRUE(IOBufEqualTo()(
+      folly::ssl::OpenSSLCertUtils::derEncode(
+          *deserialized.serverCert->getX509()),
+      folly::ssl::OpenSSLCertUtils::derEncode(*psk.serverCert->getX509())));
+  ASSERT_TRUE(deserialized.clientCert);
+  EXPECT_EQ(deserialized.clientCert->getIdentity(), "client");
+
+  auto identityOnly = deserializePsk(
+      serializePsk(psk, PskCertificateStorage::IdentityOnly)->coalesce());
+  EXPECT_EQ(identityOnly.serverCert->getIdentity(), "Fizz");
+  EXPECT_FALSE(identityOnly.serverCert->getX509());
+
+  auto noCerts = deserializePsk(
+      serializePsk(psk, PskCertificateStorage::None)->coalesce());
+  EXPECT_FALSE(noCerts.serverCert);
+  EXPECT_FALSE(noCerts.clientCert);
+}
+
+TEST_F(PersistentPskCacheTest, TestDeserializeTruncated) {
+  auto serialized = serializePsk(getCachedPsk());
+  auto range = serialized->coalesce();
+  EXPECT_ANY_THROW(deserializePsk(range.subpiece(0, range.size() - 1)));
+}
+
+TEST_F(PersistentPskCacheTest, TestDeserializeInvalidType) {
+  auto psk = getCachedPsk();
+  psk.type = PskType::Rejected;
+  auto serialized = serializePsk(psk);
+  EXPECT_THROW(deserializePsk(serialized->coalesce()), std::runtime_error);
+
+  // Type byte follows the version and the two length prefixed strings.
+  auto good = serializePsk(getCachedPsk());
+  auto range = good->coalesce();
+  std::string bytes(range.begin(), range.end());
+  bytes[1 + 2 + psk.psk.size() + 2 + psk.secret.size()] = 0x7f;
+  EXPECT_THROW(
+      deserializePsk(folly::ByteRange(folly::StringPiece(bytes))),
+      std::runtime_error);
+}
+
+TEST_F(PersistentPskCacheTest, TestPersistence) {
+  auto psk1 = getCachedPsk("psk 1");
+  auto psk2 = getCachedPsk("psk 2");
+  {
+    auto cache = makeCache();
+    cache->putPsk("one", psk1);
+    cache->putPsk("two", getCachedPsk("replaced"));
+    cache->putPsk("two", psk2);
+    cache->putPsk("three", getCachedPsk("psk 3"));
+    cache->removePsk("three");
+  }
+
+  auto cache = makeCache();
+  auto cached1 = cache->getPsk("one");
+  ASSERT_TRUE(cached1);
+  pskEq(psk1, *cached1);
+  auto cached2 = cache->getPsk("two");
+  ASSERT_TRUE(cached2);
+  pskEq(psk2, *cached2);
+  EXPECT_FALSE(cache->getPsk("three"));
+}
+
+TEST_F(PersistentPskCacheTest, TestTornTail) {
+  {
+    auto cache = makeCache();
+    cache->putPsk("one", getCachedPsk("psk 1"));
+    cache->putPsk("two", getCachedPsk("psk 2"));
+  }
+  auto goodSize = fileSize();
+
+  // Simulate a partially written record.
+  std::string contents;
+  ASSERT_TRUE(readFile(path_.c_str(), contents));
+  contents.append(std::string("\x00\x00\x01\x00garbage", 11));
+  ASSERT_TRUE(writeFile(contents, path_.c_str()));
+
+  {
+    auto cache = makeCache();
+    EXPECT_EQ(fileSize(), goodSize);
+    EXPECT_TRUE(cache->getPsk("one"));
+    EXPECT_TRUE(cache->getPsk("two"));
+    cache->putPsk("three", getCachedPsk("psk 3"));
+  }
+
+  auto cache = makeCache();
+  EXPECT_TRUE(cache->getPsk("one"));
+  EXPECT_TRUE(cache->getPsk("two"));
+  EXPECT_TRUE(cache->getPsk("three"));
+}
+
+TEST_F(PersistentPskCacheTest, TestCorruptRecord) {
+  {
+    auto cache = makeCache();
+    cache->putPsk("one", getCachedPsk("psk 1"));
+  }
+  auto firstRecordEnd = fileSize();
+  {
+    auto cache = makeCache();
+    cache->putPsk("two", getCachedPsk("psk 2"));
+  }
+
+  // Flip a byte in the second record, it should fail its checksum.
+  std::string contents;
+  ASSERT_TRUE(readFile(path_.c_str(), contents));
+  contents[firstRecordEnd + 10] ^= 0xff;
+  ASSERT_TRUE(writeFile(contents, path_.c_str()));
+
+  auto cache = makeCache();
+  EXPECT_TRUE(cache->getPsk("one"));
+  EXPECT_FALSE(cache->getPsk("two"));
+  EXPECT_EQ(fileSize(), firstRecordEnd);
+}
+
+TEST_F(PersistentPskCacheTest, TestUnknownFormat) {
+  std::string contents("not a psk cache");
+  ASSERT_TRUE(writeFile(contents, path_.c_str()));
+  EXPECT_THROW(makeCache(), std::runtime_error);
+
+  std::string after;
+  ASSERT_TRUE(readFile(path_.c_str(), after));
+  EXPECT_EQ(after, contents);
+}
+
+TEST_F(PersistentPskCacheTest, TestTornMagic) {
+  ASSERT_TRUE(writeFile(std::string("FIZZ"), path_.c_str()));
+  {
+    auto cache = makeCache();
+    EXPECT_FALSE(cache->getPsk("one"));
+    cache->putPsk("one", getCachedPsk());
+  }
+  auto cache = makeCache();
+  EXPECT_TRUE(cache->getPsk("one"));
+}
+
+TEST_F(PersistentPskCacheTest, TestFileInUse) {
+  auto cache = makeCache();
+  EXPECT_THROW(makeCache(), std::runtime_error);
+
+  // The lock moves to the file written by compaction.
+  cache->putPsk("one", getCachedPsk());
+  cache->compact();
+  EXPECT_THROW(makeCache(), std::runtime_error);
+
+  cache.reset();
+  EXPECT_TRUE(makeCache()->getPsk("one"));
+}
+
+TEST_F(PersistentPskCacheTest, TestFailedWrite) {
+  auto cache = makeCache();
+  cache->putPsk("one", getCachedPsk("psk 1"));
+  auto goodSize = fileSize();
+
+  // Let only part of the next record reach the file.
+  auto oldHandler = signal(SIGXFSZ, SIG_IGN);
+  struct rlimit oldLimit;
+  ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &oldLimit), 0);
+  struct rlimit limit = oldLimit;
+  limit.rlim_cur = goodSize + 10;
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limit), 0);
+  cache->putPsk("two", getCachedPsk("psk 2"));
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &oldLimit), 0);
+  signal(SIGXFSZ, oldHandler);
+
+  // The torn bytes are gone and the update was dropped.
+  EXPECT_EQ(fileSize(), goodSize);
+  EXPECT_FALSE(cache->getPsk("two"));
+  cache->putPsk("three", getCachedPsk("psk 3"));
+  cache.reset();
+
+  cache = makeCache();
+  EXPECT_TRUE(cache->getPsk("one"));
+  EXPECT_FALSE(cache->getPsk("two"));
+  EXPECT_TRUE(cache->getPsk("three"));
+}
+
+TEST_F(PersistentPskCacheTest, TestCompaction) {
+  PersistentPskCache::Options options;
+  options.compactionThreshold = std::numeric_limits<size_t>::max();
+  {
+    auto cache = makeCache(options);
+    for (int i = 0; i < 10; ++i) {
+      cache->putPsk("one", getCachedPsk("psk 1"));
+    }
+    cache->putPsk("two", getCachedPsk("psk 2"));
+  }
+  auto uncompactedSize = fileSize();
+
+  {
+    auto cache = makeCache(options);
+    cache->compact();
+    EXPECT_LT(fileSize(), uncompactedSize);
+    EXPECT_TRUE(cache->getPsk("one"));
+    cache->putPsk("three", getCachedPsk("psk 3"));
+  }
+
+  auto cache = makeCache(options);
+  EXPECT_TRUE(cache->getPsk("one"));
+  EXPECT_TRUE(cache->getPsk("two"));
+  EXPECT_TRUE(cache->getPsk("three"));
+}
+
+TEST_F(PersistentPskCacheTest, TestCompactionDropsExpired) {
+  {
+    auto cache = makeCache();
+    cache->putPsk("one", getCachedPsk("psk 1"));
+    cache->putPsk("two", getCachedPsk("psk 2"));
+  }
+  {
+    auto cache = makeCache();
+    cache->now_ += std::chrono::seconds(10);
+    EXPECT_FALSE(cache->getPsk("one"));
+    cache->compact();
+  }
+
+  auto cache = makeCache();
+  EXPECT_FALSE(cache->getPsk("two"));
+  EXPECT_EQ(fileSize(), 8);
+}
+
+TEST_F(PersistentPskCacheTest, TestAutomaticCompaction) {
+  PersistentPskCache::Options options;
+  options.compactionThreshold = 0;
+  auto cache = makeCache(options);
+  cache->putPsk("one", getCachedPsk("psk 1"));
+  auto singleRecordSize = fileSize();
+  for (int i = 0; i < 10; ++i) {
+    cache->putPsk("one", getCachedPsk("psk 1"));
+  }
+  EXPECT_EQ(fileSize(), singleRecordSize);
+  cache->removePsk("one");
+  EXPECT_EQ(fileSize(), 8);
+}
+} // namespace test
+} // namespace client
+} // namespace fizz
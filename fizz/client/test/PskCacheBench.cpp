@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/init/Init.h>
+
+#include <fizz/client/ShardedPskCache.h>
+#include <fizz/client/SynchronizedLruPskCache.h>
+
+#include <thread>
+
+using namespace fizz;
+using namespace fizz::client;
+
+/**
+ * Measures PSK lookups from many threads at once, as done by a proxy opening
+ * connections to a set of origins. Each iteration is one lookup per thread.
+ */
+namespace {
+constexpr size_t kNumThreads = 64;
+constexpr size_t kNumIdentities = 1000;
+
+CachedPsk makePsk(std::string identity) {
+  CachedPsk psk;
+  psk.psk = std::move(identity);
+  psk.secret = std::string(32, 's');
+  psk.type = PskType::Resumption;
+  psk.version = ProtocolVersion::tls_1_3;
+  psk.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+  psk.group = NamedGroup::x25519;
+  psk.alpn = "h2";
+  psk.ticketAgeAdd = 0x11111111;
+  psk.ticketIssueTime = std::chrono::system_clock::now();
+  psk.ticketExpirationTime = psk.ticketIssueTime + std::chrono::hours(1);
+  return psk;
+}
+
+std::vector<std::string> makeIdentities() {
+  std::vector<std::string> identities;
+  for (size_t i = 0; i < kNumIdentities; ++i) {
+    identities.push_back(folly::to<std::string>("origin", i, ".example.com"));
+  }
+  return identities;
+}
+
+template <typename Lookup>
+void runThreads(size_t n, Lookup lookup) {
+  static const auto identities = makeIdentities();
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < n; ++i) {
+        lookup(identities[(i * kNumThreads + t) % identities.size()]);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+template <typename Cache>
+void fill(Cache& cache) {
+  for (const auto& identity : makeIdentities()) {
+    cache.putPsk(identity, makePsk(identity));
+  }
+}
+} // namespace
+
+BENCHMARK(synchronizedLruGetPsk, n) {
+  SynchronizedLruPskCache cache(kNumIdentities);
+  BENCHMARK_SUSPEND {
+    fill(cache);
+  }
+  runThreads(n, [&](const std::string& identity) {
+    auto psk = cache.getPsk(identity);
+    folly::doNotOptimizeAway(psk);
+  });
+}
+
+BENCHMARK_RELATIVE(shardedGetPsk, n) {
+  ShardedPskCache cache;
+  BENCHMARK_SUSPEND {
+    fill(cache);
+  }
+  runThreads(n, [&](const std::string& identity) {
+    auto psk = cache.getPsk(identity);
+    folly::doNotOptimizeAway(psk);
+  });
+}
+
+BENCHMARK_RELATIVE(shardedGetSharedPsk, n) {
+  ShardedPskCache cache;
+  BENCHMARK_SUSPEND {
+    fill(cache);
+  }
+  runThreads(n, [&](const std::string& identity) {
+    auto psk = cache.getSharedPsk(identity);
+    folly::doNotOptimizeAway(psk);
+  });
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
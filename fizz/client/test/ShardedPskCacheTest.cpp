@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/client/ShardedPskCache.h>
+#include <fizz/client/test/Utilities.h>
+#include <folly/Format.h>
+
+#include <thread>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class ShardedPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    ShardedPskCache::Options options;
+    options.capacity = 3;
+    options.numShards = 1;
+    cache_ = std::make_unique<ShardedPskCache>(options);
+    ticketTime_ = std::chrono::system_clock::now();
+  }
+
+ protected:
+  CachedPsk getCachedPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_);
+  }
+
+  // Access times are only used to order entries for eviction, make sure
+  // consecutive operations get distinct ones.
+  void tick() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::unique_ptr<ShardedPskCache> cache_;
+  std::chrono::system_clock::time_point ticketTime_;
+};
+
+TEST_F(ShardedPskCacheTest, TestBasic) {
+  auto psk = getCachedPsk();
+  cache_->putPsk("fizz", psk);
+  auto cachedPsk = cache_->getPsk("fizz");
+  EXPECT_TRUE(cachedPsk);
+  pskEq(psk, *cachedPsk);
+
+  cache_->removePsk("fizz");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_FALSE(cache_->getSharedPsk("fizz"));
+}
+
+TEST_F(ShardedPskCacheTest, TestSharedPsk) {
+  auto psk = getCachedPsk();
+  cache_->putPsk("fizz", psk);
+  auto shared1 = cache_->getSharedPsk("fizz");
+  auto shared2 = cache_->getSharedPsk("fizz");
+  ASSERT_TRUE(shared1);
+  EXPECT_EQ(shared1, shared2);
+  pskEq(psk, *shared1);
+
+  // Replacing the entry does not affect PSKs already handed out.
+  cache_->putPsk("fizz", getCachedPsk("other"));
+  EXPECT_EQ(shared1->psk, "PSK");
+  EXPECT_EQ(cache_->getSharedPsk("fizz")->psk, "other");
+}
+
+TEST_F(ShardedPskCacheTest, TestEviction) {
+  for (int i : {1, 2, 3}) {
+    auto pskName = folly::sformat("psk {}", i);
+    cache_->putPsk(pskName, getCachedPsk(pskName));
+    tick();
+  }
+
+  // Prime 1 to be evicted
+  cache_->getPsk("psk 2");
+  tick();
+  cache_->getPsk("psk 3");
+  tick();
+
+  cache_->putPsk("psk 4", getCachedPsk("psk 4"));
+
+  EXPECT_FALSE(cache_->getPsk("psk 1"));
+  EXPECT_TRUE(cache_->getPsk("psk 2"));
+  EXPECT_TRUE(cache_->getPsk("psk 3"));
+  EXPECT_TRUE(cache_->getPsk("psk 4"));
+}
+
+TEST_F(ShardedPskCacheTest, TestConcurrentAccess) {
+  ShardedPskCache::Options options;
+  options.capacity = 64;
+  options.numShards = 8;
+  ShardedPskCache cache(options);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache, t, this]() {
+      for (int i = 0; i < 1000; ++i) {
+        auto identity = folly::to<std::string>("psk ", (i + t) % 100);
+        if (i % 10 == 0) {
+          cache.putPsk(identity, getCachedPsk(identity));
+        } else if (i % 97 == 0) {
+          cache.removePsk(identity);
+        } else {
+          auto psk = cache.getSharedPsk(identity);
+          if (psk) {
+            EXPECT_EQ(psk->psk, identity);
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+} // namespace test
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,33 @@
+# - Try to find liburing
+# Once done, this will define
+#
+# LIBURING_FOUND - system has liburing 2.2 or later (provided buffer rings)
+# LIBURING_INCLUDE_DIRS - the liburing include directories
+# LIBURING_LIBRARIES - link these to use liburing
+
+include(FindPackageHandleStandardArgs)
+include(CheckSymbolExists)
+include(CMakePushCheckState)
+
+find_path(LIBURING_INCLUDE_DIR liburing.h
+  PATHS ${LIBURING_INCLUDEDIR})
+
+find_library(LIBURING_LIBRARY uring
+  PATHS ${LIBURING_LIBRARYDIR})
+
+if(LIBURING_INCLUDE_DIR AND LIBURING_LIBRARY)
+  cmake_push_check_state(RESET)
+  set(CMAKE_REQUIRED_INCLUDES ${LIBURING_INCLUDE_DIR})
+  set(CMAKE_REQUIRED_LIBRARIES ${LIBURING_LIBRARY})
+  check_symbol_exists(
+    io_uring_register_buf_ring liburing.h LIBURING_HAS_BUF_RING)
+  cmake_pop_check_state()
+endif()
+
+find_package_handle_standard_args(liburing DEFAULT_MSG
+  LIBURING_LIBRARY LIBURING_INCLUDE_DIR LIBURING_HAS_BUF_RING)
+
+mark_as_advanced(LIBURING_INCLUDE_DIR LIBURING_LIBRARY)
+
+set(LIBURING_INCLUDE_DIRS ${LIBURING_INCLUDE_DIR})
+set(LIBURING_LIBRARIES ${LIBURING_LIBRARY})
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <folly/Optional.h>
+#include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
 
 namespace fizz {
@@ -83,6 +84,38 @@ class Aead {
       const folly::IOBuf* associatedData,
       uint64_t seqNum) const = 0;
 
+  /**
+   * Decrypt ciphertext into output, which must be an empty, unchained buffer
+   * with room for the plaintext (the ciphertext length minus
+   * getCipherOverhead()). On success output holds the plaintext. Returns false
+   * if the ciphertext does not decrypt successfully, in which case the
+   * contents of output's tailroom are unspecified.
+   *
+   * Allows decrypting straight into memory supplied by the caller. The default
+   * implementation decrypts with tryDecrypt() and copies the plaintext.
+   */
+  virtual bool tryDecryptInto(
+      std::unique_ptr<folly::IOBuf>&& ciphertext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum,
+      folly::IOBuf& output) const {
+    auto plaintext = tryDecrypt(
+        std::forward<std::unique_ptr<folly::IOBuf>>(ciphertext),
+        associatedData,
+        seqNum);
+    if (!plaintext) {
+      return false;
+    }
+    auto length = (*plaintext)->computeChainDataLength();
+    if (output.isChained() || output.length() != 0 ||
+        output.tailroom() < length) {
+      throw std::runtime_error("decryption output too small");
+    }
+    folly::io::Cursor(plaintext->get()).pull(output.writableTail(), length);
+    output.append(length);
+    return true;
+  }
+
   /**
    * Returns the number of bytes the aead will add to the plaintext (size of
    * ciphertext - size of plaintext).
@@ -16,6 +16,15 @@ folly::Optional<std::unique_ptr<folly::IOBuf>> evpDecrypt(
     bool useBlockOps,
     EVP_CIPHER_CTX* decryptCtx);
 
+bool evpDecryptInto(
+    std::unique_ptr<folly::IOBuf>&& ciphertext,
+    const folly::IOBuf* associatedData,
+    folly::ByteRange iv,
+    folly::MutableByteRange tag,
+    bool useBlockOps,
+    EVP_CIPHER_CTX* decryptCtx,
+    folly::IOBuf& output);
+
 std::unique_ptr<folly::IOBuf> evpEncrypt(
     std::unique_ptr<folly::IOBuf>&& plaintext,
     const folly::IOBuf* associatedData,
@@ -27,57 +36,71 @@ std::unique_ptr<folly::IOBuf> evpEncrypt(
 } // namespace detail
 
 template <typename EVPImpl>
-OpenSSLEVPCipher<EVPImpl>::OpenSSLEVPCipher() {
-  encryptCtx_.reset(EVP_CIPHER_CTX_new());
-  if (encryptCtx_ == nullptr) {
-    throw std::runtime_error("Unable to allocate an EVP_CIPHER_CTX object");
-  }
-  decryptCtx_.reset(EVP_CIPHER_CTX_new());
-  if (decryptCtx_ == nullptr) {
+OpenSSLEVPCipher<EVPImpl>::OpenSSLEVPCipher() {}
+
+template <typename EVPImpl>
+typename OpenSSLEVPCipher<EVPImpl>::CipherCtxPtr
+OpenSSLEVPCipher<EVPImpl>::makeCipherCtx(bool encrypt) const {
+  CipherCtxPtr ctx(EVP_CIPHER_CTX_new());
+  if (ctx == nullptr) {
     throw std::runtime_error("Unable to allocate an EVP_CIPHER_CTX object");
   }
-  if (EVP_EncryptInit_ex(
-          encryptCtx_.get(), EVPImpl::Cipher(), nullptr, nullptr, nullptr) !=
-      1) {
+  if (EVP_CipherInit_ex(
+          ctx.get(),
+          EVPImpl::Cipher(),
+          nullptr,
+          nullptr,
+          nullptr,
+          encrypt ? 1 : 0) != 1) {
     throw std::runtime_error("Init error");
   }
   if (EVP_CIPHER_CTX_ctrl(
-          encryptCtx_.get(),
-          EVP_CTRL_GCM_SET_IVLEN,
-          EVPImpl::kIVLength,
-          nullptr) != 1) {
-    throw std::runtime_error("Error setting iv length");
-  }
-  if (EVP_DecryptInit_ex(
-          decryptCtx_.get(), EVPImpl::Cipher(), nullptr, nullptr, nullptr) !=
+          ctx.get(), EVP_CTRL_GCM_SET_IVLEN, EVPImpl::kIVLength, nullptr) !=
       1) {
-    throw std::runtime_error("Init error");
-  }
-  if (EVP_CIPHER_CTX_ctrl(
-          decryptCtx_.get(),
-          EVP_CTRL_GCM_SET_IVLEN,
-          EVPImpl::kIVLength,
-          nullptr) != 1) {
     throw std::runtime_error("Error setting iv length");
   }
-
   if (EVPImpl::kRequiresPresetTagLen) {
     if (EVP_CIPHER_CTX_ctrl(
-            encryptCtx_.get(),
-            EVP_CTRL_GCM_SET_TAG,
-            EVPImpl::kTagLength,
-            nullptr) != 1) {
-      throw std::runtime_error("Error setting enc tag length");
+            ctx.get(), EVP_CTRL_GCM_SET_TAG, EVPImpl::kTagLength, nullptr) !=
+        1) {
+      throw std::runtime_error("Error setting tag length");
     }
+  }
+  if (trafficKey_.key) {
+    setCtxKey(ctx.get(), encrypt);
+  }
+  return ctx;
+}
 
-    if (EVP_CIPHER_CTX_ctrl(
-            decryptCtx_.get(),
-            EVP_CTRL_GCM_SET_TAG,
-            EVPImpl::kTagLength,
-            nullptr) != 1) {
-      throw std::runtime_error("Error setting dec tag length");
-    }
+template <typename EVPImpl>
+void OpenSSLEVPCipher<EVPImpl>::setCtxKey(EVP_CIPHER_CTX* ctx, bool encrypt)
+    const {
+  if (EVP_CipherInit_ex(
+          ctx,
+          nullptr,
+          nullptr,
+          trafficKey_.key->data(),
+          nullptr,
+          encrypt ? 1 : 0) != 1) {
+    throw std::runtime_error(
+        encrypt ? "Error setting encrypt key" : "Error setting decrypt key");
+  }
+}
+
+template <typename EVPImpl>
+EVP_CIPHER_CTX* OpenSSLEVPCipher<EVPImpl>::getEncryptCtx() const {
+  if (!encryptCtx_) {
+    encryptCtx_ = makeCipherCtx(true);
+  }
+  return encryptCtx_.get();
+}
+
+template <typename EVPImpl>
+EVP_CIPHER_CTX* OpenSSLEVPCipher<EVPImpl>::getDecryptCtx() const {
+  if (!decryptCtx_) {
+    decryptCtx_ = makeCipherCtx(false);
   }
+  return decryptCtx_.get();
 }
 
 template <typename EVPImpl>
@@ -91,21 +114,12 @@ void OpenSSLEVPCipher<EVPImpl>::setKey(TrafficKey trafficKey) {
     throw std::runtime_error("Invalid IV");
   }
   trafficKey_ = std::move(trafficKey);
-  if (EVP_EncryptInit_ex(
-          encryptCtx_.get(),
-          nullptr,
-          nullptr,
-          trafficKey_.key->data(),
-          nullptr) != 1) {
-    throw std::runtime_error("Error setting encrypt key");
+  // Contexts are otherwise keyed when they are first used.
+  if (encryptCtx_) {
+    setCtxKey(encryptCtx_.get(), true);
   }
-  if (EVP_DecryptInit_ex(
-          decryptCtx_.get(),
-          nullptr,
-          nullptr,
-          trafficKey_.key->data(),
-          nullptr) != 1) {
-    throw std::runtime_error("Error setting decrypt key");
+  if (decryptCtx_) {
+    setCtxKey(decryptCtx_.get(), false);
   }
 }
 
@@ -122,7 +136,7 @@ std::unique_ptr<folly::IOBuf> OpenSSLEVPCipher<EVPImpl>::encrypt(
       EVPImpl::kTagLength,
       EVPImpl::kOperatesInBlocks,
       headroom_,
-      encryptCtx_.get());
+      getEncryptCtx());
 }
 
 template <typename EVPImpl>
@@ -141,7 +155,26 @@ OpenSSLEVPCipher<EVPImpl>::tryDecrypt(
       iv,
       tagOut,
       EVPImpl::kOperatesInBlocks,
-      decryptCtx_.get());
+      getDecryptCtx());
+}
+
+template <typename EVPImpl>
+bool OpenSSLEVPCipher<EVPImpl>::tryDecryptInto(
+    std::unique_ptr<folly::IOBuf>&& ciphertext,
+    const folly::IOBuf* associatedData,
+    uint64_t seqNum,
+    folly::IOBuf& output) const {
+  auto iv = createIV(seqNum);
+  std::array<uint8_t, EVPImpl::kTagLength> tagData;
+  folly::MutableByteRange tagOut{tagData};
+  return detail::evpDecryptInto(
+      std::move(ciphertext),
+      associatedData,
+      iv,
+      tagOut,
+      EVPImpl::kOperatesInBlocks,
+      getDecryptCtx(),
+      output);
 }
 
 template <typename EVPImpl>
@@ -261,6 +261,40 @@ std::unique_ptr<folly::IOBuf> evpEncrypt(
   return output;
 }
 
+static bool evpDecryptWithCtx(
+    const folly::IOBuf& input,
+    folly::IOBuf& output,
+    const folly::IOBuf* associatedData,
+    folly::ByteRange iv,
+    folly::MutableByteRange tagOut,
+    bool useBlockOps,
+    EVP_CIPHER_CTX* decryptCtx) {
+  if (EVP_DecryptInit_ex(decryptCtx, nullptr, nullptr, nullptr, iv.data()) !=
+      1) {
+    throw std::runtime_error("Decryption error");
+  }
+
+  if (associatedData) {
+    for (auto current : *associatedData) {
+      if (current.size() > std::numeric_limits<int>::max()) {
+        throw std::runtime_error("too much associated data");
+      }
+      int len;
+      if (EVP_DecryptUpdate(
+              decryptCtx,
+              nullptr,
+              &len,
+              current.data(),
+              static_cast<int>(current.size())) != 1) {
+        throw std::runtime_error("Decryption error");
+      }
+    }
+  }
+
+  return useBlockOps ? decFuncBlocks(decryptCtx, input, output, tagOut)
+                     : decFunc(decryptCtx, input, output, tagOut);
+}
+
 folly::Optional<std::unique_ptr<folly::IOBuf>> evpDecrypt(
     std::unique_ptr<folly::IOBuf>&& ciphertext,
     const folly::IOBuf* associatedData,
@@ -289,35 +323,52 @@ folly::Optional<std::unique_ptr<folly::IOBuf>> evpDecrypt(
     input = output.get();
   }
 
-  if (EVP_DecryptInit_ex(decryptCtx, nullptr, nullptr, nullptr, iv.data()) !=
-      1) {
-    throw std::runtime_error("Decryption error");
+  if (!evpDecryptWithCtx(
+          *input,
+          *output,
+          associatedData,
+          iv,
+          tagOut,
+          useBlockOps,
+          decryptCtx)) {
+    return folly::none;
   }
+  return std::move(output);
+}
 
-  if (associatedData) {
-    for (auto current : *associatedData) {
-      if (current.size() > std::numeric_limits<int>::max()) {
-        throw std::runtime_error("too much associated data");
-      }
-      int len;
-      if (EVP_DecryptUpdate(
-              decryptCtx,
-              nullptr,
-              &len,
-              current.data(),
-              static_cast<int>(current.size())) != 1) {
-        throw std::runtime_error("Decryption error");
-      }
-    }
+bool evpDecryptInto(
+    std::unique_ptr<folly::IOBuf>&& ciphertext,
+    const folly::IOBuf* associatedData,
+    folly::ByteRange iv,
+    folly::MutableByteRange tagOut,
+    bool useBlockOps,
+    EVP_CIPHER_CTX* decryptCtx,
+    folly::IOBuf& output) {
+  auto tagLen = tagOut.size();
+  auto inputLength = ciphertext->computeChainDataLength();
+  if (inputLength < tagLen) {
+    return false;
+  }
+  inputLength -= tagLen;
+  if (output.isChained() || output.length() != 0 ||
+      output.tailroom() < inputLength) {
+    throw std::runtime_error("decryption output too small");
   }
 
-  auto decrypted = useBlockOps
-      ? decFuncBlocks(decryptCtx, *input, *output, tagOut)
-      : decFunc(decryptCtx, *input, *output, tagOut);
-  if (!decrypted) {
-    return folly::none;
+  trimBytes(*ciphertext, tagOut);
+  output.append(inputLength);
+  if (!evpDecryptWithCtx(
+          *ciphertext,
+          output,
+          associatedData,
+          iv,
+          tagOut,
+          useBlockOps,
+          decryptCtx)) {
+    output.trimEnd(inputLength);
+    return false;
   }
-  return std::move(output);
+  return true;
 }
 } // namespace detail
 } // namespace fizz
@@ -69,6 +69,12 @@ class OpenSSLEVPCipher : public Aead {
       const folly::IOBuf* associatedData,
       uint64_t seqNum) const override;
 
+  bool tryDecryptInto(
+      std::unique_ptr<folly::IOBuf>&& ciphertext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum,
+      folly::IOBuf& output) const override;
+
   size_t getCipherOverhead() const override;
 
   void setEncryptedBufferHeadroom(size_t headroom) override {
@@ -76,16 +82,24 @@ class OpenSSLEVPCipher : public Aead {
   }
 
  private:
-  std::array<uint8_t, EVPImpl::kIVLength> createIV(uint64_t seqNum) const;
-
   using CipherCtxDeleter =
       folly::static_function_deleter<EVP_CIPHER_CTX, &EVP_CIPHER_CTX_free>;
+  using CipherCtxPtr = std::unique_ptr<EVP_CIPHER_CTX, CipherCtxDeleter>;
+
+  std::array<uint8_t, EVPImpl::kIVLength> createIV(uint64_t seqNum) const;
+
+  CipherCtxPtr makeCipherCtx(bool encrypt) const;
+  void setCtxKey(EVP_CIPHER_CTX* ctx, bool encrypt) const;
+  EVP_CIPHER_CTX* getEncryptCtx() const;
+  EVP_CIPHER_CTX* getDecryptCtx() const;
 
   TrafficKey trafficKey_;
   size_t headroom_{5};
 
-  std::unique_ptr<EVP_CIPHER_CTX, CipherCtxDeleter> encryptCtx_;
-  std::unique_ptr<EVP_CIPHER_CTX, CipherCtxDeleter> decryptCtx_;
+  // Created on first use, so that a record layer that only encrypts (or only
+  // decrypts) never allocates the other context.
+  mutable CipherCtxPtr encryptCtx_;
+  mutable CipherCtxPtr decryptCtx_;
 };
 } // namespace fizz
 #include <fizz/crypto/aead/OpenSSLEVPCipher-inl.h>
@@ -68,6 +68,21 @@ class MockAead : public Aead {
     return _tryDecrypt(ciphertext, associatedData, seqNum);
   }
 
+  MOCK_CONST_METHOD4(
+      _tryDecryptInto,
+      bool(
+          std::unique_ptr<folly::IOBuf>& ciphertext,
+          const folly::IOBuf* associatedData,
+          uint64_t seqNum,
+          folly::IOBuf& output));
+  bool tryDecryptInto(
+      std::unique_ptr<folly::IOBuf>&& ciphertext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum,
+      folly::IOBuf& output) const override {
+    return _tryDecryptInto(ciphertext, associatedData, seqNum, output);
+  }
+
   void setDefaults() {
     ON_CALL(*this, _encrypt(_, _, _)).WillByDefault(InvokeWithoutArgs([]() {
       return folly::IOBuf::copyBuffer("ciphertext");
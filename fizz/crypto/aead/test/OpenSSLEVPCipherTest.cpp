@@ -146,6 +146,26 @@ TEST_P(OpenSSLEVPCipherTest, TestEncryptReusedCipher) {
   callEncrypt(cipher, GetParam());
 }
 
+TEST_P(OpenSSLEVPCipherTest, TestSetKeyAfterUse) {
+  auto params = GetParam();
+  auto cipher = getCipher(params);
+
+  // Use the cipher under a different key first, so that the encrypt context
+  // exists before the real key is set.
+  TrafficKey otherKey;
+  otherKey.key = toIOBuf(std::string(params.key.size(), '0'));
+  otherKey.iv = toIOBuf(params.iv);
+  cipher->setKey(std::move(otherKey));
+  cipher->encrypt(toIOBuf(params.plaintext), nullptr, 0);
+
+  TrafficKey trafficKey;
+  trafficKey.key = toIOBuf(params.key);
+  trafficKey.iv = toIOBuf(params.iv);
+  cipher->setKey(std::move(trafficKey));
+  callEncrypt(cipher, params);
+  callDecrypt(cipher, params);
+}
+
 TEST_P(OpenSSLEVPCipherTest, TestEncryptChunkedInput) {
   auto cipher = getCipher(GetParam());
   auto input = toIOBuf(GetParam().plaintext);
@@ -277,6 +297,49 @@ TEST_P(OpenSSLEVPCipherTest, TestTryDecrypt) {
   }
 }
 
+TEST_P(OpenSSLEVPCipherTest, TestTryDecryptInto) {
+  auto cipher = getCipher(GetParam());
+  auto ciphertext = chunkIOBuf(toIOBuf(GetParam().ciphertext), 3);
+  auto plaintextLength =
+      ciphertext->computeChainDataLength() - cipher->getCipherOverhead();
+  std::vector<uint8_t> memory(plaintextLength);
+  auto output = IOBuf::wrapBuffer(memory.data(), memory.size());
+  output->clear();
+  auto decrypted = cipher->tryDecryptInto(
+      std::move(ciphertext),
+      toIOBuf(GetParam().aad).get(),
+      GetParam().seqNum,
+      *output);
+  if (decrypted) {
+    EXPECT_TRUE(GetParam().valid);
+    EXPECT_TRUE(IOBufEqualTo()(toIOBuf(GetParam().plaintext), *output));
+    EXPECT_EQ(output->data(), memory.data());
+  } else {
+    EXPECT_FALSE(GetParam().valid);
+    EXPECT_EQ(output->length(), 0);
+  }
+}
+
+TEST_P(OpenSSLEVPCipherTest, TestTryDecryptIntoTooSmall) {
+  auto cipher = getCipher(GetParam());
+  auto ciphertext = toIOBuf(GetParam().ciphertext);
+  auto plaintextLength =
+      ciphertext->computeChainDataLength() - cipher->getCipherOverhead();
+  if (plaintextLength == 0) {
+    return;
+  }
+  std::vector<uint8_t> memory(plaintextLength - 1);
+  auto output = IOBuf::wrapBuffer(memory.data(), memory.size());
+  output->clear();
+  EXPECT_THROW(
+      cipher->tryDecryptInto(
+          std::move(ciphertext),
+          toIOBuf(GetParam().aad).get(),
+          GetParam().seqNum,
+          *output),
+      std::runtime_error);
+}
+
 // Adapted from draft-thomson-tls-tls13-vectors
 INSTANTIATE_TEST_CASE_P(
     AESGCM128TestVectors,
@@ -0,0 +1,36 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/AsyncCertificateVerifier.h>
+
+namespace fizz {
+
+ExecutorCertificateVerifier::ExecutorCertificateVerifier(
+    std::shared_ptr<const CertificateVerifier> verifier,
+    std::shared_ptr<folly::Executor> executor)
+    : verifier_(std::move(verifier)), executor_(std::move(executor)) {}
+
+void ExecutorCertificateVerifier::verify(
+    const std::vector<std::shared_ptr<const PeerCert>>& certs) const {
+  verifier_->verify(certs);
+}
+
+folly::Future<folly::Unit> ExecutorCertificateVerifier::verifyFuture(
+    const std::vector<std::shared_ptr<const PeerCert>>& certs) const {
+  // The wrapped verifier is kept alive by the queued function, as it may run
+  // after the context holding us has been released.
+  return folly::via(executor_.get(), [verifier = verifier_, certs]() {
+    verifier->verify(certs);
+  });
+}
+
+std::vector<Extension>
+ExecutorCertificateVerifier::getCertificateRequestExtensions() const {
+  return verifier_->getCertificateRequestExtensions();
+}
+} // namespace fizz
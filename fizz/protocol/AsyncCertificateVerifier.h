@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/CertificateVerifier.h>
+#include <folly/Executor.h>
+#include <folly/futures/Future.h>
+
+namespace fizz {
+
+/**
+ * CertificateVerifier with an asynchronous verify method. This is useful for
+ * verification policies that are too expensive to run on the event base, such
+ * as large CA stores, revocation checks, or remote pinning services.
+ *
+ * Both state machines wait on verifyFuture() instead of calling verify(). The
+ * handshake resumes on the connection's executor once the future completes.
+ */
+class AsyncCertificateVerifier : public CertificateVerifier {
+ public:
+  /**
+   * Verifies the certificates in certs, see CertificateVerifier::verify(). The
+   * returned future completes with an exception if verification fails.
+   */
+  virtual folly::Future<folly::Unit> verifyFuture(
+      const std::vector<std::shared_ptr<const PeerCert>>& certs) const = 0;
+};
+
+/**
+ * Runs an existing CertificateVerifier on an executor, typically a
+ * CPUThreadPoolExecutor, so that it does not block the event base.
+ */
+class ExecutorCertificateVerifier : public AsyncCertificateVerifier {
+ public:
+  ExecutorCertificateVerifier(
+      std::shared_ptr<const CertificateVerifier> verifier,
+      std::shared_ptr<folly::Executor> executor);
+
+  ~ExecutorCertificateVerifier() override = default;
+
+  /**
+   * Runs the wrapped verifier inline.
+   */
+  void verify(const std::vector<std::shared_ptr<const PeerCert>>& certs)
+      const override;
+
+  folly::Future<folly::Unit> verifyFuture(
+      const std::vector<std::shared_ptr<const PeerCert>>& certs) const override;
+
+  std::vector<Extension> getCertificateRequestExtensions() const override;
+
+ private:
+  std::shared_ptr<const CertificateVerifier> verifier_;
+  std::shared_ptr<folly::Executor> executor_;
+};
+} // namespace fizz
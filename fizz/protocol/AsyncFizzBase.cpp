@@ -8,32 +8,85 @@
 
 #include <fizz/protocol/AsyncFizzBase.h>
 
+#include <fizz/protocol/ReadBufferPool.h>
 #include <folly/Conv.h>
 #include <folly/io/Cursor.h>
+#include <folly/io/async/AsyncSocket.h>
 
 namespace fizz {
 
 using folly::AsyncSocketException;
 
 /**
- * Min and max read buffer sizes when using non-mo
+ * Minimum space to offer the transport for a read.
  */
-static const uint32_t kMinReadSize = 1460;
-static const uint32_t kMaxReadSize = 4000;
+static const size_t kMinReadSize = 1460;
+
+/**
+ * Size of a TLS record header: content type, legacy version and length.
+ */
+static const size_t kRecordHeaderSize = 5;
 
 /**
  * Buffer size above which we should unset our read callback to apply back
  * pressure on the transport.
  */
-static const uint32_t kMaxBufSize = 64 * 1024;
+static const size_t kMaxBufSize = 64 * 1024;
+
+/**
+ * What kMaxBufSize shrinks to when the memory budget (if any) is exhausted.
+ * Enough for one full record.
+ */
+static const size_t kMinBudgetBufSize = ReadBufferPool::kMaxBufferSize;
+
+namespace {
+/**
+ * Memory held by the chain starting at buf, including unused headroom and
+ * tailroom.
+ */
+size_t chainCapacity(const folly::IOBuf* buf) {
+  if (!buf) {
+    return 0;
+  }
+  size_t capacity = 0;
+  auto current = buf;
+  do {
+    capacity += current->capacity();
+    current = current->next();
+  } while (current != buf);
+  return capacity;
+}
+
+/**
+ * Returns buf unchanged unless more than half of the memory it holds is unused
+ * (or shared with data we no longer reference), in which case its data is
+ * copied into a single exactly sized buffer.
+ */
+std::unique_ptr<folly::IOBuf> compactIdleBuf(
+    std::unique_ptr<folly::IOBuf> buf) {
+  size_t length = buf->computeChainDataLength();
+  if (chainCapacity(buf.get()) <= 2 * length) {
+    return buf;
+  }
+  auto compacted = folly::IOBuf::create(length);
+  folly::io::Cursor cursor(buf.get());
+  cursor.pull(compacted->writableTail(), length);
+  compacted->append(length);
+  return compacted;
+}
+} // namespace
 
 AsyncFizzBase::AsyncFizzBase(folly::AsyncTransportWrapper::UniquePtr transport)
     : folly::WriteChainAsyncTransportWrapper<folly::AsyncTransportWrapper>(
           std::move(transport)),
-      handshakeTimeout_(*this, transport_->getEventBase()) {}
+      handshakeTimeout_(*this, transport_->getEventBase()),
+      idleBufferTimeout_(*this, transport_->getEventBase()) {}
 
 AsyncFizzBase::~AsyncFizzBase() {
   transport_->setReadCB(nullptr);
+  if (memoryBudget_) {
+    memoryBudget_->release(memoryCharged_);
+  }
 }
 
 void AsyncFizzBase::destroy() {
@@ -85,10 +138,56 @@ size_t AsyncFizzBase::getAppBytesReceived() const {
   return appBytesReceived_;
 }
 
+bool AsyncFizzBase::setZeroCopyWriteThreshold(size_t threshold) {
+  zeroCopyWriteThreshold_ = 0;
+  if (threshold == 0) {
+    // Zero copy is left enabled on the socket, without the write flag it
+    // doesn't affect anything.
+    return true;
+  }
+  auto socket = transport_->getUnderlyingTransport<folly::AsyncSocket>();
+  if (!socket || !socket->setZeroCopy(true)) {
+    return false;
+  }
+  zeroCopyWriteThreshold_ = threshold;
+  return true;
+}
+
+folly::WriteFlags AsyncFizzBase::getTransportWriteFlags(
+    const folly::IOBuf& buf,
+    folly::WriteFlags flags) const {
+  // The ciphertext is always in buffers we own and won't modify again, which
+  // is what zero copy writes require.
+  if (zeroCopyWriteThreshold_ != 0 &&
+      buf.computeChainDataLength() >= zeroCopyWriteThreshold_) {
+    flags = flags | folly::WriteFlags::WRITE_MSG_ZEROCOPY;
+  }
+  return flags;
+}
+
 void AsyncFizzBase::startTransportReads() {
+  transportReadsPaused_ = false;
   transport_->setReadCB(this);
 }
 
+void AsyncFizzBase::setIdleBufferTimeout(std::chrono::milliseconds timeout) {
+  idleBufferTimeoutDuration_ = timeout;
+  idleBufferTimeout_.cancelTimeout();
+  readSinceIdleCheck_ = false;
+  if (idleBufferTimeoutDuration_.count() != 0) {
+    idleBufferTimeout_.scheduleTimeout(idleBufferTimeoutDuration_);
+  }
+}
+
+void AsyncFizzBase::setMemoryBudget(std::shared_ptr<MemoryBudget> budget) {
+  if (memoryBudget_) {
+    memoryBudget_->release(memoryCharged_);
+    memoryCharged_ = 0;
+  }
+  memoryBudget_ = std::move(budget);
+  updateMemoryBudget();
+}
+
 void AsyncFizzBase::startHandshakeTimeout(std::chrono::milliseconds timeout) {
   handshakeTimeout_.scheduleTimeout(timeout);
 }
@@ -102,6 +201,21 @@ void AsyncFizzBase::deliverAppData(std::unique_ptr<folly::IOBuf> data) {
     appBytesReceived_ += data->computeChainDataLength();
   }
 
+  if (data && decryptionBuffer_ &&
+      static_cast<const void*>(data->data()) == decryptionBuffer_) {
+    decryptionBuffer_ = nullptr;
+    if (readCallback_ && readCallback_ == decryptionBufferCallback_ &&
+        !appDataBuf_ && !data->isChained()) {
+      // Already decrypted into the read callback's buffer.
+      readCallback_->readDataAvailable(data->length());
+      checkBufLen();
+      return;
+    }
+    // The memory belongs to a read callback that may no longer be expecting
+    // us to fill it, so take a copy to deliver later.
+    data = folly::IOBuf::copyBuffer(data->data(), data->length());
+  }
+
   if (appDataBuf_) {
     if (data) {
       appDataBuf_->prependChain(std::move(data));
@@ -175,16 +289,75 @@ void AsyncFizzBase::deliverError(
 }
 
 void AsyncFizzBase::getReadBuffer(void** bufReturn, size_t* lenReturn) {
+  // Data is consumed a record at a time, so the front of transportReadBuf_ is
+  // always the start of a record.
+  size_t buffered = transportReadBuf_.chainLength();
+  size_t remaining = 0;
+  if (buffered >= kRecordHeaderSize) {
+    folly::io::Cursor cursor(transportReadBuf_.front());
+    cursor.skip(kRecordHeaderSize - sizeof(uint16_t));
+    size_t recordSize = kRecordHeaderSize + cursor.readBE<uint16_t>();
+    // Track a slowly decaying maximum of recent record sizes, so that we have
+    // room for a whole record when starting to read the next one. This may be
+    // called several times for the same record, which must only count once.
+    auto record = transportReadBuf_.front()->data();
+    if (record != hintedRecord_) {
+      hintedRecord_ = record;
+      readSizeHint_ = std::max(recordSize, readSizeHint_ - readSizeHint_ / 8);
+    }
+    if (recordSize > buffered) {
+      remaining = recordSize - buffered;
+    }
+  }
+
+  size_t readSize;
+  if (buffered == 0 && !lastReadFilled_) {
+    // At a record boundary with nothing else to read, the next record may be
+    // a long way off; don't hold a full record sized buffer while waiting.
+    readSize = kMinReadSize;
+  } else {
+    readSize = std::min(
+        std::max(remaining, std::max(readSizeHint_, kMinReadSize)),
+        ReadBufferPool::kMaxBufferSize);
+  }
+
+  // Make sure the rest of the next record fits in a single buffer, so that it
+  // can usually be decrypted without crossing buffer boundaries.
+  auto front = transportReadBuf_.front();
+  auto tail = front ? front->prev() : nullptr;
+  if (!tail || tail->isSharedOne() || tail->tailroom() < readSize) {
+    if (remaining > buffered) {
+      // Only the start of a record is buffered, and it's small enough that it
+      // is worth moving it into the new buffer to keep the record contiguous.
+      // The record length is not validated yet, so don't trust it further
+      // than the largest record we accept.
+      auto readBuf = ReadBufferPool::allocate(std::min(
+          std::max(buffered + remaining, readSize),
+          ReadBufferPool::kMaxBufferSize));
+      auto partial = transportReadBuf_.move();
+      folly::io::Cursor(partial.get()).pull(readBuf->writableTail(), buffered);
+      readBuf->append(buffered);
+      readSize = std::min(readSize, readBuf->tailroom());
+      transportReadBuf_.append(std::move(readBuf));
+    } else {
+      transportReadBuf_.append(ReadBufferPool::allocate(readSize));
+    }
+  }
   std::pair<void*, uint32_t> readSpace =
-      transportReadBuf_.preallocate(kMinReadSize, kMaxReadSize);
+      transportReadBuf_.preallocate(readSize, readSize);
   *bufReturn = readSpace.first;
   *lenReturn = readSpace.second;
+  readSpaceOffered_ = readSpace.second;
 }
 
 void AsyncFizzBase::readDataAvailable(size_t len) noexcept {
   DelayedDestruction::DestructorGuard dg(this);
 
+  // A read that filled all the space it was given likely left more data in
+  // the transport.
+  lastReadFilled_ = len >= readSpaceOffered_;
   transportReadBuf_.postallocate(len);
+  scheduleIdleBufferTimeout();
   transportDataAvailable();
   checkBufLen();
 }
@@ -198,6 +371,7 @@ void AsyncFizzBase::readBufferAvailable(
   DelayedDestruction::DestructorGuard dg(this);
 
   transportReadBuf_.append(std::move(data));
+  scheduleIdleBufferTimeout();
   transportDataAvailable();
   checkBufLen();
 }
@@ -211,6 +385,38 @@ void AsyncFizzBase::readErr(const folly::AsyncSocketException& ex) noexcept {
   transportError(ex);
 }
 
+std::unique_ptr<folly::IOBuf> AsyncFizzBase::getDecryptionBuffer(size_t size) {
+  // Forget any earlier buffer, so that its address can't be mistaken for this
+  // record's if the read callback hands it out again.
+  releaseDecryptionBuffer();
+
+  // Anything buffered has to be delivered first, through the usual path.
+  if (!readCallback_ || appDataBuf_ || readCallback_->isBufferMovable()) {
+    return nullptr;
+  }
+  void* buf = nullptr;
+  size_t buflen = 0;
+  try {
+    readCallback_->getReadBuffer(&buf, &buflen);
+  } catch (...) {
+    // The error is reported when delivering the data the usual way.
+    return nullptr;
+  }
+  if (!buf || buflen < size) {
+    return nullptr;
+  }
+  decryptionBuffer_ = buf;
+  decryptionBufferCallback_ = readCallback_;
+  auto decryptionBuf = folly::IOBuf::wrapBuffer(buf, buflen);
+  decryptionBuf->clear();
+  return decryptionBuf;
+}
+
+void AsyncFizzBase::releaseDecryptionBuffer() {
+  decryptionBuffer_ = nullptr;
+  decryptionBufferCallback_ = nullptr;
+}
+
 void AsyncFizzBase::writeSuccess() noexcept {}
 
 void AsyncFizzBase::writeErr(
@@ -220,16 +426,78 @@ void AsyncFizzBase::writeErr(
 }
 
 void AsyncFizzBase::checkBufLen() {
-  if (!readCallback_ &&
-      (transportReadBuf_.chainLength() >= kMaxBufSize ||
-       (appDataBuf_ && appDataBuf_->computeChainDataLength() >= kMaxBufSize))) {
+  auto maxBufSize = kMaxBufSize;
+  if (memoryBudget_) {
+    updateMemoryBudget();
+    maxBufSize =
+        memoryBudget_->getConnectionLimit(kMaxBufSize, kMinBudgetBufSize);
+  }
+  // Undelivered app data only builds up without a read callback, but records
+  // can also pile up while the state machine is busy (for example waiting on
+  // an asynchronous action), so the transport buffer is limited either way.
+  if (transportReadBuf_.chainLength() >= maxBufSize ||
+      (!readCallback_ && appDataBuf_ &&
+       appDataBuf_->computeChainDataLength() >= maxBufSize)) {
+    transportReadsPaused_ = true;
     transport_->setReadCB(nullptr);
   }
 }
 
+void AsyncFizzBase::updateMemoryBudget() {
+  if (!memoryBudget_) {
+    return;
+  }
+  // Charge the memory held rather than the data in it, a buffer's unused
+  // tailroom is just as unavailable to other connections.
+  size_t buffered = chainCapacity(transportReadBuf_.front()) +
+      getBufferedHandshakeSize() + chainCapacity(appDataBuf_.get());
+  if (buffered > memoryCharged_) {
+    memoryBudget_->charge(buffered - memoryCharged_);
+  } else {
+    memoryBudget_->release(memoryCharged_ - buffered);
+  }
+  memoryCharged_ = buffered;
+}
+
 void AsyncFizzBase::handshakeTimeoutExpired() noexcept {
   AsyncSocketException eof(
       AsyncSocketException::TIMED_OUT, "handshake timeout expired");
   transportError(eof);
 }
+
+void AsyncFizzBase::scheduleIdleBufferTimeout() {
+  if (idleBufferTimeoutDuration_.count() == 0) {
+    return;
+  }
+  // Rescheduling on every read would be wasteful, so we only note the read and
+  // check for it when the timeout fires.
+  readSinceIdleCheck_ = true;
+  if (!idleBufferTimeout_.isScheduled()) {
+    idleBufferTimeout_.scheduleTimeout(idleBufferTimeoutDuration_);
+  }
+}
+
+void AsyncFizzBase::idleBufferTimeoutExpired() noexcept {
+  if (readSinceIdleCheck_) {
+    readSinceIdleCheck_ = false;
+    idleBufferTimeout_.scheduleTimeout(idleBufferTimeoutDuration_);
+    return;
+  }
+  // Not rescheduled until the next read, so fully idle connections don't keep
+  // a timer armed.
+  releaseIdleBuffers();
+}
+
+void AsyncFizzBase::releaseIdleBuffers() {
+  auto readBuf = transportReadBuf_.move();
+  if (readBuf && !readBuf->empty()) {
+    transportReadBuf_.append(compactIdleBuf(std::move(readBuf)));
+  }
+
+  if (appDataBuf_ && !appDataBuf_->empty()) {
+    appDataBuf_ = compactIdleBuf(std::move(appDataBuf_));
+  } else {
+    appDataBuf_.reset();
+  }
+}
 } // namespace fizz
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <fizz/protocol/MemoryBudget.h>
+#include <fizz/record/RecordLayer.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/io/async/AsyncSocket.h>
 #include <folly/io/async/WriteChainAsyncTransportWrapper.h>
@@ -23,6 +25,7 @@ using Cert = folly::AsyncTransportCertificate;
 class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
                           folly::AsyncTransportWrapper>,
                       protected folly::AsyncTransportWrapper::WriteCallback,
+                      protected DecryptionBufferProvider,
                       private folly::AsyncTransportWrapper::ReadCallback {
  public:
   using UniquePtr =
@@ -44,6 +47,21 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
     AsyncFizzBase& transport_;
   };
 
+  class IdleBufferTimeout : public folly::AsyncTimeout {
+   public:
+    IdleBufferTimeout(AsyncFizzBase& transport, folly::EventBase* eventBase)
+        : folly::AsyncTimeout(eventBase), transport_(transport) {}
+
+    ~IdleBufferTimeout() override = default;
+
+    void timeoutExpired() noexcept override {
+      transport_.idleBufferTimeoutExpired();
+    }
+
+   private:
+    AsyncFizzBase& transport_;
+  };
+
   explicit AsyncFizzBase(folly::AsyncTransportWrapper::UniquePtr transport);
 
   ~AsyncFizzBase() override;
@@ -104,26 +122,63 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
     return "Fizz";
   }
 
+  /**
+   * Release read buffers once no data has been read from the transport for
+   * roughly the given time (between one and two timeout periods). Empty
+   * buffers are freed and partially filled ones are copied into exactly sized
+   * buffers; the next read allocates a fresh buffer as usual. Useful for
+   * servers holding many mostly idle connections. A zero timeout disables
+   * this, which is the default. Must be called while attached to an
+   * EventBase.
+   */
+  void setIdleBufferTimeout(std::chrono::milliseconds timeout);
+
+  /**
+   * Accounts the memory held by this connection's read buffers against
+   * budget, which is usually shared by all connections in the process. The
+   * closer the budget is to being exhausted, the less is buffered before
+   * reads are paused.
+   */
+  void setMemoryBudget(std::shared_ptr<MemoryBudget> budget);
+
+  /**
+   * Send writes of at least threshold bytes of ciphertext with MSG_ZEROCOPY,
+   * saving the copy into the kernel for bulk transfers. The underlying
+   * AsyncSocket keeps the buffers alive until the kernel reports the send as
+   * complete. Returns false, leaving zero copy writes disabled, if the
+   * transport is not an AsyncSocket or the socket doesn't support zero copy.
+   * A zero threshold disables zero copy writes, which is the default.
+   */
+  bool setZeroCopyWriteThreshold(size_t threshold);
+
   /**
    * EventBase operations.
    */
   void attachTimeoutManager(folly::TimeoutManager* manager) {
     handshakeTimeout_.attachTimeoutManager(manager);
+    idleBufferTimeout_.attachTimeoutManager(manager);
   }
   void detachTimeoutManager() {
     handshakeTimeout_.detachTimeoutManager();
+    idleBufferTimeout_.detachTimeoutManager();
   }
   void attachEventBase(folly::EventBase* eventBase) override {
     handshakeTimeout_.attachEventBase(eventBase);
+    idleBufferTimeout_.attachEventBase(eventBase);
     transport_->attachEventBase(eventBase);
     // we want to avoid setting a read cb on a bad transport (i.e. closed or
     // disconnected) unless we have a read callback we can pass the errors to.
     if (transport_->good() || readCallback_) {
       startTransportReads();
     }
+    scheduleIdleBufferTimeout();
   }
   void detachEventBase() override {
     handshakeTimeout_.detachEventBase();
+    // The idle timeout is only an optimization, so rather than preventing
+    // detaching we restart it once attached to the new EventBase.
+    idleBufferTimeout_.cancelTimeout();
+    idleBufferTimeout_.detachEventBase();
     transport_->setReadCB(nullptr);
     transport_->detachEventBase();
   }
@@ -147,6 +202,15 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
    */
   virtual void startTransportReads();
 
+  /**
+   * Whether reads from the transport were paused because too much data is
+   * buffered. The derived class should start them again once the state
+   * machine is waiting for more data.
+   */
+  bool transportReadsPaused() const {
+    return transportReadsPaused_;
+  }
+
   /**
    * Interface for the derived class to schedule a handshake timeout.
    *
@@ -184,6 +248,21 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
    */
   virtual void transportDataAvailable() = 0;
 
+  /**
+   * Amount of handshake data the derived class has received but not yet
+   * parsed, for memory accounting.
+   */
+  virtual size_t getBufferedHandshakeSize() const {
+    return 0;
+  }
+
+  /**
+   * Flags for the derived class to write ciphertext to the transport with.
+   */
+  folly::WriteFlags getTransportWriteFlags(
+      const folly::IOBuf& buf,
+      folly::WriteFlags flags) const;
+
   folly::IOBufQueue transportReadBuf_{folly::IOBufQueue::cacheChainLength()};
 
  private:
@@ -198,6 +277,14 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
   void readEOF() noexcept override;
   void readErr(const folly::AsyncSocketException& ex) noexcept override;
 
+  /**
+   * DecryptionBufferProvider implementation. If the read callback doesn't take
+   * ownership of buffers, app data is decrypted straight into the buffers it
+   * provides rather than copied into them afterwards.
+   */
+  std::unique_ptr<folly::IOBuf> getDecryptionBuffer(size_t size) override;
+  void releaseDecryptionBuffer() override;
+
   /**
    * WriteCallback implementation, for use with handshake messages.
    */
@@ -207,15 +294,44 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
       const folly::AsyncSocketException& ex) noexcept override;
 
   void checkBufLen();
+  void updateMemoryBudget();
 
   void handshakeTimeoutExpired() noexcept;
 
+  void scheduleIdleBufferTimeout();
+  void idleBufferTimeoutExpired() noexcept;
+  void releaseIdleBuffers();
+
   ReadCallback* readCallback_{nullptr};
   std::unique_ptr<folly::IOBuf> appDataBuf_;
 
+  // The last buffer handed out by getDecryptionBuffer(), and the read callback
+  // it came from.
+  const void* decryptionBuffer_{nullptr};
+  ReadCallback* decryptionBufferCallback_{nullptr};
+
+  // Set when checkBufLen() stopped reading from the transport to apply back
+  // pressure, cleared by startTransportReads().
+  bool transportReadsPaused_{false};
+
+  size_t readSizeHint_{0};
+  // Start of the last record counted in readSizeHint_.
+  const uint8_t* hintedRecord_{nullptr};
+  size_t readSpaceOffered_{0};
+  bool lastReadFilled_{false};
+
+  std::shared_ptr<MemoryBudget> memoryBudget_;
+  size_t memoryCharged_{0};
+
+  size_t zeroCopyWriteThreshold_{0};
+
   size_t appBytesWritten_{0};
   size_t appBytesReceived_{0};
 
   HandshakeTimeout handshakeTimeout_;
+
+  IdleBufferTimeout idleBufferTimeout_;
+  std::chrono::milliseconds idleBufferTimeoutDuration_{0};
+  bool readSinceIdleCheck_{false};
 };
 } // namespace fizz
@@ -0,0 +1,497 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/AsyncIoUringSocket.h>
+
+#include <folly/io/Cursor.h>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace fizz {
+
+using folly::AsyncSocketException;
+
+constexpr size_t AsyncIoUringSocket::kMaxIovecs;
+
+AsyncIoUringSocket::AsyncIoUringSocket(IoUringRing* ring, int fd)
+    : ring_(ring), fd_(fd), sendTimeout_(*this, ring->getEventBase()) {
+  std::memset(&sendMsg_, 0, sizeof(sendMsg_));
+}
+
+AsyncIoUringSocket::~AsyncIoUringSocket() {
+  DCHECK(!recvInFlight_ && !sendInFlight_);
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+void AsyncIoUringSocket::destroy() {
+  closeNow();
+  folly::DelayedDestruction::destroy();
+}
+
+folly::AsyncTransportWrapper::ReadCallback*
+AsyncIoUringSocket::getReadCallback() const {
+  return readCallback_;
+}
+
+void AsyncIoUringSocket::setReadCB(ReadCallback* callback) {
+  readCallback_ = callback;
+  if (!callback) {
+    // A receive in flight is left to complete, its data is buffered until a
+    // read callback is set again.
+    return;
+  }
+  DestructorGuard dg(this);
+  deliverReads();
+  startRecv();
+}
+
+void AsyncIoUringSocket::startRecv() {
+  if (!readCallback_ || recvInFlight_ || closed_ || closePending_ ||
+      readEOF_) {
+    return;
+  }
+  auto sqe = ring_->getSqe();
+  if (ring_->hasProvidedBuffers() && !useRecvBuf_) {
+    io_uring_prep_recv(sqe, fd_, nullptr, ring_->getBufferSize(), 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = IoUringRing::kBufferGroup;
+  } else {
+    recvBuf_ = ReadBufferPool::allocate(ring_->getBufferSize());
+    io_uring_prep_recv(
+        sqe, fd_, recvBuf_->writableTail(), recvBuf_->tailroom(), 0);
+  }
+  ring_->prepare(sqe, this, IoUringRing::Op::Recv);
+  recvInFlight_ = true;
+  recvGuard_.emplace(this);
+}
+
+void AsyncIoUringSocket::recvComplete(int res, uint32_t flags) {
+  DestructorGuard dg(this);
+  recvInFlight_ = false;
+  recvGuard_.clear();
+
+  std::unique_ptr<folly::IOBuf> buf;
+  if (flags & IORING_CQE_F_BUFFER) {
+    buf = ring_->takeBuffer(
+        flags >> IORING_CQE_BUFFER_SHIFT, res > 0 ? res : 0);
+  } else if (recvBuf_) {
+    buf = std::move(recvBuf_);
+    if (res > 0) {
+      buf->append(res);
+    }
+  }
+
+  if (closed_) {
+    return;
+  }
+  if (res == -ENOBUFS) {
+    // Every provided buffer is held by some connection. Rather than wait for
+    // one to be released, read into a buffer of our own this time.
+    useRecvBuf_ = true;
+    return startRecv();
+  }
+  if (res == -EINTR || res == -EAGAIN) {
+    return startRecv();
+  }
+  if (res < 0) {
+    return fail(AsyncSocketException(
+        AsyncSocketException::INTERNAL_ERROR, "recv failed", -res));
+  }
+
+  useRecvBuf_ = false;
+  if (res == 0) {
+    readEOF_ = true;
+  } else {
+    bytesReceived_ += res;
+    readBuf_.append(std::move(buf));
+  }
+  deliverReads();
+  startRecv();
+}
+
+void AsyncIoUringSocket::deliverReads() {
+  DestructorGuard dg(this);
+  while (readCallback_ && !readBuf_.empty()) {
+    if (readCallback_->isBufferMovable()) {
+      auto data = readBuf_.move();
+      // Keep the buffers referenced until the callback returns. As they are
+      // shared, records are decrypted out of them into buffers of their own
+      // rather than in place, so provided buffers aren't handed on to the
+      // application and only stay out of the ring while holding a partial
+      // record.
+      auto pinned = data->clone();
+      readCallback_->readBufferAvailable(std::move(data));
+      continue;
+    }
+
+    void* buf = nullptr;
+    size_t buflen = 0;
+    try {
+      readCallback_->getReadBuffer(&buf, &buflen);
+    } catch (const AsyncSocketException& ex) {
+      return fail(ex);
+    } catch (const std::exception& ex) {
+      return fail(AsyncSocketException(
+          AsyncSocketException::BAD_ARGS,
+          std::string("getReadBuffer() threw: ") + ex.what()));
+    }
+    if (!buf || buflen == 0) {
+      return fail(AsyncSocketException(
+          AsyncSocketException::BAD_ARGS,
+          "getReadBuffer() returned empty buffer"));
+    }
+    folly::io::Cursor cursor(readBuf_.front());
+    auto len = cursor.pullAtMost(buf, buflen);
+    readBuf_.trimStart(len);
+    readCallback_->readDataAvailable(len);
+  }
+
+  if (!readCallback_ || !readBuf_.empty() || !(readEOF_ || closed_)) {
+    return;
+  }
+  // Like AsyncSocket, the read callback is uninstalled once there is nothing
+  // more to read.
+  auto callback = readCallback_;
+  readCallback_ = nullptr;
+  if (readErr_) {
+    callback->readErr(*readErr_);
+  } else if (readEOF_) {
+    callback->readEOF();
+  } else {
+    callback->readErr(AsyncSocketException(
+        AsyncSocketException::NOT_OPEN, "socket is closed"));
+  }
+}
+
+void AsyncIoUringSocket::writeChain(
+    WriteCallback* callback,
+    std::unique_ptr<folly::IOBuf>&& buf,
+    folly::WriteFlags /* flags */) {
+  if (closed_ || closePending_ || writeShutdown_ || shutdownWritePending_) {
+    if (callback) {
+      callback->writeErr(
+          0,
+          AsyncSocketException(
+              AsyncSocketException::NOT_OPEN,
+              "write on closed or shut down socket"));
+    }
+    return;
+  }
+  writes_.push_back(WriteRequest{callback, std::move(buf)});
+  scheduleWrite();
+}
+
+void AsyncIoUringSocket::scheduleWrite() {
+  if (!writeScheduled_ && !sendInFlight_) {
+    writeScheduled_ = true;
+    ring_->scheduleWrite(this);
+  }
+}
+
+void AsyncIoUringSocket::prepareSend() {
+  writeScheduled_ = false;
+  if (closed_ || sendInFlight_ || writes_.empty()) {
+    return;
+  }
+
+  // Everything written during this loop iteration goes out in one sendmsg.
+  sendIov_.clear();
+  for (const auto& write : writes_) {
+    if (!write.buf) {
+      continue;
+    }
+    for (auto range : *write.buf) {
+      if (!range.empty() && sendIov_.size() < kMaxIovecs) {
+        sendIov_.push_back(
+            {const_cast<uint8_t*>(range.data()), range.size()});
+      }
+    }
+    if (sendIov_.size() >= kMaxIovecs) {
+      break;
+    }
+  }
+  if (sendIov_.empty()) {
+    // Only empty writes queued.
+    return completeWrites(0);
+  }
+
+  std::memset(&sendMsg_, 0, sizeof(sendMsg_));
+  sendMsg_.msg_iov = sendIov_.data();
+  sendMsg_.msg_iovlen = sendIov_.size();
+  auto sqe = ring_->getSqe();
+  io_uring_prep_sendmsg(sqe, fd_, &sendMsg_, MSG_NOSIGNAL);
+  ring_->prepare(sqe, this, IoUringRing::Op::Send);
+  sendInFlight_ = true;
+  sendGuard_.emplace(this);
+  if (sendTimeoutMs_ > 0) {
+    sendTimeout_.scheduleTimeout(sendTimeoutMs_);
+  }
+}
+
+void AsyncIoUringSocket::sendComplete(int res) {
+  DestructorGuard dg(this);
+  sendInFlight_ = false;
+  sendGuard_.clear();
+  sendTimeout_.cancelTimeout();
+  orphanedBufs_.clear();
+
+  if (closed_) {
+    return;
+  }
+  if (res == -EINTR || res == -EAGAIN) {
+    return scheduleWrite();
+  }
+  if (res < 0) {
+    return fail(AsyncSocketException(
+        AsyncSocketException::INTERNAL_ERROR, "sendmsg failed", -res));
+  }
+  bytesWritten_ += res;
+  completeWrites(res);
+}
+
+void AsyncIoUringSocket::completeWrites(size_t bytes) {
+  DestructorGuard dg(this);
+  while (!writes_.empty()) {
+    auto& write = writes_.front();
+    auto len = write.buf ? write.buf->computeChainDataLength() : 0;
+    if (len > bytes) {
+      // Partially written, the rest goes out with the next send.
+      folly::IOBufQueue queue;
+      queue.append(std::move(write.buf));
+      queue.trimStart(bytes);
+      write.buf = queue.move();
+      break;
+    }
+    bytes -= len;
+    auto callback = write.callback;
+    writes_.pop_front();
+    if (callback) {
+      callback->writeSuccess();
+    }
+    if (closed_) {
+      return;
+    }
+  }
+
+  if (!writes_.empty()) {
+    scheduleWrite();
+  } else if (closePending_) {
+    closeNow();
+  } else if (shutdownWritePending_) {
+    doShutdownWrite();
+  }
+}
+
+void AsyncIoUringSocket::failWrites(const AsyncSocketException& ex) {
+  auto writes = std::move(writes_);
+  writes_.clear();
+  for (auto& write : writes) {
+    if (sendInFlight_ && write.buf) {
+      orphanedBufs_.push_back(std::move(write.buf));
+    }
+    if (write.callback) {
+      write.callback->writeErr(0, ex);
+    }
+  }
+}
+
+void AsyncIoUringSocket::fail(const AsyncSocketException& ex) {
+  if (closed_) {
+    return;
+  }
+  error_ = true;
+  readErr_ = ex;
+  closeImpl(ex);
+}
+
+void AsyncIoUringSocket::close() {
+  if (closed_) {
+    return;
+  }
+  if (writes_.empty()) {
+    return closeNow();
+  }
+  // Finish the pending writes first, but stop reading right away.
+  closePending_ = true;
+  if (readCallback_) {
+    auto callback = readCallback_;
+    readCallback_ = nullptr;
+    callback->readEOF();
+  }
+}
+
+void AsyncIoUringSocket::closeNow() {
+  closeImpl(AsyncSocketException(
+      AsyncSocketException::NOT_OPEN, "socket closed locally"));
+}
+
+void AsyncIoUringSocket::closeWithReset() {
+  if (fd_ >= 0) {
+    linger optLinger = {1, 0};
+    ::setsockopt(fd_, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
+  }
+  closeNow();
+}
+
+void AsyncIoUringSocket::closeImpl(const AsyncSocketException& ex) {
+  if (closed_) {
+    return;
+  }
+  DestructorGuard dg(this);
+  closed_ = true;
+  closePending_ = false;
+  sendTimeout_.cancelTimeout();
+
+  // Requests in flight hold a reference to the file, so closing the
+  // descriptor alone doesn't stop them.
+  if (recvInFlight_) {
+    ring_->cancel(this, IoUringRing::Op::Recv);
+  }
+  if (sendInFlight_) {
+    ring_->cancel(this, IoUringRing::Op::Send);
+  }
+  ::shutdown(fd_, SHUT_RDWR);
+  ::close(fd_);
+  fd_ = -1;
+
+  readBuf_.move();
+  failWrites(ex);
+  if (readCallback_) {
+    auto callback = readCallback_;
+    readCallback_ = nullptr;
+    if (readErr_) {
+      callback->readErr(*readErr_);
+    } else {
+      callback->readEOF();
+    }
+  }
+}
+
+void AsyncIoUringSocket::shutdownWrite() {
+  if (closed_ || writeShutdown_) {
+    return;
+  }
+  if (writes_.empty()) {
+    doShutdownWrite();
+  } else {
+    shutdownWritePending_ = true;
+  }
+}
+
+void AsyncIoUringSocket::shutdownWriteNow() {
+  if (closed_ || writeShutdown_) {
+    return;
+  }
+  DestructorGuard dg(this);
+  failWrites(AsyncSocketException(
+      AsyncSocketException::NOT_OPEN, "write side shut down"));
+  doShutdownWrite();
+}
+
+void AsyncIoUringSocket::doShutdownWrite() {
+  shutdownWritePending_ = false;
+  writeShutdown_ = true;
+  ::shutdown(fd_, SHUT_WR);
+}
+
+void AsyncIoUringSocket::sendTimeoutExpired() noexcept {
+  fail(AsyncSocketException(
+      AsyncSocketException::TIMED_OUT, "write timed out"));
+}
+
+bool AsyncIoUringSocket::good() const {
+  return !closed_ && !error_;
+}
+
+bool AsyncIoUringSocket::readable() const {
+  if (!readBuf_.empty()) {
+    return true;
+  }
+  if (fd_ < 0) {
+    return false;
+  }
+  pollfd fds[1];
+  fds[0].fd = fd_;
+  fds[0].events = POLLIN;
+  fds[0].revents = 0;
+  return ::poll(fds, 1, 0) == 1;
+}
+
+bool AsyncIoUringSocket::connecting() const {
+  return false;
+}
+
+bool AsyncIoUringSocket::error() const {
+  return error_;
+}
+
+folly::EventBase* AsyncIoUringSocket::getEventBase() const {
+  return ring_->getEventBase();
+}
+
+void AsyncIoUringSocket::attachEventBase(folly::EventBase* eventBase) {
+  DCHECK_EQ(eventBase, ring_->getEventBase())
+      << "AsyncIoUringSocket can't move between EventBases";
+}
+
+void AsyncIoUringSocket::detachEventBase() {}
+
+bool AsyncIoUringSocket::isDetachable() const {
+  return false;
+}
+
+void AsyncIoUringSocket::setSendTimeout(uint32_t milliseconds) {
+  sendTimeoutMs_ = milliseconds;
+  if (sendInFlight_) {
+    if (milliseconds > 0) {
+      sendTimeout_.scheduleTimeout(milliseconds);
+    } else {
+      sendTimeout_.cancelTimeout();
+    }
+  }
+}
+
+uint32_t AsyncIoUringSocket::getSendTimeout() const {
+  return sendTimeoutMs_;
+}
+
+void AsyncIoUringSocket::getLocalAddress(folly::SocketAddress* address) const {
+  address->setFromLocalAddress(fd_);
+}
+
+void AsyncIoUringSocket::getPeerAddress(folly::SocketAddress* address) const {
+  address->setFromPeerAddress(fd_);
+}
+
+bool AsyncIoUringSocket::isEorTrackingEnabled() const {
+  return false;
+}
+
+void AsyncIoUringSocket::setEorTracking(bool /* track */) {}
+
+size_t AsyncIoUringSocket::getAppBytesWritten() const {
+  return bytesWritten_;
+}
+
+size_t AsyncIoUringSocket::getRawBytesWritten() const {
+  return bytesWritten_;
+}
+
+size_t AsyncIoUringSocket::getAppBytesReceived() const {
+  return bytesReceived_;
+}
+
+size_t AsyncIoUringSocket::getRawBytesReceived() const {
+  return bytesReceived_;
+}
+} // namespace fizz
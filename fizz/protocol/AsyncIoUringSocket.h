@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/IoUringRing.h>
+#include <folly/Optional.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/io/async/AsyncSocketException.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/WriteChainAsyncTransportWrapper.h>
+
+#include <sys/socket.h>
+
+#include <deque>
+
+namespace fizz {
+
+/**
+ * Transport for a connected socket, doing its I/O through the IoUringRing of
+ * its EventBase rather than through readiness notifications and a system call
+ * per read or write. Meant to be passed to AsyncFizzClient or AsyncFizzServer
+ * in place of an AsyncSocket:
+ *
+ *   - Receives use the ring's provided buffers, which are handed to the read
+ *     callback as is through readBufferAvailable(). AsyncFizzBase decrypts
+ *     records straight out of them, and a buffer returns to the kernel once
+ *     the records in it have been processed.
+ *   - Writes are gathered into a single sendmsg per socket and submitted
+ *     along with those of every other socket on the EventBase at the end of
+ *     the loop iteration.
+ *
+ * The socket stays on the EventBase of its ring for its whole lifetime.
+ */
+class AsyncIoUringSocket : public folly::WriteChainAsyncTransportWrapper<
+                               folly::AsyncTransportWrapper> {
+ public:
+  using UniquePtr = std::
+      unique_ptr<AsyncIoUringSocket, folly::DelayedDestruction::Destructor>;
+
+  class SendTimeout : public folly::AsyncTimeout {
+   public:
+    SendTimeout(AsyncIoUringSocket& socket, folly::EventBase* eventBase)
+        : folly::AsyncTimeout(eventBase), socket_(socket) {}
+
+    ~SendTimeout() override = default;
+
+    void timeoutExpired() noexcept override {
+      socket_.sendTimeoutExpired();
+    }
+
+   private:
+    AsyncIoUringSocket& socket_;
+  };
+
+  /**
+   * Takes ownership of fd, which must be a connected stream socket.
+   */
+  AsyncIoUringSocket(IoUringRing* ring, int fd);
+
+  ReadCallback* getReadCallback() const override;
+  void setReadCB(ReadCallback* callback) override;
+  void writeChain(
+      WriteCallback* callback,
+      std::unique_ptr<folly::IOBuf>&& buf,
+      folly::WriteFlags flags = folly::WriteFlags::NONE) override;
+
+  void close() override;
+  void closeNow() override;
+  void closeWithReset() override;
+  void shutdownWrite() override;
+  void shutdownWriteNow() override;
+
+  bool good() const override;
+  bool readable() const override;
+  bool connecting() const override;
+  bool error() const override;
+
+  folly::EventBase* getEventBase() const override;
+  void attachEventBase(folly::EventBase* eventBase) override;
+  void detachEventBase() override;
+  bool isDetachable() const override;
+
+  void setSendTimeout(uint32_t milliseconds) override;
+  uint32_t getSendTimeout() const override;
+
+  void getLocalAddress(folly::SocketAddress* address) const override;
+  void getPeerAddress(folly::SocketAddress* address) const override;
+
+  bool isEorTrackingEnabled() const override;
+  void setEorTracking(bool track) override;
+
+  size_t getAppBytesWritten() const override;
+  size_t getRawBytesWritten() const override;
+  size_t getAppBytesReceived() const override;
+  size_t getRawBytesReceived() const override;
+
+  void destroy() override;
+
+ protected:
+  ~AsyncIoUringSocket() override;
+
+ private:
+  friend class IoUringRing;
+
+  struct WriteRequest {
+    WriteCallback* callback;
+    std::unique_ptr<folly::IOBuf> buf;
+  };
+
+  /**
+   * Maximum number of buffers passed to a single sendmsg.
+   */
+  static constexpr size_t kMaxIovecs = 64;
+
+  /**
+   * Called by the ring.
+   */
+  void recvComplete(int res, uint32_t flags);
+  void prepareSend();
+  void sendComplete(int res);
+
+  void startRecv();
+  void deliverReads();
+  void scheduleWrite();
+  void completeWrites(size_t bytes);
+  void failWrites(const folly::AsyncSocketException& ex);
+  void fail(const folly::AsyncSocketException& ex);
+  void closeImpl(const folly::AsyncSocketException& ex);
+  void doShutdownWrite();
+  void sendTimeoutExpired() noexcept;
+
+  IoUringRing* ring_;
+  int fd_;
+
+  ReadCallback* readCallback_{nullptr};
+  // Data received but not yet taken by a read callback.
+  folly::IOBufQueue readBuf_{folly::IOBufQueue::cacheChainLength()};
+  // Buffer of the receive in flight, when not using a provided buffer.
+  std::unique_ptr<folly::IOBuf> recvBuf_;
+  bool recvInFlight_{false};
+  folly::Optional<folly::DelayedDestruction::DestructorGuard> recvGuard_;
+  // Set after a receive failed for lack of provided buffers.
+  bool useRecvBuf_{false};
+  bool readEOF_{false};
+  folly::Optional<folly::AsyncSocketException> readErr_;
+
+  std::deque<WriteRequest> writes_;
+  bool writeScheduled_{false};
+  bool sendInFlight_{false};
+  folly::Optional<folly::DelayedDestruction::DestructorGuard> sendGuard_;
+  std::vector<iovec> sendIov_;
+  msghdr sendMsg_;
+  // Buffers of failed writes the send in flight may still be reading.
+  std::vector<std::unique_ptr<folly::IOBuf>> orphanedBufs_;
+
+  bool closed_{false};
+  bool error_{false};
+  bool closePending_{false};
+  bool shutdownWritePending_{false};
+  bool writeShutdown_{false};
+
+  SendTimeout sendTimeout_;
+  uint32_t sendTimeoutMs_{0};
+
+  size_t bytesWritten_{0};
+  size_t bytesReceived_{0};
+};
+} // namespace fizz
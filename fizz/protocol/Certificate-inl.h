@@ -48,6 +48,11 @@ SelfCertImpl<T>::SelfCertImpl(
   certs_ = std::move(certs);
 }
 
+template <KeyType T>
+SelfCertImpl<T>::SelfCertImpl(folly::ssl::EvpPkeyUniquePtr pkey) {
+  signature_.setKey(std::move(pkey));
+}
+
 template <KeyType T>
 std::string SelfCertImpl<T>::getIdentity() const {
   return folly::ssl::OpenSSLCertUtils::getCommonName(*certs_.front())
@@ -141,6 +146,11 @@ PeerCertImpl<T>::PeerCertImpl(folly::ssl::X509UniquePtr cert) {
   cert_ = std::move(cert);
 }
 
+template <KeyType T>
+PeerCertImpl<T>::PeerCertImpl(folly::ssl::EvpPkeyUniquePtr key) {
+  signature_.setKey(std::move(key));
+}
+
 template <KeyType T>
 std::string PeerCertImpl<T>::getIdentity() const {
   return folly::ssl::OpenSSLCertUtils::getCommonName(*cert_).value_or("");
@@ -221,4 +231,64 @@ folly::ssl::X509UniquePtr SelfCertImpl<T>::getX509() const {
   X509_up_ref(certs_.front().get());
   return folly::ssl::X509UniquePtr(certs_.front().get());
 }
+
+template <KeyType T>
+SelfRawPublicKeyImpl<T>::SelfRawPublicKeyImpl(folly::ssl::EvpPkeyUniquePtr pkey)
+    : SelfRawPublicKeyImpl(
+          CertUtils::getSubjectPublicKeyInfo(pkey.get()),
+          std::move(pkey)) {}
+
+template <KeyType T>
+SelfRawPublicKeyImpl<T>::SelfRawPublicKeyImpl(
+    Buf spki,
+    folly::ssl::EvpPkeyUniquePtr&& pkey)
+    : SelfCertImpl<T>(std::move(pkey)), spki_(std::move(spki)) {}
+
+template <KeyType T>
+std::string SelfRawPublicKeyImpl<T>::getIdentity() const {
+  return CertUtils::getRawPublicKeyIdentity(*spki_);
+}
+
+template <KeyType T>
+std::vector<std::string> SelfRawPublicKeyImpl<T>::getAltIdentities() const {
+  return {};
+}
+
+template <KeyType T>
+CertificateMsg SelfRawPublicKeyImpl<T>::getCertMessage(
+    Buf certificateRequestContext) const {
+  CertificateEntry entry;
+  entry.cert_data = spki_->clone();
+  CertificateMsg msg;
+  msg.certificate_request_context = std::move(certificateRequestContext);
+  msg.certificate_list.push_back(std::move(entry));
+  return msg;
+}
+
+template <KeyType T>
+CertificateType SelfRawPublicKeyImpl<T>::getCertificateType() const {
+  return CertificateType::RawPublicKey;
+}
+
+template <KeyType T>
+folly::ssl::X509UniquePtr SelfRawPublicKeyImpl<T>::getX509() const {
+  return nullptr;
+}
+
+template <KeyType T>
+PeerRawPublicKeyImpl<T>::PeerRawPublicKeyImpl(
+    folly::ssl::EvpPkeyUniquePtr key,
+    Buf spki)
+    : PeerCertImpl<T>(std::move(key)),
+      identity_(CertUtils::getRawPublicKeyIdentity(*spki)) {}
+
+template <KeyType T>
+std::string PeerRawPublicKeyImpl<T>::getIdentity() const {
+  return identity_;
+}
+
+template <KeyType T>
+folly::ssl::X509UniquePtr PeerRawPublicKeyImpl<T>::getX509() const {
+  return nullptr;
+}
 } // namespace fizz
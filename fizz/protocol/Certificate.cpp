@@ -8,6 +8,9 @@
 
 #include <fizz/protocol/Certificate.h>
 
+#include <fizz/crypto/Sha256.h>
+#include <folly/String.h>
+
 namespace {
 int getCurveName(EVP_PKEY* key) {
   auto ecKey = EVP_PKEY_get0_EC_KEY(key);
@@ -170,6 +173,87 @@ std::unique_ptr<SelfCert> CertUtils::makeSelfCert(
   throw std::runtime_error("unknown self cert type");
 }
 
+Buf CertUtils::getSubjectPublicKeyInfo(EVP_PKEY* key) {
+  int len = i2d_PUBKEY(key, nullptr);
+  if (len < 0) {
+    throw std::runtime_error("Error computing public key length");
+  }
+  auto spki = folly::IOBuf::create(len);
+  auto dataPtr = spki->writableData();
+  len = i2d_PUBKEY(key, &dataPtr);
+  if (len < 0) {
+    throw std::runtime_error("Error converting public key to DER");
+  }
+  spki->append(len);
+  return spki;
+}
+
+std::string CertUtils::getRawPublicKeyIdentity(const folly::IOBuf& spki) {
+  std::array<uint8_t, Sha256::HashLen> digest;
+  Sha256::hash(spki, folly::range(digest));
+  return folly::hexlify(folly::range(digest));
+}
+
+std::unique_ptr<PeerCert> CertUtils::makePeerRawPublicKey(Buf spki) {
+  if (spki->empty()) {
+    throw std::runtime_error("empty peer raw public key");
+  }
+
+  auto range = spki->coalesce();
+  const unsigned char* begin = range.data();
+  folly::ssl::EvpPkeyUniquePtr pubKey(
+      d2i_PUBKEY(nullptr, &begin, range.size()));
+  if (!pubKey) {
+    throw std::runtime_error("could not read raw public key");
+  }
+  if (begin != range.data() + range.size()) {
+    throw std::runtime_error("trailing data after raw public key");
+  }
+
+  if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_RSA) {
+    return std::make_unique<PeerRawPublicKeyImpl<KeyType::RSA>>(
+        std::move(pubKey), std::move(spki));
+  } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_EC) {
+    switch (getCurveName(pubKey.get())) {
+      case NID_X9_62_prime256v1:
+        return std::make_unique<PeerRawPublicKeyImpl<KeyType::P256>>(
+            std::move(pubKey), std::move(spki));
+      case NID_secp384r1:
+        return std::make_unique<PeerRawPublicKeyImpl<KeyType::P384>>(
+            std::move(pubKey), std::move(spki));
+      case NID_secp521r1:
+        return std::make_unique<PeerRawPublicKeyImpl<KeyType::P521>>(
+            std::move(pubKey), std::move(spki));
+      default:
+        break;
+    }
+  }
+  throw std::runtime_error("unknown peer raw public key type");
+}
+
+std::unique_ptr<SelfCert> CertUtils::makeSelfRawPublicKey(
+    folly::ssl::EvpPkeyUniquePtr key) {
+  if (EVP_PKEY_id(key.get()) == EVP_PKEY_RSA) {
+    return std::make_unique<SelfRawPublicKeyImpl<KeyType::RSA>>(
+        std::move(key));
+  } else if (EVP_PKEY_id(key.get()) == EVP_PKEY_EC) {
+    switch (getCurveName(key.get())) {
+      case NID_X9_62_prime256v1:
+        return std::make_unique<SelfRawPublicKeyImpl<KeyType::P256>>(
+            std::move(key));
+      case NID_secp384r1:
+        return std::make_unique<SelfRawPublicKeyImpl<KeyType::P384>>(
+            std::move(key));
+      case NID_secp521r1:
+        return std::make_unique<SelfRawPublicKeyImpl<KeyType::P521>>(
+            std::move(key));
+      default:
+        break;
+    }
+  }
+  throw std::runtime_error("unknown self raw public key type");
+}
+
 IdentityCert::IdentityCert(std::string identity) : identity_(identity) {}
 
 std::string IdentityCert::getIdentity() const {
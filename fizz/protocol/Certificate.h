@@ -49,6 +49,13 @@ class SelfCert : public Cert {
   virtual CertificateMsg getCertMessage(
       Buf certificateRequestContext = nullptr) const = 0;
 
+  /**
+   * The certificate type (RFC 7250) of the entries in getCertMessage().
+   */
+  virtual CertificateType getCertificateType() const {
+    return CertificateType::X509;
+  }
+
   virtual Buf sign(
       SignatureScheme scheme,
       CertificateVerifyContext context,
@@ -103,6 +110,29 @@ class CertUtils {
   static std::unique_ptr<SelfCert> makeSelfCert(
       std::vector<folly::ssl::X509UniquePtr> certs,
       folly::ssl::EvpPkeyUniquePtr key);
+
+  /**
+   * Returns the DER encoded SubjectPublicKeyInfo of key.
+   */
+  static Buf getSubjectPublicKeyInfo(EVP_PKEY* key);
+
+  /**
+   * Identity of a raw public key: the hex encoded SHA-256 of its
+   * SubjectPublicKeyInfo, suitable for pinning.
+   */
+  static std::string getRawPublicKeyIdentity(const folly::IOBuf& spki);
+
+  /**
+   * Create a PeerCert from a DER encoded SubjectPublicKeyInfo received as a
+   * raw public key.
+   */
+  static std::unique_ptr<PeerCert> makePeerRawPublicKey(Buf spki);
+
+  /**
+   * Creates a SelfCert that is sent as a raw public key.
+   */
+  static std::unique_ptr<SelfCert> makeSelfRawPublicKey(
+      folly::ssl::EvpPkeyUniquePtr key);
 };
 
 template <KeyType T>
@@ -134,11 +164,45 @@ class SelfCertImpl : public SelfCert {
 
   folly::ssl::X509UniquePtr getX509() const override;
 
+ protected:
+  /**
+   * Only sets the private key, for subclasses without an X509 chain.
+   */
+  explicit SelfCertImpl(folly::ssl::EvpPkeyUniquePtr pkey);
+
  private:
   OpenSSLSignature<T> signature_;
   std::vector<folly::ssl::X509UniquePtr> certs_;
 };
 
+/**
+ * SelfCert that is only a key pair (RFC 7250). The certificate message
+ * carries the SubjectPublicKeyInfo instead of an X509 chain.
+ */
+template <KeyType T>
+class SelfRawPublicKeyImpl : public SelfCertImpl<T> {
+ public:
+  explicit SelfRawPublicKeyImpl(folly::ssl::EvpPkeyUniquePtr pkey);
+
+  ~SelfRawPublicKeyImpl() override = default;
+
+  std::string getIdentity() const override;
+
+  std::vector<std::string> getAltIdentities() const override;
+
+  CertificateMsg getCertMessage(
+      Buf certificateRequestContext = nullptr) const override;
+
+  CertificateType getCertificateType() const override;
+
+  folly::ssl::X509UniquePtr getX509() const override;
+
+ private:
+  SelfRawPublicKeyImpl(Buf spki, folly::ssl::EvpPkeyUniquePtr&& pkey);
+
+  Buf spki_;
+};
+
 template <KeyType T>
 class PeerCertImpl : public PeerCert {
  public:
@@ -156,11 +220,33 @@ class PeerCertImpl : public PeerCert {
 
   folly::ssl::X509UniquePtr getX509() const override;
 
+ protected:
+  explicit PeerCertImpl(folly::ssl::EvpPkeyUniquePtr key);
+
  private:
   OpenSSLSignature<T> signature_;
   folly::ssl::X509UniquePtr cert_;
 };
 
+/**
+ * PeerCert for a raw public key (RFC 7250) received instead of an X509
+ * chain. getX509() returns nullptr.
+ */
+template <KeyType T>
+class PeerRawPublicKeyImpl : public PeerCertImpl<T> {
+ public:
+  PeerRawPublicKeyImpl(folly::ssl::EvpPkeyUniquePtr key, Buf spki);
+
+  ~PeerRawPublicKeyImpl() override = default;
+
+  std::string getIdentity() const override;
+
+  folly::ssl::X509UniquePtr getX509() const override;
+
+ private:
+  std::string identity_;
+};
+
 } // namespace fizz
 
 #include <fizz/protocol/Certificate-inl.h>
@@ -127,5 +127,13 @@ class Factory {
   virtual std::shared_ptr<PeerCert> makePeerCert(Buf certData) const {
     return CertUtils::makePeerCert(std::move(certData));
   }
+
+  /**
+   * Makes a PeerCert from a DER encoded SubjectPublicKeyInfo, for peers
+   * authenticating with a raw public key (RFC 7250).
+   */
+  virtual std::shared_ptr<PeerCert> makePeerRawPublicKey(Buf spki) const {
+    return CertUtils::makePeerRawPublicKey(std::move(spki));
+  }
 };
 } // namespace fizz
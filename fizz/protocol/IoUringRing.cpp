@@ -0,0 +1,324 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/IoUringRing.h>
+
+#include <fizz/protocol/AsyncIoUringSocket.h>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace fizz {
+
+constexpr uint16_t IoUringRing::kBufferGroup;
+
+namespace {
+constexpr uint64_t kOpMask = 3;
+} // namespace
+
+/**
+ * The provided buffers and the ring through which they are handed to the
+ * kernel. Buffers taken by sockets may be released on any thread, and may
+ * outlive the IoUringRing, in which case this is destroyed along with the
+ * last of them.
+ */
+class IoUringRing::ProvidedBuffers {
+ public:
+  ProvidedBuffers(unsigned numBuffers, size_t bufferSize)
+      : numBuffers_(numBuffers), bufferSize_(bufferSize) {
+    auto ringSize = numBuffers * sizeof(io_uring_buf);
+    void* ring = nullptr;
+    if (posix_memalign(&ring, sysconf(_SC_PAGESIZE), ringSize) != 0) {
+      throw std::bad_alloc();
+    }
+    std::memset(ring, 0, ringSize);
+    ring_ = static_cast<io_uring_buf_ring*>(ring);
+    slab_ = static_cast<uint8_t*>(std::malloc(numBuffers * bufferSize));
+    if (!slab_) {
+      std::free(ring_);
+      throw std::bad_alloc();
+    }
+    for (unsigned i = 0; i < numBuffers; ++i) {
+      io_uring_buf_ring_add(
+          ring_, slab_ + i * bufferSize, bufferSize, i, numBuffers - 1, i);
+    }
+    io_uring_buf_ring_advance(ring_, numBuffers);
+    numFree_ = numBuffers;
+  }
+
+  ~ProvidedBuffers() {
+    std::free(slab_);
+    std::free(ring_);
+  }
+
+  io_uring_buf_ring* getRing() const {
+    return ring_;
+  }
+
+  std::unique_ptr<folly::IOBuf> take(uint16_t bufferId, size_t length) {
+    CHECK_LT(bufferId, numBuffers_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      numFree_--;
+      outstanding_++;
+    }
+    return folly::IOBuf::takeOwnership(
+        slab_ + bufferId * bufferSize_,
+        bufferSize_,
+        length,
+        &ProvidedBuffers::freeBuf,
+        this);
+  }
+
+  size_t numFree() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return numFree_;
+  }
+
+  /**
+   * Called once the kernel no longer uses the ring. Buffers released from
+   * now on are not handed back.
+   */
+  void retire() {
+    bool last;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      retired_ = true;
+      last = outstanding_ == 0;
+    }
+    if (last) {
+      delete this;
+    }
+  }
+
+ private:
+  static void freeBuf(void* buf, void* userData) {
+    static_cast<ProvidedBuffers*>(userData)->release(
+        static_cast<uint8_t*>(buf));
+  }
+
+  void release(uint8_t* buf) {
+    bool last = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      outstanding_--;
+      if (!retired_) {
+        auto bufferId = static_cast<uint16_t>((buf - slab_) / bufferSize_);
+        io_uring_buf_ring_add(
+            ring_, buf, bufferSize_, bufferId, numBuffers_ - 1, 0);
+        io_uring_buf_ring_advance(ring_, 1);
+        numFree_++;
+      } else {
+        last = outstanding_ == 0;
+      }
+    }
+    if (last) {
+      delete this;
+    }
+  }
+
+  mutable std::mutex mutex_;
+  io_uring_buf_ring* ring_{nullptr};
+  uint8_t* slab_{nullptr};
+  unsigned numBuffers_;
+  size_t bufferSize_;
+  size_t numFree_{0};
+  size_t outstanding_{0};
+  bool retired_{false};
+};
+
+IoUringRing::IoUringRing(folly::EventBase* evb)
+    : IoUringRing(evb, Options()) {}
+
+IoUringRing::IoUringRing(folly::EventBase* evb, Options options)
+    : evb_(evb), bufferSize_(options.bufferSize) {
+  int ret = io_uring_queue_init(options.queueDepth, &ring_, 0);
+  if (ret < 0) {
+    throw std::runtime_error(
+        std::string("io_uring_queue_init failed: ") + std::strerror(-ret));
+  }
+
+  eventFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  ret = eventFd_ < 0 ? -errno : io_uring_register_eventfd(&ring_, eventFd_);
+  if (ret < 0) {
+    if (eventFd_ >= 0) {
+      ::close(eventFd_);
+    }
+    io_uring_queue_exit(&ring_);
+    throw std::runtime_error(
+        std::string("io_uring eventfd setup failed: ") + std::strerror(-ret));
+  }
+  initHandler(evb_, eventFd_);
+
+  if (options.numBuffers > 0) {
+    CHECK_EQ(options.numBuffers & (options.numBuffers - 1), 0)
+        << "numBuffers must be a power of two";
+    auto buffers = new ProvidedBuffers(options.numBuffers, bufferSize_);
+    io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buffers->getRing());
+    reg.ring_entries = options.numBuffers;
+    reg.bgid = kBufferGroup;
+    ret = io_uring_register_buf_ring(&ring_, &reg, 0);
+    if (ret < 0) {
+      VLOG(1) << "provided buffer rings unavailable: " << std::strerror(-ret);
+      buffers->retire();
+    } else {
+      buffers_ = buffers;
+    }
+  }
+}
+
+IoUringRing::~IoUringRing() {
+  cancelLoopCallback();
+  // Sockets are closed by now, but their cancelled requests may not have
+  // completed yet. Wait for them so the sockets release their guards.
+  io_uring_submit(&ring_);
+  while (inflight_ > 0) {
+    io_uring_cqe* cqe = nullptr;
+    if (io_uring_wait_cqe(&ring_, &cqe) < 0) {
+      break;
+    }
+    reapCompletions();
+  }
+  if (handlerRegistered_) {
+    unregisterHandler();
+  }
+  if (buffers_) {
+    io_uring_unregister_buf_ring(&ring_, kBufferGroup);
+    buffers_->retire();
+  }
+  io_uring_unregister_eventfd(&ring_);
+  io_uring_queue_exit(&ring_);
+  ::close(eventFd_);
+}
+
+size_t IoUringRing::numFreeBuffers() const {
+  return buffers_ ? buffers_->numFree() : 0;
+}
+
+io_uring_sqe* IoUringRing::getSqe() {
+  auto sqe = io_uring_get_sqe(&ring_);
+  if (!sqe) {
+    // The submission queue is full, make room without waiting for the end of
+    // the loop iteration.
+    submit();
+    sqe = io_uring_get_sqe(&ring_);
+    if (!sqe) {
+      throw std::runtime_error("io_uring submission queue full");
+    }
+  }
+  return sqe;
+}
+
+void IoUringRing::prepare(
+    io_uring_sqe* sqe,
+    AsyncIoUringSocket* socket,
+    Op op) {
+  io_uring_sqe_set_data64(
+      sqe, reinterpret_cast<uint64_t>(socket) | static_cast<uint64_t>(op));
+  inflight_++;
+  // Like AsyncSocket, only keep the loop running while there is something to
+  // wait for.
+  if (!handlerRegistered_) {
+    registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+    handlerRegistered_ = true;
+  }
+  scheduleSubmit();
+}
+
+void IoUringRing::cancel(AsyncIoUringSocket* socket, Op op) {
+  auto sqe = getSqe();
+  io_uring_prep_cancel64(
+      sqe, reinterpret_cast<uint64_t>(socket) | static_cast<uint64_t>(op), 0);
+  // The completion of the cancellation itself is ignored.
+  io_uring_sqe_set_data64(sqe, 0);
+  inflight_++;
+  scheduleSubmit();
+}
+
+std::unique_ptr<folly::IOBuf> IoUringRing::takeBuffer(
+    uint16_t bufferId,
+    size_t length) {
+  CHECK(buffers_);
+  return buffers_->take(bufferId, length);
+}
+
+void IoUringRing::scheduleWrite(AsyncIoUringSocket* socket) {
+  pendingWrites_.emplace_back(socket, socket);
+  scheduleSubmit();
+}
+
+void IoUringRing::scheduleSubmit() {
+  if (!isLoopCallbackScheduled()) {
+    evb_->runInLoop(this);
+  }
+}
+
+void IoUringRing::submit() {
+  int ret = io_uring_submit(&ring_);
+  if (ret == -EBUSY || ret == -EAGAIN) {
+    // The completion queue overflowed, try again once it has been reaped.
+    reapCompletions();
+    scheduleSubmit();
+  } else if (ret < 0) {
+    LOG(ERROR) << "io_uring_submit failed: " << std::strerror(-ret);
+  }
+}
+
+void IoUringRing::runLoopCallback() noexcept {
+  auto writes = std::move(pendingWrites_);
+  pendingWrites_.clear();
+  for (auto& write : writes) {
+    write.first->prepareSend();
+  }
+  if (io_uring_sq_ready(&ring_) > 0) {
+    submit();
+  }
+}
+
+void IoUringRing::handlerReady(uint16_t /* events */) noexcept {
+  uint64_t count;
+  while (::read(eventFd_, &count, sizeof(count)) > 0) {
+  }
+  reapCompletions();
+}
+
+void IoUringRing::reapCompletions() {
+  io_uring_cqe* cqe = nullptr;
+  while (io_uring_peek_cqe(&ring_, &cqe) == 0 && cqe) {
+    auto data = io_uring_cqe_get_data64(cqe);
+    auto res = cqe->res;
+    auto flags = cqe->flags;
+    io_uring_cqe_seen(&ring_, cqe);
+    inflight_--;
+
+    auto socket = reinterpret_cast<AsyncIoUringSocket*>(data & ~kOpMask);
+    switch (static_cast<Op>(data & kOpMask)) {
+      case Op::Recv:
+        socket->recvComplete(res, flags);
+        break;
+      case Op::Send:
+        socket->sendComplete(res);
+        break;
+      default:
+        // Cancellation.
+        break;
+    }
+  }
+  if (inflight_ == 0 && handlerRegistered_) {
+    unregisterHandler();
+    handlerRegistered_ = false;
+  }
+}
+} // namespace fizz
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/ReadBufferPool.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/DelayedDestruction.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/EventHandler.h>
+
+#include <liburing.h>
+
+#include <vector>
+
+namespace fizz {
+
+class AsyncIoUringSocket;
+
+/**
+ * An io_uring instance shared by the AsyncIoUringSockets of one EventBase.
+ *
+ * Receives are served from a ring of buffers provided to the kernel up front,
+ * so a connection only holds a read buffer once data has arrived for it.
+ * Requests queued by all sockets during an iteration of the EventBase loop,
+ * including their pending writes, are submitted together with one system call
+ * at the end of the iteration. Completions are reaped when the ring's eventfd
+ * becomes readable.
+ *
+ * Kernels without provided buffer rings (before 5.19) are supported by
+ * receiving into buffers from ReadBufferPool instead.
+ *
+ * Must be used on the thread of its EventBase, and must outlive its sockets.
+ */
+class IoUringRing : private folly::EventHandler,
+                    private folly::EventBase::LoopCallback {
+ public:
+  struct Options {
+    // Size of the submission queue. The completion queue is twice as large.
+    unsigned queueDepth{256};
+
+    // Number of provided receive buffers, a power of two. Zero disables
+    // provided buffers.
+    unsigned numBuffers{256};
+
+    size_t bufferSize{ReadBufferPool::kMaxBufferSize};
+  };
+
+  explicit IoUringRing(folly::EventBase* evb);
+  IoUringRing(folly::EventBase* evb, Options options);
+
+  ~IoUringRing() override;
+
+  folly::EventBase* getEventBase() const {
+    return evb_;
+  }
+
+  /**
+   * Whether receives are served from provided buffers.
+   */
+  bool hasProvidedBuffers() const {
+    return buffers_ != nullptr;
+  }
+
+  /**
+   * Number of provided buffers currently available to the kernel.
+   */
+  size_t numFreeBuffers() const;
+
+ private:
+  friend class AsyncIoUringSocket;
+
+  class ProvidedBuffers;
+
+  enum class Op : uint64_t {
+    Recv = 1,
+    Send = 2,
+  };
+
+  static constexpr uint16_t kBufferGroup = 0;
+
+  size_t getBufferSize() const {
+    return bufferSize_;
+  }
+
+  /**
+   * Returns a submission queue entry, which must be passed to prepare() once
+   * filled in. It is submitted at the end of the current loop iteration.
+   */
+  io_uring_sqe* getSqe();
+  void prepare(io_uring_sqe* sqe, AsyncIoUringSocket* socket, Op op);
+
+  /**
+   * Cancels the socket's request of the given type, if any.
+   */
+  void cancel(AsyncIoUringSocket* socket, Op op);
+
+  /**
+   * Wraps the provided buffer the kernel filled with length bytes. The buffer
+   * is handed back to the kernel once released.
+   */
+  std::unique_ptr<folly::IOBuf> takeBuffer(uint16_t bufferId, size_t length);
+
+  /**
+   * Has prepareSend() called on the socket before the next submission, so
+   * that the writes of all sockets in this loop iteration go out together.
+   */
+  void scheduleWrite(AsyncIoUringSocket* socket);
+
+  void scheduleSubmit();
+  void submit();
+  void reapCompletions();
+
+  /**
+   * EventHandler implementation, for the eventfd signalled on completions.
+   */
+  void handlerReady(uint16_t events) noexcept override;
+
+  /**
+   * LoopCallback implementation, submitting queued requests.
+   */
+  void runLoopCallback() noexcept override;
+
+  folly::EventBase* evb_;
+  io_uring ring_;
+  int eventFd_{-1};
+  bool handlerRegistered_{false};
+
+  // Requests submitted or queued whose completion hasn't been reaped yet.
+  size_t inflight_{0};
+
+  ProvidedBuffers* buffers_{nullptr};
+  size_t bufferSize_;
+
+  std::vector<std::pair<
+      AsyncIoUringSocket*,
+      folly::DelayedDestruction::DestructorGuard>>
+      pendingWrites_;
+};
+} // namespace fizz
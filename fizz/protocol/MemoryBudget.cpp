@@ -0,0 +1,29 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/MemoryBudget.h>
+
+namespace fizz {
+
+size_t MemoryBudget::getConnectionLimit(size_t defaultLimit, size_t minLimit)
+    const {
+  auto usage = getUsage();
+  auto half = limit_ / 2;
+  if (usage <= half || defaultLimit <= minLimit) {
+    return defaultLimit;
+  }
+  if (usage >= limit_) {
+    return minLimit;
+  }
+  // Scale in floating point to avoid overflowing on large budgets.
+  double fractionLeft =
+      static_cast<double>(limit_ - usage) / static_cast<double>(limit_ - half);
+  return minLimit +
+      static_cast<size_t>(fractionLeft * (defaultLimit - minLimit));
+}
+} // namespace fizz
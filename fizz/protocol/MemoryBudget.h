@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace fizz {
+
+/**
+ * Accounts for the memory buffered by a set of connections (usually all of
+ * them in the process) against a shared limit: data read from the transport
+ * but not yet processed, handshake messages not yet fully received, and app
+ * data not yet taken by the application.
+ *
+ * As usage grows past half of the limit, connections buffer less before
+ * pausing reads, and once over the limit servers refuse new handshakes. The
+ * limit is soft: it is not enforced on individual allocations.
+ *
+ * Thread safe.
+ */
+class MemoryBudget {
+ public:
+  explicit MemoryBudget(size_t limit) : limit_(limit) {}
+
+  void charge(size_t bytes) {
+    usage_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  void release(size_t bytes) {
+    usage_.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  size_t getUsage() const {
+    return usage_.load(std::memory_order_relaxed);
+  }
+
+  size_t getLimit() const {
+    return limit_;
+  }
+
+  bool overBudget() const {
+    return getUsage() >= limit_;
+  }
+
+  /**
+   * Returns how much a connection may buffer before pausing reads, given what
+   * it may buffer when memory is plentiful. This is defaultLimit until half of
+   * the budget is used, then shrinks linearly down to minLimit when the
+   * budget is exhausted.
+   */
+  size_t getConnectionLimit(size_t defaultLimit, size_t minLimit) const;
+
+ private:
+  const size_t limit_;
+  std::atomic<size_t> usage_{0};
+};
+} // namespace fizz
@@ -40,6 +40,9 @@ struct Connect : EventType<Event::Connect> {
   std::shared_ptr<const CertificateVerifier> verifier;
   folly::Optional<std::string> sni;
   folly::Optional<client::CachedPsk> cachedPsk;
+  // Used instead of cachedPsk when set, so that a PSK shared with the cache
+  // doesn't have to be copied.
+  std::shared_ptr<const client::CachedPsk> sharedPsk;
   std::shared_ptr<ClientExtensions> extensions;
 };
 
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/ReadBufferPool.h>
+
+#include <cstdlib>
+#include <vector>
+
+namespace fizz {
+
+constexpr size_t ReadBufferPool::kMaxBufferSize;
+constexpr std::array<size_t, 3> ReadBufferPool::kSizeClasses;
+constexpr size_t ReadBufferPool::kMaxCachedPerClass;
+
+namespace {
+struct FreeLists {
+  ~FreeLists();
+
+  std::array<std::vector<void*>, ReadBufferPool::kSizeClasses.size()> lists;
+};
+
+// Buffers may be released during thread exit after the free lists of that
+// thread are gone, in which case they are simply freed.
+thread_local bool freeListsDestroyed = false;
+
+FreeLists::~FreeLists() {
+  freeListsDestroyed = true;
+  for (auto& list : lists) {
+    for (auto buf : list) {
+      std::free(buf);
+    }
+  }
+}
+
+FreeLists* getFreeLists() {
+  if (freeListsDestroyed) {
+    return nullptr;
+  }
+  static thread_local FreeLists freeLists;
+  return &freeLists;
+}
+} // namespace
+
+std::unique_ptr<folly::IOBuf> ReadBufferPool::allocate(size_t minCapacity) {
+  size_t sizeClass = 0;
+  while (sizeClass < kSizeClasses.size() &&
+         kSizeClasses[sizeClass] < minCapacity) {
+    sizeClass++;
+  }
+  if (sizeClass == kSizeClasses.size()) {
+    return folly::IOBuf::create(minCapacity);
+  }
+
+  void* buf = nullptr;
+  auto freeLists = getFreeLists();
+  if (freeLists && !freeLists->lists[sizeClass].empty()) {
+    buf = freeLists->lists[sizeClass].back();
+    freeLists->lists[sizeClass].pop_back();
+  } else {
+    buf = std::malloc(kSizeClasses[sizeClass]);
+    if (!buf) {
+      throw std::bad_alloc();
+    }
+  }
+  // takeOwnership calls freeBuf (and so returns buf to the pool) if it throws.
+  return folly::IOBuf::takeOwnership(
+      buf,
+      kSizeClasses[sizeClass],
+      0,
+      &ReadBufferPool::freeBuf,
+      reinterpret_cast<void*>(sizeClass));
+}
+
+size_t ReadBufferPool::numCached(size_t sizeClass) {
+  auto freeLists = getFreeLists();
+  return freeLists ? freeLists->lists.at(sizeClass).size() : 0;
+}
+
+void ReadBufferPool::freeBuf(void* buf, void* userData) {
+  auto sizeClass = reinterpret_cast<size_t>(userData);
+  auto freeLists = getFreeLists();
+  if (freeLists && freeLists->lists[sizeClass].size() < kMaxCachedPerClass) {
+    freeLists->lists[sizeClass].push_back(buf);
+  } else {
+    std::free(buf);
+  }
+}
+} // namespace fizz
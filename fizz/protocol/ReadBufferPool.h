@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/io/IOBuf.h>
+
+#include <array>
+
+namespace fizz {
+
+/**
+ * Per-thread cache of transport read buffers in a few fixed size classes, the
+ * largest of which holds a full size TLS record.
+ *
+ * Released buffers go back to the cache of the thread releasing them (up to a
+ * small limit per size class), so connections on the same thread reuse each
+ * other's buffers rather than going back to malloc for every read.
+ */
+class ReadBufferPool {
+ public:
+  /**
+   * Large enough for the biggest record a peer may send (header, 16k of
+   * plaintext and up to 256 bytes of expansion), rounded up.
+   */
+  static constexpr size_t kMaxBufferSize = 17 * 1024;
+
+  static constexpr std::array<size_t, 3> kSizeClasses{
+      {4 * 1024, 8 * 1024, kMaxBufferSize}};
+
+  /**
+   * Number of free buffers of each size class kept per thread.
+   */
+  static constexpr size_t kMaxCachedPerClass = 32;
+
+  /**
+   * Returns an empty buffer with at least minCapacity bytes of tailroom.
+   * Requests larger than kMaxBufferSize are not pooled.
+   */
+  static std::unique_ptr<folly::IOBuf> allocate(size_t minCapacity);
+
+  /**
+   * Number of free buffers of the given size class cached on this thread.
+   */
+  static size_t numCached(size_t sizeClass);
+
+ private:
+  static void freeBuf(void* buf, void* userData);
+};
+} // namespace fizz
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/protocol/AsyncCertificateVerifier.h>
+#include <fizz/protocol/test/Mocks.h>
+#include <folly/executors/ManualExecutor.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace test {
+
+class ExecutorCertificateVerifierTest : public Test {
+ public:
+  void SetUp() override {
+    verifier_ = std::make_shared<MockCertificateVerifier>();
+    executor_ = std::make_shared<ManualExecutor>();
+    asyncVerifier_ =
+        std::make_shared<ExecutorCertificateVerifier>(verifier_, executor_);
+    certs_.push_back(std::make_shared<MockPeerCert>());
+  }
+
+ protected:
+  std::shared_ptr<MockCertificateVerifier> verifier_;
+  std::shared_ptr<ManualExecutor> executor_;
+  std::shared_ptr<ExecutorCertificateVerifier> asyncVerifier_;
+  std::vector<std::shared_ptr<const PeerCert>> certs_;
+};
+
+TEST_F(ExecutorCertificateVerifierTest, TestVerifyOnExecutor) {
+  auto future = asyncVerifier_->verifyFuture(certs_);
+  EXPECT_FALSE(future.isReady());
+
+  EXPECT_CALL(*verifier_, verify(_))
+      .WillOnce(Invoke(
+          [this](const std::vector<std::shared_ptr<const PeerCert>>& certs) {
+            EXPECT_EQ(certs, certs_);
+          }));
+  executor_->run();
+  EXPECT_TRUE(future.isReady());
+  EXPECT_FALSE(future.hasException());
+}
+
+TEST_F(ExecutorCertificateVerifierTest, TestVerifyFailure) {
+  auto future = asyncVerifier_->verifyFuture(certs_);
+  EXPECT_CALL(*verifier_, verify(_))
+      .WillOnce(Throw(std::runtime_error("untrusted")));
+  executor_->run();
+  EXPECT_TRUE(future.isReady());
+  EXPECT_THROW(std::move(future).get(), std::runtime_error);
+}
+
+TEST_F(ExecutorCertificateVerifierTest, TestVerifyOutlivesVerifier) {
+  auto future = asyncVerifier_->verifyFuture(certs_);
+  asyncVerifier_.reset();
+  EXPECT_CALL(*verifier_, verify(_));
+  executor_->run();
+  EXPECT_TRUE(future.isReady());
+}
+
+TEST_F(ExecutorCertificateVerifierTest, TestSyncVerifyInline) {
+  EXPECT_CALL(*verifier_, verify(_));
+  asyncVerifier_->verify(certs_);
+  EXPECT_EQ(executor_->run(), 0);
+}
+
+TEST_F(ExecutorCertificateVerifierTest, TestCertificateRequestExtensions) {
+  EXPECT_CALL(*verifier_, getCertificateRequestExtensions())
+      .WillOnce(Return(std::vector<Extension>()));
+  EXPECT_TRUE(asyncVerifier_->getCertificateRequestExtensions().empty());
+}
+} // namespace test
+} // namespace fizz
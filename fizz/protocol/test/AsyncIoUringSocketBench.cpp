@@ -0,0 +1,264 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/ssl/Init.h>
+
+#include <fizz/client/AsyncFizzClient.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/protocol/AsyncIoUringSocket.h>
+#include <fizz/server/AsyncFizzServer.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+
+using namespace fizz;
+using namespace fizz::test;
+
+/**
+ * Compares Fizz connections over AsyncIoUringSocket with the same connections
+ * over AsyncSocket, both ends of a loopback TCP connection running on one
+ * EventBase. Each handshake iteration is a full handshake on a new
+ * connection; each bulk iteration is a 16KB write from client to server.
+ */
+namespace {
+constexpr size_t kWriteSize = 16 * 1024;
+
+std::shared_ptr<server::FizzServerContext> makeServerContext() {
+  auto context = std::make_shared<server::FizzServerContext>();
+  auto certManager = std::make_unique<server::CertManager>();
+  std::vector<folly::ssl::X509UniquePtr> certs;
+  certs.emplace_back(getCert(kP256Certificate));
+  certManager->addCert(
+      std::make_shared<SelfCertImpl<KeyType::P256>>(
+          getPrivateKey(kP256Key), std::move(certs)),
+      true);
+  context->setCertManager(std::move(certManager));
+  return context;
+}
+
+void checkErrno(int ret, const char* what) {
+  if (ret < 0) {
+    throw std::runtime_error(
+        std::string(what) + " failed: " + std::strerror(errno));
+  }
+}
+
+/**
+ * Returns the two ends of a loopback TCP connection.
+ */
+std::pair<int, int> makeConnection() {
+  int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  checkErrno(listener, "socket");
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addrLen = sizeof(addr);
+  checkErrno(
+      ::bind(listener, reinterpret_cast<sockaddr*>(&addr), addrLen), "bind");
+  checkErrno(::listen(listener, 1), "listen");
+  checkErrno(
+      ::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen),
+      "getsockname");
+
+  int client = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  checkErrno(client, "socket");
+  checkErrno(
+      ::connect(client, reinterpret_cast<sockaddr*>(&addr), addrLen),
+      "connect");
+  int server = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+  checkErrno(server, "accept");
+  ::close(listener);
+
+  int one = 1;
+  ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  ::setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return std::make_pair(server, client);
+}
+
+folly::AsyncTransportWrapper::UniquePtr
+makeTransport(folly::EventBase* evb, IoUringRing* ring, int fd) {
+  if (ring) {
+    return folly::AsyncTransportWrapper::UniquePtr(
+        new AsyncIoUringSocket(ring, fd));
+  }
+  return folly::AsyncTransportWrapper::UniquePtr(
+      new folly::AsyncSocket(evb, fd));
+}
+
+class HandshakeCallbacks : public server::AsyncFizzServer::HandshakeCallback,
+                           public client::AsyncFizzClient::HandshakeCallback {
+ public:
+  void fizzHandshakeSuccess(server::AsyncFizzServer*) noexcept override {
+    serverDone = true;
+  }
+
+  void fizzHandshakeError(
+      server::AsyncFizzServer*,
+      folly::exception_wrapper ex) noexcept override {
+    LOG(FATAL) << "server handshake failed: " << ex.what();
+  }
+
+  void fizzHandshakeAttemptFallback(std::unique_ptr<folly::IOBuf>) override {
+    LOG(FATAL) << "unexpected fallback";
+  }
+
+  void fizzHandshakeSuccess(client::AsyncFizzClient*) noexcept override {
+    clientDone = true;
+  }
+
+  void fizzHandshakeError(
+      client::AsyncFizzClient*,
+      folly::exception_wrapper ex) noexcept override {
+    LOG(FATAL) << "client handshake failed: " << ex.what();
+  }
+
+  bool serverDone{false};
+  bool clientDone{false};
+};
+
+class CountingReadCallback : public folly::AsyncTransportWrapper::ReadCallback {
+ public:
+  void getReadBuffer(void**, size_t*) override {
+    LOG(FATAL) << "buffers are movable";
+  }
+
+  void readDataAvailable(size_t) noexcept override {
+    LOG(FATAL) << "buffers are movable";
+  }
+
+  bool isBufferMovable() noexcept override {
+    return true;
+  }
+
+  void readBufferAvailable(
+      std::unique_ptr<folly::IOBuf> buf) noexcept override {
+    received += buf->computeChainDataLength();
+  }
+
+  void readEOF() noexcept override {}
+
+  void readErr(const folly::AsyncSocketException&) noexcept override {}
+
+  size_t received{0};
+};
+
+struct Connection {
+  std::unique_ptr<HandshakeCallbacks> callbacks;
+  server::AsyncFizzServer::UniquePtr server;
+  client::AsyncFizzClient::UniquePtr client;
+};
+
+Connection establish(
+    folly::EventBase& evb,
+    IoUringRing* ring,
+    const std::shared_ptr<server::FizzServerContext>& serverContext,
+    const std::shared_ptr<client::FizzClientContext>& clientContext) {
+  Connection conn;
+  auto fds = makeConnection();
+  conn.server.reset(new server::AsyncFizzServer(
+      makeTransport(&evb, ring, fds.first), serverContext));
+  conn.client.reset(new client::AsyncFizzClient(
+      makeTransport(&evb, ring, fds.second), clientContext));
+
+  conn.callbacks = std::make_unique<HandshakeCallbacks>();
+  conn.server->accept(conn.callbacks.get());
+  conn.client->connect(
+      conn.callbacks.get(), nullptr, folly::none, folly::none);
+  while (!conn.callbacks->serverDone || !conn.callbacks->clientDone) {
+    evb.loopOnce();
+  }
+  return conn;
+}
+
+void handshakes(uint32_t n, bool ioUring) {
+  folly::EventBase evb;
+  std::unique_ptr<IoUringRing> ring;
+  std::shared_ptr<server::FizzServerContext> serverContext;
+  std::shared_ptr<client::FizzClientContext> clientContext;
+  BENCHMARK_SUSPEND {
+    if (ioUring) {
+      ring = std::make_unique<IoUringRing>(&evb);
+    }
+    serverContext = makeServerContext();
+    clientContext = std::make_shared<client::FizzClientContext>();
+  }
+
+  for (uint32_t i = 0; i < n; ++i) {
+    auto conn = establish(evb, ring.get(), serverContext, clientContext);
+    BENCHMARK_SUSPEND {
+      conn.client.reset();
+      conn.server.reset();
+      evb.loop();
+    }
+  }
+}
+
+void bulk(uint32_t n, bool ioUring) {
+  folly::EventBase evb;
+  std::unique_ptr<IoUringRing> ring;
+  Connection conn;
+  CountingReadCallback serverRead;
+  std::vector<std::unique_ptr<folly::IOBuf>> writes;
+  BENCHMARK_SUSPEND {
+    if (ioUring) {
+      ring = std::make_unique<IoUringRing>(&evb);
+    }
+    conn = establish(
+        evb,
+        ring.get(),
+        makeServerContext(),
+        std::make_shared<client::FizzClientContext>());
+    conn.server->setReadCB(&serverRead);
+    for (uint32_t i = 0; i < n; ++i) {
+      auto buf = folly::IOBuf::create(kWriteSize);
+      std::memset(buf->writableData(), 'a', kWriteSize);
+      buf->append(kWriteSize);
+      writes.push_back(std::move(buf));
+    }
+  }
+
+  for (auto& buf : writes) {
+    conn.client->writeChain(nullptr, std::move(buf));
+    // Let the server keep up, as a real peer would.
+    evb.loopOnce(EVLOOP_NONBLOCK);
+  }
+  while (serverRead.received < n * kWriteSize) {
+    evb.loopOnce();
+  }
+
+  BENCHMARK_SUSPEND {
+    conn.server->setReadCB(nullptr);
+    conn.client.reset();
+    conn.server.reset();
+    evb.loop();
+  }
+}
+} // namespace
+
+BENCHMARK_NAMED_PARAM(handshakes, asyncSocket, false);
+BENCHMARK_RELATIVE_NAMED_PARAM(handshakes, ioUring, true);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(bulk, asyncSocket, false);
+BENCHMARK_RELATIVE_NAMED_PARAM(bulk, ioUring, true);
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::ssl::init();
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,275 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/client/AsyncFizzClient.h>
+#include <fizz/client/test/Mocks.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/protocol/AsyncIoUringSocket.h>
+#include <fizz/protocol/test/Matchers.h>
+#include <fizz/server/AsyncFizzServer.h>
+#include <fizz/server/test/Mocks.h>
+
+#include <folly/io/async/test/MockAsyncTransport.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fizz {
+namespace test {
+
+using namespace folly;
+using namespace folly::test;
+using namespace testing;
+
+class AsyncIoUringSocketTest : public Test {
+ public:
+  void SetUp() override {
+    IoUringRing::Options options;
+    options.numBuffers = 4;
+    ring_ = std::make_unique<IoUringRing>(&evb_, options);
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+    socket_.reset(new AsyncIoUringSocket(ring_.get(), fds[0]));
+    peerFd_ = fds[1];
+
+    ON_CALL(readCallback_, isBufferMovable_()).WillByDefault(Return(true));
+  }
+
+  void TearDown() override {
+    socket_.reset();
+    if (peerFd_ >= 0) {
+      ::close(peerFd_);
+    }
+    ring_.reset();
+  }
+
+ protected:
+  void peerWrite(const std::string& data) {
+    ASSERT_EQ(
+        ::write(peerFd_, data.data(), data.size()),
+        static_cast<ssize_t>(data.size()));
+  }
+
+  std::string peerRead(size_t len) {
+    std::string data(len, '\0');
+    size_t read = 0;
+    while (read < len) {
+      auto ret = ::read(peerFd_, &data[read], len - read);
+      EXPECT_GT(ret, 0);
+      if (ret <= 0) {
+        break;
+      }
+      read += ret;
+    }
+    return data;
+  }
+
+  void loopUntil(const bool& done) {
+    while (!done) {
+      evb_.loopOnce();
+    }
+  }
+
+  EventBase evb_;
+  std::unique_ptr<IoUringRing> ring_;
+  AsyncIoUringSocket::UniquePtr socket_;
+  int peerFd_{-1};
+  MockReadCallback readCallback_;
+};
+
+TEST_F(AsyncIoUringSocketTest, TestReadProvidedBuffer) {
+  if (!ring_->hasProvidedBuffers()) {
+    return;
+  }
+  bool done = false;
+  EXPECT_CALL(readCallback_, readBufferAvailable_(BufMatches("hello")))
+      .WillOnce(Invoke([&](std::unique_ptr<IOBuf>& buf) {
+        // The buffer was provided to the kernel by the ring.
+        EXPECT_EQ(buf->capacity(), ReadBufferPool::kMaxBufferSize);
+        EXPECT_EQ(ring_->numFreeBuffers(), 3);
+        done = true;
+      }));
+  socket_->setReadCB(&readCallback_);
+  peerWrite("hello");
+  loopUntil(done);
+
+  // Released once the callback is done with it.
+  EXPECT_EQ(ring_->numFreeBuffers(), 4);
+  EXPECT_EQ(socket_->getAppBytesReceived(), 5);
+}
+
+TEST_F(AsyncIoUringSocketTest, TestReadBufferHeldByCallback) {
+  if (!ring_->hasProvidedBuffers()) {
+    return;
+  }
+  std::unique_ptr<IOBuf> held;
+  bool done = false;
+  EXPECT_CALL(readCallback_, readBufferAvailable_(BufMatches("hello")))
+      .WillOnce(Invoke([&](std::unique_ptr<IOBuf>& buf) {
+        held = std::move(buf);
+        done = true;
+      }));
+  socket_->setReadCB(&readCallback_);
+  peerWrite("hello");
+  loopUntil(done);
+
+  // Stays out of the ring until released.
+  EXPECT_EQ(ring_->numFreeBuffers(), 3);
+  held.reset();
+  EXPECT_EQ(ring_->numFreeBuffers(), 4);
+}
+
+TEST_F(AsyncIoUringSocketTest, TestReadNotMovable) {
+  std::array<char, 3> buf;
+  std::string received;
+  ON_CALL(readCallback_, isBufferMovable_()).WillByDefault(Return(false));
+  EXPECT_CALL(readCallback_, getReadBuffer(_, _))
+      .WillRepeatedly(Invoke([&](void** bufReturn, size_t* lenReturn) {
+        *bufReturn = buf.data();
+        *lenReturn = buf.size();
+      }));
+  EXPECT_CALL(readCallback_, readDataAvailable_(_))
+      .WillRepeatedly(
+          Invoke([&](size_t len) { received.append(buf.data(), len); }));
+  socket_->setReadCB(&readCallback_);
+  peerWrite("hello");
+  while (received.size() < 5) {
+    evb_.loopOnce();
+  }
+  EXPECT_EQ(received, "hello");
+}
+
+TEST_F(AsyncIoUringSocketTest, TestReadBufferedWithoutCallback) {
+  socket_->setReadCB(&readCallback_);
+  // Submit the receive, then stop reading while it is in flight.
+  evb_.loopOnce(EVLOOP_NONBLOCK);
+  socket_->setReadCB(nullptr);
+  peerWrite("hello");
+  evb_.loop();
+
+  EXPECT_CALL(readCallback_, readBufferAvailable_(BufMatches("hello")));
+  socket_->setReadCB(&readCallback_);
+}
+
+TEST_F(AsyncIoUringSocketTest, TestReadEOF) {
+  bool done = false;
+  EXPECT_CALL(readCallback_, readEOF_()).WillOnce(Invoke([&]() {
+    done = true;
+  }));
+  socket_->setReadCB(&readCallback_);
+  ::close(peerFd_);
+  peerFd_ = -1;
+  loopUntil(done);
+  EXPECT_EQ(socket_->getReadCallback(), nullptr);
+}
+
+TEST_F(AsyncIoUringSocketTest, TestWritesBatched) {
+  MockWriteCallback writeCallback1;
+  MockWriteCallback writeCallback2;
+  Sequence s;
+  EXPECT_CALL(writeCallback1, writeSuccess_()).InSequence(s);
+  EXPECT_CALL(writeCallback2, writeSuccess_()).InSequence(s);
+
+  auto chain = IOBuf::copyBuffer("lo ");
+  chain->prependChain(IOBuf::copyBuffer("wor"));
+  socket_->writeChain(&writeCallback1, IOBuf::copyBuffer("hel"));
+  socket_->writeChain(&writeCallback2, std::move(chain));
+  socket_->writeChain(nullptr, IOBuf::copyBuffer("ld"));
+  // Nothing is sent until the end of the loop iteration.
+  EXPECT_EQ(socket_->getAppBytesWritten(), 0);
+
+  evb_.loop();
+  EXPECT_EQ(socket_->getAppBytesWritten(), 11);
+  EXPECT_EQ(peerRead(11), "hello world");
+}
+
+TEST_F(AsyncIoUringSocketTest, TestCloseFlushesWrites) {
+  MockWriteCallback writeCallback;
+  EXPECT_CALL(writeCallback, writeSuccess_());
+  socket_->writeChain(&writeCallback, IOBuf::copyBuffer("bye"));
+  socket_->close();
+  EXPECT_TRUE(socket_->good());
+  evb_.loop();
+  EXPECT_FALSE(socket_->good());
+  EXPECT_EQ(peerRead(3), "bye");
+
+  char c;
+  EXPECT_EQ(::read(peerFd_, &c, 1), 0);
+}
+
+TEST_F(AsyncIoUringSocketTest, TestCloseNowFailsWrites) {
+  MockWriteCallback writeCallback;
+  EXPECT_CALL(writeCallback, writeErr_(0, _));
+  socket_->setReadCB(&readCallback_);
+  socket_->writeChain(&writeCallback, IOBuf::copyBuffer("bye"));
+  EXPECT_CALL(readCallback_, readEOF_());
+  socket_->closeNow();
+  EXPECT_FALSE(socket_->good());
+  EXPECT_EQ(socket_->getReadCallback(), nullptr);
+  // The cancelled receive still completes.
+  evb_.loop();
+}
+
+TEST_F(AsyncIoUringSocketTest, TestFizzHandshake) {
+  auto serverContext = std::make_shared<server::FizzServerContext>();
+  auto certManager = std::make_unique<server::CertManager>();
+  std::vector<ssl::X509UniquePtr> certs;
+  certs.emplace_back(getCert(kP256Certificate));
+  certManager->addCert(
+      std::make_shared<SelfCertImpl<KeyType::P256>>(
+          getPrivateKey(kP256Key), std::move(certs)),
+      true);
+  serverContext->setCertManager(std::move(certManager));
+  auto clientContext = std::make_shared<client::FizzClientContext>();
+
+  int fds[2];
+  ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+  server::AsyncFizzServer::UniquePtr server(new server::AsyncFizzServer(
+      AsyncTransportWrapper::UniquePtr(
+          new AsyncIoUringSocket(ring_.get(), fds[0])),
+      serverContext));
+  client::AsyncFizzClient::UniquePtr client(new client::AsyncFizzClient(
+      AsyncTransportWrapper::UniquePtr(
+          new AsyncIoUringSocket(ring_.get(), fds[1])),
+      clientContext));
+
+  server::test::MockHandshakeCallback serverCallback;
+  client::test::MockHandshakeCallback clientCallback;
+  MockReadCallback serverRead;
+  ON_CALL(serverRead, isBufferMovable_()).WillByDefault(Return(true));
+  bool serverDone = false;
+  bool clientDone = false;
+  EXPECT_CALL(serverCallback, _fizzHandshakeSuccess()).WillOnce(Invoke([&]() {
+    server->setReadCB(&serverRead);
+    serverDone = true;
+  }));
+  EXPECT_CALL(clientCallback, _fizzHandshakeSuccess()).WillOnce(Invoke([&]() {
+    clientDone = true;
+  }));
+  server->accept(&serverCallback);
+  client->connect(&clientCallback, nullptr, folly::none, folly::none);
+  while (!serverDone || !clientDone) {
+    evb_.loopOnce();
+  }
+
+  bool received = false;
+  EXPECT_CALL(serverRead, readBufferAvailable_(BufMatches("hello")))
+      .WillOnce(Invoke([&](std::unique_ptr<IOBuf>&) { received = true; }));
+  client->writeChain(nullptr, IOBuf::copyBuffer("hello"));
+  loopUntil(received);
+
+  client.reset();
+  server.reset();
+  evb_.loop();
+}
+} // namespace test
+} // namespace fizz
@@ -184,6 +184,49 @@ TEST(CertTest, PeerCertGetX509) {
   EXPECT_NE(x509.get(), nullptr);
 }
 
+TEST(CertTest, MakePeerRawPublicKeyEmpty) {
+  EXPECT_THROW(
+      CertUtils::makePeerRawPublicKey(IOBuf::copyBuffer("")),
+      std::runtime_error);
+}
+
+TEST(CertTest, MakePeerRawPublicKeyJunk) {
+  EXPECT_THROW(
+      CertUtils::makePeerRawPublicKey(IOBuf::copyBuffer("blah")),
+      std::runtime_error);
+}
+
+TEST(CertTest, MakePeerRawPublicKeyTrailingData) {
+  auto spki = CertUtils::getSubjectPublicKeyInfo(
+      getPrivateKey(kP256Key).get());
+  spki->prependChain(IOBuf::copyBuffer("x"));
+  EXPECT_THROW(
+      CertUtils::makePeerRawPublicKey(std::move(spki)), std::runtime_error);
+}
+
+TEST(CertTest, RawPublicKeyIdentity) {
+  auto selfCert = CertUtils::makeSelfRawPublicKey(getPrivateKey(kP256Key));
+  EXPECT_EQ(selfCert->getCertificateType(), CertificateType::RawPublicKey);
+  EXPECT_EQ(selfCert->getAltIdentities().size(), 0);
+  EXPECT_EQ(selfCert->getX509(), nullptr);
+  EXPECT_EQ(selfCert->getIdentity().size(), 64);
+
+  auto msg = selfCert->getCertMessage();
+  ASSERT_EQ(msg.certificate_list.size(), 1);
+  auto peerCert = CertUtils::makePeerRawPublicKey(
+      std::move(msg.certificate_list.front().cert_data));
+  EXPECT_EQ(peerCert->getIdentity(), selfCert->getIdentity());
+  EXPECT_EQ(peerCert->getX509(), nullptr);
+
+  // The identity only depends on the public key, not the certificate.
+  auto x509 = getCert(kP256Certificate);
+  folly::ssl::EvpPkeyUniquePtr certKey(X509_get_pubkey(x509.get()));
+  EXPECT_EQ(
+      CertUtils::getRawPublicKeyIdentity(
+          *CertUtils::getSubjectPublicKeyInfo(certKey.get())),
+      selfCert->getIdentity());
+}
+
 TYPED_TEST(CertTestTyped, MatchingCert) {
   std::vector<folly::ssl::X509UniquePtr> certs;
   certs.push_back(getCert<TypeParam>());
@@ -282,6 +325,33 @@ TYPED_TEST(CertTestTyped, TestVerifyWrongScheme) {
       std::runtime_error);
 }
 
+TYPED_TEST(CertTestTyped, TestSignVerifyRawPublicKey) {
+  auto selfCert = CertUtils::makeSelfRawPublicKey(getKey<TypeParam>());
+  std::vector<SignatureScheme> expected{TypeParam::Scheme};
+  EXPECT_EQ(selfCert->getSigSchemes(), expected);
+
+  auto msg = selfCert->getCertMessage();
+  ASSERT_EQ(msg.certificate_list.size(), 1);
+  auto peerCert = CertUtils::makePeerRawPublicKey(
+      std::move(msg.certificate_list.front().cert_data));
+
+  StringPiece tbs{"ToBeSigned"};
+  auto sig =
+      selfCert->sign(TypeParam::Scheme, CertificateVerifyContext::Server, tbs);
+  peerCert->verify(
+      TypeParam::Scheme,
+      CertificateVerifyContext::Server,
+      tbs,
+      sig->coalesce());
+  EXPECT_THROW(
+      peerCert->verify(
+          TypeParam::Scheme,
+          CertificateVerifyContext::Client,
+          tbs,
+          sig->coalesce()),
+      std::runtime_error);
+}
+
 TYPED_TEST(CertTestTyped, TestVerifyDecodedCert) {
   std::vector<folly::ssl::X509UniquePtr> certs;
   certs.push_back(getCert<TypeParam>());
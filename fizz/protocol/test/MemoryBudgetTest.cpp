@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/protocol/MemoryBudget.h>
+
+namespace fizz {
+namespace test {
+
+TEST(MemoryBudgetTest, TestChargeRelease) {
+  MemoryBudget budget(100);
+  EXPECT_EQ(budget.getLimit(), 100);
+  EXPECT_EQ(budget.getUsage(), 0);
+  budget.charge(60);
+  budget.charge(30);
+  EXPECT_EQ(budget.getUsage(), 90);
+  EXPECT_FALSE(budget.overBudget());
+  budget.charge(10);
+  EXPECT_TRUE(budget.overBudget());
+  budget.release(50);
+  EXPECT_EQ(budget.getUsage(), 50);
+  EXPECT_FALSE(budget.overBudget());
+}
+
+TEST(MemoryBudgetTest, TestConnectionLimit) {
+  MemoryBudget budget(1000);
+  EXPECT_EQ(budget.getConnectionLimit(200, 100), 200);
+  budget.charge(500);
+  EXPECT_EQ(budget.getConnectionLimit(200, 100), 200);
+  budget.charge(250);
+  EXPECT_EQ(budget.getConnectionLimit(200, 100), 150);
+  budget.charge(250);
+  EXPECT_EQ(budget.getConnectionLimit(200, 100), 100);
+  budget.charge(1000);
+  EXPECT_EQ(budget.getConnectionLimit(200, 100), 100);
+}
+
+TEST(MemoryBudgetTest, TestConnectionLimitBelowMin) {
+  MemoryBudget budget(1000);
+  budget.charge(1000);
+  EXPECT_EQ(budget.getConnectionLimit(50, 100), 50);
+}
+} // namespace test
+} // namespace fizz
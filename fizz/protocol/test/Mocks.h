@@ -11,6 +11,7 @@
 #include <fizz/crypto/aead/test/Mocks.h>
 #include <fizz/crypto/exchange/test/Mocks.h>
 #include <fizz/crypto/test/Mocks.h>
+#include <fizz/protocol/AsyncCertificateVerifier.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/CertificateVerifier.h>
 #include <fizz/protocol/Factory.h>
@@ -109,6 +110,7 @@ class MockSelfCert : public SelfCert {
           CertificateVerifyContext context,
           folly::ByteRange toBeSigned));
   MOCK_CONST_METHOD0(getX509, folly::ssl::X509UniquePtr());
+  MOCK_CONST_METHOD0(getCertificateType, CertificateType());
 };
 
 class MockPeerCert : public PeerCert {
@@ -133,6 +135,19 @@ class MockCertificateVerifier : public CertificateVerifier {
   MOCK_CONST_METHOD0(getCertificateRequestExtensions, std::vector<Extension>());
 };
 
+class MockAsyncCertificateVerifier : public AsyncCertificateVerifier {
+ public:
+  MOCK_CONST_METHOD1(
+      verify,
+      void(const std::vector<std::shared_ptr<const PeerCert>>&));
+  MOCK_CONST_METHOD1(
+      verifyFuture,
+      folly::Future<folly::Unit>(
+          const std::vector<std::shared_ptr<const PeerCert>>&));
+
+  MOCK_CONST_METHOD0(getCertificateRequestExtensions, std::vector<Extension>());
+};
+
 class MockFactory : public Factory {
  public:
   MOCK_CONST_METHOD0(
@@ -165,6 +180,11 @@ class MockFactory : public Factory {
     return _makePeerCert(certData);
   }
 
+  MOCK_CONST_METHOD1(_makePeerRawPublicKey, std::shared_ptr<PeerCert>(Buf&));
+  std::shared_ptr<PeerCert> makePeerRawPublicKey(Buf spki) const override {
+    return _makePeerRawPublicKey(spki);
+  }
+
   void setDefaults() {
     ON_CALL(*this, makePlaintextReadRecordLayer())
         .WillByDefault(InvokeWithoutArgs(
@@ -219,6 +239,9 @@ class MockFactory : public Factory {
     ON_CALL(*this, _makePeerCert(_)).WillByDefault(InvokeWithoutArgs([]() {
       return std::make_unique<MockPeerCert>();
     }));
+    ON_CALL(*this, _makePeerRawPublicKey(_))
+        .WillByDefault(InvokeWithoutArgs(
+            []() { return std::make_unique<MockPeerCert>(); }));
   }
 };
 } // namespace test
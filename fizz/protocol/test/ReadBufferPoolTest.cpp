@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/protocol/ReadBufferPool.h>
+
+#include <thread>
+#include <vector>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+TEST(ReadBufferPoolTest, TestSizeClasses) {
+  auto buf = ReadBufferPool::allocate(100);
+  EXPECT_EQ(buf->length(), 0);
+  EXPECT_EQ(buf->tailroom(), ReadBufferPool::kSizeClasses[0]);
+  EXPECT_FALSE(buf->isShared());
+
+  buf = ReadBufferPool::allocate(5000);
+  EXPECT_EQ(buf->tailroom(), ReadBufferPool::kSizeClasses[1]);
+
+  buf = ReadBufferPool::allocate(0x4000 + 256 + 5);
+  EXPECT_EQ(buf->tailroom(), ReadBufferPool::kMaxBufferSize);
+}
+
+TEST(ReadBufferPoolTest, TestReuse) {
+  auto buf = ReadBufferPool::allocate(ReadBufferPool::kMaxBufferSize);
+  auto data = buf->data();
+  auto cached = ReadBufferPool::numCached(2);
+  buf.reset();
+  EXPECT_EQ(ReadBufferPool::numCached(2), cached + 1);
+
+  buf = ReadBufferPool::allocate(ReadBufferPool::kMaxBufferSize);
+  EXPECT_EQ(buf->data(), data);
+  EXPECT_EQ(ReadBufferPool::numCached(2), cached);
+}
+
+TEST(ReadBufferPoolTest, TestSharedRelease) {
+  auto buf = ReadBufferPool::allocate(100);
+  auto cached = ReadBufferPool::numCached(0);
+  memcpy(buf->writableTail(), "hello", 5);
+  buf->append(5);
+  auto clone = buf->clone();
+  buf.reset();
+  EXPECT_EQ(ReadBufferPool::numCached(0), cached);
+  EXPECT_EQ(StringPiece(clone->coalesce()), "hello");
+  clone.reset();
+  EXPECT_EQ(ReadBufferPool::numCached(0), cached + 1);
+}
+
+TEST(ReadBufferPoolTest, TestCacheLimit) {
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  for (size_t i = 0; i < ReadBufferPool::kMaxCachedPerClass + 5; ++i) {
+    bufs.push_back(ReadBufferPool::allocate(5000));
+  }
+  bufs.clear();
+  EXPECT_EQ(ReadBufferPool::numCached(1), ReadBufferPool::kMaxCachedPerClass);
+}
+
+TEST(ReadBufferPoolTest, TestLargeNotPooled) {
+  auto buf = ReadBufferPool::allocate(ReadBufferPool::kMaxBufferSize + 1);
+  EXPECT_GE(buf->tailroom(), ReadBufferPool::kMaxBufferSize + 1);
+}
+
+TEST(ReadBufferPoolTest, TestReleaseOnOtherThread) {
+  auto buf = ReadBufferPool::allocate(100);
+  auto cached = ReadBufferPool::numCached(0);
+  std::thread t([buf = std::move(buf)]() mutable {
+    buf.reset();
+    EXPECT_EQ(ReadBufferPool::numCached(0), 1);
+  });
+  t.join();
+  EXPECT_EQ(ReadBufferPool::numCached(0), cached);
+}
+} // namespace test
+} // namespace fizz
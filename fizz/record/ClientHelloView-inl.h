@@ -0,0 +1,42 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+namespace fizz {
+
+template <class T>
+folly::Optional<T> ClientHelloView::getExtension() const {
+  auto data = getExtensionData(T::extension_type);
+  if (!data) {
+    return folly::none;
+  }
+  auto buf = extensionBuf(*data);
+  folly::io::Cursor cs{&buf};
+  auto ret = fizz::getExtension<T>(cs);
+  if (!cs.isAtEnd()) {
+    throw std::runtime_error("didn't read entire extension");
+  }
+  return ret;
+}
+
+template <>
+inline folly::Optional<ClientKeyShare> ClientHelloView::getExtension() const {
+  ClientKeyShare share;
+  auto data = getExtensionData(ExtensionType::key_share);
+  if (!data) {
+    data = getExtensionData(ExtensionType::key_share_old);
+    if (!data) {
+      return folly::none;
+    }
+    share.preDraft23 = true;
+  }
+  auto buf = extensionBuf(*data);
+  folly::io::Cursor cs{&buf};
+  detail::readVector<uint16_t>(share.client_shares, cs);
+  return std::move(share);
+}
+} // namespace fizz
@@ -0,0 +1,181 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/record/ClientHelloView.h>
+
+#include <folly/Bits.h>
+
+#include <limits>
+
+namespace fizz {
+
+namespace {
+class Reader {
+ public:
+  explicit Reader(folly::ByteRange data) : data_(data) {}
+
+  uint8_t readUint8() {
+    return take(1)[0];
+  }
+
+  uint16_t readUint16() {
+    auto bytes = take(2);
+    return folly::Endian::big(folly::loadUnaligned<uint16_t>(bytes.data()));
+  }
+
+  folly::ByteRange take(size_t len) {
+    if (data_.size() < len) {
+      throw std::runtime_error("client hello truncated");
+    }
+    auto ret = data_.subpiece(0, len);
+    data_.advance(len);
+    return ret;
+  }
+
+  bool isAtEnd() const {
+    return data_.empty();
+  }
+
+  const uint8_t* position() const {
+    return data_.begin();
+  }
+
+ private:
+  folly::ByteRange data_;
+};
+} // namespace
+
+constexpr size_t ClientHelloView::kMaxIndexedExtensions;
+constexpr size_t ClientHelloView::kFastLookupTypes;
+
+ClientHelloView::ClientHelloView(
+    folly::ByteRange body,
+    const folly::IOBuf* backing)
+    : body_(body), backing_(backing) {
+  if (body_.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("client hello too large");
+  }
+
+  Reader reader(body_);
+  legacyVersion_ = static_cast<ProtocolVersion>(reader.readUint16());
+  random_ = reader.take(sizeof(Random));
+  legacySessionId_ = reader.take(reader.readUint8());
+  cipherSuites_ = reader.take(reader.readUint16());
+  if (cipherSuites_.size() % sizeof(CipherSuite) != 0) {
+    throw std::runtime_error("malformed cipher suites");
+  }
+  compressionMethods_ = reader.take(reader.readUint8());
+  // Before TLS 1.3 clients could omit the extensions section entirely, see
+  // decode<ClientHello>().
+  if (reader.isAtEnd()) {
+    return;
+  }
+  extensions_ = reader.take(reader.readUint16());
+  if (!reader.isAtEnd()) {
+    throw std::runtime_error("trailing data after client hello");
+  }
+
+  Reader extReader(extensions_);
+  while (!extReader.isAtEnd()) {
+    auto extStart = extReader.position();
+    auto type = extReader.readUint16();
+    auto length = extReader.readUint16();
+    auto data = extReader.take(length);
+
+    if (numExtensions_ < kMaxIndexedExtensions) {
+      if (type < kFastLookupTypes) {
+        if (fastLookup_[type] != 0) {
+          duplicateExtensions_ = true;
+        } else {
+          fastLookup_[type] = numExtensions_ + 1;
+        }
+      } else {
+        for (size_t i = 0; i < numExtensions_; ++i) {
+          if (index_[i].type == type) {
+            duplicateExtensions_ = true;
+            break;
+          }
+        }
+      }
+      index_[numExtensions_] = IndexEntry{
+          type, length, static_cast<uint32_t>(data.begin() - body_.begin())};
+    } else if (!duplicateExtensions_) {
+      // Only reached for unusually large ClientHellos, so it's fine to rescan
+      // the extensions seen so far.
+      auto seen = scanExtensions(
+          static_cast<ExtensionType>(type),
+          folly::ByteRange(extensions_.begin(), extStart));
+      if (seen) {
+        duplicateExtensions_ = true;
+      }
+    }
+    ++numExtensions_;
+  }
+}
+
+CipherSuite ClientHelloView::cipherSuite(size_t i) const {
+  if (i >= numCipherSuites()) {
+    throw std::out_of_range("cipher suite index out of range");
+  }
+  return static_cast<CipherSuite>(folly::Endian::big(
+      folly::loadUnaligned<uint16_t>(cipherSuites_.data() + 2 * i)));
+}
+
+folly::Optional<folly::ByteRange> ClientHelloView::getExtensionData(
+    ExtensionType type) const {
+  auto rawType = static_cast<uint16_t>(type);
+  size_t numIndexed = numExtensions_ < kMaxIndexedExtensions
+      ? numExtensions_
+      : kMaxIndexedExtensions;
+  if (rawType < kFastLookupTypes) {
+    auto slot = fastLookup_[rawType];
+    if (slot != 0) {
+      const auto& entry = index_[slot - 1];
+      return body_.subpiece(entry.offset, entry.length);
+    }
+  } else {
+    for (size_t i = 0; i < numIndexed; ++i) {
+      if (index_[i].type == rawType) {
+        return body_.subpiece(index_[i].offset, index_[i].length);
+      }
+    }
+  }
+  if (numExtensions_ <= kMaxIndexedExtensions) {
+    return folly::none;
+  }
+  const auto& last = index_[kMaxIndexedExtensions - 1];
+  auto overflowStart = body_.begin() + last.offset + last.length;
+  return scanExtensions(
+      type, folly::ByteRange(overflowStart, extensions_.end()));
+}
+
+folly::IOBuf ClientHelloView::extensionBuf(folly::ByteRange data) const {
+  if (!backing_) {
+    return folly::IOBuf::wrapBufferAsValue(data);
+  }
+  auto buf = backing_->cloneOneAsValue();
+  buf.trimStart(data.begin() - buf.data());
+  buf.trimEnd(buf.tail() - data.end());
+  return buf;
+}
+
+folly::Optional<folly::ByteRange> ClientHelloView::scanExtensions(
+    ExtensionType type,
+    folly::ByteRange extensions) {
+  // The extensions block has already been validated by the constructor.
+  Reader reader(extensions);
+  while (!reader.isAtEnd()) {
+    auto extType = reader.readUint16();
+    auto data = reader.take(reader.readUint16());
+    if (extType == static_cast<uint16_t>(type)) {
+      return data;
+    }
+  }
+  return folly::none;
+}
+} // namespace fizz
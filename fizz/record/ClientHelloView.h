@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Extensions.h>
+#include <folly/Range.h>
+
+#include <array>
+
+namespace fizz {
+
+/**
+ * Read-only view of an encoded ClientHello body (without the handshake
+ * header). Unlike decode<ClientHello>(), constructing a view does not copy
+ * anything: the fields are validated and the extension offsets indexed in a
+ * single pass over the bytes, and typed extensions are only decoded when
+ * asked for.
+ *
+ * The view does not own the bytes, which must outlive it and be contiguous
+ * (coalesce the buffer first if necessary). The constructor throws
+ * std::runtime_error if the ClientHello is malformed.
+ *
+ * Buffers in decoded extensions point into the viewed bytes. If backing (a
+ * single, managed IOBuf containing body) is given they hold a reference on
+ * it, otherwise they are only valid as long as the bytes are.
+ *
+ * The state machines still use the fully decoded ClientHello. The view is
+ * meant for code that inspects a ClientHello before the handshake starts,
+ * such as routing a connection on its SNI or ALPN.
+ */
+class ClientHelloView {
+ public:
+  /**
+   * Number of extensions whose offsets are kept in the fixed size index.
+   * Lookups of extensions beyond this fall back to scanning the extensions
+   * block.
+   */
+  static constexpr size_t kMaxIndexedExtensions = 32;
+
+  explicit ClientHelloView(
+      folly::ByteRange body,
+      const folly::IOBuf* backing = nullptr);
+
+  ProtocolVersion legacyVersion() const {
+    return legacyVersion_;
+  }
+
+  folly::ByteRange random() const {
+    return random_;
+  }
+
+  folly::ByteRange legacySessionId() const {
+    return legacySessionId_;
+  }
+
+  size_t numCipherSuites() const {
+    return cipherSuites_.size() / sizeof(CipherSuite);
+  }
+
+  CipherSuite cipherSuite(size_t i) const;
+
+  folly::ByteRange legacyCompressionMethods() const {
+    return compressionMethods_;
+  }
+
+  size_t numExtensions() const {
+    return numExtensions_;
+  }
+
+  /**
+   * Whether the same extension type appeared more than once.
+   */
+  bool hasDuplicateExtensions() const {
+    return duplicateExtensions_;
+  }
+
+  bool hasExtension(ExtensionType type) const {
+    return getExtensionData(type).hasValue();
+  }
+
+  /**
+   * Returns the body of the first extension of the given type, if present.
+   */
+  folly::Optional<folly::ByteRange> getExtensionData(ExtensionType type) const;
+
+  /**
+   * Decodes the first extension of type T, if present. Follows the same rules
+   * as getExtension<T>(const std::vector<Extension>&).
+   */
+  template <class T>
+  folly::Optional<T> getExtension() const;
+
+ private:
+  struct IndexEntry {
+    uint16_t type;
+    uint16_t length;
+    uint32_t offset;
+  };
+
+  folly::IOBuf extensionBuf(folly::ByteRange data) const;
+
+  static folly::Optional<folly::ByteRange> scanExtensions(
+      ExtensionType type,
+      folly::ByteRange extensions);
+
+  folly::ByteRange body_;
+  const folly::IOBuf* backing_;
+  ProtocolVersion legacyVersion_;
+  folly::ByteRange random_;
+  folly::ByteRange legacySessionId_;
+  folly::ByteRange cipherSuites_;
+  folly::ByteRange compressionMethods_;
+  folly::ByteRange extensions_;
+
+  size_t numExtensions_{0};
+  bool duplicateExtensions_{false};
+  std::array<IndexEntry, kMaxIndexedExtensions> index_;
+
+  // For extension types below kFastLookupTypes, 1 + the position of the first
+  // extension of that type in index_, or 0 if not indexed.
+  static constexpr size_t kFastLookupTypes = 64;
+  std::array<uint8_t, kFastLookupTypes> fastLookup_{};
+};
+} // namespace fizz
+
+#include <fizz/record/ClientHelloView-inl.h>
@@ -19,7 +19,8 @@ static constexpr size_t kEncryptedHeaderSize =
     sizeof(ContentType) + sizeof(ProtocolVersion) + sizeof(uint16_t);
 
 folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
-    folly::IOBufQueue& buf) {
+    folly::IOBufQueue& buf,
+    bool& usedProvidedBuffer) {
   while (true) {
     folly::io::Cursor cursor(buf.front());
 
@@ -83,18 +84,36 @@ folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
       } else {
         continue;
       }
-    } else {
-      return aead_->decrypt(
-          std::move(encrypted),
-          useAdditionalData_ ? &adBuf : nullptr,
-          seqNum_++);
     }
+
+    if (decryptionBufferProvider_ &&
+        contentType == ContentType::application_data &&
+        length > aead_->getCipherOverhead()) {
+      auto output = decryptionBufferProvider_->getDecryptionBuffer(
+          length - aead_->getCipherOverhead());
+      if (output) {
+        if (!aead_->tryDecryptInto(
+                std::move(encrypted),
+                useAdditionalData_ ? &adBuf : nullptr,
+                seqNum_,
+                *output)) {
+          decryptionBufferProvider_->releaseDecryptionBuffer();
+          throw std::runtime_error("decryption failed");
+        }
+        seqNum_++;
+        usedProvidedBuffer = true;
+        return std::move(output);
+      }
+    }
+    return aead_->decrypt(
+        std::move(encrypted), useAdditionalData_ ? &adBuf : nullptr, seqNum_++);
   }
 }
 
 folly::Optional<TLSMessage> EncryptedReadRecordLayer::read(
     folly::IOBufQueue& buf) {
-  auto decryptedBuf = getDecryptedBuf(buf);
+  bool usedProvidedBuffer = false;
+  auto decryptedBuf = getDecryptedBuf(buf, usedProvidedBuffer);
   if (!decryptedBuf) {
     return folly::none;
   }
@@ -122,6 +141,16 @@ folly::Optional<TLSMessage> EncryptedReadRecordLayer::read(
           static_cast<ContentTypeType>(msg.type)));
   }
 
+  if (usedProvidedBuffer &&
+      (!msg.fragment || msg.type != ContentType::application_data)) {
+    // The provided buffer is only meant to receive application data.
+    if (msg.fragment) {
+      msg.fragment = folly::IOBuf::copyBuffer(
+          msg.fragment->data(), msg.fragment->length());
+    }
+    decryptionBufferProvider_->releaseDecryptionBuffer();
+  }
+
   if (!msg.fragment) {
     if (msg.type == ContentType::application_data) {
       msg.fragment = folly::IOBuf::create(0);
@@ -204,6 +233,15 @@ Buf EncryptedWriteRecordLayer::write(TLSMessage&& msg) const {
   return outBuf;
 }
 
+size_t EncryptedWriteRecordLayer::getRecordHeadroom() const {
+  return kEncryptedHeaderSize;
+}
+
+size_t EncryptedWriteRecordLayer::getRecordTailroom() const {
+  // Inner content type followed by the tag.
+  return sizeof(ContentType) + (aead_ ? aead_->getCipherOverhead() : 0);
+}
+
 Buf EncryptedWriteRecordLayer::getBufToEncrypt(folly::IOBufQueue& queue) const {
   static constexpr size_t kMinSuggestedRecordSize = 1500;
   if (queue.front()->length() > maxRecord_) {
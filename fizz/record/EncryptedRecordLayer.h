@@ -33,6 +33,11 @@ class EncryptedReadRecordLayer : public ReadRecordLayer {
     skipFailedDecryption_ = enabled;
   }
 
+  void setDecryptionBufferProvider(
+      DecryptionBufferProvider* provider) override {
+    decryptionBufferProvider_ = provider;
+  }
+
   void setProtocolVersion(ProtocolVersion version) {
     auto realVersion = getRealDraftVersion(version);
     if (realVersion == ProtocolVersion::tls_1_3_23 ||
@@ -46,10 +51,13 @@ class EncryptedReadRecordLayer : public ReadRecordLayer {
   }
 
  private:
-  folly::Optional<Buf> getDecryptedBuf(folly::IOBufQueue& buf);
+  folly::Optional<Buf> getDecryptedBuf(
+      folly::IOBufQueue& buf,
+      bool& usedProvidedBuffer);
 
   std::unique_ptr<Aead> aead_;
   bool skipFailedDecryption_{false};
+  DecryptionBufferProvider* decryptionBufferProvider_{nullptr};
 
   bool useAdditionalData_{true};
 
@@ -62,6 +70,10 @@ class EncryptedWriteRecordLayer : public WriteRecordLayer {
 
   Buf write(TLSMessage&& msg) const override;
 
+  size_t getRecordHeadroom() const override;
+
+  size_t getRecordTailroom() const override;
+
   virtual void setAead(std::unique_ptr<Aead> aead) {
     if (seqNum_ != 0) {
       throw std::runtime_error("aead set after write");
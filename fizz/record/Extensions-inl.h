@@ -164,6 +164,34 @@ inline CertificateAuthorities getExtension(folly::io::Cursor& cs) {
   return authorities;
 }
 
+template <>
+inline ClientCertificateTypes getExtension(folly::io::Cursor& cs) {
+  ClientCertificateTypes types;
+  detail::readVector<uint8_t>(types.certificate_types, cs);
+  return types;
+}
+
+template <>
+inline SelectedClientCertificateType getExtension(folly::io::Cursor& cs) {
+  SelectedClientCertificateType type;
+  detail::read(type.certificate_type, cs);
+  return type;
+}
+
+template <>
+inline ServerCertificateTypes getExtension(folly::io::Cursor& cs) {
+  ServerCertificateTypes types;
+  detail::readVector<uint8_t>(types.certificate_types, cs);
+  return types;
+}
+
+template <>
+inline SelectedServerCertificateType getExtension(folly::io::Cursor& cs) {
+  SelectedServerCertificateType type;
+  detail::read(type.certificate_type, cs);
+  return type;
+}
+
 template <>
 inline Extension encodeExtension(const SignatureAlgorithms& sig) {
   Extension ext;
@@ -338,6 +366,46 @@ inline Extension encodeExtension(const CertificateAuthorities& authorities) {
   return ext;
 }
 
+template <>
+inline Extension encodeExtension(const ClientCertificateTypes& types) {
+  Extension ext;
+  ext.extension_type = ExtensionType::client_certificate_type;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::writeVector<uint8_t>(types.certificate_types, appender);
+  return ext;
+}
+
+template <>
+inline Extension encodeExtension(const SelectedClientCertificateType& type) {
+  Extension ext;
+  ext.extension_type = ExtensionType::client_certificate_type;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::write(type.certificate_type, appender);
+  return ext;
+}
+
+template <>
+inline Extension encodeExtension(const ServerCertificateTypes& types) {
+  Extension ext;
+  ext.extension_type = ExtensionType::server_certificate_type;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::writeVector<uint8_t>(types.certificate_types, appender);
+  return ext;
+}
+
+template <>
+inline Extension encodeExtension(const SelectedServerCertificateType& type) {
+  Extension ext;
+  ext.extension_type = ExtensionType::server_certificate_type;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::write(type.certificate_type, appender);
+  return ext;
+}
+
 inline size_t getBinderLength(const ClientHello& chlo) {
   if (chlo.extensions.empty() ||
       chlo.extensions.back().extension_type != ExtensionType::pre_shared_key) {
@@ -141,6 +141,32 @@ struct CertificateAuthorities {
       ExtensionType::certificate_authorities;
 };
 
+// RFC 7250 certificate type extensions. The ClientHello carries the list of
+// types the client supports, the server selects one in EncryptedExtensions.
+struct ClientCertificateTypes {
+  std::vector<CertificateType> certificate_types;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::client_certificate_type;
+};
+
+struct SelectedClientCertificateType {
+  CertificateType certificate_type;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::client_certificate_type;
+};
+
+struct ServerCertificateTypes {
+  std::vector<CertificateType> certificate_types;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::server_certificate_type;
+};
+
+struct SelectedServerCertificateType {
+  CertificateType certificate_type;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::server_certificate_type;
+};
+
 template <class T>
 folly::Optional<T> getExtension(const std::vector<Extension>& extension);
 template <class T>
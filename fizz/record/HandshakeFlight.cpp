@@ -0,0 +1,30 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/record/HandshakeFlight.h>
+
+namespace fizz {
+
+Buf HandshakeFlight::allocate(size_t length) {
+  // Only a message that starts a record needs room for its header, but any
+  // of them may end one.
+  auto headroom = queue_.empty() ? recordLayer_->getRecordHeadroom() : 0;
+  auto capacity = headroom + length + recordLayer_->getRecordTailroom();
+  auto buf = folly::IOBuf::create(capacity);
+  buf->advance(headroom);
+  return buf;
+}
+
+Buf HandshakeFlight::write(size_t maxLength) {
+  auto length = std::min(maxLength, queue_.chainLength());
+  if (length == 0) {
+    throw std::runtime_error("no handshake data to write");
+  }
+  return recordLayer_->writeHandshake(queue_.split(length));
+}
+} // namespace fizz
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/RecordLayer.h>
+
+#include <limits>
+
+namespace fizz {
+
+/**
+ * Builds a flight of handshake messages and writes it through a record layer.
+ *
+ * Messages are encoded straight into buffers sized exactly for them (using
+ * detail::getSize), with the headroom and tailroom the record layer needs to
+ * frame and encrypt a record in place. Writing hands the queued buffers to
+ * the record layer without copying them.
+ */
+class HandshakeFlight {
+ public:
+  explicit HandshakeFlight(const WriteRecordLayer& recordLayer)
+      : recordLayer_(&recordLayer) {}
+
+  /**
+   * Encodes msg, including its handshake header, and queues it. Returns the
+   * encoding to be appended to the transcript. It shares the queued buffer,
+   * so it should be released before the next write() to let the record layer
+   * encrypt in place.
+   */
+  template <class T>
+  Buf add(T&& msg);
+
+  /**
+   * Queues an already encoded handshake message.
+   */
+  void addEncoded(Buf encodedHandshakeMsg) {
+    queue_.append(std::move(encodedHandshakeMsg));
+  }
+
+  bool empty() const {
+    return queue_.empty();
+  }
+
+  size_t length() const {
+    return queue_.chainLength();
+  }
+
+  /**
+   * Writes up to maxLength bytes of the pending messages as handshake
+   * records.
+   */
+  Buf write(size_t maxLength = std::numeric_limits<size_t>::max());
+
+ private:
+  Buf allocate(size_t length);
+
+  const WriteRecordLayer* recordLayer_;
+  folly::IOBufQueue queue_{folly::IOBufQueue::cacheChainLength()};
+};
+
+template <class T>
+Buf HandshakeFlight::add(T&& msg) {
+  constexpr auto handshakeType = std::remove_reference<T>::type::handshake_type;
+  auto bodyLength = detail::getSize(msg);
+  auto buf = allocate(
+      sizeof(HandshakeType) + detail::bits24::size + bodyLength);
+  folly::io::Appender appender(buf.get(), 0);
+  detail::write(handshakeType, appender);
+  detail::writeBits24(bodyLength, appender);
+  detail::write(msg, appender);
+
+  auto encoding = buf->clone();
+  queue_.append(std::move(buf));
+  return encoding;
+}
+} // namespace fizz
@@ -98,6 +98,10 @@ Buf PlaintextWriteRecordLayer::write(TLSMessage&& msg) const {
   return write(std::move(msg), recordVersion_);
 }
 
+size_t PlaintextWriteRecordLayer::getRecordHeadroom() const {
+  return kPlaintextHeaderSize;
+}
+
 Buf PlaintextWriteRecordLayer::writeInitialClientHello(
     Buf encodedClientHello) const {
   return write(
@@ -113,6 +117,19 @@ Buf PlaintextWriteRecordLayer::write(
   }
 
   auto fragment = std::move(msg.fragment);
+  if (!fragment->isChained() && !fragment->isShared() && !fragment->empty() &&
+      fragment->length() <= kMaxPlaintextRecordSize &&
+      fragment->headroom() >= kPlaintextHeaderSize) {
+    // Single record that we can frame in place.
+    auto len = fragment->length();
+    fragment->prepend(kPlaintextHeaderSize);
+    folly::io::RWPrivateCursor header(fragment.get());
+    header.writeBE(static_cast<ContentTypeType>(msg.type));
+    header.writeBE(static_cast<ProtocolVersionType>(recordVersion));
+    header.writeBE<uint16_t>(len);
+    return fragment;
+  }
+
   folly::io::Cursor cursor(fragment.get());
   std::unique_ptr<folly::IOBuf> data;
   while (!cursor.isAtEnd()) {
@@ -45,6 +45,8 @@ class PlaintextWriteRecordLayer : public WriteRecordLayer {
 
   Buf write(TLSMessage&& msg) const override;
 
+  size_t getRecordHeadroom() const override;
+
   /**
    * Write the initial ClientHello handshake message. This is a separate method
    * as the record encoding can be slightly different since the version has not
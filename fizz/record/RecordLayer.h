@@ -15,6 +15,30 @@
 
 namespace fizz {
 
+/**
+ * Supplies memory for the record layer to decrypt application data into, so
+ * that it can be decrypted directly into the application's buffers.
+ */
+class DecryptionBufferProvider {
+ public:
+  virtual ~DecryptionBufferProvider() = default;
+
+  /**
+   * Returns an empty buffer with at least size bytes of tailroom, or nullptr
+   * if the record should be decrypted into a buffer of the record layer's
+   * choosing. The buffer may be unmanaged; if the record turns out not to
+   * hold application data, the record layer copies its contents out.
+   */
+  virtual std::unique_ptr<folly::IOBuf> getDecryptionBuffer(size_t size) = 0;
+
+  /**
+   * Called when the buffer last returned by getDecryptionBuffer() will not be
+   * returned in a record, for example because the record did not hold
+   * application data or failed to decrypt.
+   */
+  virtual void releaseDecryptionBuffer() = 0;
+};
+
 class ReadRecordLayer {
  public:
   virtual ~ReadRecordLayer() = default;
@@ -37,6 +61,20 @@ class ReadRecordLayer {
    */
   virtual bool hasUnparsedHandshakeData() const;
 
+  /**
+   * Amount of decrypted but unparsed handshake data buffered.
+   */
+  size_t getUnparsedHandshakeDataSize() const {
+    return unparsedHandshakeData_.chainLength();
+  }
+
+  /**
+   * Sets where to decrypt records into, if this record layer decrypts.
+   * Ignored otherwise.
+   */
+  virtual void setDecryptionBufferProvider(
+      DecryptionBufferProvider* /* provider */) {}
+
  private:
   static folly::Optional<Param> decodeHandshakeMessage(folly::IOBufQueue& buf);
 
@@ -50,6 +88,19 @@ class WriteRecordLayer {
 
   virtual Buf write(TLSMessage&& msg) const = 0;
 
+  /**
+   * Space write() needs before and after a record's fragment in order to
+   * frame (and encrypt) it without allocating, if the fragment is a single
+   * unshared buffer.
+   */
+  virtual size_t getRecordHeadroom() const {
+    return 0;
+  }
+
+  virtual size_t getRecordTailroom() const {
+    return 0;
+  }
+
   Buf writeAlert(Alert&& alert) const {
     return write(TLSMessage{ContentType::alert, encode(std::move(alert))});
   }
@@ -333,25 +333,160 @@ struct Reader<CertificateEntry> {
     return len;
   }
 };
-} // namespace detail
+
+/*
+ * Sizers and writers for handshake message bodies, so that they can be
+ * encoded into a buffer of exactly the right size.
+ */
+
+inline size_t getBufLength(const Buf& buf) {
+  return buf ? buf->computeChainDataLength() : 0;
+}
+
+template <class T>
+size_t getElementsSize(const std::vector<T>& data) {
+  size_t len = 0;
+  for (const auto& t : data) {
+    len += getSize<T>(t);
+  }
+  return len;
+}
 
 template <>
-inline Buf encode<ServerHello>(ServerHello&& shlo) {
-  auto buf = folly::IOBuf::create(
-      sizeof(ProtocolVersion) + sizeof(Random) + sizeof(CipherSuite) + 20);
-  folly::io::Appender appender(buf.get(), 20);
-  detail::write(shlo.legacy_version, appender);
-  detail::write(shlo.random, appender);
-  if (shlo.legacy_session_id_echo) {
-    detail::writeBuf<uint8_t>(shlo.legacy_session_id_echo, appender);
+struct Sizer<ServerHello> {
+  template <class T>
+  size_t getSize(const ServerHello& shlo) {
+    size_t len = sizeof(ProtocolVersion) + sizeof(Random) + sizeof(CipherSuite);
+    if (shlo.legacy_session_id_echo) {
+      len += sizeof(uint8_t) + getBufLength(shlo.legacy_session_id_echo);
+      len += sizeof(shlo.legacy_compression_method);
+    }
+    return len + sizeof(uint16_t) + getElementsSize(shlo.extensions);
   }
-  detail::write(shlo.cipher_suite, appender);
-  if (shlo.legacy_session_id_echo) {
-    detail::write(shlo.legacy_compression_method, appender);
+};
+
+template <>
+struct Writer<ServerHello> {
+  template <class T>
+  void write(const ServerHello& shlo, folly::io::Appender& out) {
+    detail::write(shlo.legacy_version, out);
+    detail::write(shlo.random, out);
+    if (shlo.legacy_session_id_echo) {
+      writeBuf<uint8_t>(shlo.legacy_session_id_echo, out);
+    }
+    detail::write(shlo.cipher_suite, out);
+    if (shlo.legacy_session_id_echo) {
+      detail::write(shlo.legacy_compression_method, out);
+    }
+    writeVector<uint16_t>(shlo.extensions, out);
   }
-  detail::writeVector<uint16_t>(shlo.extensions, appender);
+};
+
+template <>
+struct Sizer<EncryptedExtensions> {
+  template <class T>
+  size_t getSize(const EncryptedExtensions& ee) {
+    return sizeof(uint16_t) + getElementsSize(ee.extensions);
+  }
+};
+
+template <>
+struct Writer<EncryptedExtensions> {
+  template <class T>
+  void write(const EncryptedExtensions& ee, folly::io::Appender& out) {
+    writeVector<uint16_t>(ee.extensions, out);
+  }
+};
+
+template <>
+struct Sizer<CertificateRequest> {
+  template <class T>
+  size_t getSize(const CertificateRequest& cr) {
+    return sizeof(uint8_t) + getBufLength(cr.certificate_request_context) +
+        sizeof(uint16_t) + getElementsSize(cr.extensions);
+  }
+};
+
+template <>
+struct Writer<CertificateRequest> {
+  template <class T>
+  void write(const CertificateRequest& cr, folly::io::Appender& out) {
+    writeBuf<uint8_t>(cr.certificate_request_context, out);
+    writeVector<uint16_t>(cr.extensions, out);
+  }
+};
+
+template <>
+struct Sizer<CertificateMsg> {
+  template <class T>
+  size_t getSize(const CertificateMsg& cert) {
+    return sizeof(uint8_t) + getBufLength(cert.certificate_request_context) +
+        bits24::size + getElementsSize(cert.certificate_list);
+  }
+};
+
+template <>
+struct Writer<CertificateMsg> {
+  template <class T>
+  void write(const CertificateMsg& cert, folly::io::Appender& out) {
+    writeBuf<uint8_t>(cert.certificate_request_context, out);
+    writeVector<bits24>(cert.certificate_list, out);
+  }
+};
+
+template <>
+struct Sizer<CertificateVerify> {
+  template <class T>
+  size_t getSize(const CertificateVerify& certVerify) {
+    return sizeof(SignatureScheme) + sizeof(uint16_t) +
+        getBufLength(certVerify.signature);
+  }
+};
+
+template <>
+struct Writer<CertificateVerify> {
+  template <class T>
+  void write(const CertificateVerify& certVerify, folly::io::Appender& out) {
+    detail::write(certVerify.algorithm, out);
+    writeBuf<uint16_t>(certVerify.signature, out);
+  }
+};
+
+template <>
+struct Sizer<Finished> {
+  template <class T>
+  size_t getSize(const Finished& fin) {
+    return getBufLength(fin.verify_data);
+  }
+};
+
+template <>
+struct Writer<Finished> {
+  template <class T>
+  void write(const Finished& fin, folly::io::Appender& out) {
+    for (auto current : *fin.verify_data) {
+      out.push(current.data(), current.size());
+    }
+  }
+};
+
+/**
+ * Encodes t into a single buffer sized with getSize().
+ */
+template <class T>
+Buf encodeExactly(const T& t) {
+  auto buf = folly::IOBuf::create(getSize(t));
+  // No growth, so a sizer that disagrees with its writer throws.
+  folly::io::Appender appender(buf.get(), 0);
+  write(t, appender);
   return buf;
 }
+} // namespace detail
+
+template <>
+inline Buf encode<ServerHello>(ServerHello&& shlo) {
+  return detail::encodeExactly(shlo);
+}
 
 template <>
 inline Buf encode<HelloRetryRequest>(HelloRetryRequest&& shlo) {
@@ -374,37 +509,22 @@ inline Buf encode<EndOfEarlyData>(EndOfEarlyData&&) {
 
 template <>
 inline Buf encode<EncryptedExtensions>(EncryptedExtensions&& extensions) {
-  auto buf = folly::IOBuf::create(20);
-  folly::io::Appender appender(buf.get(), 20);
-  detail::writeVector<uint16_t>(extensions.extensions, appender);
-  return buf;
+  return detail::encodeExactly(extensions);
 }
 
 template <>
 inline Buf encode<CertificateRequest>(CertificateRequest&& cr) {
-  auto buf = folly::IOBuf::create(20);
-  folly::io::Appender appender(buf.get(), 20);
-  detail::writeBuf<uint8_t>(cr.certificate_request_context, appender);
-  detail::writeVector<uint16_t>(cr.extensions, appender);
-  return buf;
+  return detail::encodeExactly(cr);
 }
 
 template <>
 inline Buf encode<CertificateMsg>(CertificateMsg&& cert) {
-  auto buf = folly::IOBuf::create(20);
-  folly::io::Appender appender(buf.get(), 20);
-  detail::writeBuf<uint8_t>(cert.certificate_request_context, appender);
-  detail::writeVector<detail::bits24>(cert.certificate_list, appender);
-  return buf;
+  return detail::encodeExactly(cert);
 }
 
 template <>
 inline Buf encode<CertificateVerify>(CertificateVerify&& certVerify) {
-  auto buf = folly::IOBuf::create(20);
-  folly::io::Appender appender(buf.get(), 20);
-  detail::write(certVerify.algorithm, appender);
-  detail::writeBuf<uint16_t>(certVerify.signature, appender);
-  return buf;
+  return detail::encodeExactly(certVerify);
 }
 
 template <>
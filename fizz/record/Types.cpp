@@ -86,6 +86,10 @@ std::string toString(ExtensionType extType) {
       return "signature_algorithms";
     case ExtensionType::application_layer_protocol_negotiation:
       return "application_layer_protocol_negotiation";
+    case ExtensionType::client_certificate_type:
+      return "client_certificate_type";
+    case ExtensionType::server_certificate_type:
+      return "server_certificate_type";
     case ExtensionType::token_binding:
       return "token_binding";
     case ExtensionType::quic_transport_parameters:
@@ -204,6 +208,16 @@ std::string toString(PskKeyExchangeMode pskKeMode) {
   return enumToHex(pskKeMode);
 }
 
+std::string toString(CertificateType certType) {
+  switch (certType) {
+    case CertificateType::X509:
+      return "X509";
+    case CertificateType::RawPublicKey:
+      return "RawPublicKey";
+  }
+  return enumToHex(certType);
+}
+
 std::string toString(SignatureScheme sigScheme) {
   switch (sigScheme) {
     case SignatureScheme::ecdsa_secp256r1_sha256:
@@ -92,6 +92,8 @@ enum class ExtensionType : uint16_t {
   supported_groups = 10,
   signature_algorithms = 13,
   application_layer_protocol_negotiation = 16,
+  client_certificate_type = 19,
+  server_certificate_type = 20,
   token_binding = 24,
   quic_transport_parameters = 26,
   key_share_old = 40,
@@ -158,6 +160,10 @@ enum class PskKeyExchangeMode : uint8_t { psk_ke = 0, psk_dhe_ke = 1 };
 
 std::string toString(PskKeyExchangeMode);
 
+enum class CertificateType : uint8_t { X509 = 0, RawPublicKey = 2 };
+
+std::string toString(CertificateType);
+
 struct Extension {
   ExtensionType extension_type;
   Buf extension_data; // Limited to 2^16-1 bytes.
@@ -0,0 +1,278 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/record/ClientHelloView.h>
+#include <folly/String.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace test {
+
+class ClientHelloViewTest : public Test {
+ protected:
+  static ClientHello makeClientHello() {
+    ClientHello chlo;
+    chlo.legacy_version = ProtocolVersion::tls_1_2;
+    chlo.random.fill(0x44);
+    chlo.legacy_session_id = IOBuf::copyBuffer("sessionid");
+    chlo.cipher_suites.push_back(CipherSuite::TLS_AES_128_GCM_SHA256);
+    chlo.cipher_suites.push_back(CipherSuite::TLS_AES_256_GCM_SHA384);
+    chlo.legacy_compression_methods.push_back(0x00);
+    SupportedVersions supportedVersions;
+    supportedVersions.versions.push_back(ProtocolVersion::tls_1_3);
+    chlo.extensions.push_back(encodeExtension(std::move(supportedVersions)));
+    SupportedGroups supportedGroups;
+    supportedGroups.named_group_list.push_back(NamedGroup::x25519);
+    chlo.extensions.push_back(encodeExtension(std::move(supportedGroups)));
+    ClientKeyShare keyShare;
+    KeyShareEntry entry;
+    entry.group = NamedGroup::x25519;
+    entry.key_exchange = IOBuf::copyBuffer("keyshare");
+    keyShare.client_shares.push_back(std::move(entry));
+    chlo.extensions.push_back(encodeExtension(std::move(keyShare)));
+    ServerNameList sni;
+    ServerName sn;
+    sn.hostname = IOBuf::copyBuffer("www.hostname.com");
+    sni.server_name_list.push_back(std::move(sn));
+    chlo.extensions.push_back(encodeExtension(std::move(sni)));
+    return chlo;
+  }
+
+  void setEncoding(ClientHello&& chlo) {
+    encoding_ = encode(std::move(chlo));
+    encoding_->coalesce();
+  }
+
+  ByteRange encoding() const {
+    return encoding_->coalesce();
+  }
+
+  Buf encoding_;
+};
+
+TEST_F(ClientHelloViewTest, TestFields) {
+  setEncoding(makeClientHello());
+  ClientHelloView view(encoding());
+
+  EXPECT_EQ(view.legacyVersion(), ProtocolVersion::tls_1_2);
+  Random random;
+  random.fill(0x44);
+  EXPECT_TRUE(view.random() == range(random));
+  EXPECT_EQ(StringPiece(view.legacySessionId()), "sessionid");
+  ASSERT_EQ(view.numCipherSuites(), 2);
+  EXPECT_EQ(view.cipherSuite(0), CipherSuite::TLS_AES_128_GCM_SHA256);
+  EXPECT_EQ(view.cipherSuite(1), CipherSuite::TLS_AES_256_GCM_SHA384);
+  EXPECT_THROW(view.cipherSuite(2), std::out_of_range);
+  EXPECT_EQ(view.legacyCompressionMethods().size(), 1);
+  EXPECT_EQ(view.numExtensions(), 4);
+  EXPECT_FALSE(view.hasDuplicateExtensions());
+}
+
+TEST_F(ClientHelloViewTest, TestGetExtension) {
+  setEncoding(makeClientHello());
+  ClientHelloView view(encoding());
+
+  EXPECT_TRUE(view.hasExtension(ExtensionType::supported_versions));
+  EXPECT_FALSE(view.hasExtension(ExtensionType::cookie));
+  EXPECT_FALSE(view.getExtension<Cookie>().hasValue());
+
+  auto versions = view.getExtension<SupportedVersions>();
+  ASSERT_TRUE(versions.hasValue());
+  EXPECT_EQ(
+      versions->versions,
+      std::vector<ProtocolVersion>({ProtocolVersion::tls_1_3}));
+
+  auto sni = view.getExtension<ServerNameList>();
+  ASSERT_TRUE(sni.hasValue());
+  EXPECT_EQ(
+      StringPiece(sni->server_name_list[0].hostname->coalesce()),
+      "www.hostname.com");
+
+  auto keyShare = view.getExtension<ClientKeyShare>();
+  ASSERT_TRUE(keyShare.hasValue());
+  EXPECT_FALSE(keyShare->preDraft23);
+  ASSERT_EQ(keyShare->client_shares.size(), 1);
+  EXPECT_EQ(keyShare->client_shares[0].group, NamedGroup::x25519);
+}
+
+TEST_F(ClientHelloViewTest, TestBackingOutlivesView) {
+  setEncoding(makeClientHello());
+  folly::Optional<ServerNameList> sni;
+  {
+    ClientHelloView view(encoding(), encoding_.get());
+    sni = view.getExtension<ServerNameList>();
+  }
+  encoding_.reset();
+  ASSERT_TRUE(sni.hasValue());
+  EXPECT_EQ(
+      StringPiece(sni->server_name_list[0].hostname->coalesce()),
+      "www.hostname.com");
+}
+
+TEST_F(ClientHelloViewTest, TestMatchesDecode) {
+  setEncoding(makeClientHello());
+  ClientHelloView view(encoding());
+  auto chlo = decode<ClientHello>(encoding_->clone());
+
+  ASSERT_EQ(view.numExtensions(), chlo.extensions.size());
+  for (const auto& ext : chlo.extensions) {
+    auto data = view.getExtensionData(ext.extension_type);
+    ASSERT_TRUE(data.hasValue());
+    EXPECT_EQ(
+        StringPiece(*data), StringPiece(ext.extension_data->coalesce()));
+  }
+}
+
+TEST_F(ClientHelloViewTest, TestPreDraft23KeyShare) {
+  auto chlo = makeClientHello();
+  for (auto& ext : chlo.extensions) {
+    if (ext.extension_type == ExtensionType::key_share) {
+      ext.extension_type = ExtensionType::key_share_old;
+    }
+  }
+  setEncoding(std::move(chlo));
+  ClientHelloView view(encoding());
+
+  auto keyShare = view.getExtension<ClientKeyShare>();
+  ASSERT_TRUE(keyShare.hasValue());
+  EXPECT_TRUE(keyShare->preDraft23);
+}
+
+TEST_F(ClientHelloViewTest, TestNoExtensions) {
+  auto chlo = makeClientHello();
+  chlo.extensions.clear();
+  setEncoding(std::move(chlo));
+  // Strip the (empty) extensions block entirely.
+  encoding_->trimEnd(2);
+  ClientHelloView view(encoding());
+
+  EXPECT_EQ(view.numExtensions(), 0);
+  EXPECT_FALSE(view.hasExtension(ExtensionType::supported_versions));
+}
+
+TEST_F(ClientHelloViewTest, TestDuplicateExtensions) {
+  auto chlo = makeClientHello();
+  SupportedVersions supportedVersions;
+  supportedVersions.versions.push_back(ProtocolVersion::tls_1_2);
+  chlo.extensions.push_back(encodeExtension(std::move(supportedVersions)));
+  setEncoding(std::move(chlo));
+  ClientHelloView view(encoding());
+
+  EXPECT_TRUE(view.hasDuplicateExtensions());
+  // As with the vector lookup, the first occurrence wins.
+  auto versions = view.getExtension<SupportedVersions>();
+  EXPECT_EQ(
+      versions->versions,
+      std::vector<ProtocolVersion>({ProtocolVersion::tls_1_3}));
+}
+
+TEST_F(ClientHelloViewTest, TestDuplicateUnindexedType) {
+  auto chlo = makeClientHello();
+  chlo.extensions.push_back(
+      Extension{static_cast<ExtensionType>(0xfe00), IOBuf::copyBuffer("a")});
+  chlo.extensions.push_back(
+      Extension{static_cast<ExtensionType>(0xfe00), IOBuf::copyBuffer("b")});
+  setEncoding(std::move(chlo));
+  ClientHelloView view(encoding());
+
+  EXPECT_TRUE(view.hasDuplicateExtensions());
+  EXPECT_EQ(
+      StringPiece(*view.getExtensionData(static_cast<ExtensionType>(0xfe00))),
+      "a");
+}
+
+TEST_F(ClientHelloViewTest, TestManyExtensions) {
+  auto chlo = makeClientHello();
+  chlo.extensions.clear();
+  for (uint16_t i = 0; i < ClientHelloView::kMaxIndexedExtensions + 8; ++i) {
+    chlo.extensions.push_back(Extension{static_cast<ExtensionType>(0x1000 + i),
+                                        IOBuf::copyBuffer(to<std::string>(i))});
+  }
+  Cookie cookie;
+  cookie.cookie = IOBuf::copyBuffer("cookie");
+  chlo.extensions.push_back(encodeExtension(std::move(cookie)));
+  setEncoding(std::move(chlo));
+  ClientHelloView view(encoding());
+
+  EXPECT_EQ(view.numExtensions(), ClientHelloView::kMaxIndexedExtensions + 9);
+  EXPECT_FALSE(view.hasDuplicateExtensions());
+  EXPECT_EQ(
+      StringPiece(*view.getExtensionData(static_cast<ExtensionType>(0x1000))),
+      "0");
+  EXPECT_EQ(
+      StringPiece(*view.getExtensionData(static_cast<ExtensionType>(
+          0x1000 + ClientHelloView::kMaxIndexedExtensions + 7))),
+      "39");
+  auto cookieExt = view.getExtension<Cookie>();
+  ASSERT_TRUE(cookieExt.hasValue());
+  EXPECT_EQ(StringPiece(cookieExt->cookie->coalesce()), "cookie");
+}
+
+TEST_F(ClientHelloViewTest, TestDuplicateAfterIndex) {
+  auto chlo = makeClientHello();
+  for (uint16_t i = 0; i < ClientHelloView::kMaxIndexedExtensions; ++i) {
+    chlo.extensions.push_back(Extension{static_cast<ExtensionType>(0x1000 + i),
+                                        IOBuf::copyBuffer("x")});
+  }
+  SupportedGroups supportedGroups;
+  supportedGroups.named_group_list.push_back(NamedGroup::secp256r1);
+  chlo.extensions.push_back(encodeExtension(std::move(supportedGroups)));
+  setEncoding(std::move(chlo));
+  ClientHelloView view(encoding());
+
+  EXPECT_TRUE(view.hasDuplicateExtensions());
+}
+
+TEST_F(ClientHelloViewTest, TestTruncated) {
+  setEncoding(makeClientHello());
+  auto full = encoding();
+  for (size_t len = 0; len < full.size(); ++len) {
+    if (len == 2 + 32 + 1 + 9 + 2 + 4 + 1 + 1) {
+      // Truncating exactly before the extensions block is a valid pre-TLS 1.3
+      // ClientHello.
+      EXPECT_NO_THROW(ClientHelloView(full.subpiece(0, len)));
+      continue;
+    }
+    EXPECT_THROW(ClientHelloView(full.subpiece(0, len)), std::runtime_error)
+        << "length " << len;
+  }
+}
+
+TEST_F(ClientHelloViewTest, TestTrailingData) {
+  setEncoding(makeClientHello());
+  auto withTrailing = encoding_->clone();
+  withTrailing->prependChain(IOBuf::copyBuffer("x"));
+  EXPECT_THROW(ClientHelloView(withTrailing->coalesce()), std::runtime_error);
+}
+
+TEST_F(ClientHelloViewTest, TestOddCipherSuites) {
+  setEncoding(makeClientHello());
+  auto buf = IOBuf::copyBuffer(encoding());
+  // Cipher suite vector length follows version, random and session id.
+  auto lengthOffset = 2 + 32 + 1 + 9;
+  buf->writableData()[lengthOffset + 1] = 3;
+  EXPECT_THROW(ClientHelloView(buf->coalesce()), std::runtime_error);
+}
+
+TEST_F(ClientHelloViewTest, TestExtensionTrailingData) {
+  auto chlo = makeClientHello();
+  chlo.extensions.push_back(
+      Extension{ExtensionType::supported_groups,
+                IOBuf::copyBuffer(unhexlify("0002001dff"))});
+  chlo.extensions.erase(chlo.extensions.begin() + 1);
+  setEncoding(std::move(chlo));
+  ClientHelloView view(encoding());
+  EXPECT_THROW(view.getExtension<SupportedGroups>(), std::runtime_error);
+}
+} // namespace test
+} // namespace fizz
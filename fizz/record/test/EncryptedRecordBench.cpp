@@ -4,6 +4,7 @@
 #include <folly/Benchmark.h>
 #include <folly/Random.h>
 #include <folly/init/Init.h>
+#include <folly/io/Cursor.h>
 #include <folly/ssl/Init.h>
 
 #include <fizz/crypto/aead/AESGCM128.h>
@@ -96,6 +97,128 @@ BENCHMARK_PARAM(encryptOCB, 4000);
 BENCHMARK_PARAM(encryptOCB, 8000);
 #endif
 
+/**
+ * Decrypts records of the given size that arrive split into buffers of
+ * chunkSize bytes, as they do when read from the transport (0 for contiguous
+ * records).
+ */
+void decryptGCM(uint32_t n, size_t size, size_t chunkSize) {
+  EncryptedReadRecordLayer read;
+  std::vector<folly::IOBufQueue> records;
+  BENCHMARK_SUSPEND {
+    EncryptedWriteRecordLayer write;
+    auto writeAead = std::make_unique<OpenSSLEVPCipher<AESGCM128>>();
+    writeAead->setKey(getKey());
+    write.setAead(std::move(writeAead));
+    auto readAead = std::make_unique<OpenSSLEVPCipher<AESGCM128>>();
+    readAead->setKey(getKey());
+    read.setAead(std::move(readAead));
+    for (size_t i = 0; i < n; ++i) {
+      auto record = write.write(
+          TLSMessage{ContentType::application_data, makeRandom(size)});
+      record->coalesce();
+      folly::IOBufQueue queue(folly::IOBufQueue::cacheChainLength());
+      if (chunkSize == 0) {
+        queue.append(std::move(record));
+      } else {
+        folly::io::Cursor cursor(record.get());
+        while (!cursor.isAtEnd()) {
+          std::unique_ptr<folly::IOBuf> chunk;
+          cursor.clone(chunk, std::min(chunkSize, cursor.totalLength()));
+          chunk->coalesce();
+          queue.append(std::move(chunk));
+        }
+      }
+      records.push_back(std::move(queue));
+    }
+  }
+
+  folly::Optional<TLSMessage> msg;
+  for (auto& record : records) {
+    msg = read.read(record);
+  }
+  doNotOptimizeAway(msg);
+}
+
+BENCHMARK_NAMED_PARAM(decryptGCM, 16000_contiguous, 16000, 0);
+BENCHMARK_RELATIVE_NAMED_PARAM(decryptGCM, 16000_chunks_of_4000, 16000, 4000);
+BENCHMARK_RELATIVE_NAMED_PARAM(decryptGCM, 16000_chunks_of_1460, 16000, 1460);
+BENCHMARK_RELATIVE_NAMED_PARAM(decryptGCM, 16000_chunks_of_100, 16000, 100);
+BENCHMARK_NAMED_PARAM(decryptGCM, 4000_contiguous, 4000, 0);
+BENCHMARK_RELATIVE_NAMED_PARAM(decryptGCM, 4000_chunks_of_1460, 4000, 1460);
+
+namespace {
+class AppBufferProvider : public DecryptionBufferProvider {
+ public:
+  explicit AppBufferProvider(std::vector<uint8_t>& appBuffer)
+      : appBuffer_(appBuffer) {}
+
+  std::unique_ptr<folly::IOBuf> getDecryptionBuffer(size_t) override {
+    auto buf = folly::IOBuf::wrapBuffer(appBuffer_.data(), appBuffer_.size());
+    buf->clear();
+    return buf;
+  }
+
+  void releaseDecryptionBuffer() override {}
+
+ private:
+  std::vector<uint8_t>& appBuffer_;
+};
+} // namespace
+
+/**
+ * Delivers decrypted records into an application owned buffer, as done for
+ * read callbacks that don't take buffer ownership. Either the record is
+ * decrypted into a record layer buffer and then copied, or it is decrypted
+ * in place through a DecryptionBufferProvider.
+ */
+void decryptIntoAppBufferGCM(uint32_t n, size_t size, bool provided) {
+  EncryptedReadRecordLayer read;
+  std::vector<folly::IOBufQueue> records;
+  std::vector<uint8_t> appBuffer(size);
+  AppBufferProvider provider(appBuffer);
+  BENCHMARK_SUSPEND {
+    EncryptedWriteRecordLayer write;
+    auto writeAead = std::make_unique<OpenSSLEVPCipher<AESGCM128>>();
+    writeAead->setKey(getKey());
+    write.setAead(std::move(writeAead));
+    auto readAead = std::make_unique<OpenSSLEVPCipher<AESGCM128>>();
+    readAead->setKey(getKey());
+    read.setAead(std::move(readAead));
+    if (provided) {
+      read.setDecryptionBufferProvider(&provider);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      folly::IOBufQueue queue(folly::IOBufQueue::cacheChainLength());
+      queue.append(write.write(
+          TLSMessage{ContentType::application_data, makeRandom(size)}));
+      records.push_back(std::move(queue));
+    }
+  }
+
+  for (auto& record : records) {
+    auto msg = read.read(record);
+    if (!provided) {
+      folly::io::Cursor(msg->fragment.get())
+          .pull(appBuffer.data(), msg->fragment->computeChainDataLength());
+    }
+    doNotOptimizeAway(msg);
+  }
+}
+
+BENCHMARK_NAMED_PARAM(decryptIntoAppBufferGCM, 16000_copy, 16000, false);
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    decryptIntoAppBufferGCM,
+    16000_provided,
+    16000,
+    true);
+BENCHMARK_NAMED_PARAM(decryptIntoAppBufferGCM, 1000_copy, 1000, false);
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    decryptIntoAppBufferGCM,
+    1000_provided,
+    1000,
+    true);
+
 int main(int argc, char** argv) {
   folly::init(&argc, &argv);
   folly::ssl::init();
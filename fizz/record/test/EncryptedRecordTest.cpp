@@ -23,6 +23,12 @@ using namespace testing;
 namespace fizz {
 namespace test {
 
+class MockDecryptionBufferProvider : public DecryptionBufferProvider {
+ public:
+  MOCK_METHOD1(getDecryptionBuffer, std::unique_ptr<IOBuf>(size_t));
+  MOCK_METHOD0(releaseDecryptionBuffer, void());
+};
+
 class EncryptedRecordTest : public testing::Test {
   void SetUp() override {
     auto readAead = std::make_unique<MockAead>();
@@ -102,6 +108,90 @@ TEST_F(EncryptedRecordTest, TestReadAppData) {
   EXPECT_TRUE(queue_.empty());
 }
 
+TEST_F(EncryptedRecordTest, TestReadAppDataIntoProvidedBuffer) {
+  MockDecryptionBufferProvider provider;
+  read_.setDecryptionBufferProvider(&provider);
+  std::array<uint8_t, 20> memory;
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(*readAead_, getCipherOverhead()).WillRepeatedly(Return(1));
+  EXPECT_CALL(provider, getDecryptionBuffer(4))
+      .WillOnce(InvokeWithoutArgs([&]() {
+        auto buf = IOBuf::wrapBuffer(memory.data(), memory.size());
+        buf->clear();
+        return buf;
+      }));
+  EXPECT_CALL(*readAead_, _tryDecryptInto(_, _, 0, _))
+      .WillOnce(Invoke(
+          [](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t, IOBuf& out) {
+            expectSame(buf, "0123456789");
+            auto plaintext = unhexlify("1234ab17");
+            memcpy(out.writableTail(), plaintext.data(), plaintext.size());
+            out.append(plaintext.size());
+            return true;
+          }));
+  EXPECT_CALL(provider, releaseDecryptionBuffer()).Times(0);
+  auto msg = read_.read(queue_);
+  EXPECT_EQ(msg->type, ContentType::application_data);
+  EXPECT_EQ(msg->fragment->data(), memory.data());
+  expectSame(msg->fragment, "1234ab");
+  EXPECT_TRUE(queue_.empty());
+
+  // The sequence number advances as usual.
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(provider, getDecryptionBuffer(4)).WillOnce(Return(nullptr));
+  EXPECT_CALL(*readAead_, _decrypt(_, _, 1))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>&, const IOBuf*, uint64_t) {
+        return getBuf("1234abcd17");
+      }));
+  msg = read_.read(queue_);
+  expectSame(msg->fragment, "1234abcd");
+}
+
+TEST_F(EncryptedRecordTest, TestReadHandshakeIntoProvidedBuffer) {
+  MockDecryptionBufferProvider provider;
+  read_.setDecryptionBufferProvider(&provider);
+  std::array<uint8_t, 20> memory;
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(*readAead_, getCipherOverhead()).WillRepeatedly(Return(1));
+  EXPECT_CALL(provider, getDecryptionBuffer(4))
+      .WillOnce(InvokeWithoutArgs([&]() {
+        auto buf = IOBuf::wrapBuffer(memory.data(), memory.size());
+        buf->clear();
+        return buf;
+      }));
+  EXPECT_CALL(*readAead_, _tryDecryptInto(_, _, 0, _))
+      .WillOnce(Invoke(
+          [](std::unique_ptr<IOBuf>&, const IOBuf*, uint64_t, IOBuf& out) {
+            auto plaintext = unhexlify("abcd16");
+            memcpy(out.writableTail(), plaintext.data(), plaintext.size());
+            out.append(plaintext.size());
+            return true;
+          }));
+  EXPECT_CALL(provider, releaseDecryptionBuffer());
+  auto msg = read_.read(queue_);
+  EXPECT_EQ(msg->type, ContentType::handshake);
+  // Handshake data must not stay in the provided buffer.
+  EXPECT_NE(msg->fragment->data(), memory.data());
+  expectSame(msg->fragment, "abcd");
+}
+
+TEST_F(EncryptedRecordTest, TestReadIntoProvidedBufferFails) {
+  MockDecryptionBufferProvider provider;
+  read_.setDecryptionBufferProvider(&provider);
+  std::array<uint8_t, 20> memory;
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(*readAead_, getCipherOverhead()).WillRepeatedly(Return(1));
+  EXPECT_CALL(provider, getDecryptionBuffer(4))
+      .WillOnce(InvokeWithoutArgs([&]() {
+        auto buf = IOBuf::wrapBuffer(memory.data(), memory.size());
+        buf->clear();
+        return buf;
+      }));
+  EXPECT_CALL(*readAead_, _tryDecryptInto(_, _, 0, _)).WillOnce(Return(false));
+  EXPECT_CALL(provider, releaseDecryptionBuffer());
+  EXPECT_ANY_THROW(read_.read(queue_));
+}
+
 TEST_F(EncryptedRecordTest, TestReadUnknown) {
   addToQueue("17030100050123456789");
   EXPECT_CALL(*readAead_, _decrypt(_, _, 0))
@@ -26,6 +26,10 @@ StringPiece clientEarlyData{"002a0000"};
 StringPiece serverEarlyData{"002a0000"};
 StringPiece ticketEarlyData{"002a000400000005"};
 StringPiece cookie{"002c00080006636f6f6b6965"};
+StringPiece serverCertTypes{"00140003020200"};
+StringPiece selectedServerCertType{"0014000102"};
+StringPiece clientCertTypes{"001300020102"};
+StringPiece selectedClientCertType{"0013000100"};
 StringPiece authorities{
     "002f005400520028434e3d4c696d696e616c6974792c204f553d46697a7a2c204f3d46616365626f6f6b2c20433d55530026434e3d457465726e6974792c204f553d46697a7a2c204f3d46616365626f6f6b2c20433d5553"};
 
@@ -115,6 +119,35 @@ TEST_F(ExtensionsTest, TestCertificateAuthorities) {
   checkEncode(std::move(*ext), authorities);
 }
 
+TEST_F(ExtensionsTest, TestServerCertificateTypes) {
+  auto exts = getExtensions(serverCertTypes);
+  auto ext = getExtension<ServerCertificateTypes>(exts);
+  EXPECT_EQ(
+      ext->certificate_types,
+      std::vector<CertificateType>(
+          {CertificateType::RawPublicKey, CertificateType::X509}));
+  checkEncode(std::move(*ext), serverCertTypes);
+
+  exts = getExtensions(selectedServerCertType);
+  auto selected = getExtension<SelectedServerCertificateType>(exts);
+  EXPECT_EQ(selected->certificate_type, CertificateType::RawPublicKey);
+  checkEncode(std::move(*selected), selectedServerCertType);
+}
+
+TEST_F(ExtensionsTest, TestClientCertificateTypes) {
+  auto exts = getExtensions(clientCertTypes);
+  auto ext = getExtension<ClientCertificateTypes>(exts);
+  EXPECT_EQ(
+      ext->certificate_types,
+      std::vector<CertificateType>({CertificateType::RawPublicKey}));
+  checkEncode(std::move(*ext), clientCertTypes);
+
+  exts = getExtensions(selectedClientCertType);
+  auto selected = getExtension<SelectedClientCertificateType>(exts);
+  EXPECT_EQ(selected->certificate_type, CertificateType::X509);
+  checkEncode(std::move(*selected), selectedClientCertType);
+}
+
 TEST_F(ExtensionsTest, TestBadlyFormedExtension) {
   auto buf = getBuf(sni);
   buf->reserve(0, 1);
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/crypto/aead/test/Mocks.h>
+#include <fizz/record/EncryptedRecordLayer.h>
+#include <fizz/record/HandshakeFlight.h>
+#include <fizz/record/PlaintextRecordLayer.h>
+#include <folly/String.h>
+
+using namespace folly;
+
+using testing::_;
+using namespace testing;
+
+namespace fizz {
+namespace test {
+
+class HandshakeFlightTest : public testing::Test {
+ protected:
+  static Buf getBuf(const std::string& hex) {
+    auto data = unhexlify(hex);
+    return IOBuf::copyBuffer(data.data(), data.size());
+  }
+
+  static void expectSame(const Buf& buf, const std::string& hex) {
+    auto str = buf->moveToFbString().toStdString();
+    EXPECT_EQ(hexlify(str), hex);
+  }
+};
+
+TEST_F(HandshakeFlightTest, TestPlaintext) {
+  PlaintextWriteRecordLayer recordLayer;
+  HandshakeFlight flight(recordLayer);
+  flight.addEncoded(getBuf("0102"));
+  flight.addEncoded(getBuf("030405"));
+  EXPECT_EQ(flight.length(), 5);
+
+  auto buf = flight.write();
+  EXPECT_TRUE(flight.empty());
+  expectSame(buf, "16030300050102030405");
+}
+
+TEST_F(HandshakeFlightTest, TestMaxLength) {
+  PlaintextWriteRecordLayer recordLayer;
+  HandshakeFlight flight(recordLayer);
+  flight.addEncoded(getBuf("0102"));
+  flight.addEncoded(getBuf("030405"));
+
+  auto first = flight.write(3);
+  expectSame(first, "1603030003010203");
+  EXPECT_EQ(flight.length(), 2);
+
+  auto second = flight.write(3);
+  expectSame(second, "16030300020405");
+  EXPECT_TRUE(flight.empty());
+}
+
+TEST_F(HandshakeFlightTest, TestEmpty) {
+  PlaintextWriteRecordLayer recordLayer;
+  HandshakeFlight flight(recordLayer);
+  EXPECT_THROW(flight.write(), std::runtime_error);
+}
+
+TEST_F(HandshakeFlightTest, TestAddMatchesEncodeHandshake) {
+  PlaintextWriteRecordLayer recordLayer;
+  HandshakeFlight flight(recordLayer);
+
+  auto makeCertVerify = []() {
+    CertificateVerify verify;
+    verify.algorithm = SignatureScheme::ecdsa_secp256r1_sha256;
+    verify.signature = IOBuf::copyBuffer("signature");
+    return verify;
+  };
+  auto makeEncryptedExt = []() {
+    EncryptedExtensions ee;
+    Extension ext;
+    ext.extension_type = ExtensionType::token_binding;
+    ext.extension_data = IOBuf::copyBuffer("someextension");
+    ee.extensions.push_back(std::move(ext));
+    return ee;
+  };
+
+  auto encodedEncryptedExt = flight.add(makeEncryptedExt());
+  EXPECT_FALSE(encodedEncryptedExt->isChained());
+  EXPECT_TRUE(IOBufEqualTo()(
+      encodedEncryptedExt, encodeHandshake(makeEncryptedExt())));
+  auto encodedCertVerify = flight.add(makeCertVerify());
+  EXPECT_FALSE(encodedCertVerify->isChained());
+  EXPECT_TRUE(
+      IOBufEqualTo()(encodedCertVerify, encodeHandshake(makeCertVerify())));
+  EXPECT_EQ(
+      flight.length(),
+      encodedEncryptedExt->length() + encodedCertVerify->length());
+}
+
+TEST_F(HandshakeFlightTest, TestPlaintextInPlace) {
+  PlaintextWriteRecordLayer recordLayer;
+  HandshakeFlight flight(recordLayer);
+  Finished finished;
+  finished.verify_data = getBuf("0102");
+  const uint8_t* messageData = flight.add(std::move(finished))->data();
+
+  auto buf = flight.write();
+  EXPECT_FALSE(buf->isChained());
+  EXPECT_EQ(buf->data() + 5, messageData);
+  expectSame(buf, "1603030006140000020102");
+}
+
+TEST_F(HandshakeFlightTest, TestEncryptedInPlace) {
+  EncryptedWriteRecordLayer recordLayer;
+  auto aead = std::make_unique<MockAead>();
+  auto aeadPtr = aead.get();
+  recordLayer.setAead(std::move(aead));
+  EXPECT_CALL(*aeadPtr, getCipherOverhead()).WillRepeatedly(Return(2));
+
+  HandshakeFlight flight(recordLayer);
+  Finished first;
+  first.verify_data = getBuf("0102");
+  const uint8_t* plaintextData = flight.add(std::move(first))->data();
+  Finished second;
+  second.verify_data = getBuf("030405");
+  flight.add(std::move(second));
+
+  EXPECT_CALL(*aeadPtr, _encrypt(_, _, 0))
+      .WillOnce(
+          Invoke([&](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+            // The messages are not copied, and there is room for the record
+            // header before the first and for the content type and tag after
+            // the last.
+            EXPECT_EQ(buf->data(), plaintextData);
+            EXPECT_FALSE(buf->isShared());
+            EXPECT_EQ(buf->headroom(), 5);
+            EXPECT_EQ(buf->computeChainDataLength(), 14);
+            auto last = buf->prev();
+            EXPECT_GE(last->tailroom(), 2);
+            memset(last->writableTail(), 0xff, 2);
+            last->append(2);
+            return std::move(buf);
+          }));
+  auto buf = flight.write();
+  EXPECT_EQ(buf->data() + 5, plaintextData);
+  expectSame(buf, "17030300101400000201021400000303040516ffff");
+}
+} // namespace test
+} // namespace fizz
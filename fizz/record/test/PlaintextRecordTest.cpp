@@ -137,6 +137,17 @@ TEST_F(PlaintextRecordTest, TestWriteHandshake) {
   expectSame(buf, "16030300051234567890");
 }
 
+TEST_F(PlaintextRecordTest, TestWriteHandshakeInPlace) {
+  auto data = unhexlify("1234567890");
+  TLSMessage msg{ContentType::handshake,
+                 IOBuf::copyBuffer(data.data(), data.size(), 5, 0)};
+  auto fragment = msg.fragment.get();
+  auto buf = write_.write(std::move(msg));
+  EXPECT_EQ(buf.get(), fragment);
+  EXPECT_FALSE(buf->isChained());
+  expectSame(buf, "16030300051234567890");
+}
+
 TEST_F(PlaintextRecordTest, TestWriteClientHello) {
   auto buf = write_.writeInitialClientHello(getBuf("1234567890"));
   expectSame(buf, "16030100051234567890");
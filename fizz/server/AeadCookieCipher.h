@@ -34,6 +34,13 @@ class AeadCookieCipher : public CookieCipher {
     return tokenCipher_.setSecrets(cookieSecrets);
   }
 
+  /**
+   * Set the format used for newly issued cookies. See AeadTokenCipher.h.
+   */
+  void setTokenFormat(TokenFormat format) {
+    tokenCipher_.setTokenFormat(format);
+  }
+
   /**
    * Set the Fizz context to use when negotiating the parameters for a stateless
    * hello retry request.
@@ -40,6 +40,13 @@ class AeadTicketCipher : public TicketCipher {
     return tokenCipher_.setSecrets(ticketSecrets);
   }
 
+  /**
+   * Set the format used for newly issued tickets. See AeadTokenCipher.h.
+   */
+  void setTokenFormat(TokenFormat format) {
+    tokenCipher_.setTokenFormat(format);
+  }
+
   void setContext(const FizzServerContext* context) {
     context_ = context;
   }
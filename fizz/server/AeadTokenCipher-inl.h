@@ -14,12 +14,20 @@ namespace fizz {
 namespace server {
 
 /*
- * Token structure:
+ * Token structure (V1):
  *
  * 32 bytes salt
  * 4 bytes sequence number
  * remaining data ciphertext
  *
+ * Token structure (V2):
+ *
+ * 1 byte version (2)
+ * 4 bytes key ID
+ * 32 bytes salt
+ * 4 bytes sequence number
+ * remaining data ciphertext, with the preceding header as associated data
+ *
  * secret = HKDF-Extract(Codec label, token secret)
  * if (PSK context)
  *   secret = HKDF-Extract(PSK context, secret)
@@ -27,10 +35,17 @@ namespace server {
  * (aead key | aead iv) = HKDF-Expand(
  *     secret, salt, key length + iv length)
  *
+ * key ID = HKDF-Expand(secret, "Fizz token key id", 4)
+ *
  * The 32 byte salt is used to derive an aead key with sufficient space such
- * that the salts can be generated randomly without worry of collisions. The
- * sequence number is currently always 0 when encrypting tokens, however it
- * could be incremented to avoid an extra HKDF-Expand on every token.
+ * that the salts can be generated randomly without worry of collisions. V1
+ * tokens always use sequence number 0 with a fresh salt. V2 tokens reuse a
+ * salt for many tokens, incrementing the sequence number, so that both sides
+ * can cache the derived aead rather than running HKDF-Expand per token. The
+ * key ID lets decryption pick the right secret without trying each of them.
+ *
+ * A V1 token may happen to start with the V2 version byte, so decryption
+ * falls back to V1 if a token does not decrypt as V2.
  */
 
 template <typename AeadType, typename HkdfType>
@@ -46,29 +61,48 @@ bool AeadTokenCipher<AeadType, HkdfType>::setSecrets(
   }
 
   VLOG(4) << "Updating token secrets, num=" << tokenSecrets.size();
-  clearSecrets();
+  auto secrets = std::make_shared<SecretSet>();
+  secrets->generation = nextGeneration();
   for (const auto& tokenSecret : tokenSecrets) {
     Secret extracted(tokenSecret.begin(), tokenSecret.end());
     for (const auto& contextString : contextStrings_) {
       extracted = HkdfType().extract(
           folly::range(contextString), folly::range(extracted));
     }
-    secrets_.push_back(std::move(extracted));
+    secrets->keyIds.push_back(computeKeyId(folly::range(extracted)));
+    secrets->secrets.push_back(std::move(extracted));
   }
+  // Threads still using the previous set keep it alive until they are done.
+  secrets_.store(std::move(secrets));
   return true;
 }
 
 template <typename AeadType, typename HkdfType>
 folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::encrypt(
     Buf plaintext) const {
-  if (secrets_.empty()) {
+  auto secrets = secrets_.load();
+  if (!secrets || secrets->secrets.empty()) {
     return folly::none;
   }
 
+  switch (format_.load()) {
+    case TokenFormat::V1:
+      return encryptV1(*secrets, std::move(plaintext));
+    case TokenFormat::V2:
+      return encryptV2(*secrets, std::move(plaintext));
+  }
+  return folly::none;
+}
+
+template <typename AeadType, typename HkdfType>
+folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::encryptV1(
+    const SecretSet& secrets,
+    Buf plaintext) const {
   auto salt = RandomGenerator<kSaltLength>().generateRandom();
-  auto aead = createAead(folly::range(secrets_.front()), folly::range(salt));
+  auto aead =
+      createAead(folly::range(secrets.secrets.front()), folly::range(salt));
 
-  // For now we always use sequence number 0.
+  // V1 tokens always use sequence number 0.
   SeqNum seqNum = 0;
   auto token = folly::IOBuf::create(kTokenHeaderLength);
   folly::io::Appender appender(token.get(), kTokenHeaderLength);
@@ -79,11 +113,63 @@ folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::encrypt(
   return std::move(token);
 }
 
+template <typename AeadType, typename HkdfType>
+folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::encryptV2(
+    const SecretSet& secrets,
+    Buf plaintext) const {
+  auto& state = threadState_->get()->encryptState;
+  if (state.generation != secrets.generation || !state.aead ||
+      state.nextSeqNum == kMaxTokensPerSalt) {
+    state.salt = RandomGenerator<kSaltLength>().generateRandom();
+    state.aead.emplace(createAead(
+        folly::range(secrets.secrets.front()), folly::range(state.salt)));
+    state.nextSeqNum = 0;
+    state.generation = secrets.generation;
+  }
+
+  auto seqNum = state.nextSeqNum++;
+  auto token = folly::IOBuf::create(kV2TokenHeaderLength);
+  folly::io::Appender appender(token.get(), kV2TokenHeaderLength);
+  appender.writeBE(kV2Version);
+  appender.writeBE(secrets.keyIds.front());
+  appender.push(folly::range(state.salt));
+  appender.writeBE(seqNum);
+  token->prependChain(
+      state.aead->encrypt(std::move(plaintext), token.get(), seqNum));
+
+  return std::move(token);
+}
+
 template <typename AeadType, typename HkdfType>
 folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::decrypt(
     Buf token) const {
+  auto secrets = secrets_.load();
+  if (!secrets || secrets->secrets.empty()) {
+    return folly::none;
+  }
+
+  folly::io::Cursor cursor(token.get());
+  if (cursor.canAdvance(kV2TokenHeaderLength) &&
+      cursor.read<uint8_t>() == kV2Version) {
+    auto result = decryptV2(*secrets, token);
+    if (result) {
+      return result;
+    }
+  }
+
+  auto result = decryptV1(*secrets, token);
+  if (!result) {
+    VLOG(6) << "Failed to decrypt token.";
+  }
+  return result;
+}
+
+template <typename AeadType, typename HkdfType>
+folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::decryptV1(
+    const SecretSet& secrets,
+    const Buf& token) const {
   folly::io::Cursor cursor(token.get());
-  if (secrets_.empty() || !cursor.canAdvance(kTokenHeaderLength)) {
+  if (!cursor.canAdvance(kTokenHeaderLength)) {
     return folly::none;
   }
 
@@ -93,18 +179,67 @@ folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::decrypt(
   Buf ciphertext;
   cursor.clone(ciphertext, cursor.totalLength());
 
-  for (const auto& secret : secrets_) {
+  for (const auto& secret : secrets.secrets) {
     auto aead = createAead(folly::range(secret), folly::range(salt));
     auto result = aead.tryDecrypt(ciphertext->clone(), nullptr, seqNum);
     if (result) {
       return std::move(result);
     }
   }
+  return folly::none;
+}
 
-  VLOG(6) << "Failed to decrypt token.";
+template <typename AeadType, typename HkdfType>
+folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::decryptV2(
+    const SecretSet& secrets,
+    const Buf& token) const {
+  folly::io::Cursor cursor(token.get());
+  Buf header;
+  cursor.clone(header, kV2TokenHeaderLength);
+  header->coalesce();
+  Buf ciphertext;
+  cursor.clone(ciphertext, cursor.totalLength());
+
+  folly::io::Cursor headerCursor(header.get());
+  headerCursor.skip(sizeof(uint8_t));
+  auto keyId = headerCursor.readBE<KeyId>();
+  Salt salt;
+  headerCursor.pull(salt.data(), salt.size());
+  auto seqNum = headerCursor.readBE<SeqNum>();
+
+  // Key IDs are only 4 bytes so in the unlikely event of a collision try every
+  // matching secret.
+  for (size_t i = 0; i < secrets.keyIds.size(); ++i) {
+    if (secrets.keyIds[i] != keyId) {
+      continue;
+    }
+    const auto& aead = getCachedAead(secrets, i, salt);
+    auto result = aead.tryDecrypt(ciphertext->clone(), header.get(), seqNum);
+    if (result) {
+      return std::move(result);
+    }
+  }
   return folly::none;
 }
 
+template <typename AeadType, typename HkdfType>
+const AeadType& AeadTokenCipher<AeadType, HkdfType>::getCachedAead(
+    const SecretSet& secrets,
+    size_t secretIndex,
+    const Salt& salt) const {
+  auto& entry =
+      threadState_->get()->decryptCache[salt.front() % kDecryptCacheSize];
+  if (entry.generation != secrets.generation ||
+      entry.secretIndex != secretIndex || entry.salt != salt || !entry.aead) {
+    entry.aead.emplace(createAead(
+        folly::range(secrets.secrets[secretIndex]), folly::range(salt)));
+    entry.generation = secrets.generation;
+    entry.secretIndex = secretIndex;
+    entry.salt = salt;
+  }
+  return *entry.aead;
+}
+
 template <typename AeadType, typename HkdfType>
 AeadType AeadTokenCipher<AeadType, HkdfType>::createAead(
     folly::ByteRange secret,
@@ -122,11 +257,20 @@ AeadType AeadTokenCipher<AeadType, HkdfType>::createAead(
 }
 
 template <typename AeadType, typename HkdfType>
-void AeadTokenCipher<AeadType, HkdfType>::clearSecrets() {
-  for (auto& secret : secrets_) {
+typename AeadTokenCipher<AeadType, HkdfType>::KeyId
+AeadTokenCipher<AeadType, HkdfType>::computeKeyId(
+    folly::ByteRange secret) const {
+  auto info = folly::IOBuf::copyBuffer("Fizz token key id");
+  auto keyId = HkdfType().expand(secret, *info, sizeof(KeyId));
+  folly::io::Cursor cursor(keyId.get());
+  return cursor.readBE<KeyId>();
+}
+
+template <typename AeadType, typename HkdfType>
+AeadTokenCipher<AeadType, HkdfType>::SecretSet::~SecretSet() {
+  for (auto& secret : secrets) {
     CryptoUtils::clean(folly::range(secret));
   }
-  secrets_.clear();
 }
 } // namespace server
 } // namespace fizz
@@ -10,13 +10,35 @@
 
 #include <fizz/record/Types.h>
 #include <folly/Optional.h>
+#include <folly/ThreadLocal.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
 #include <folly/io/IOBuf.h>
 
+#include <atomic>
+
 namespace fizz {
 namespace server {
 
+/**
+ * Format used when encrypting tokens. Tokens of either format can always be
+ * decrypted, so V2 should only be enabled once every server sharing the token
+ * secrets is able to decrypt it.
+ */
+enum class TokenFormat {
+  // A fresh salt, and therefore a fresh key derivation, for every token.
+  V1,
+  // Tagged with the secret's key ID, and salts are reused across many tokens
+  // with an incrementing sequence number so that derived keys can be cached.
+  V2,
+};
+
 /**
  * Used to encrypt and decrypt various tokens (for example PSKs).
+ *
+ * All methods may be called concurrently from multiple threads. Secrets are
+ * held in an immutable set that setSecrets() replaces atomically, so secrets
+ * can be rotated while tokens are being encrypted and decrypted without
+ * taking any locks on those paths.
  */
 template <typename AeadType, typename HkdfType>
 class AeadTokenCipher {
@@ -32,8 +54,21 @@ class AeadTokenCipher {
   explicit AeadTokenCipher(std::vector<std::string> contextStrings)
       : contextStrings_(std::move(contextStrings)) {}
 
-  ~AeadTokenCipher() {
-    clearSecrets();
+  AeadTokenCipher(AeadTokenCipher&& other) noexcept
+      : secrets_(other.secrets_.load()),
+        format_(other.format_.load()),
+        threadState_(std::move(other.threadState_)),
+        contextStrings_(std::move(other.contextStrings_)) {
+    other.secrets_.store(nullptr);
+  }
+
+  AeadTokenCipher& operator=(AeadTokenCipher&& other) noexcept {
+    secrets_.store(other.secrets_.load());
+    other.secrets_.store(nullptr);
+    format_.store(other.format_.load());
+    threadState_ = std::move(other.threadState_);
+    contextStrings_ = std::move(other.contextStrings_);
+    return *this;
   }
 
   /**
@@ -43,6 +78,13 @@ class AeadTokenCipher {
    */
   bool setSecrets(const std::vector<folly::ByteRange>& tokenSecrets);
 
+  /**
+   * Set the format used for newly encrypted tokens. Defaults to V1.
+   */
+  void setTokenFormat(TokenFormat format) {
+    format_.store(format);
+  }
+
   folly::Optional<Buf> encrypt(Buf plaintext) const;
 
   folly::Optional<Buf> decrypt(Buf) const;
@@ -52,14 +94,78 @@ class AeadTokenCipher {
   static constexpr size_t kSaltLength = HkdfType::HashLen;
   using Salt = std::array<uint8_t, kSaltLength>;
   using SeqNum = uint32_t;
+  using KeyId = uint32_t;
   static constexpr size_t kTokenHeaderLength = kSaltLength + sizeof(SeqNum);
+  static constexpr uint8_t kV2Version = 2;
+  static constexpr size_t kV2TokenHeaderLength =
+      sizeof(uint8_t) + sizeof(KeyId) + kTokenHeaderLength;
+  // Number of tokens encrypted under a single salt before picking a new one.
+  static constexpr SeqNum kMaxTokensPerSalt = 1 << 20;
+  static constexpr size_t kDecryptCacheSize = 16;
+
+  struct SecretSet {
+    ~SecretSet();
+
+    // First secret is the one used to encrypt.
+    std::vector<Secret> secrets;
+    std::vector<KeyId> keyIds;
+
+    // Unique to this set, so that cached keys derived from a previous set
+    // are never used.
+    uint64_t generation{0};
+  };
+
+  struct EncryptState {
+    uint64_t generation{0};
+    Salt salt;
+    SeqNum nextSeqNum{0};
+    folly::Optional<AeadType> aead;
+  };
+
+  struct DecryptCacheEntry {
+    uint64_t generation{0};
+    size_t secretIndex{0};
+    Salt salt;
+    folly::Optional<AeadType> aead;
+  };
+
+  // Derived keys are cached per thread as the aead objects are not safe to
+  // share between threads.
+  struct ThreadState {
+    EncryptState encryptState;
+    std::array<DecryptCacheEntry, kDecryptCacheSize> decryptCache;
+  };
+
+  folly::Optional<Buf> encryptV1(const SecretSet& secrets, Buf plaintext)
+      const;
+  folly::Optional<Buf> encryptV2(const SecretSet& secrets, Buf plaintext)
+      const;
+
+  folly::Optional<Buf> decryptV1(const SecretSet& secrets, const Buf& token)
+      const;
+  folly::Optional<Buf> decryptV2(const SecretSet& secrets, const Buf& token)
+      const;
+
+  const AeadType& getCachedAead(
+      const SecretSet& secrets,
+      size_t secretIndex,
+      const Salt& salt) const;
 
   AeadType createAead(folly::ByteRange secret, folly::ByteRange salt) const;
 
-  void clearSecrets();
+  KeyId computeKeyId(folly::ByteRange secret) const;
+
+  static uint64_t nextGeneration() {
+    static std::atomic<uint64_t> generation{0};
+    return ++generation;
+  }
+
+  folly::atomic_shared_ptr<SecretSet> secrets_;
+
+  std::atomic<TokenFormat> format_{TokenFormat::V1};
 
-  // First secret is the one used to encrypt.
-  std::vector<Secret> secrets_;
+  std::unique_ptr<folly::ThreadLocal<ThreadState>> threadState_{
+      std::make_unique<folly::ThreadLocal<ThreadState>>()};
 
   std::vector<std::string> contextStrings_;
 };
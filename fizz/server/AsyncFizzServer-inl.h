@@ -20,12 +20,26 @@ AsyncFizzServerT<SM>::AsyncFizzServerT(
       fizzContext_(fizzContext),
       extensions_(extensions),
       visitor_(*this),
-      fizzServer_(state_, transportReadBuf_, visitor_, this) {}
+      fizzServer_(state_, transportReadBuf_, visitor_, this) {
+  if (fizzContext_->getMemoryBudget()) {
+    setMemoryBudget(fizzContext_->getMemoryBudget());
+  }
+}
 
 template <typename SM>
 void AsyncFizzServerT<SM>::accept(HandshakeCallback* callback) {
   handshakeCallback_ = callback;
 
+  const auto& memoryBudget = fizzContext_->getMemoryBudget();
+  if (memoryBudget && memoryBudget->overBudget()) {
+    DelayedDestruction::DestructorGuard dg(this);
+    folly::AsyncSocketException ase(
+        folly::AsyncSocketException::INTERNAL_ERROR,
+        "memory budget exhausted, refusing handshake");
+    deliverAllErrors(ase);
+    return;
+  }
+
   fizzServer_.accept(transport_->getEventBase(), fizzContext_, extensions_);
   startTransportReads();
 }
@@ -197,9 +211,21 @@ void AsyncFizzServerT<SM>::transportError(
 
 template <typename SM>
 void AsyncFizzServerT<SM>::transportDataAvailable() {
+  // The read record layer is replaced during the handshake and on key updates,
+  // so make sure the current one decrypts into the app's buffers if possible.
+  auto readRecordLayer = getState().readRecordLayer();
+  if (readRecordLayer) {
+    readRecordLayer->setDecryptionBufferProvider(this);
+  }
   fizzServer_.newTransportData();
 }
 
+template <typename SM>
+size_t AsyncFizzServerT<SM>::getBufferedHandshakeSize() const {
+  auto readRecordLayer = getState().readRecordLayer();
+  return readRecordLayer ? readRecordLayer->getUnparsedHandshakeDataSize() : 0;
+}
+
 template <typename SM>
 void AsyncFizzServerT<SM>::deliverAllErrors(
     const folly::AsyncSocketException& ex,
@@ -225,8 +251,8 @@ void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(DeliverAppData& data) {
 
 template <typename SM>
 void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(WriteToSocket& data) {
-  server_.transport_->writeChain(
-      data.callback, std::move(data.data), data.flags);
+  auto flags = server_.getTransportWriteFlags(*data.data, data.flags);
+  server_.transport_->writeChain(data.callback, std::move(data.data), flags);
 }
 
 template <typename SM>
@@ -261,7 +287,7 @@ template <typename SM>
 void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(WaitForData&) {
   server_.fizzServer_.waitForData();
 
-  if (server_.handshakeCallback_) {
+  if (server_.handshakeCallback_ || server_.transportReadsPaused()) {
     // Make sure that the read callback is installed.
     server_.startTransportReads();
   }
@@ -92,6 +92,8 @@ class AsyncFizzServerT : public AsyncFizzBase {
 
   void transportDataAvailable() override;
 
+  size_t getBufferedHandshakeSize() const override;
+
  private:
   void deliverAllErrors(
       const folly::AsyncSocketException& ex,
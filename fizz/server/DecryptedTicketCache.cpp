@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/DecryptedTicketCache.h>
+
+namespace fizz {
+namespace server {
+
+static ResumptionState cloneState(const ResumptionState& state) {
+  ResumptionState copy;
+  copy.version = state.version;
+  copy.cipher = state.cipher;
+  copy.resumptionSecret =
+      state.resumptionSecret ? state.resumptionSecret->clone() : nullptr;
+  copy.serverCert = state.serverCert;
+  copy.clientCert = state.clientCert;
+  copy.alpn = state.alpn;
+  copy.ticketAgeAdd = state.ticketAgeAdd;
+  copy.ticketIssueTime = state.ticketIssueTime;
+  copy.appToken = state.appToken ? state.appToken->clone() : nullptr;
+  return copy;
+}
+
+static std::string toKey(const folly::IOBuf& ticket) {
+  std::string key;
+  key.reserve(ticket.computeChainDataLength());
+  for (auto range : ticket) {
+    key.append(reinterpret_cast<const char*>(range.data()), range.size());
+  }
+  return key;
+}
+
+DecryptedTicketCache::DecryptedTicketCache(Options options)
+    : options_(std::move(options)) {
+  auto numShards = std::max<size_t>(options_.numShards, 1);
+  auto shardCapacity = std::max<size_t>(options_.capacity / numShards, 1);
+  for (size_t i = 0; i < numShards; ++i) {
+    shards_.push_back(std::make_unique<Shard>(shardCapacity));
+  }
+}
+
+folly::Optional<ResumptionState> DecryptedTicketCache::get(
+    const folly::IOBuf& ticket) {
+  auto key = toKey(ticket);
+  auto& shard = getShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.cache.find(key);
+  if (it == shard.cache.end()) {
+    return folly::none;
+  }
+  if (it->second.expiry <= now()) {
+    shard.cache.erase(key);
+    return folly::none;
+  }
+  return cloneState(it->second.state);
+}
+
+void DecryptedTicketCache::put(
+    const folly::IOBuf& ticket,
+    const ResumptionState& state) {
+  auto currentTime = now();
+  auto expiry = std::min(
+      currentTime + options_.ttl,
+      state.ticketIssueTime + options_.ticketValidity);
+  if (expiry <= currentTime) {
+    return;
+  }
+
+  auto key = toKey(ticket);
+  auto& shard = getShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.cache.set(std::move(key), Entry{cloneState(state), expiry});
+}
+
+void DecryptedTicketCache::clear() {
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->cache.clear();
+  }
+}
+
+DecryptedTicketCache::Shard& DecryptedTicketCache::getShard(
+    const std::string& key) {
+  return *shards_[std::hash<std::string>()(key) % shards_.size()];
+}
+} // namespace server
+} // namespace fizz
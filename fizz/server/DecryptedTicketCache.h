@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/ResumptionState.h>
+#include <folly/container/EvictingCacheMap.h>
+
+#include <mutex>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Bounded cache of decrypted session tickets, so that a ticket presented
+ * repeatedly (for example by clients that reuse a single ticket for many
+ * connections) is only decrypted and decoded by the TicketCipher once.
+ *
+ * The cache is split into shards, each with its own lock and LRU list, so
+ * that concurrent handshakes on different tickets rarely contend.
+ *
+ * An entry is dropped once ttl has passed since it was added, or once the
+ * ticket is older than ticketValidity, whichever comes first. A cached ticket
+ * continues to be accepted for up to ttl after its secret has been rotated
+ * out of the TicketCipher, so ttl should be kept short relative to the
+ * rotation interval (or clear() called on rotation).
+ *
+ * Only consulted for ClientHellos that do not attempt early data, see
+ * FizzServerContext::setDecryptedTicketCache().
+ */
+class DecryptedTicketCache {
+ public:
+  struct Options {
+    size_t capacity{100000};
+    size_t numShards{16};
+    std::chrono::seconds ttl{std::chrono::minutes(5)};
+    std::chrono::seconds ticketValidity{std::chrono::hours(1)};
+  };
+
+  DecryptedTicketCache() : DecryptedTicketCache(Options()) {}
+  explicit DecryptedTicketCache(Options options);
+
+  virtual ~DecryptedTicketCache() = default;
+
+  /**
+   * Returns a copy of the cached state for ticket, if present and still
+   * valid.
+   */
+  folly::Optional<ResumptionState> get(const folly::IOBuf& ticket);
+
+  void put(const folly::IOBuf& ticket, const ResumptionState& state);
+
+  void clear();
+
+ protected:
+  virtual std::chrono::system_clock::time_point now() const {
+    return std::chrono::system_clock::now();
+  }
+
+ private:
+  struct Entry {
+    ResumptionState state;
+    std::chrono::system_clock::time_point expiry;
+  };
+
+  struct Shard {
+    explicit Shard(size_t capacity) : cache(capacity) {}
+
+    std::mutex mutex;
+    folly::EvictingCacheMap<std::string, Entry> cache;
+  };
+
+  Shard& getShard(const std::string& key);
+
+  Options options_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+} // namespace server
+} // namespace fizz
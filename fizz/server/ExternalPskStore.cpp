@@ -0,0 +1,32 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/ExternalPskStore.h>
+
+namespace fizz {
+namespace server {
+
+folly::Optional<ExternalPsk> InMemoryExternalPskStore::getPsk(
+    folly::ByteRange identity) const {
+  auto psks = psks_.rlock();
+  auto it = psks->find(std::string(identity.begin(), identity.end()));
+  if (it == psks->end()) {
+    return folly::none;
+  }
+  return it->second;
+}
+
+void InMemoryExternalPskStore::addPsk(std::string identity, ExternalPsk psk) {
+  (*psks_.wlock())[std::move(identity)] = std::move(psk);
+}
+
+void InMemoryExternalPskStore::removePsk(const std::string& identity) {
+  psks_.wlock()->erase(identity);
+}
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Certificate.h>
+#include <fizz/record/Types.h>
+#include <folly/Synchronized.h>
+
+#include <unordered_map>
+
+namespace fizz {
+namespace server {
+
+/**
+ * A PSK provisioned out of band (RFC 8446 section 4.2.11), rather than
+ * obtained from a previous connection.
+ */
+struct ExternalPsk {
+  std::string secret;
+
+  // Determines the hash used with the PSK. Any cipher suite with the same
+  // hash may be negotiated.
+  CipherSuite cipher{CipherSuite::TLS_AES_128_GCM_SHA256};
+
+  // Identity of the peer holding the PSK, reported as the client certificate
+  // of connections using it.
+  std::shared_ptr<const Cert> clientIdentity;
+};
+
+/**
+ * Resolves PSK identities offered by clients to external PSKs. Identities not
+ * found in the store are passed on to the TicketCipher.
+ *
+ * Handshakes using an external PSK do not send or request certificates, and
+ * never accept early data.
+ */
+class ExternalPskStore {
+ public:
+  virtual ~ExternalPskStore() = default;
+
+  virtual folly::Optional<ExternalPsk> getPsk(
+      folly::ByteRange identity) const = 0;
+};
+
+/**
+ * Basic ExternalPskStore that keeps PSKs in a hash map. PSKs may be added
+ * and removed while in use.
+ */
+class InMemoryExternalPskStore : public ExternalPskStore {
+ public:
+  ~InMemoryExternalPskStore() override = default;
+
+  folly::Optional<ExternalPsk> getPsk(folly::ByteRange identity) const override;
+
+  void addPsk(std::string identity, ExternalPsk psk);
+
+  void removePsk(const std::string& identity);
+
+ private:
+  folly::Synchronized<std::unordered_map<std::string, ExternalPsk>> psks_;
+};
+} // namespace server
+} // namespace fizz
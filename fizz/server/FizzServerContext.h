@@ -10,12 +10,16 @@
 
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/Factory.h>
+#include <fizz/protocol/MemoryBudget.h>
 #include <fizz/record/Types.h>
 #include <fizz/server/CertManager.h>
 #include <fizz/server/CookieCipher.h>
+#include <fizz/server/DecryptedTicketCache.h>
+#include <fizz/server/ExternalPskStore.h>
 #include <fizz/server/Negotiator.h>
 #include <fizz/server/ReplayCache.h>
 #include <fizz/server/TicketCipher.h>
+#include <fizz/server/TicketPolicy.h>
 
 namespace fizz {
 namespace server {
@@ -154,6 +158,30 @@ class FizzServerContext {
     return ticketCipher_.get();
   }
 
+  /**
+   * Sets a cache of decrypted tickets to consult before the ticket cipher.
+   * ClientHellos attempting early data always go to the ticket cipher. Not
+   * set by default.
+   */
+  void setDecryptedTicketCache(std::shared_ptr<DecryptedTicketCache> cache) {
+    decryptedTicketCache_ = std::move(cache);
+  }
+  const std::shared_ptr<DecryptedTicketCache>& getDecryptedTicketCache()
+      const {
+    return decryptedTicketCache_;
+  }
+
+  /**
+   * Sets the store of external PSKs, consulted before the ticket cipher for
+   * each offered PSK identity. External PSKs will not be accepted if not set.
+   */
+  void setExternalPskStore(std::shared_ptr<const ExternalPskStore> store) {
+    externalPskStore_ = std::move(store);
+  }
+  const ExternalPskStore* getExternalPskStore() const {
+    return externalPskStore_.get();
+  }
+
   /**
    * Sets the cookie cipher to use. Stateless client retries will be rejected
    * if not set.
@@ -173,7 +201,44 @@ class FizzServerContext {
   }
 
   /**
-   * Sets the certificate verifier to use for client authentication
+   * Sets the CertManager holding raw public keys (RFC 7250), used for clients
+   * that prefer a raw public key over an X509 certificate in their
+   * server_certificate_type extension. Raw public keys are not offered if
+   * not set.
+   */
+  void setRawPublicKeyCertManager(std::unique_ptr<CertManager> manager) {
+    rawPublicKeyCertManager_ = std::move(manager);
+  }
+
+  /**
+   * Returns the certificate types we are able to authenticate with.
+   */
+  std::vector<CertificateType> getSupportedServerCertTypes() const {
+    std::vector<CertificateType> types = {CertificateType::X509};
+    if (rawPublicKeyCertManager_) {
+      types.push_back(CertificateType::RawPublicKey);
+    }
+    return types;
+  }
+
+  /**
+   * Set the certificate types (RFC 7250) we accept for client
+   * authentication, in preference order. A raw public key is authenticated
+   * by the client cert verifier, typically by pinning
+   * PeerCert::getIdentity().
+   */
+  void setSupportedClientCertTypes(std::vector<CertificateType> types) {
+    supportedClientCertTypes_ = std::move(types);
+  }
+
+  const auto& getSupportedClientCertTypes() const {
+    return supportedClientCertTypes_;
+  }
+
+  /**
+   * Sets the certificate verifier to use for client authentication. If it is
+   * an AsyncCertificateVerifier the handshake waits on verifyFuture() rather
+   * than calling verify() on the event base.
    */
   void setClientCertVerifier(
       std::shared_ptr<const CertificateVerifier> verifier) {
@@ -191,7 +256,15 @@ class FizzServerContext {
   folly::Optional<std::pair<std::shared_ptr<SelfCert>, SignatureScheme>>
   getCert(
       const folly::Optional<std::string>& sni,
-      const std::vector<SignatureScheme>& peerSigSchemes) const {
+      const std::vector<SignatureScheme>& peerSigSchemes,
+      CertificateType certType = CertificateType::X509) const {
+    if (certType == CertificateType::RawPublicKey) {
+      if (!rawPublicKeyCertManager_) {
+        return folly::none;
+      }
+      return rawPublicKeyCertManager_->getCert(
+          sni, supportedSigSchemes_, peerSigSchemes);
+    }
     return certManager_->getCert(sni, supportedSigSchemes_, peerSigSchemes);
   }
 
@@ -200,7 +273,11 @@ class FizzServerContext {
    * matching certificate is not found.
    */
   std::shared_ptr<SelfCert> getCert(const std::string& identity) const {
-    return certManager_->getCert(identity);
+    auto cert = certManager_->getCert(identity);
+    if (!cert && rawPublicKeyCertManager_) {
+      cert = rawPublicKeyCertManager_->getCert(identity);
+    }
+    return cert;
   }
 
   /**
@@ -273,14 +350,43 @@ class FizzServerContext {
     return sendNewSessionTicket_;
   }
 
+  /**
+   * Sets the policy deciding how many tickets are sent automatically when the
+   * handshake completes. Only consulted if getSendNewSessionTicket() is true.
+   * If not set, one ticket is sent after every handshake.
+   */
+  void setTicketPolicy(std::shared_ptr<const TicketPolicy> ticketPolicy) {
+    ticketPolicy_ = std::move(ticketPolicy);
+  }
+  const TicketPolicy* getTicketPolicy() const {
+    return ticketPolicy_.get();
+  }
+
+  /**
+   * Sets the memory budget that connections using this context account their
+   * buffered data against (see MemoryBudget). New handshakes are refused
+   * while the budget is exhausted. Not set by default.
+   */
+  void setMemoryBudget(std::shared_ptr<MemoryBudget> memoryBudget) {
+    memoryBudget_ = std::move(memoryBudget);
+  }
+  const std::shared_ptr<MemoryBudget>& getMemoryBudget() const {
+    return memoryBudget_;
+  }
+
  private:
   std::unique_ptr<Factory> factory_;
 
   std::shared_ptr<TicketCipher> ticketCipher_;
+  std::shared_ptr<DecryptedTicketCache> decryptedTicketCache_;
+  std::shared_ptr<const ExternalPskStore> externalPskStore_;
   std::shared_ptr<CookieCipher> cookieCipher_;
 
   std::unique_ptr<CertManager> certManager_;
+  std::unique_ptr<CertManager> rawPublicKeyCertManager_;
   std::shared_ptr<const CertificateVerifier> clientCertVerifier_;
+  std::vector<CertificateType> supportedClientCertTypes_ = {
+      CertificateType::X509};
 
   std::vector<ProtocolVersion> supportedVersions_ = {
       ProtocolVersion::tls_1_3_26};
@@ -314,6 +420,9 @@ class FizzServerContext {
   bool earlyDataFbOnly_{false};
 
   bool sendNewSessionTicket_{true};
+  std::shared_ptr<const TicketPolicy> ticketPolicy_;
+
+  std::shared_ptr<MemoryBudget> memoryBudget_;
 };
 } // namespace server
 } // namespace fizz
@@ -0,0 +1,401 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/RemoteReplayCache.h>
+
+#include <fizz/server/StrikeRegisterProtocol.h>
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/AsyncTimeout.h>
+
+#include <deque>
+#include <mutex>
+
+namespace fizz {
+namespace server {
+
+namespace {
+struct PendingCheck {
+  Buf identifier;
+  folly::Promise<ReplayCacheResult> promise;
+};
+
+struct InflightBatch {
+  uint32_t batchId;
+  std::chrono::steady_clock::time_point deadline;
+  std::vector<folly::Promise<ReplayCacheResult>> promises;
+};
+
+void failChecks(std::vector<folly::Promise<ReplayCacheResult>>& promises) {
+  for (auto& promise : promises) {
+    promise.setValue(ReplayCacheResult::MaybeReplay);
+  }
+  promises.clear();
+}
+} // namespace
+
+/**
+ * Event base side of RemoteReplayCache. Kept alive by any callbacks queued on
+ * the event base so that it can be released safely from any thread.
+ */
+class StrikeRegisterClient
+    : public std::enable_shared_from_this<StrikeRegisterClient> {
+ public:
+  StrikeRegisterClient(
+      folly::EventBase* evb,
+      folly::SocketAddress serverAddress,
+      RemoteReplayCache::Options options)
+      : evb_(evb),
+        serverAddress_(std::move(serverAddress)),
+        options_(std::move(options)),
+        flushTimeout_(*this, evb),
+        expiryTimeout_(*this, evb) {
+    for (size_t i = 0; i < std::max<size_t>(options_.numConnections, 1); ++i) {
+      connections_.push_back(std::make_unique<Connection>(*this));
+    }
+  }
+
+  /**
+   * Adds a check to the next batch. May be called from any thread.
+   */
+  void enqueue(PendingCheck check) {
+    bool firstInBatch;
+    bool batchFull;
+    {
+      std::lock_guard<std::mutex> lock(pendingMutex_);
+      if (closed_) {
+        check.promise.setValue(ReplayCacheResult::MaybeReplay);
+        return;
+      }
+      firstInBatch = pending_.empty();
+      pending_.push_back(std::move(check));
+      batchFull = pending_.size() == options_.maxBatchSize;
+    }
+
+    if (firstInBatch) {
+      evb_->runInEventBaseThread([self = shared_from_this()]() {
+        if (!self->flushTimeout_.isScheduled()) {
+          self->flushTimeout_.scheduleTimeout(self->options_.batchWindow);
+        }
+      });
+    }
+    if (batchFull) {
+      evb_->runInEventBaseThread(
+          [self = shared_from_this()]() { self->flush(); });
+    }
+  }
+
+  /**
+   * Closes all connections and completes outstanding checks. Must be called
+   * on the event base.
+   */
+  void close() {
+    std::vector<PendingCheck> pending;
+    {
+      std::lock_guard<std::mutex> lock(pendingMutex_);
+      closed_ = true;
+      pending.swap(pending_);
+    }
+    for (auto& check : pending) {
+      check.promise.setValue(ReplayCacheResult::MaybeReplay);
+    }
+    flushTimeout_.cancelTimeout();
+    expiryTimeout_.cancelTimeout();
+    for (auto& connection : connections_) {
+      connection->reset("replay cache closed");
+    }
+  }
+
+ private:
+  class Connection : public folly::AsyncSocket::ConnectCallback,
+                     public folly::AsyncTransportWrapper::ReadCallback,
+                     public folly::AsyncTransportWrapper::WriteCallback {
+   public:
+    explicit Connection(StrikeRegisterClient& client) : client_(client) {}
+
+    ~Connection() override {
+      reset("connection destroyed");
+    }
+
+    bool canSend() const {
+      return inflight_.size() < client_.options_.maxPipelineDepth;
+    }
+
+    void send(
+        uint32_t batchId,
+        std::vector<PendingCheck> checks,
+        std::chrono::steady_clock::time_point deadline) {
+      StrikeRegisterRequest request;
+      request.batchId = batchId;
+      InflightBatch batch;
+      batch.batchId = batchId;
+      batch.deadline = deadline;
+      for (auto& check : checks) {
+        request.identifiers.push_back(std::move(check.identifier));
+        batch.promises.push_back(std::move(check.promise));
+      }
+
+      if (!socket_) {
+        connect();
+        if (!socket_) {
+          failChecks(batch.promises);
+          return;
+        }
+      }
+      inflight_.push_back(std::move(batch));
+      // Writes issued while the connection is still being established are
+      // buffered by the socket and sent once it connects.
+      socket_->writeChain(this, encodeStrikeRegisterRequest(request));
+    }
+
+    /**
+     * Resets the connection if any batch is past its deadline, completing all
+     * outstanding checks; the next send reconnects. Otherwise returns the
+     * earliest deadline still pending, if any.
+     */
+    folly::Optional<std::chrono::steady_clock::time_point> expire(
+        std::chrono::steady_clock::time_point now) {
+      folly::Optional<std::chrono::steady_clock::time_point> next;
+      for (auto& batch : inflight_) {
+        if (batch.deadline <= now) {
+          // Responses come back in order, so everything behind an unanswered
+          // batch is stuck as well.
+          VLOG(4) << "Strike register batch " << batch.batchId << " timed out";
+          reset("timeout");
+          return folly::none;
+        } else if (!next || batch.deadline < *next) {
+          next = batch.deadline;
+        }
+      }
+      return next;
+    }
+
+    void reset(const std::string& reason) {
+      if (socket_) {
+        VLOG(4) << "Resetting strike register connection: " << reason;
+        auto socket = std::move(socket_);
+        socket->setReadCB(nullptr);
+        socket->closeNow();
+      }
+      readBuf_.move();
+      for (auto& batch : inflight_) {
+        failChecks(batch.promises);
+      }
+      inflight_.clear();
+    }
+
+    void connectSuccess() noexcept override {
+      socket_->setNoDelay(true);
+      socket_->setReadCB(this);
+    }
+
+    void connectErr(const folly::AsyncSocketException& ex) noexcept override {
+      reset(folly::to<std::string>("connect error: ", ex.what()));
+    }
+
+    void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+      auto readSpace = readBuf_.preallocate(
+          kStrikeRegisterMinReadSize, kStrikeRegisterMaxReadSize);
+      *bufReturn = readSpace.first;
+      *lenReturn = readSpace.second;
+    }
+
+    void readDataAvailable(size_t len) noexcept override {
+      readBuf_.postallocate(len);
+      try {
+        while (auto response = decodeStrikeRegisterResponse(readBuf_)) {
+          deliver(std::move(*response));
+          if (!socket_) {
+            return;
+          }
+        }
+      } catch (const std::exception& ex) {
+        reset(folly::to<std::string>("bad response: ", ex.what()));
+      }
+    }
+
+    void readEOF() noexcept override {
+      reset("EOF");
+    }
+
+    void readErr(const folly::AsyncSocketException& ex) noexcept override {
+      reset(folly::to<std::string>("read error: ", ex.what()));
+    }
+
+    void writeSuccess() noexcept override {}
+
+    void writeErr(size_t, const folly::AsyncSocketException& ex) noexcept
+        override {
+      reset(folly::to<std::string>("write error: ", ex.what()));
+    }
+
+   private:
+    void connect() {
+      socket_ = folly::AsyncSocket::UniquePtr(
+          new folly::AsyncSocket(client_.evb_));
+      socket_->connect(
+          this,
+          client_.serverAddress_,
+          static_cast<int>(client_.options_.timeout.count()));
+    }
+
+    void deliver(StrikeRegisterResponse response) {
+      // Responses are returned in request order.
+      if (inflight_.empty() ||
+          inflight_.front().batchId != response.batchId) {
+        return reset("unexpected batch id");
+      }
+      auto batch = std::move(inflight_.front());
+      inflight_.pop_front();
+      if (batch.promises.size() != response.results.size()) {
+        failChecks(batch.promises);
+        return reset("result count mismatch");
+      }
+      for (size_t i = 0; i < batch.promises.size(); ++i) {
+        batch.promises[i].setValue(response.results[i]);
+      }
+    }
+
+    StrikeRegisterClient& client_;
+    folly::AsyncSocket::UniquePtr socket_;
+    folly::IOBufQueue readBuf_{folly::IOBufQueue::cacheChainLength()};
+    std::deque<InflightBatch> inflight_;
+  };
+
+  class FlushTimeout : public folly::AsyncTimeout {
+   public:
+    FlushTimeout(StrikeRegisterClient& client, folly::EventBase* evb)
+        : folly::AsyncTimeout(evb), client_(client) {}
+
+    void timeoutExpired() noexcept override {
+      client_.flush();
+    }
+
+   private:
+    StrikeRegisterClient& client_;
+  };
+
+  class ExpiryTimeout : public folly::AsyncTimeout {
+   public:
+    ExpiryTimeout(StrikeRegisterClient& client, folly::EventBase* evb)
+        : folly::AsyncTimeout(evb), client_(client) {}
+
+    void timeoutExpired() noexcept override {
+      client_.expire();
+    }
+
+   private:
+    StrikeRegisterClient& client_;
+  };
+
+  void flush() {
+    flushTimeout_.cancelTimeout();
+    std::vector<PendingCheck> pending;
+    {
+      std::lock_guard<std::mutex> lock(pendingMutex_);
+      pending.swap(pending_);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+    auto it = pending.begin();
+    while (it != pending.end()) {
+      auto batchEnd = it +
+          std::min<size_t>(std::distance(it, pending.end()),
+                           std::min(options_.maxBatchSize,
+                                    kMaxStrikeRegisterBatchSize));
+      std::vector<PendingCheck> batch(
+          std::make_move_iterator(it), std::make_move_iterator(batchEnd));
+      it = batchEnd;
+
+      auto connection = nextConnection();
+      if (!connection) {
+        VLOG(4) << "All strike register connections saturated";
+        for (auto& check : batch) {
+          check.promise.setValue(ReplayCacheResult::MaybeReplay);
+        }
+        continue;
+      }
+      connection->send(nextBatchId_++, std::move(batch), deadline);
+    }
+
+    if (!expiryTimeout_.isScheduled()) {
+      expiryTimeout_.scheduleTimeout(options_.timeout);
+    }
+  }
+
+  void expire() {
+    auto now = std::chrono::steady_clock::now();
+    folly::Optional<std::chrono::steady_clock::time_point> next;
+    for (auto& connection : connections_) {
+      auto connectionNext = connection->expire(now);
+      if (connectionNext && (!next || *connectionNext < *next)) {
+        next = connectionNext;
+      }
+    }
+    if (next) {
+      expiryTimeout_.scheduleTimeout(std::max(
+          std::chrono::milliseconds(1),
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              *next - now)));
+    }
+  }
+
+  Connection* nextConnection() {
+    for (size_t i = 0; i < connections_.size(); ++i) {
+      auto& connection = connections_[nextConnection_++ % connections_.size()];
+      if (connection->canSend()) {
+        return connection.get();
+      }
+    }
+    return nullptr;
+  }
+
+  folly::EventBase* evb_;
+  folly::SocketAddress serverAddress_;
+  RemoteReplayCache::Options options_;
+
+  std::mutex pendingMutex_;
+  std::vector<PendingCheck> pending_;
+  bool closed_{false};
+
+  std::vector<std::unique_ptr<Connection>> connections_;
+  size_t nextConnection_{0};
+  uint32_t nextBatchId_{0};
+
+  FlushTimeout flushTimeout_;
+  ExpiryTimeout expiryTimeout_;
+};
+
+RemoteReplayCache::RemoteReplayCache(
+    folly::EventBase* evb,
+    folly::SocketAddress serverAddress,
+    Options options)
+    : evb_(evb),
+      client_(std::make_shared<StrikeRegisterClient>(
+          evb,
+          std::move(serverAddress),
+          std::move(options))) {}
+
+RemoteReplayCache::~RemoteReplayCache() {
+  evb_->runInEventBaseThread(
+      [client = std::move(client_)]() { client->close(); });
+}
+
+folly::Future<ReplayCacheResult> RemoteReplayCache::check(
+    folly::ByteRange identifier) {
+  if (identifier.empty() ||
+      identifier.size() > kMaxStrikeRegisterIdentifierLength) {
+    return ReplayCacheResult::MaybeReplay;
+  }
+  PendingCheck check;
+  check.identifier = folly::IOBuf::copyBuffer(identifier);
+  auto future = check.promise.getFuture();
+  client_->enqueue(std::move(check));
+  return future;
+}
+} // namespace server
+} // namespace fizz
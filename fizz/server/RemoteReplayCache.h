@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/ReplayCache.h>
+#include <folly/SocketAddress.h>
+#include <folly/io/async/EventBase.h>
+
+namespace fizz {
+namespace server {
+
+class StrikeRegisterClient;
+
+/**
+ * Replay cache that consults a remote strike register service (see
+ * StrikeRegisterProtocol.h) so that anti-replay state can be shared across
+ * hosts.
+ *
+ * Checks are not sent individually. Identifiers are collected for up to
+ * batchWindow (or until maxBatchSize is reached) and sent as a single batch
+ * over one of numConnections persistent connections. Batches are pipelined, so
+ * a connection does not wait for a reply before sending the next batch.
+ *
+ * Any check that is not answered within timeout, or that is outstanding when a
+ * connection fails, is completed with MaybeReplay so that the handshake falls
+ * back to rejecting early data rather than stalling. A connection that times
+ * out is reset, failing its other outstanding checks as well.
+ *
+ * All network activity happens on the passed in EventBase, which must outlive
+ * this object. check() may be called from any thread.
+ */
+class RemoteReplayCache : public ReplayCache {
+ public:
+  struct Options {
+    std::chrono::milliseconds batchWindow{std::chrono::milliseconds(1)};
+    size_t maxBatchSize{256};
+    size_t numConnections{2};
+    std::chrono::milliseconds timeout{std::chrono::milliseconds(20)};
+
+    // Maximum number of unanswered batches on a single connection. Once every
+    // connection is at the limit checks complete with MaybeReplay straight
+    // away. A connection is reset (and reconnected on the next send) when one
+    // of its batches isn't answered within timeout.
+    size_t maxPipelineDepth{128};
+  };
+
+  RemoteReplayCache(
+      folly::EventBase* evb,
+      folly::SocketAddress serverAddress,
+      Options options);
+
+  RemoteReplayCache(folly::EventBase* evb, folly::SocketAddress serverAddress)
+      : RemoteReplayCache(evb, std::move(serverAddress), Options()) {}
+
+  ~RemoteReplayCache() override;
+
+  folly::Future<ReplayCacheResult> check(folly::ByteRange identifier) override;
+
+ private:
+  folly::EventBase* evb_;
+  std::shared_ptr<StrikeRegisterClient> client_;
+};
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/SecretRotator.h>
+
+#include <fizz/crypto/Hkdf.h>
+#include <fizz/crypto/Utils.h>
+#include <folly/FileUtil.h>
+#include <folly/io/Cursor.h>
+
+namespace fizz {
+namespace server {
+
+static constexpr size_t kEpochSecretLength = 32;
+
+SecretRotator::SecretRotator(
+    folly::EventBase* evb,
+    std::string seedFile,
+    std::string label,
+    Callback callback,
+    Options options)
+    : folly::AsyncTimeout(evb),
+      seedFile_(std::move(seedFile)),
+      label_(std::move(label)),
+      callback_(std::move(callback)),
+      options_(std::move(options)) {}
+
+SecretRotator::~SecretRotator() {
+  CryptoUtils::clean(folly::MutableByteRange(
+      reinterpret_cast<uint8_t*>(&seed_[0]), seed_.size()));
+}
+
+SecretRotator::SecretSet::~SecretSet() {
+  for (auto& secret : secrets) {
+    CryptoUtils::clean(folly::range(secret));
+  }
+}
+
+void SecretRotator::start() {
+  if (!readSeed()) {
+    throw std::runtime_error("unable to read secret seed");
+  }
+  publish(currentEpoch());
+}
+
+std::vector<std::vector<uint8_t>> SecretRotator::deriveSecrets(
+    folly::ByteRange seed,
+    folly::StringPiece label,
+    uint64_t epoch,
+    const Options& options) {
+  HkdfImpl<Sha256> hkdf;
+  auto prk = hkdf.extract(folly::range(label), seed);
+
+  auto deriveEpoch = [&](uint64_t e) {
+    auto info = folly::IOBuf::create(sizeof(uint64_t));
+    folly::io::Appender appender(info.get(), sizeof(uint64_t));
+    appender.writeBE(e);
+    auto secretBuf = hkdf.expand(folly::range(prk), *info, kEpochSecretLength);
+    auto secretRange = secretBuf->coalesce();
+    return std::vector<uint8_t>(secretRange.begin(), secretRange.end());
+  };
+
+  std::vector<std::vector<uint8_t>> secrets;
+  secrets.push_back(deriveEpoch(epoch));
+  secrets.push_back(deriveEpoch(epoch + 1));
+  for (uint64_t i = 1; i <= options.previousEpochs && i <= epoch; ++i) {
+    secrets.push_back(deriveEpoch(epoch - i));
+  }
+  CryptoUtils::clean(folly::range(prk));
+  return secrets;
+}
+
+void SecretRotator::timeoutExpired() noexcept {
+  auto epoch = currentEpoch();
+  try {
+    publish(epoch);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to rotate secrets for " << label_ << ": "
+               << ex.what();
+    scheduleNext();
+  }
+}
+
+uint64_t SecretRotator::currentEpoch() const {
+  auto sinceEpoch = std::chrono::duration_cast<std::chrono::seconds>(
+      now().time_since_epoch());
+  return sinceEpoch.count() / options_.epochLength.count();
+}
+
+bool SecretRotator::readSeed() {
+  std::string seed;
+  if (!folly::readFile(seedFile_.c_str(), seed)) {
+    LOG(ERROR) << "Unable to read secret seed file " << seedFile_;
+    return false;
+  }
+  if (seed.size() < kMinSeedLength) {
+    LOG(ERROR) << "Secret seed file " << seedFile_ << " too short";
+    return false;
+  }
+  seed_ = std::move(seed);
+  return true;
+}
+
+void SecretRotator::publish(uint64_t epoch) {
+  // Normally the timer fires at the boundary the next set was prepared for,
+  // but derive it now if the clock has moved since.
+  if (!next_ || next_->epoch != epoch) {
+    prepare(epoch);
+  }
+
+  std::vector<folly::ByteRange> secrets;
+  for (const auto& secret : next_->secrets) {
+    secrets.push_back(folly::range(secret));
+  }
+  VLOG(4) << "Publishing secrets for " << label_ << ", epoch=" << epoch;
+  callback_(secrets);
+
+  // Prepare the following set now, off the rotation path.
+  readSeed();
+  prepare(epoch + 1);
+  scheduleNext();
+}
+
+void SecretRotator::prepare(uint64_t epoch) {
+  next_.clear();
+  next_.emplace();
+  next_->epoch = epoch;
+  next_->secrets = deriveSecrets(
+      folly::ByteRange(folly::StringPiece(seed_)), label_, epoch, options_);
+}
+
+void SecretRotator::scheduleNext() {
+  auto sinceEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now().time_since_epoch());
+  auto epochLength =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          options_.epochLength);
+  auto untilNext = epochLength - (sinceEpoch % epochLength);
+  scheduleTimeout(untilNext);
+}
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBase.h>
+
+#include <chrono>
+#include <functional>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Rotates token secrets (for example for an AeadTicketCipher or an
+ * AeadCookieCipher) derived from a seed file shared between servers.
+ *
+ * Time is divided into fixed length epochs based on the system clock, and
+ * each epoch has its own secret:
+ *
+ *   secret(epoch) = HKDF-Expand(HKDF-Extract(label, seed), epoch, 32)
+ *
+ * so every server with the same seed file derives the same secrets without
+ * further coordination. At each epoch boundary the callback is given the
+ * secret for the current epoch first (used for encryption), then the secret
+ * for the next epoch (so that tokens from servers whose clock is slightly
+ * ahead are accepted), then those for previousEpochs prior epochs (so that
+ * tokens issued before the rotation keep working). epochLength *
+ * previousEpochs should therefore cover the ticket validity.
+ *
+ * The set for the next epoch, including reading the seed file, is prepared
+ * ahead of time so that publishing it at the boundary is just the callback.
+ * If the seed file cannot be read when preparing a set, the last good seed is
+ * used.
+ *
+ * Must be used from the thread of the EventBase passed in.
+ */
+class SecretRotator : private folly::AsyncTimeout {
+ public:
+  using Callback = std::function<void(const std::vector<folly::ByteRange>&)>;
+
+  struct Options {
+    std::chrono::seconds epochLength{std::chrono::hours(12)};
+    size_t previousEpochs{1};
+  };
+
+  SecretRotator(
+      folly::EventBase* evb,
+      std::string seedFile,
+      std::string label,
+      Callback callback,
+      Options options);
+
+  SecretRotator(
+      folly::EventBase* evb,
+      std::string seedFile,
+      std::string label,
+      Callback callback)
+      : SecretRotator(
+            evb,
+            std::move(seedFile),
+            std::move(label),
+            std::move(callback),
+            Options()) {}
+
+  ~SecretRotator() override;
+
+  /**
+   * Publishes the secrets for the current epoch and schedules rotation. Throws
+   * if the seed file can not be read.
+   */
+  void start();
+
+  /**
+   * Derives the secrets published during epoch, in the order described above.
+   */
+  static std::vector<std::vector<uint8_t>> deriveSecrets(
+      folly::ByteRange seed,
+      folly::StringPiece label,
+      uint64_t epoch,
+      const Options& options);
+
+  static constexpr size_t kMinSeedLength = 32;
+
+ protected:
+  virtual std::chrono::system_clock::time_point now() const {
+    return std::chrono::system_clock::now();
+  }
+
+  void timeoutExpired() noexcept override;
+
+ private:
+  struct SecretSet {
+    ~SecretSet();
+
+    uint64_t epoch;
+    std::vector<std::vector<uint8_t>> secrets;
+  };
+
+  uint64_t currentEpoch() const;
+
+  bool readSeed();
+
+  void publish(uint64_t epoch);
+
+  void prepare(uint64_t epoch);
+
+  void scheduleNext();
+
+  std::string seedFile_;
+  std::string label_;
+  Callback callback_;
+  Options options_;
+
+  std::string seed_;
+  folly::Optional<SecretSet> next_;
+};
+} // namespace server
+} // namespace fizz
@@ -9,10 +9,11 @@
 #include <fizz/server/ServerProtocol.h>
 
 #include <fizz/crypto/Utils.h>
-#include <fizz/protocol/CertificateVerifier.h>
+#include <fizz/protocol/AsyncCertificateVerifier.h>
 #include <fizz/protocol/Protocol.h>
 #include <fizz/protocol/StateMachine.h>
 #include <fizz/record/Extensions.h>
+#include <fizz/record/HandshakeFlight.h>
 #include <fizz/record/PlaintextRecordLayer.h>
 #include <fizz/server/AsyncSelfCert.h>
 #include <fizz/server/Negotiator.h>
@@ -431,9 +432,50 @@ struct ResumptionStateResult {
 };
 } // namespace
 
+static Future<std::pair<PskType, Optional<ResumptionState>>> decryptTicket(
+    const ClientHello& chlo,
+    const Buf& ticket,
+    const TicketCipher& ticketCipher,
+    const std::shared_ptr<DecryptedTicketCache>& ticketCache) {
+  // Early data is only accepted for tickets freshly checked by the cipher.
+  if (!ticketCache || getExtension<ClientEarlyData>(chlo.extensions)) {
+    return ticketCipher.decrypt(ticket->clone());
+  }
+
+  auto cached = ticketCache->get(*ticket);
+  if (cached) {
+    return std::make_pair(PskType::Resumption, std::move(cached));
+  }
+  return ticketCipher.decrypt(ticket->clone())
+      .then([ticketCache, ticket = ticket->clone()](
+                std::pair<PskType, Optional<ResumptionState>> result) {
+        if (result.first == PskType::Resumption && result.second) {
+          ticketCache->put(*ticket, *result.second);
+        }
+        return result;
+      });
+}
+
+static ResumptionState getExternalPskState(
+    ExternalPsk psk,
+    ProtocolVersion version) {
+  ResumptionState resState;
+  // External PSKs are not tied to a protocol version.
+  resState.version = version;
+  resState.cipher = psk.cipher;
+  resState.resumptionSecret = folly::IOBuf::copyBuffer(psk.secret);
+  resState.clientCert = std::move(psk.clientIdentity);
+  resState.ticketAgeAdd = 0;
+  resState.ticketIssueTime = std::chrono::system_clock::now();
+  return resState;
+}
+
 static ResumptionStateResult getResumptionState(
     const ClientHello& chlo,
+    ProtocolVersion version,
+    const ExternalPskStore* externalPskStore,
     const TicketCipher* ticketCipher,
+    const std::shared_ptr<DecryptedTicketCache>& ticketCache,
     const std::vector<PskKeyExchangeMode>& supportedModes) {
   auto psks = getExtension<ClientPresharedKey>(chlo.extensions);
   auto clientModes = getExtension<PskKeyExchangeModes>(chlo.extensions);
@@ -451,6 +493,20 @@ static ResumptionStateResult getResumptionState(
   } else if (!psks || psks->identities.size() <= kPskIndex) {
     return ResumptionStateResult(
         std::make_pair(PskType::NotAttempted, folly::none));
+  }
+
+  const auto& ident = psks->identities[kPskIndex].psk_identity;
+  Optional<ExternalPsk> externalPsk;
+  if (externalPskStore && pskMode) {
+    externalPsk = externalPskStore->getPsk(ident->clone()->coalesce());
+  }
+
+  if (externalPsk) {
+    return ResumptionStateResult(
+        std::pair<PskType, Optional<ResumptionState>>(
+            PskType::External,
+            getExternalPskState(std::move(*externalPsk), version)),
+        pskMode);
   } else if (!ticketCipher) {
     VLOG(8) << "No ticket cipher, rejecting PSK.";
     return ResumptionStateResult(
@@ -460,9 +516,8 @@ static ResumptionStateResult getResumptionState(
     return ResumptionStateResult(
         std::make_pair(PskType::Rejected, folly::none));
   } else {
-    const auto& ident = psks->identities[kPskIndex].psk_identity;
     return ResumptionStateResult(
-        ticketCipher->decrypt(ident->clone()),
+        decryptTicket(chlo, ident, *ticketCipher, ticketCache),
         pskMode,
         psks->identities[kPskIndex].obfuscated_ticket_age);
   }
@@ -691,7 +746,7 @@ static Buf getHelloRetryRequest(
   return encodedHelloRetryRequest;
 }
 
-static Buf getServerHello(
+static void addServerHello(
     ProtocolVersion version,
     Random random,
     CipherSuite cipher,
@@ -699,7 +754,8 @@ static Buf getServerHello(
     Optional<NamedGroup> group,
     Optional<Buf> serverShare,
     Buf legacy_session_id,
-    HandshakeContext& handshakeContext) {
+    HandshakeContext& handshakeContext,
+    HandshakeFlight& flight) {
   ServerHello serverHello;
 
   auto realVersion = getRealDraftVersion(version);
@@ -735,9 +791,7 @@ static Buf getServerHello(
     serverPsk.selected_identity = kPskIndex;
     serverHello.extensions.push_back(encodeExtension(std::move(serverPsk)));
   }
-  auto encodedServerHello = encodeHandshake(std::move(serverHello));
-  handshakeContext.appendToTranscript(encodedServerHello);
-  return encodedServerHello;
+  handshakeContext.appendToTranscript(flight.add(std::move(serverHello)));
 }
 
 static Optional<std::string> negotiateAlpn(
@@ -848,10 +902,31 @@ static EarlyDataType negotiateEarlyDataType(
   return EarlyDataType::Accepted;
 }
 
-static Buf getEncryptedExt(
+template <typename CertTypes>
+static Optional<CertificateType> negotiateCertType(
+    const Optional<CertTypes>& clientTypes,
+    const std::vector<CertificateType>& supportedTypes) {
+  if (!clientTypes) {
+    return folly::none;
+  }
+  for (auto type : clientTypes->certificate_types) {
+    if (std::find(supportedTypes.begin(), supportedTypes.end(), type) !=
+        supportedTypes.end()) {
+      return type;
+    }
+  }
+  throw FizzException(
+      "no supported certificate type",
+      AlertDescription::unsupported_certificate);
+}
+
+static void addEncryptedExt(
     HandshakeContext& handshakeContext,
+    HandshakeFlight& flight,
     const folly::Optional<std::string>& selectedAlpn,
     EarlyDataType earlyData,
+    const Optional<CertificateType>& serverCertType,
+    const Optional<CertificateType>& clientCertType,
     std::vector<Extension> otherExtensions) {
   EncryptedExtensions encryptedExt;
   if (selectedAlpn) {
@@ -866,18 +941,28 @@ static Buf getEncryptedExt(
     encryptedExt.extensions.push_back(encodeExtension(ServerEarlyData()));
   }
 
+  if (serverCertType) {
+    SelectedServerCertificateType selected;
+    selected.certificate_type = *serverCertType;
+    encryptedExt.extensions.push_back(encodeExtension(std::move(selected)));
+  }
+
+  if (clientCertType) {
+    SelectedClientCertificateType selected;
+    selected.certificate_type = *clientCertType;
+    encryptedExt.extensions.push_back(encodeExtension(std::move(selected)));
+  }
+
   for (auto& ext : otherExtensions) {
     encryptedExt.extensions.push_back(std::move(ext));
   }
-  auto encodedEncryptedExt =
-      encodeHandshake<EncryptedExtensions>(std::move(encryptedExt));
-  handshakeContext.appendToTranscript(encodedEncryptedExt);
-  return encodedEncryptedExt;
+  handshakeContext.appendToTranscript(flight.add(std::move(encryptedExt)));
 }
 
 static std::pair<std::shared_ptr<SelfCert>, SignatureScheme> chooseCert(
     const FizzServerContext& context,
-    const ClientHello& chlo) {
+    const ClientHello& chlo,
+    CertificateType certType) {
   const auto& clientSigSchemes =
       getExtension<SignatureAlgorithms>(chlo.extensions);
   if (!clientSigSchemes) {
@@ -891,8 +976,8 @@ static std::pair<std::shared_ptr<SelfCert>, SignatureScheme> chooseCert(
               .toStdString();
   }
 
-  auto certAndScheme =
-      context.getCert(sni, clientSigSchemes->supported_signature_algorithms);
+  auto certAndScheme = context.getCert(
+      sni, clientSigSchemes->supported_signature_algorithms, certType);
   if (!certAndScheme) {
     throw FizzException(
         "could not find suitable cert", AlertDescription::handshake_failure);
@@ -900,30 +985,30 @@ static std::pair<std::shared_ptr<SelfCert>, SignatureScheme> chooseCert(
   return *certAndScheme;
 }
 
-static Buf getCertificate(
+static void addCertificate(
     const std::shared_ptr<const SelfCert>& serverCert,
-    HandshakeContext& handshakeContext) {
-  auto encodedCertificate = encodeHandshake(serverCert->getCertMessage());
-  handshakeContext.appendToTranscript(encodedCertificate);
-  return encodedCertificate;
+    HandshakeContext& handshakeContext,
+    HandshakeFlight& flight) {
+  handshakeContext.appendToTranscript(
+      flight.add(serverCert->getCertMessage()));
 }
 
-static Buf getCertificateVerify(
+static void addCertificateVerify(
     SignatureScheme sigScheme,
     Buf signature,
-    HandshakeContext& handshakeContext) {
+    HandshakeContext& handshakeContext,
+    HandshakeFlight& flight) {
   CertificateVerify verify;
   verify.algorithm = sigScheme;
   verify.signature = std::move(signature);
-  auto encodedCertificateVerify = encodeHandshake(std::move(verify));
-  handshakeContext.appendToTranscript(encodedCertificateVerify);
-  return encodedCertificateVerify;
+  handshakeContext.appendToTranscript(flight.add(std::move(verify)));
 }
 
-static Buf getCertificateRequest(
+static void addCertificateRequest(
     const std::vector<SignatureScheme>& acceptableSigSchemes,
     const CertificateVerifier* const verifier,
-    HandshakeContext& handshakeContext) {
+    HandshakeContext& handshakeContext,
+    HandshakeFlight& flight) {
   CertificateRequest request;
   SignatureAlgorithms algos;
   algos.supported_signature_algorithms = acceptableSigSchemes;
@@ -934,9 +1019,33 @@ static Buf getCertificateRequest(
       request.extensions.push_back(std::move(ext));
     }
   }
-  auto encodedCertificateRequest = encodeHandshake(std::move(request));
-  handshakeContext.appendToTranscript(encodedCertificateRequest);
-  return encodedCertificateRequest;
+  handshakeContext.appendToTranscript(flight.add(std::move(request)));
+}
+
+static Future<Actions> toFutureActions(AsyncActions asyncActions) {
+  return folly::variant_match(
+      asyncActions,
+      [](Future<Actions>& futureActions) { return std::move(futureActions); },
+      [](Actions& immediateActions) {
+        return folly::makeFuture(std::move(immediateActions));
+      });
+}
+
+/**
+ * Runs func with the result of future. If the future has already completed
+ * func is run inline and its actions are returned synchronously, otherwise it
+ * is run on executor once the result is available.
+ */
+template <typename T, typename F>
+static AsyncActions
+runOnCallerIfComplete(folly::Executor* executor, Future<T> future, F func) {
+  if (future.isReady()) {
+    return AsyncActions(func(std::move(future.value())));
+  }
+  return std::move(future).via(executor).then(
+      [func = std::move(func)](T result) mutable {
+        return toFutureActions(AsyncActions(func(std::move(result))));
+      });
 }
 
 AsyncActions
@@ -993,7 +1102,10 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
 
   auto resStateResult = getResumptionState(
       chlo,
+      *version,
+      state.context()->getExternalPskStore(),
       state.context()->getTicketCipher(),
+      state.context()->getDecryptedTicketCache(),
       state.context()->getSupportedPskModes());
 
   auto replayCacheResultFuture = getReplayCacheResult(
@@ -1001,21 +1113,18 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
       state.context()->getAcceptEarlyData(*version),
       state.context()->getReplayCache());
 
-  auto results =
-      collectAll(resStateResult.futureResState, replayCacheResultFuture);
-
   using FutureResultType = std::tuple<
       folly::Try<std::pair<PskType, Optional<ResumptionState>>>,
       folly::Try<ReplayCacheResult>>;
-  return results.via(state.executor())
-      .then([&state,
-             chlo = std::move(chlo),
-             cookieState = std::move(cookieState),
-             version = *version,
-             cipher,
-             pskMode = resStateResult.pskMode,
-             obfuscatedAge = resStateResult.obfuscatedAge](
-                FutureResultType result) mutable {
+  auto continuation =
+      [&state,
+       chlo = std::move(chlo),
+       cookieState = std::move(cookieState),
+       version = *version,
+       cipher,
+       pskMode = resStateResult.pskMode,
+       obfuscatedAge = resStateResult.obfuscatedAge](
+          FutureResultType result) mutable -> AsyncActions {
         auto& resumption = *std::get<0>(result);
         auto pskType = resumption.first;
         auto resState = std::move(resumption.second);
@@ -1061,6 +1170,10 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
         auto alpn = negotiateAlpn(chlo, folly::none, *state.context());
 
         auto clockSkew = getClockSkew(resState, obfuscatedAge);
+        Optional<std::chrono::system_clock::time_point> resumedTicketIssueTime;
+        if (resState && pskType == PskType::Resumption) {
+          resumedTicketIssueTime = resState->ticketIssueTime;
+        }
 
         auto earlyDataType = negotiateEarlyDataType(
             state.context()->getAcceptEarlyData(version),
@@ -1149,7 +1262,7 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
             newReadRecordLayer->setSkipEncryptedRecords(
                 earlyDataType == EarlyDataType::Rejected);
 
-            return Future<Actions>(actions(
+            return actions(
                 [handshakeContext = std::move(handshakeContext),
                  version,
                  cipher,
@@ -1173,7 +1286,7 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                   newState.readRecordLayer() = std::move(newReadRecordLayer);
                 },
                 std::move(write),
-                &Transition<StateEnum::ExpectingClientHello>));
+                &Transition<StateEnum::ExpectingClientHello>);
           }
 
           if (state.keyExchangeType().hasValue()) {
@@ -1210,7 +1323,8 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
               AlertDescription::illegal_parameter);
         }
 
-        auto encodedServerHello = getServerHello(
+        HandshakeFlight plaintextFlight(*state.writeRecordLayer());
+        addServerHello(
             version,
             state.context()->getFactory()->makeRandom(),
             cipher,
@@ -1218,7 +1332,8 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
             group,
             std::move(serverShare),
             legacySessionId ? legacySessionId->clone() : nullptr,
-            *handshakeContext);
+            *handshakeContext,
+            plaintextFlight);
 
         // Derive handshake keys.
         auto handshakeWriteRecordLayer =
@@ -1251,25 +1366,47 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
         auto clientHandshakeSecret =
             folly::IOBuf::copyBuffer(folly::range(handshakeReadSecret));
 
-        auto encodedEncryptedExt = getEncryptedExt(
+        bool requestClientAuth =
+            state.context()->getClientAuthMode() != ClientAuthMode::None &&
+            !resState;
+
+        /*
+         * Negotiate certificate types (RFC 7250). These are only selected if
+         * the client offered them and a certificate will be sent.
+         */
+        Optional<CertificateType> serverCertType;
+        Optional<CertificateType> clientCertType;
+        if (!resState) {
+          serverCertType = negotiateCertType(
+              getExtension<ServerCertificateTypes>(chlo.extensions),
+              state.context()->getSupportedServerCertTypes());
+        }
+        if (requestClientAuth) {
+          clientCertType = negotiateCertType(
+              getExtension<ClientCertificateTypes>(chlo.extensions),
+              state.context()->getSupportedClientCertTypes());
+        }
+
+        HandshakeFlight encryptedFlight(*handshakeWriteRecordLayer);
+        addEncryptedExt(
             *handshakeContext,
+            encryptedFlight,
             alpn,
             earlyDataType,
+            serverCertType,
+            clientCertType,
             std::move(additionalExtensions));
 
         /*
-         * Determine we are requesting client auth.
-         * If yes, add CertificateRequest to handshake write and transcript.
+         * If we are requesting client auth, add CertificateRequest to
+         * handshake write and transcript.
          */
-        bool requestClientAuth =
-            state.context()->getClientAuthMode() != ClientAuthMode::None &&
-            !resState;
-        Optional<Buf> encodedCertRequest;
         if (requestClientAuth) {
-          encodedCertRequest = getCertificateRequest(
+          addCertificateRequest(
               state.context()->getSupportedSigSchemes(),
               state.context()->getClientCertVerifier().get(),
-              *handshakeContext);
+              *handshakeContext,
+              encryptedFlight);
         }
 
         /*
@@ -1277,18 +1414,18 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
          * If sending new cert, add Certificate to handshake write and
          * transcript.
          */
-        Optional<Buf> encodedCertificate;
         Future<Optional<Buf>> signature = folly::none;
         Optional<SignatureScheme> sigScheme;
         Optional<std::shared_ptr<const Cert>> serverCert;
         std::shared_ptr<const Cert> clientCert;
         if (!resState) { // TODO or reauth
           std::shared_ptr<const SelfCert> originalSelfCert;
-          std::tie(originalSelfCert, sigScheme) =
-              chooseCert(*state.context(), chlo);
+          std::tie(originalSelfCert, sigScheme) = chooseCert(
+              *state.context(),
+              chlo,
+              serverCertType.value_or(CertificateType::X509));
 
-          encodedCertificate =
-              getCertificate(originalSelfCert, *handshakeContext);
+          addCertificate(originalSelfCert, *handshakeContext, encryptedFlight);
 
           auto toBeSigned = handshakeContext->getHandshakeContext();
           auto asyncSelfCert =
@@ -1310,80 +1447,64 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
           clientCert = std::move(resState->clientCert);
         }
 
-        return signature.via(state.executor())
-            .then([&state,
-                   scheduler = std::move(scheduler),
-                   handshakeContext = std::move(handshakeContext),
-                   cipher,
-                   group,
-                   encodedServerHello = std::move(encodedServerHello),
-                   handshakeWriteRecordLayer =
-                       std::move(handshakeWriteRecordLayer),
-                   handshakeWriteSecret = std::move(handshakeWriteSecret),
-                   handshakeReadRecordLayer =
-                       std::move(handshakeReadRecordLayer),
-                   earlyReadRecordLayer = std::move(earlyReadRecordLayer),
-                   earlyExporterMaster = std::move(earlyExporterMaster),
-                   clientHandshakeSecret = std::move(clientHandshakeSecret),
-                   encodedEncryptedExt = std::move(encodedEncryptedExt),
-                   encodedCertificate = std::move(encodedCertificate),
-                   encodedCertRequest = std::move(encodedCertRequest),
-                   requestClientAuth,
-                   pskType,
-                   pskMode,
-                   sigScheme,
-                   version,
-                   keyExchangeType,
-                   earlyDataType,
-                   replayCacheResult,
-                   serverCert = std::move(serverCert),
-                   clientCert = std::move(clientCert),
-                   alpn = std::move(alpn),
-                   clockSkew,
-                   legacySessionId =
-                       std::move(legacySessionId)](Optional<Buf> sig) mutable {
-              Optional<Buf> encodedCertificateVerify;
+        return runOnCallerIfComplete(
+            state.executor(),
+            std::move(signature),
+            [&state,
+             scheduler = std::move(scheduler),
+             handshakeContext = std::move(handshakeContext),
+             cipher,
+             group,
+             plaintextFlight = std::move(plaintextFlight),
+             encryptedFlight = std::move(encryptedFlight),
+             handshakeWriteRecordLayer = std::move(handshakeWriteRecordLayer),
+             handshakeWriteSecret = std::move(handshakeWriteSecret),
+             handshakeReadRecordLayer = std::move(handshakeReadRecordLayer),
+             earlyReadRecordLayer = std::move(earlyReadRecordLayer),
+             earlyExporterMaster = std::move(earlyExporterMaster),
+             clientHandshakeSecret = std::move(clientHandshakeSecret),
+             requestClientAuth,
+             pskType,
+             pskMode,
+             sigScheme,
+             version,
+             keyExchangeType,
+             earlyDataType,
+             replayCacheResult,
+             serverCert = std::move(serverCert),
+             clientCert = std::move(clientCert),
+             serverCertType,
+             clientCertType,
+             alpn = std::move(alpn),
+             clockSkew,
+             resumedTicketIssueTime,
+             legacySessionId =
+                 std::move(legacySessionId)](Optional<Buf> sig) mutable {
               if (sig) {
-                encodedCertificateVerify = getCertificateVerify(
-                    *sigScheme, std::move(*sig), *handshakeContext);
+                addCertificateVerify(
+                    *sigScheme,
+                    std::move(*sig),
+                    *handshakeContext,
+                    encryptedFlight);
               }
 
-              auto encodedFinished = Protocol::getFinished(
-                  folly::range(handshakeWriteSecret), *handshakeContext);
-
-              folly::IOBufQueue combined;
-              if (encodedCertificate) {
-                if (encodedCertRequest) {
-                  combined.append(std::move(encodedEncryptedExt));
-                  combined.append(std::move(*encodedCertRequest));
-                  combined.append(std::move(*encodedCertificate));
-                  combined.append(std::move(*encodedCertificateVerify));
-                  combined.append(std::move(encodedFinished));
-                } else {
-                  combined.append(std::move(encodedEncryptedExt));
-                  combined.append(std::move(*encodedCertificate));
-                  combined.append(std::move(*encodedCertificateVerify));
-                  combined.append(std::move(encodedFinished));
-                }
-              } else {
-                combined.append(std::move(encodedEncryptedExt));
-                combined.append(std::move(encodedFinished));
-              }
+              Finished finished;
+              finished.verify_data = handshakeContext->getFinishedData(
+                  folly::range(handshakeWriteSecret));
+              handshakeContext->appendToTranscript(
+                  encryptedFlight.add(std::move(finished)));
 
               // Some middleboxes appear to break if the first encrypted record
               // is larger than ~1300 bytes (likely if it does not fit in the
               // first packet).
-              auto writtenEncryptedHandshake =
-                  handshakeWriteRecordLayer->writeHandshake(
-                      combined.splitAtMost(1000));
-              if (!combined.empty()) {
+              auto writtenEncryptedHandshake = encryptedFlight.write(1000);
+              if (!encryptedFlight.empty()) {
                 writtenEncryptedHandshake->prependChain(
-                    handshakeWriteRecordLayer->writeHandshake(combined.move()));
+                    encryptedFlight.write());
               }
 
               WriteToSocket write;
-              write.data = state.writeRecordLayer()->writeHandshake(
-                  std::move(encodedServerHello));
+              write.data = plaintextFlight.write();
               if (legacySessionId && !legacySessionId->empty()) {
                 write.data->prependChain(
                     folly::IOBuf::wrapBuffer(FakeChangeCipherSpec));
@@ -1432,6 +1553,8 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                                 exporterMaster = std::move(exporterMaster),
                                 serverCert = std::move(serverCert),
                                 clientCert = std::move(clientCert),
+                                serverCertType,
+                                clientCertType,
                                 cipher,
                                 group,
                                 sigScheme,
@@ -1444,7 +1567,9 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                                 alpn = std::move(alpn),
                                 earlyDataTypeSave,
                                 replayCacheResult,
-                                clockSkew](State& newState) mutable {
+                                clockSkew,
+                                resumedTicketIssueTime](
+                                   State& newState) mutable {
                 newState.writeRecordLayer() =
                     std::move(appTrafficWriteRecordLayer);
                 newState.handshakeContext() = std::move(handshakeContext);
@@ -1452,6 +1577,10 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                 newState.exporterMasterSecret() = std::move(exporterMaster);
                 newState.serverCert() = std::move(*serverCert);
                 newState.clientCert() = std::move(clientCert);
+                newState.serverCertType() =
+                    serverCertType.value_or(CertificateType::X509);
+                newState.clientCertType() =
+                    clientCertType.value_or(CertificateType::X509);
                 newState.version() = version;
                 newState.cipher() = cipher;
                 newState.group() = group;
@@ -1465,6 +1594,7 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                 newState.replayCacheResult() = replayCacheResult;
                 newState.alpn() = std::move(alpn);
                 newState.clientClockSkew() = clockSkew;
+                newState.resumedTicketIssueTime() = resumedTicketIssueTime;
               };
 
               if (earlyDataType == EarlyDataType::Accepted) {
@@ -1500,6 +1630,23 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                     transition);
               }
             });
+      };
+
+  // When neither the ticket cipher nor the replay cache had to do async work
+  // (for example a full handshake, or a synchronous ticket cipher) we continue
+  // inline rather than paying for collectAll and a hop through the executor.
+  if (resStateResult.futureResState.isReady() &&
+      replayCacheResultFuture.isReady()) {
+    return continuation(FutureResultType(
+        std::move(resStateResult.futureResState.getTry()),
+        std::move(replayCacheResultFuture.getTry())));
+  }
+
+  return collectAll(resStateResult.futureResState, replayCacheResultFuture)
+      .via(state.executor())
+      .then([continuation = std::move(continuation)](
+                FutureResultType result) mutable {
+        return toFutureActions(continuation(std::move(result)));
       });
 }
 
@@ -1586,9 +1733,21 @@ static WriteToSocket writeNewSessionTicket(
   return nstWrite;
 }
 
+static Buf getTicketNonce(uint32_t ticketIndex) {
+  // The first ticket on a connection uses an empty nonce.
+  if (ticketIndex == 0) {
+    return folly::IOBuf::create(0);
+  }
+  auto nonce = folly::IOBuf::create(sizeof(uint32_t));
+  folly::io::Appender appender(nonce.get(), 0);
+  fizz::detail::write(ticketIndex, appender);
+  return nonce;
+}
+
 static Future<Optional<WriteToSocket>> generateTicket(
     const State& state,
     const std::vector<uint8_t>& resumptionMasterSecret,
+    uint32_t ticketIndex,
     Buf appToken = nullptr) {
   auto ticketCipher = state.context()->getTicketCipher();
 
@@ -1604,7 +1763,7 @@ static Future<Optional<WriteToSocket>> generateTicket(
     resumptionSecret =
         folly::IOBuf::copyBuffer(folly::range(resumptionMasterSecret));
   } else {
-    ticketNonce = folly::IOBuf::create(0);
+    ticketNonce = getTicketNonce(ticketIndex);
     resumptionSecret = state.keyScheduler()->getResumptionSecret(
         folly::range(resumptionMasterSecret), ticketNonce->coalesce());
   }
@@ -1642,6 +1801,59 @@ static Future<Optional<WriteToSocket>> generateTicket(
           });
 }
 
+/**
+ * Generates numTickets tickets and combines them into a single write.
+ * Tickets that the cipher declines to issue are left out.
+ */
+static Future<Optional<WriteToSocket>> generateTickets(
+    const State& state,
+    const std::vector<uint8_t>& resumptionMasterSecret,
+    size_t numTickets) {
+  if (numTickets == 1) {
+    return generateTicket(
+        state, resumptionMasterSecret, state.numTicketsIssued());
+  }
+
+  std::vector<Future<Optional<WriteToSocket>>> ticketFutures;
+  for (size_t i = 0; i < numTickets; ++i) {
+    ticketFutures.push_back(generateTicket(
+        state, resumptionMasterSecret, state.numTicketsIssued() + i));
+  }
+  return folly::collectAll(ticketFutures)
+      .then([](std::vector<folly::Try<Optional<WriteToSocket>>> results) {
+        Optional<WriteToSocket> combined;
+        for (auto& result : results) {
+          auto& nstWrite = result.value();
+          if (!nstWrite) {
+            continue;
+          }
+          if (!combined) {
+            combined = std::move(*nstWrite);
+          } else {
+            combined->data->prependChain(std::move(nstWrite->data));
+          }
+        }
+        return combined;
+      });
+}
+
+static size_t getNumTicketsOnHandshake(const State& state) {
+  if (!state.context()->getSendNewSessionTicket()) {
+    return 0;
+  }
+  auto ticketPolicy = state.context()->getTicketPolicy();
+  if (!ticketPolicy) {
+    return 1;
+  }
+  auto numTickets = ticketPolicy->numTicketsOnHandshake(state);
+  if (numTickets > 1 &&
+      getRealDraftVersion(*state.version()) == ProtocolVersion::tls_1_3_20) {
+    // Without a ticket nonce every ticket would carry the same secret.
+    numTickets = 1;
+  }
+  return numTickets;
+}
+
 AsyncActions
 EventHandler<ServerTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
     handle(const State& state, Param param) {
@@ -1655,6 +1867,13 @@ EventHandler<ServerTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
         AlertDescription::illegal_parameter);
   }
 
+  if (state.clientCertType() == CertificateType::RawPublicKey &&
+      certMsg.certificate_list.size() > 1) {
+    throw FizzException(
+        "raw public key certificate message with multiple entries",
+        AlertDescription::illegal_parameter);
+  }
+
   std::vector<std::shared_ptr<const PeerCert>> clientCerts;
   for (auto& certEntry : certMsg.certificate_list) {
     // We don't request any extensions, so this ought to be empty
@@ -1664,8 +1883,14 @@ EventHandler<ServerTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
           AlertDescription::illegal_parameter);
     }
 
-    clientCerts.emplace_back(state.context()->getFactory()->makePeerCert(
-        std::move(certEntry.cert_data)));
+    if (state.clientCertType() == CertificateType::RawPublicKey) {
+      clientCerts.emplace_back(
+          state.context()->getFactory()->makePeerRawPublicKey(
+              std::move(certEntry.cert_data)));
+    } else {
+      clientCerts.emplace_back(state.context()->getFactory()->makePeerCert(
+          std::move(certEntry.cert_data)));
+    }
   }
 
   if (clientCerts.empty()) {
@@ -1714,27 +1939,45 @@ AsyncActions EventHandler<
       state.handshakeContext()->getHandshakeContext()->coalesce(),
       certVerify.signature->coalesce());
 
-  try {
-    const auto& verifier = state.context()->getClientCertVerifier();
-    if (verifier) {
-      verifier->verify(certs);
+  Future<folly::Unit> verified = folly::unit;
+  const auto& verifier = state.context()->getClientCertVerifier();
+  if (verifier) {
+    auto asyncVerifier =
+        dynamic_cast<const AsyncCertificateVerifier*>(verifier.get());
+    if (asyncVerifier) {
+      verified = asyncVerifier->verifyFuture(certs);
+    } else {
+      verified = folly::makeFutureWith([&]() { verifier->verify(certs); });
     }
-  } catch (const FizzException&) {
-    throw;
-  } catch (const std::exception& e) {
-    throw FizzException(
-        folly::to<std::string>("client certificate failure: ", e.what()),
-        AlertDescription::bad_certificate);
+    verified = std::move(verified).onError(
+        [](folly::exception_wrapper ew) -> folly::Unit {
+          if (ew.is_compatible_with<FizzException>()) {
+            ew.throw_exception();
+          }
+          throw FizzException(
+              folly::to<std::string>(
+                  "client certificate failure: ",
+                  ew.get_exception() ? ew.get_exception()->what()
+                                     : ew.what().toStdString()),
+              AlertDescription::bad_certificate);
+        });
   }
 
-  state.handshakeContext()->appendToTranscript(*certVerify.originalEncoding);
-
-  return actions(
-      [cert = std::move(leafCert)](State& newState) {
-        newState.unverifiedCertChain() = folly::none;
-        newState.clientCert() = std::move(cert);
-      },
-      &Transition<StateEnum::ExpectingFinished>);
+  return runOnCallerIfComplete(
+      state.executor(),
+      std::move(verified),
+      [&state,
+       originalEncoding = std::move(certVerify.originalEncoding),
+       cert = std::move(leafCert)](folly::Unit) mutable {
+        state.handshakeContext()->appendToTranscript(*originalEncoding);
+
+        return actions(
+            [cert = std::move(cert)](State& newState) {
+              newState.unverifiedCertChain() = folly::none;
+              newState.clientCert() = std::move(cert);
+            },
+            &Transition<StateEnum::ExpectingFinished>);
+      });
 }
 
 AsyncActions
@@ -1772,20 +2015,32 @@ EventHandler<ServerTypes, StateEnum::ExpectingFinished, Event::Finished>::
       state.handshakeContext()->getHandshakeContext()->coalesce());
   state.keyScheduler()->clearMasterSecret();
 
+  auto numTickets = getNumTicketsOnHandshake(state);
+
   auto saveState = [readRecordLayer = std::move(readRecordLayer),
-                    resumptionMasterSecret](State& newState) mutable {
+                    resumptionMasterSecret,
+                    numTickets](State& newState) mutable {
     newState.readRecordLayer() = std::move(readRecordLayer);
 
+    // Release handshake material that is not needed once application data is
+    // flowing.
+    newState.handshakeContext().reset();
+    newState.clientHandshakeSecret() = folly::none;
+    newState.unverifiedCertChain() = folly::none;
+    newState.appTokenValidator().reset();
+
     newState.resumptionMasterSecret() = std::move(resumptionMasterSecret);
+    newState.numTicketsIssued() += numTickets;
   };
 
-  if (!state.context()->getSendNewSessionTicket()) {
+  if (numTickets == 0) {
     return actions(
         std::move(saveState),
         &Transition<StateEnum::AcceptingData>,
         ReportHandshakeSuccess());
   } else {
-    auto ticketFuture = generateTicket(state, resumptionMasterSecret);
+    auto ticketFuture =
+        generateTickets(state, resumptionMasterSecret, numTickets);
     return ticketFuture.via(state.executor())
         .then([saveState = std::move(saveState)](
                   Optional<WriteToSocket> nstWrite) mutable {
@@ -1813,13 +2068,16 @@ AsyncActions EventHandler<
   auto ticketFuture = generateTicket(
       state,
       state.resumptionMasterSecret(),
+      state.numTicketsIssued(),
       std::move(writeNewSessionTicket.appToken));
   return ticketFuture.via(state.executor())
       .then([](Optional<WriteToSocket> nstWrite) {
         if (!nstWrite) {
           return actions();
         }
-        return actions(std::move(*nstWrite));
+        return actions(
+            [](State& newState) { newState.numTicketsIssued()++; },
+            std::move(*nstWrite));
       });
 }
 
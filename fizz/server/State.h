@@ -169,6 +169,20 @@ class State {
     return alpn_;
   }
 
+  /**
+   * Certificate type (RFC 7250) we authenticated with on this connection.
+   */
+  CertificateType serverCertType() const {
+    return serverCertType_;
+  }
+
+  /**
+   * Certificate type (RFC 7250) the client was asked to authenticate with.
+   */
+  CertificateType clientCertType() const {
+    return clientCertType_;
+  }
+
   /**
    * How much the client ticket age was off (on a PSK connection). Negative if
    * the client was behind.
@@ -177,6 +191,15 @@ class State {
     return clientClockSkew_;
   }
 
+  /**
+   * Issue time of the ticket the connection was resumed with (on a resumed
+   * connection).
+   */
+  folly::Optional<std::chrono::system_clock::time_point>
+  resumedTicketIssueTime() const {
+    return resumedTicketIssueTime_;
+  }
+
   /**
    * Callback to application that validates appToken from ResumptionState.
    * If this function returns false, early data should be rejected.
@@ -249,6 +272,14 @@ class State {
     return resumptionMasterSecret_;
   }
 
+  /**
+   * Number of NewSessionTickets generated on this connection so far. Used to
+   * give each ticket a distinct nonce.
+   */
+  uint32_t numTicketsIssued() const {
+    return numTicketsIssued_;
+  }
+
   /**
    * The certificate chain sent by the client pre-verification
    *
@@ -343,9 +374,20 @@ class State {
   auto& alpn() {
     return alpn_;
   }
+
+  auto& serverCertType() {
+    return serverCertType_;
+  }
+
+  auto& clientCertType() {
+    return clientCertType_;
+  }
   auto& clientClockSkew() {
     return clientClockSkew_;
   }
+  auto& resumedTicketIssueTime() {
+    return resumedTicketIssueTime_;
+  }
   auto& appTokenValidator() {
     return appTokenValidator_;
   }
@@ -358,6 +400,9 @@ class State {
   auto& resumptionMasterSecret() {
     return resumptionMasterSecret_;
   }
+  auto& numTicketsIssued() {
+    return numTicketsIssued_;
+  }
   auto& earlyExporterMasterSecret() {
     return earlyExporterMasterSecret_;
   }
@@ -366,7 +411,11 @@ class State {
   }
 
  private:
+  // Small fields are kept together ahead of the pointers to avoid padding.
   StateEnum state_{StateEnum::Uninitialized};
+  CertificateType serverCertType_{CertificateType::X509};
+  CertificateType clientCertType_{CertificateType::X509};
+  uint32_t numTicketsIssued_{0};
 
   folly::Executor* executor_;
 
@@ -399,6 +448,8 @@ class State {
   folly::Optional<Buf> clientHandshakeSecret_;
   folly::Optional<std::string> alpn_;
   folly::Optional<std::chrono::milliseconds> clientClockSkew_;
+  folly::Optional<std::chrono::system_clock::time_point>
+      resumedTicketIssueTime_;
   std::unique_ptr<AppTokenValidator> appTokenValidator_;
   std::shared_ptr<ServerExtensions> extensions_;
   std::vector<uint8_t> resumptionMasterSecret_;
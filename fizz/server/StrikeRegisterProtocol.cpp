@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/StrikeRegisterProtocol.h>
+
+namespace fizz {
+namespace server {
+
+static constexpr size_t kFrameLengthSize = sizeof(uint32_t);
+static constexpr size_t kFrameHeaderSize = sizeof(uint32_t) + sizeof(uint16_t);
+
+static Buf finishFrame(Buf body) {
+  auto length = body->computeChainDataLength();
+  auto frame = folly::IOBuf::create(kFrameLengthSize);
+  folly::io::Appender appender(frame.get(), kFrameLengthSize);
+  appender.writeBE<uint32_t>(folly::to<uint32_t>(length));
+  frame->prependChain(std::move(body));
+  return frame;
+}
+
+/**
+ * Splits the next complete frame off buf, excluding the length prefix.
+ */
+static Buf readFrame(folly::IOBufQueue& buf) {
+  if (buf.empty()) {
+    return nullptr;
+  }
+  folly::io::Cursor cursor(buf.front());
+  if (!cursor.canAdvance(kFrameLengthSize)) {
+    return nullptr;
+  }
+  auto length = cursor.readBE<uint32_t>();
+  if (length > kMaxStrikeRegisterFrameSize || length < kFrameHeaderSize) {
+    throw std::runtime_error("invalid strike register frame length");
+  }
+  if (buf.chainLength() < kFrameLengthSize + length) {
+    return nullptr;
+  }
+  buf.trimStart(kFrameLengthSize);
+  return buf.split(length);
+}
+
+Buf encodeStrikeRegisterRequest(const StrikeRegisterRequest& request) {
+  if (request.identifiers.size() > kMaxStrikeRegisterBatchSize) {
+    throw std::runtime_error("strike register batch too large");
+  }
+  size_t length = kFrameHeaderSize;
+  for (const auto& identifier : request.identifiers) {
+    length += fizz::detail::getBufSize<uint8_t>(identifier);
+  }
+  auto body = folly::IOBuf::create(length);
+  folly::io::Appender appender(body.get(), length);
+  fizz::detail::write(request.batchId, appender);
+  fizz::detail::write(
+      static_cast<uint16_t>(request.identifiers.size()), appender);
+  for (const auto& identifier : request.identifiers) {
+    fizz::detail::writeBuf<uint8_t>(identifier, appender);
+  }
+  return finishFrame(std::move(body));
+}
+
+Buf encodeStrikeRegisterResponse(const StrikeRegisterResponse& response) {
+  if (response.results.size() > kMaxStrikeRegisterBatchSize) {
+    throw std::runtime_error("strike register batch too large");
+  }
+  size_t length = kFrameHeaderSize + response.results.size();
+  auto body = folly::IOBuf::create(length);
+  folly::io::Appender appender(body.get(), length);
+  fizz::detail::write(response.batchId, appender);
+  fizz::detail::write(
+      static_cast<uint16_t>(response.results.size()), appender);
+  for (auto result : response.results) {
+    fizz::detail::write(static_cast<uint8_t>(result), appender);
+  }
+  return finishFrame(std::move(body));
+}
+
+folly::Optional<StrikeRegisterRequest> decodeStrikeRegisterRequest(
+    folly::IOBufQueue& buf) {
+  auto frame = readFrame(buf);
+  if (!frame) {
+    return folly::none;
+  }
+  folly::io::Cursor cursor(frame.get());
+  StrikeRegisterRequest request;
+  fizz::detail::read(request.batchId, cursor);
+  uint16_t count;
+  fizz::detail::read(count, cursor);
+  request.identifiers.reserve(count);
+  for (uint16_t i = 0; i < count; ++i) {
+    Buf identifier;
+    fizz::detail::readBuf<uint8_t>(identifier, cursor);
+    request.identifiers.push_back(std::move(identifier));
+  }
+  if (!cursor.isAtEnd()) {
+    throw std::runtime_error("trailing data in strike register request");
+  }
+  return std::move(request);
+}
+
+folly::Optional<StrikeRegisterResponse> decodeStrikeRegisterResponse(
+    folly::IOBufQueue& buf) {
+  auto frame = readFrame(buf);
+  if (!frame) {
+    return folly::none;
+  }
+  folly::io::Cursor cursor(frame.get());
+  StrikeRegisterResponse response;
+  fizz::detail::read(response.batchId, cursor);
+  uint16_t count;
+  fizz::detail::read(count, cursor);
+  response.results.reserve(count);
+  for (uint16_t i = 0; i < count; ++i) {
+    uint8_t result;
+    fizz::detail::read(result, cursor);
+    if (result > static_cast<uint8_t>(ReplayCacheResult::DefinitelyReplay)) {
+      throw std::runtime_error("invalid strike register result");
+    }
+    response.results.push_back(static_cast<ReplayCacheResult>(result));
+  }
+  if (!cursor.isAtEnd()) {
+    throw std::runtime_error("trailing data in strike register response");
+  }
+  return std::move(response);
+}
+} // namespace server
+} // namespace fizz
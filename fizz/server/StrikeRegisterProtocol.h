@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+#include <fizz/server/ReplayCache.h>
+#include <folly/io/IOBufQueue.h>
+
+namespace fizz {
+namespace server {
+
+/*
+ * Wire format spoken between RemoteReplayCache and a strike register service.
+ * Every message is framed as:
+ *
+ * uint32 length of the remainder of the frame
+ * uint32 batch id
+ * uint16 number of entries
+ * entries
+ *
+ * Request entries are opaque identifiers (<1..255> byte vectors). Response
+ * entries are a single byte ReplayCacheResult for each identifier, in request
+ * order. A server must answer the batches on a connection in the order they
+ * were received so that clients can pipeline requests.
+ */
+
+static constexpr size_t kMaxStrikeRegisterIdentifierLength = 0xff;
+static constexpr size_t kMaxStrikeRegisterBatchSize = 0xffff;
+static constexpr size_t kMaxStrikeRegisterFrameSize = 0x1000000; // 16M
+
+// Read buffer sizing for either end of a strike register connection.
+static constexpr uint32_t kStrikeRegisterMinReadSize = 1460;
+static constexpr uint32_t kStrikeRegisterMaxReadSize = 4000;
+
+struct StrikeRegisterRequest {
+  uint32_t batchId;
+  std::vector<Buf> identifiers;
+};
+
+struct StrikeRegisterResponse {
+  uint32_t batchId;
+  std::vector<ReplayCacheResult> results;
+};
+
+Buf encodeStrikeRegisterRequest(const StrikeRegisterRequest& request);
+Buf encodeStrikeRegisterResponse(const StrikeRegisterResponse& response);
+
+/**
+ * Attempt to read a complete frame from the front of buf. Returns folly::none
+ * if more data is needed, and throws on malformed frames.
+ */
+folly::Optional<StrikeRegisterRequest> decodeStrikeRegisterRequest(
+    folly::IOBufQueue& buf);
+folly::Optional<StrikeRegisterResponse> decodeStrikeRegisterResponse(
+    folly::IOBufQueue& buf);
+} // namespace server
+} // namespace fizz
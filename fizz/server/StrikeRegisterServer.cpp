@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/StrikeRegisterServer.h>
+
+namespace fizz {
+namespace server {
+
+ReplayCacheResult StrikeRegister::check(
+    folly::ByteRange identifier,
+    std::chrono::steady_clock::time_point now) {
+  rotate(now);
+
+  std::string key(identifier.begin(), identifier.end());
+  if (current_.count(key) || previous_.count(key)) {
+    return ReplayCacheResult::DefinitelyReplay;
+  }
+  if (current_.size() >= capacity_) {
+    return ReplayCacheResult::MaybeReplay;
+  }
+  current_.insert(std::move(key));
+  return ReplayCacheResult::NotReplay;
+}
+
+void StrikeRegister::rotate(std::chrono::steady_clock::time_point now) {
+  if (!currentStart_) {
+    currentStart_ = now;
+    return;
+  }
+  if (now - *currentStart_ < window_) {
+    return;
+  }
+  if (now - *currentStart_ < 2 * window_) {
+    previous_ = std::move(current_);
+  } else {
+    previous_.clear();
+  }
+  current_.clear();
+  currentStart_ = now;
+}
+
+class StrikeRegisterServer::Connection
+    : public folly::AsyncTransportWrapper::ReadCallback,
+      public folly::AsyncTransportWrapper::WriteCallback {
+ public:
+  Connection(StrikeRegisterServer& server, folly::AsyncSocket::UniquePtr socket)
+      : server_(server), socket_(std::move(socket)) {
+    socket_->setReadCB(this);
+  }
+
+  ~Connection() override {
+    socket_->setReadCB(nullptr);
+    socket_->closeNow();
+  }
+
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    auto readSpace = readBuf_.preallocate(
+        kStrikeRegisterMinReadSize, kStrikeRegisterMaxReadSize);
+    *bufReturn = readSpace.first;
+    *lenReturn = readSpace.second;
+  }
+
+  void readDataAvailable(size_t len) noexcept override {
+    readBuf_.postallocate(len);
+    try {
+      // Answer everything that is available with a single write.
+      folly::IOBufQueue responses(folly::IOBufQueue::cacheChainLength());
+      while (auto request = decodeStrikeRegisterRequest(readBuf_)) {
+        StrikeRegisterResponse response;
+        response.batchId = request->batchId;
+        response.results.reserve(request->identifiers.size());
+        for (auto& identifier : request->identifiers) {
+          response.results.push_back(
+              server_.strikeRegister_.check(identifier->coalesce()));
+        }
+        responses.append(encodeStrikeRegisterResponse(response));
+      }
+      if (!responses.empty()) {
+        socket_->writeChain(this, responses.move());
+      }
+    } catch (const std::exception& ex) {
+      VLOG(4) << "Bad strike register request: " << ex.what();
+      server_.removeConnection(this);
+    }
+  }
+
+  void readEOF() noexcept override {
+    server_.removeConnection(this);
+  }
+
+  void readErr(const folly::AsyncSocketException& ex) noexcept override {
+    VLOG(4) << "Strike register read error: " << ex.what();
+    server_.removeConnection(this);
+  }
+
+  void writeSuccess() noexcept override {}
+
+  void writeErr(size_t, const folly::AsyncSocketException& ex) noexcept
+      override {
+    VLOG(4) << "Strike register write error: " << ex.what();
+    server_.removeConnection(this);
+  }
+
+ private:
+  StrikeRegisterServer& server_;
+  folly::AsyncSocket::UniquePtr socket_;
+  folly::IOBufQueue readBuf_{folly::IOBufQueue::cacheChainLength()};
+};
+
+StrikeRegisterServer::StrikeRegisterServer(
+    folly::EventBase* evb,
+    std::chrono::milliseconds window,
+    size_t capacity)
+    : evb_(evb), strikeRegister_(window, capacity) {}
+
+StrikeRegisterServer::~StrikeRegisterServer() {
+  socket_.reset();
+  connections_.clear();
+}
+
+void StrikeRegisterServer::start(const folly::SocketAddress& address) {
+  socket_ = folly::AsyncServerSocket::UniquePtr(
+      new folly::AsyncServerSocket(evb_));
+  socket_->bind(address);
+  socket_->listen(1024);
+  socket_->addAcceptCallback(this, evb_);
+  socket_->startAccepting();
+}
+
+folly::SocketAddress StrikeRegisterServer::getAddress() const {
+  folly::SocketAddress addr;
+  socket_->getAddress(&addr);
+  return addr;
+}
+
+void StrikeRegisterServer::connectionAccepted(
+    int fd,
+    const folly::SocketAddress& /* clientAddr */) noexcept {
+  auto socket =
+      folly::AsyncSocket::UniquePtr(new folly::AsyncSocket(evb_, fd));
+  socket->setNoDelay(true);
+  auto connection = std::make_unique<Connection>(*this, std::move(socket));
+  auto connectionPtr = connection.get();
+  connections_.emplace(connectionPtr, std::move(connection));
+}
+
+void StrikeRegisterServer::acceptError(const std::exception& ex) noexcept {
+  LOG(ERROR) << "Strike register accept error: " << ex.what();
+}
+
+void StrikeRegisterServer::removeConnection(Connection* connection) {
+  // The socket uses delayed destruction, so this is safe to call from within
+  // one of its callbacks.
+  connections_.erase(connection);
+}
+} // namespace server
+} // namespace fizz
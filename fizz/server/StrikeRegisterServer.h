@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/StrikeRegisterProtocol.h>
+#include <folly/io/async/AsyncServerSocket.h>
+#include <folly/io/async/AsyncSocket.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fizz {
+namespace server {
+
+/**
+ * In-memory strike register. Identifiers are remembered for at least window
+ * and at most twice window, which should cover the clock skew tolerance used
+ * for accepting early data.
+ *
+ * Once capacity identifiers have been recorded in the current window, new
+ * identifiers are answered with MaybeReplay rather than evicting entries that
+ * could still be replayed.
+ */
+class StrikeRegister {
+ public:
+  StrikeRegister(std::chrono::milliseconds window, size_t capacity)
+      : window_(window), capacity_(capacity) {}
+
+  ReplayCacheResult check(
+      folly::ByteRange identifier,
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now());
+
+ private:
+  void rotate(std::chrono::steady_clock::time_point now);
+
+  std::chrono::milliseconds window_;
+  size_t capacity_;
+
+  std::unordered_set<std::string> current_;
+  std::unordered_set<std::string> previous_;
+  folly::Optional<std::chrono::steady_clock::time_point> currentStart_;
+};
+
+/**
+ * Reference strike register service for RemoteReplayCache. Answers every
+ * batch from a single StrikeRegister on the given EventBase. Suitable for
+ * tests and for single-instance deployments.
+ */
+class StrikeRegisterServer : public folly::AsyncServerSocket::AcceptCallback {
+ public:
+  StrikeRegisterServer(
+      folly::EventBase* evb,
+      std::chrono::milliseconds window = std::chrono::seconds(10),
+      size_t capacity = 1000000);
+
+  ~StrikeRegisterServer() override;
+
+  /**
+   * Start accepting connections on address. Pass port 0 to bind an ephemeral
+   * port, which can then be retrieved with getAddress().
+   */
+  void start(const folly::SocketAddress& address);
+
+  folly::SocketAddress getAddress() const;
+
+  void connectionAccepted(
+      int fd,
+      const folly::SocketAddress& clientAddr) noexcept override;
+
+  void acceptError(const std::exception& ex) noexcept override;
+
+ private:
+  class Connection;
+
+  void removeConnection(Connection* connection);
+
+  folly::EventBase* evb_;
+  StrikeRegister strikeRegister_;
+  folly::AsyncServerSocket::UniquePtr socket_;
+  std::unordered_map<Connection*, std::unique_ptr<Connection>> connections_;
+};
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/TicketPolicy.h>
+
+#include <fizz/server/State.h>
+
+namespace fizz {
+namespace server {
+
+size_t FixedTicketPolicy::numTicketsOnHandshake(const State& /*state*/) const {
+  return numTickets_;
+}
+
+size_t ResumptionAwareTicketPolicy::numTicketsOnHandshake(
+    const State& state) const {
+  if (state.pskType() == PskType::Resumption &&
+      state.resumedTicketIssueTime()) {
+    auto expiry = *state.resumedTicketIssueTime() + options_.ticketValidity;
+    auto remaining = std::chrono::duration_cast<std::chrono::seconds>(
+        expiry - now());
+    if (remaining.count() >
+        options_.ticketValidity.count() * options_.reissueFraction) {
+      VLOG(8) << "Resumed ticket has " << remaining.count()
+              << "s left, issuing " << options_.numTicketsOnResumption;
+      return options_.numTicketsOnResumption;
+    }
+  }
+  return options_.numTickets;
+}
+} // namespace server
+} // namespace fizz
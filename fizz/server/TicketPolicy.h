@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace fizz {
+namespace server {
+
+class State;
+
+/**
+ * Decides how many NewSessionTickets are sent when a handshake completes.
+ *
+ * Issuing a ticket costs a ticket encryption, so policies can skip issuance
+ * when the client is unlikely to need a new ticket, or issue several so that
+ * the client can use a different ticket for each later connection.
+ *
+ * To defer issuance (for example until the connection has been idle), a
+ * policy can return 0 and the application can later call
+ * writeNewSessionTicket() on the transport.
+ */
+class TicketPolicy {
+ public:
+  virtual ~TicketPolicy() = default;
+
+  /**
+   * Number of tickets to send after the client Finished has been received.
+   * state is the state at that point; pskType() and resumedTicketIssueTime()
+   * describe how the handshake was resumed, if at all.
+   */
+  virtual size_t numTicketsOnHandshake(const State& state) const = 0;
+};
+
+/**
+ * Sends a fixed number of tickets after every handshake.
+ */
+class FixedTicketPolicy : public TicketPolicy {
+ public:
+  explicit FixedTicketPolicy(size_t numTickets = 1)
+      : numTickets_(numTickets) {}
+
+  size_t numTicketsOnHandshake(const State& state) const override;
+
+ private:
+  size_t numTickets_;
+};
+
+/**
+ * Sends numTickets tickets after full handshakes and after resumptions whose
+ * ticket is nearing expiry. Resumptions using a ticket that still has more
+ * than reissueFraction of ticketValidity left only get numTicketsOnResumption
+ * tickets.
+ *
+ * By default two tickets are sent after full handshakes and resumptions with
+ * an old ticket, so that clients keeping several tickets (such as
+ * MultiTicketPskCache) have a spare for parallel connections. Resumptions
+ * with a fresh ticket get a single ticket, replacing the one just used, as
+ * clients following RFC 8446 C.4 use each ticket only once. Setting
+ * numTicketsOnResumption to 0 saves that ticket encryption, but is only
+ * appropriate if clients reuse tickets; otherwise every other connection
+ * from a single-use client ends up as a full handshake.
+ *
+ * ticketValidity should match the validity configured on the TicketCipher.
+ */
+class ResumptionAwareTicketPolicy : public TicketPolicy {
+ public:
+  struct Options {
+    std::chrono::seconds ticketValidity{std::chrono::hours(1)};
+    double reissueFraction{0.5};
+    size_t numTickets{2};
+    size_t numTicketsOnResumption{1};
+  };
+
+  ResumptionAwareTicketPolicy() : ResumptionAwareTicketPolicy(Options()) {}
+  explicit ResumptionAwareTicketPolicy(Options options)
+      : options_(std::move(options)) {}
+
+  size_t numTicketsOnHandshake(const State& state) const override;
+
+ protected:
+  virtual std::chrono::system_clock::time_point now() const {
+    return std::chrono::system_clock::now();
+  }
+
+ private:
+  Options options_;
+};
+} // namespace server
+} // namespace fizz
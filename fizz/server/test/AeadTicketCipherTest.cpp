@@ -42,6 +42,19 @@ static constexpr StringPiece ticket3{
 static constexpr StringPiece ticket4{
     "5cef31d266ca1fe1d634de9b95668d3d8895d4837d3ba81787185ff51c056e95000000005b2168cc0fda4f9987b5e9d045845ba4809ac5189158c578c0e5d11b00"};
 
+// V2 tickets, salt as above.
+// key id: 12d3b018
+static constexpr StringPiece v2Ticket1{
+    "0212d3b018444444444444444444444444444444444444444444444444444444444444444400000000579bb5b10c83d7a581f6b8f7bd3a07dace9800799bd42d14ab4dc34c3f"};
+static constexpr StringPiece v2Ticket2{
+    "0212d3b018444444444444444444444444444444444444444444444444444444444444444400000001f444b4f0a0d1dd8b26d3a0afa25dda7aafe807ba3c81bfd7340004f0a7"};
+// Uses ticketSecret2, key id: db8191cb
+static constexpr StringPiece v2Ticket3{
+    "02db8191cb4444444444444444444444444444444444444444444444444444444444444444000000005575d0d1dce49cfc5b7e6c6c592fcecc5c17fb6934f48cf4a09ab56f3d"};
+// v2Ticket1 with the key id of ticketSecret2.
+static constexpr StringPiece v2TicketWrongKeyId{
+    "02db8191cb444444444444444444444444444444444444444444444444444444444444444400000000579bb5b10c83d7a581f6b8f7bd3a07dace9800799bd42d14ab4dc34c3f"};
+
 static constexpr StringPiece badTicket{
     "5d19a72a3becb5b061346fdf1ec6f9d9d4ddd82cb5f34a8ba0d19e4b69"};
 
@@ -133,6 +146,46 @@ TEST_F(AeadTicketCipherTest, TestEncrypt) {
   EXPECT_EQ(result->second, std::chrono::seconds(5));
 }
 
+TEST_F(AeadTicketCipherTest, TestEncryptV2) {
+  setTicketSecrets();
+  cipher_.setTokenFormat(TokenFormat::V2);
+  useMockRandom();
+  EXPECT_CALL(codec_, _encode(_)).Times(2).WillRepeatedly(InvokeWithoutArgs(
+      []() { return IOBuf::copyBuffer("encodedticket"); }));
+  auto result1 = cipher_.encrypt(ResumptionState()).get();
+  auto result2 = cipher_.encrypt(ResumptionState()).get();
+  ASSERT_TRUE(result1.hasValue());
+  ASSERT_TRUE(result2.hasValue());
+  // The salt is reused with the next sequence number.
+  EXPECT_TRUE(IOBufEqualTo()(result1->first, toIOBuf(v2Ticket1)));
+  EXPECT_TRUE(IOBufEqualTo()(result2->first, toIOBuf(v2Ticket2)));
+}
+
+TEST_F(AeadTicketCipherTest, TestEncryptDecryptV2) {
+  setTicketSecrets();
+  cipher_.setTokenFormat(TokenFormat::V2);
+  EXPECT_CALL(codec_, _encode(_)).Times(2).WillRepeatedly(InvokeWithoutArgs(
+      []() { return IOBuf::copyBuffer("encodedticket"); }));
+  auto issued1 = cipher_.encrypt(ResumptionState()).get();
+  auto issued2 = cipher_.encrypt(ResumptionState()).get();
+  ASSERT_TRUE(issued1.hasValue());
+  ASSERT_TRUE(issued2.hasValue());
+  EXPECT_CALL(codec_, _decode(_, _))
+      .Times(3)
+      .WillRepeatedly(
+          Invoke([](Buf& encoded, const FizzServerContext* /*context*/) {
+            EXPECT_TRUE(
+                IOBufEqualTo()(encoded, IOBuf::copyBuffer("encodedticket")));
+            return ResumptionState();
+          }));
+  for (auto issued :
+       {issued1->first.get(), issued2->first.get(), issued1->first.get()}) {
+    auto result = cipher_.decrypt(issued->clone()).get();
+    EXPECT_EQ(result.first, PskType::Resumption);
+    EXPECT_TRUE(result.second.hasValue());
+  }
+}
+
 TEST_F(AeadTicketCipherTest, TestDecryptNoTicketSecrets) {
   auto result = cipher_.decrypt(toIOBuf(ticket1)).get();
   EXPECT_EQ(result.first, PskType::Rejected);
@@ -195,6 +248,39 @@ TEST_F(AeadTicketCipherTest, TestDecryptSeqNum) {
   EXPECT_TRUE(result.second.hasValue());
 }
 
+TEST_F(AeadTicketCipherTest, TestDecryptV2) {
+  setTicketSecrets();
+  expectDecode();
+  auto result = cipher_.decrypt(toIOBuf(v2Ticket2)).get();
+  EXPECT_EQ(result.first, PskType::Resumption);
+  EXPECT_TRUE(result.second.hasValue());
+}
+
+TEST_F(AeadTicketCipherTest, TestDecryptV2Second) {
+  setTicketSecrets();
+  expectDecode();
+  auto result = cipher_.decrypt(toIOBuf(v2Ticket3)).get();
+  EXPECT_EQ(result.first, PskType::Resumption);
+  EXPECT_TRUE(result.second.hasValue());
+}
+
+TEST_F(AeadTicketCipherTest, TestDecryptV2WrongKeyId) {
+  setTicketSecrets();
+  auto result = cipher_.decrypt(toIOBuf(v2TicketWrongKeyId)).get();
+  EXPECT_EQ(result.first, PskType::Rejected);
+  EXPECT_FALSE(result.second.hasValue());
+}
+
+TEST_F(AeadTicketCipherTest, TestDecryptV2AfterRotation) {
+  setTicketSecrets();
+  auto s2 = toIOBuf(ticketSecret2);
+  std::vector<ByteRange> ticketSecrets{{s2->coalesce()}};
+  EXPECT_TRUE(cipher_.setTicketSecrets(std::move(ticketSecrets)));
+  auto result = cipher_.decrypt(toIOBuf(v2Ticket1)).get();
+  EXPECT_EQ(result.first, PskType::Rejected);
+  EXPECT_FALSE(result.second.hasValue());
+}
+
 TEST_F(AeadTicketCipherTest, TestDecryptFailed) {
   setTicketSecrets();
   auto result = cipher_.decrypt(toIOBuf(badTicket)).get();
@@ -14,6 +14,7 @@
 #include <fizz/extensions/tokenbinding/Types.h>
 #include <fizz/server/test/Mocks.h>
 #include <folly/io/async/test/MockAsyncTransport.h>
+#include <folly/portability/Sockets.h>
 
 namespace fizz {
 namespace server {
@@ -42,6 +43,11 @@ class AsyncFizzServerTest : public Test {
  public:
   void SetUp() override {
     context_ = std::make_shared<FizzServerContext>();
+    resetServer();
+  }
+
+ protected:
+  void resetServer() {
     socket_ = new MockAsyncTransport();
     auto transport = AsyncTransportWrapper::UniquePtr(socket_);
     server_.reset(new AsyncFizzServerT<MockServerStateMachineInstance>(
@@ -53,7 +59,6 @@ class AsyncFizzServerTest : public Test {
     ON_CALL(readCallback_, isBufferMovable_()).WillByDefault(Return(true));
   }
 
- protected:
   void expectTransportReadCallback() {
     EXPECT_CALL(*socket_, setReadCB(_))
         .WillRepeatedly(SaveArg<0>(&socketReadCallback_));
@@ -218,6 +223,34 @@ TEST_F(AsyncFizzServerTest, TestWriteToSocket) {
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
 }
 
+TEST_F(AsyncFizzServerTest, TestWriteToSocketZeroCopy) {
+  completeHandshake();
+  server_->setReadCB(&readCallback_);
+
+  // Zero copy needs an AsyncSocket, and one supporting it, underneath.
+  AsyncSocket::UniquePtr tcpSocket(
+      new AsyncSocket(&evb_, ::socket(AF_INET, SOCK_STREAM, 0)));
+  EXPECT_CALL(*socket_, getWrappedTransport())
+      .WillRepeatedly(Return(tcpSocket.get()));
+  ASSERT_TRUE(server_->setZeroCopyWriteThreshold(100));
+
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        WriteToSocket write;
+        write.data = IOBuf::copyBuffer(std::string(100, 'x'));
+        return actions(std::move(write), WaitForData());
+      }))
+      .WillOnce(InvokeWithoutArgs([]() {
+        WriteToSocket write;
+        write.data = IOBuf::copyBuffer(std::string(99, 'x'));
+        return actions(std::move(write), WaitForData());
+      }));
+  EXPECT_CALL(*socket_, writeChain(_, _, WriteFlags::WRITE_MSG_ZEROCOPY));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("Data"));
+  EXPECT_CALL(*socket_, writeChain(_, _, WriteFlags::NONE));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("Data"));
+}
+
 TEST_F(AsyncFizzServerTest, TestMutateState) {
   completeHandshake();
   server_->setReadCB(&readCallback_);
@@ -406,6 +439,34 @@ TEST_F(AsyncFizzServerTest, TestGetCerts) {
   EXPECT_CALL(*clientCert, getX509());
   EXPECT_EQ(server_->getPeerCert(), nullptr);
 }
+
+TEST_F(AsyncFizzServerTest, TestMemoryBudgetAccounting) {
+  auto budget = std::make_shared<MemoryBudget>(1024 * 1024);
+  context_->setMemoryBudget(budget);
+  resetServer();
+
+  accept();
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([]() { return actions(WaitForData()); }));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
+  EXPECT_EQ(budget->getUsage(), 11);
+
+  server_.reset();
+  EXPECT_EQ(budget->getUsage(), 0);
+}
+
+TEST_F(AsyncFizzServerTest, TestAcceptOverBudget) {
+  auto budget = std::make_shared<MemoryBudget>(100);
+  context_->setMemoryBudget(budget);
+  resetServer();
+  budget->charge(100);
+
+  EXPECT_CALL(*machine_, _processAccept(_, _, _, _)).Times(0);
+  EXPECT_CALL(handshakeCallback_, _fizzHandshakeError(_));
+  EXPECT_CALL(*socket_, close());
+  server_->accept(&handshakeCallback_);
+  EXPECT_TRUE(server_->error());
+}
 } // namespace test
 } // namespace server
 } // namespace fizz
@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/ssl/Init.h>
+
+#include <fizz/crypto/RandomGenerator.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/protocol/Certificate.h>
+#include <fizz/server/DecryptedTicketCache.h>
+#include <fizz/server/FizzServerContext.h>
+#include <fizz/server/TicketTypes.h>
+
+using namespace fizz;
+using namespace fizz::server;
+using namespace fizz::test;
+
+/**
+ * Measures the ticket redemption part of a resumption handshake: decrypting
+ * and decoding the offered ticket (including the certificate lookup) with
+ * the ticket cipher, against a hit in DecryptedTicketCache.
+ */
+namespace {
+struct Setup {
+  Setup() {
+    std::vector<folly::ssl::X509UniquePtr> certs;
+    certs.emplace_back(getCert(kP256Certificate));
+    cert = std::make_shared<SelfCertImpl<KeyType::P256>>(
+        getPrivateKey(kP256Key), std::move(certs));
+    auto certManager = std::make_unique<CertManager>();
+    certManager->addCert(cert, true);
+    context = std::make_shared<FizzServerContext>();
+    context->setCertManager(std::move(certManager));
+
+    cipher = std::make_shared<AES128TicketCipher>();
+    auto secret = RandomGenerator<32>().generateRandom();
+    cipher->setTicketSecrets({{folly::range(secret)}});
+    cipher->setContext(context.get());
+
+    ResumptionState state;
+    state.version = ProtocolVersion::tls_1_3;
+    state.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+    state.resumptionSecret = folly::IOBuf::copyBuffer(std::string(32, 'r'));
+    state.serverCert = cert;
+    state.alpn = "h2";
+    state.ticketAgeAdd = 0x12345678;
+    state.ticketIssueTime = std::chrono::system_clock::now();
+    ticket = std::move(cipher->encrypt(std::move(state)).get()->first);
+
+    auto decrypted = cipher->decrypt(ticket->clone()).get();
+    cache.put(*ticket, *decrypted.second);
+  }
+
+  std::shared_ptr<SelfCert> cert;
+  std::shared_ptr<FizzServerContext> context;
+  std::shared_ptr<AES128TicketCipher> cipher;
+  DecryptedTicketCache cache;
+  Buf ticket;
+};
+
+Setup& getSetup() {
+  static Setup setup;
+  return setup;
+}
+} // namespace
+
+BENCHMARK(redeemWithTicketCipher, n) {
+  auto& setup = getSetup();
+  for (size_t i = 0; i < n; ++i) {
+    auto result = setup.cipher->decrypt(setup.ticket->clone()).get();
+    folly::doNotOptimizeAway(result);
+  }
+}
+
+BENCHMARK_RELATIVE(redeemWithDecryptedTicketCache, n) {
+  auto& setup = getSetup();
+  for (size_t i = 0; i < n; ++i) {
+    auto result = setup.cache.get(*setup.ticket);
+    folly::doNotOptimizeAway(result);
+  }
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::ssl::init();
+  getSetup();
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/server/DecryptedTicketCache.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+class TestDecryptedTicketCache : public DecryptedTicketCache {
+ public:
+  using DecryptedTicketCache::DecryptedTicketCache;
+
+  std::chrono::system_clock::time_point now_{
+      std::chrono::system_clock::now()};
+
+ protected:
+  std::chrono::system_clock::time_point now() const override {
+    return now_;
+  }
+};
+
+class DecryptedTicketCacheTest : public Test {
+ public:
+  void SetUp() override {
+    options_.capacity = 4;
+    options_.numShards = 1;
+    options_.ttl = std::chrono::seconds(60);
+    options_.ticketValidity = std::chrono::seconds(3600);
+    cache_ = std::make_unique<TestDecryptedTicketCache>(options_);
+  }
+
+ protected:
+  ResumptionState makeState(
+      std::chrono::seconds age = std::chrono::seconds(0)) {
+    ResumptionState state;
+    state.version = ProtocolVersion::tls_1_3;
+    state.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+    state.resumptionSecret = IOBuf::copyBuffer("resumesecret");
+    state.alpn = "h2";
+    state.ticketAgeAdd = 1234;
+    state.ticketIssueTime = cache_->now_ - age;
+    state.appToken = IOBuf::copyBuffer("apptoken");
+    return state;
+  }
+
+  DecryptedTicketCache::Options options_;
+  std::unique_ptr<TestDecryptedTicketCache> cache_;
+};
+
+TEST_F(DecryptedTicketCacheTest, TestPutGet) {
+  auto state = makeState();
+  cache_->put(*IOBuf::copyBuffer("ticket"), state);
+
+  // Chained tickets with the same contents hit the same entry.
+  auto ticket = IOBuf::copyBuffer("tic");
+  ticket->prependChain(IOBuf::copyBuffer("ket"));
+  auto cached = cache_->get(*ticket);
+  ASSERT_TRUE(cached.hasValue());
+  EXPECT_EQ(cached->version, state.version);
+  EXPECT_EQ(cached->cipher, state.cipher);
+  EXPECT_TRUE(IOBufEqualTo()(cached->resumptionSecret, state.resumptionSecret));
+  EXPECT_NE(cached->resumptionSecret.get(), state.resumptionSecret.get());
+  EXPECT_EQ(cached->alpn, state.alpn);
+  EXPECT_EQ(cached->ticketAgeAdd, state.ticketAgeAdd);
+  EXPECT_EQ(cached->ticketIssueTime, state.ticketIssueTime);
+  EXPECT_TRUE(IOBufEqualTo()(cached->appToken, state.appToken));
+
+  EXPECT_FALSE(cache_->get(*IOBuf::copyBuffer("other")).hasValue());
+}
+
+TEST_F(DecryptedTicketCacheTest, TestTtl) {
+  cache_->put(*IOBuf::copyBuffer("ticket"), makeState());
+  cache_->now_ += std::chrono::seconds(59);
+  EXPECT_TRUE(cache_->get(*IOBuf::copyBuffer("ticket")).hasValue());
+  cache_->now_ += std::chrono::seconds(1);
+  EXPECT_FALSE(cache_->get(*IOBuf::copyBuffer("ticket")).hasValue());
+}
+
+TEST_F(DecryptedTicketCacheTest, TestTicketValidity) {
+  cache_->put(
+      *IOBuf::copyBuffer("ticket"), makeState(std::chrono::seconds(3570)));
+  cache_->now_ += std::chrono::seconds(29);
+  EXPECT_TRUE(cache_->get(*IOBuf::copyBuffer("ticket")).hasValue());
+  cache_->now_ += std::chrono::seconds(1);
+  EXPECT_FALSE(cache_->get(*IOBuf::copyBuffer("ticket")).hasValue());
+}
+
+TEST_F(DecryptedTicketCacheTest, TestExpiredTicketNotCached) {
+  cache_->put(
+      *IOBuf::copyBuffer("ticket"), makeState(std::chrono::seconds(3600)));
+  EXPECT_FALSE(cache_->get(*IOBuf::copyBuffer("ticket")).hasValue());
+}
+
+TEST_F(DecryptedTicketCacheTest, TestCapacity) {
+  for (size_t i = 0; i < 5; ++i) {
+    cache_->put(
+        *IOBuf::copyBuffer(folly::to<std::string>("ticket", i)), makeState());
+  }
+  EXPECT_FALSE(cache_->get(*IOBuf::copyBuffer("ticket0")).hasValue());
+  for (size_t i = 1; i < 5; ++i) {
+    EXPECT_TRUE(
+        cache_->get(*IOBuf::copyBuffer(folly::to<std::string>("ticket", i)))
+            .hasValue());
+  }
+}
+
+TEST_F(DecryptedTicketCacheTest, TestClear) {
+  cache_->put(*IOBuf::copyBuffer("ticket"), makeState());
+  cache_->clear();
+  EXPECT_FALSE(cache_->get(*IOBuf::copyBuffer("ticket")).hasValue());
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,257 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/server/RemoteReplayCache.h>
+#include <fizz/server/StrikeRegisterServer.h>
+
+#include <folly/io/async/AsyncServerSocket.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+/**
+ * Accepts connections but never reads from them.
+ */
+class BlackholeServer : public AsyncServerSocket::AcceptCallback {
+ public:
+  explicit BlackholeServer(EventBase* evb)
+      : socket_(new AsyncServerSocket(evb)) {
+    socket_->bind(SocketAddress("127.0.0.1", 0));
+    socket_->listen(10);
+    socket_->addAcceptCallback(this, evb);
+    socket_->startAccepting();
+  }
+
+  void connectionAccepted(int fd, const SocketAddress&) noexcept override {
+    fds_.push_back(fd);
+  }
+
+  void acceptError(const std::exception&) noexcept override {}
+
+  ~BlackholeServer() override {
+    for (auto fd : fds_) {
+      ::close(fd);
+    }
+  }
+
+  SocketAddress getAddress() const {
+    SocketAddress addr;
+    socket_->getAddress(&addr);
+    return addr;
+  }
+
+  size_t numAccepted() const {
+    return fds_.size();
+  }
+
+ private:
+  AsyncServerSocket::UniquePtr socket_;
+  std::vector<int> fds_;
+};
+
+class RemoteReplayCacheTest : public Test {
+ public:
+  void SetUp() override {
+    server_ = std::make_unique<StrikeRegisterServer>(&evb_);
+    server_->start(SocketAddress("127.0.0.1", 0));
+  }
+
+ protected:
+  std::unique_ptr<RemoteReplayCache> makeCache(
+      SocketAddress address,
+      RemoteReplayCache::Options options = RemoteReplayCache::Options()) {
+    return std::make_unique<RemoteReplayCache>(
+        &evb_, std::move(address), std::move(options));
+  }
+
+  ReplayCacheResult check(RemoteReplayCache& cache, StringPiece id) {
+    return cache.check(ByteRange(id)).getVia(&evb_);
+  }
+
+  EventBase evb_;
+  std::unique_ptr<StrikeRegisterServer> server_;
+};
+
+TEST(StrikeRegisterProtocolTest, TestRequestRoundTrip) {
+  StrikeRegisterRequest request;
+  request.batchId = 42;
+  request.identifiers.push_back(IOBuf::copyBuffer("first"));
+  request.identifiers.push_back(IOBuf::copyBuffer("second"));
+
+  IOBufQueue queue(IOBufQueue::cacheChainLength());
+  auto encoded = encodeStrikeRegisterRequest(request);
+  auto partial = encoded->clone();
+  partial->trimEnd(3);
+  queue.append(std::move(partial));
+  EXPECT_FALSE(decodeStrikeRegisterRequest(queue).hasValue());
+
+  queue.move();
+  queue.append(std::move(encoded));
+  auto decoded = decodeStrikeRegisterRequest(queue);
+  ASSERT_TRUE(decoded.hasValue());
+  EXPECT_EQ(decoded->batchId, 42);
+  ASSERT_EQ(decoded->identifiers.size(), 2);
+  EXPECT_TRUE(IOBufEqualTo()(
+      decoded->identifiers[0], IOBuf::copyBuffer("first")));
+  EXPECT_TRUE(IOBufEqualTo()(
+      decoded->identifiers[1], IOBuf::copyBuffer("second")));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(StrikeRegisterProtocolTest, TestResponseRoundTrip) {
+  StrikeRegisterResponse response;
+  response.batchId = 7;
+  response.results = {ReplayCacheResult::NotReplay,
+                      ReplayCacheResult::DefinitelyReplay};
+
+  IOBufQueue queue(IOBufQueue::cacheChainLength());
+  queue.append(encodeStrikeRegisterResponse(response));
+  queue.append(encodeStrikeRegisterResponse(response));
+  for (size_t i = 0; i < 2; ++i) {
+    auto decoded = decodeStrikeRegisterResponse(queue);
+    ASSERT_TRUE(decoded.hasValue());
+    EXPECT_EQ(decoded->batchId, 7);
+    EXPECT_EQ(decoded->results, response.results);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(StrikeRegisterProtocolTest, TestBadResult) {
+  IOBufQueue queue(IOBufQueue::cacheChainLength());
+  // One result with an out of range value.
+  queue.append(IOBuf::copyBuffer(
+      StringPiece("\x00\x00\x00\x07\x00\x00\x00\x01\x00\x01\x09", 11)));
+  EXPECT_THROW(decodeStrikeRegisterResponse(queue), std::runtime_error);
+}
+
+TEST(StrikeRegisterTest, TestWindow) {
+  StrikeRegister strikeRegister(std::chrono::seconds(10), 100);
+  auto now = std::chrono::steady_clock::now();
+  auto id = ByteRange(StringPiece("id"));
+  EXPECT_EQ(strikeRegister.check(id, now), ReplayCacheResult::NotReplay);
+  EXPECT_EQ(
+      strikeRegister.check(id, now + std::chrono::seconds(15)),
+      ReplayCacheResult::DefinitelyReplay);
+  EXPECT_EQ(
+      strikeRegister.check(id, now + std::chrono::seconds(40)),
+      ReplayCacheResult::NotReplay);
+}
+
+TEST(StrikeRegisterTest, TestCapacity) {
+  StrikeRegister strikeRegister(std::chrono::seconds(10), 1);
+  EXPECT_EQ(
+      strikeRegister.check(ByteRange(StringPiece("a"))),
+      ReplayCacheResult::NotReplay);
+  EXPECT_EQ(
+      strikeRegister.check(ByteRange(StringPiece("b"))),
+      ReplayCacheResult::MaybeReplay);
+  EXPECT_EQ(
+      strikeRegister.check(ByteRange(StringPiece("a"))),
+      ReplayCacheResult::DefinitelyReplay);
+}
+
+TEST_F(RemoteReplayCacheTest, TestCheck) {
+  auto cache = makeCache(server_->getAddress());
+  EXPECT_EQ(check(*cache, "id1"), ReplayCacheResult::NotReplay);
+  EXPECT_EQ(check(*cache, "id1"), ReplayCacheResult::DefinitelyReplay);
+  EXPECT_EQ(check(*cache, "id2"), ReplayCacheResult::NotReplay);
+}
+
+TEST_F(RemoteReplayCacheTest, TestBatching) {
+  RemoteReplayCache::Options options;
+  options.maxBatchSize = 8;
+  options.numConnections = 3;
+  auto cache = makeCache(server_->getAddress(), options);
+
+  std::vector<Future<ReplayCacheResult>> futures;
+  for (size_t i = 0; i < 100; ++i) {
+    auto id = folly::to<std::string>("id", i % 50);
+    futures.push_back(cache->check(ByteRange(StringPiece(id))));
+  }
+  auto results = collectAll(futures).getVia(&evb_);
+  size_t notReplay = 0;
+  size_t replay = 0;
+  for (auto& result : results) {
+    if (*result == ReplayCacheResult::NotReplay) {
+      notReplay++;
+    } else if (*result == ReplayCacheResult::DefinitelyReplay) {
+      replay++;
+    }
+  }
+  EXPECT_EQ(notReplay, 50);
+  EXPECT_EQ(replay, 50);
+}
+
+TEST_F(RemoteReplayCacheTest, TestCheckFromOtherThread) {
+  auto cache = makeCache(server_->getAddress());
+  std::thread t([&]() {
+    auto result = cache->check(ByteRange(StringPiece("threaded"))).get();
+    EXPECT_EQ(result, ReplayCacheResult::NotReplay);
+    evb_.terminateLoopSoon();
+  });
+  evb_.loopForever();
+  t.join();
+}
+
+TEST_F(RemoteReplayCacheTest, TestTimeout) {
+  BlackholeServer blackhole(&evb_);
+  RemoteReplayCache::Options options;
+  options.timeout = std::chrono::milliseconds(10);
+  auto cache = makeCache(blackhole.getAddress(), options);
+  EXPECT_EQ(check(*cache, "id"), ReplayCacheResult::MaybeReplay);
+}
+
+TEST_F(RemoteReplayCacheTest, TestTimeoutResetsConnection) {
+  BlackholeServer blackhole(&evb_);
+  RemoteReplayCache::Options options;
+  options.timeout = std::chrono::milliseconds(10);
+  options.numConnections = 1;
+  options.maxPipelineDepth = 1;
+  auto cache = makeCache(blackhole.getAddress(), options);
+  EXPECT_EQ(check(*cache, "id1"), ReplayCacheResult::MaybeReplay);
+  EXPECT_EQ(blackhole.numAccepted(), 1);
+
+  // The unanswered batch must not keep the connection saturated; the next
+  // check goes out on a new connection.
+  EXPECT_EQ(check(*cache, "id2"), ReplayCacheResult::MaybeReplay);
+  EXPECT_EQ(blackhole.numAccepted(), 2);
+  EXPECT_EQ(check(*cache, "id3"), ReplayCacheResult::MaybeReplay);
+  EXPECT_EQ(blackhole.numAccepted(), 3);
+}
+
+TEST_F(RemoteReplayCacheTest, TestConnectionRefused) {
+  auto address = server_->getAddress();
+  server_.reset();
+  auto cache = makeCache(address);
+  EXPECT_EQ(check(*cache, "id"), ReplayCacheResult::MaybeReplay);
+}
+
+TEST_F(RemoteReplayCacheTest, TestServerGoesAway) {
+  auto cache = makeCache(server_->getAddress());
+  EXPECT_EQ(check(*cache, "id"), ReplayCacheResult::NotReplay);
+
+  server_.reset();
+  evb_.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(check(*cache, "id"), ReplayCacheResult::MaybeReplay);
+}
+
+TEST_F(RemoteReplayCacheTest, TestOversizedIdentifier) {
+  auto cache = makeCache(server_->getAddress());
+  std::string id(kMaxStrikeRegisterIdentifierLength + 1, 'a');
+  EXPECT_EQ(check(*cache, id), ReplayCacheResult::MaybeReplay);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,194 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/server/SecretRotator.h>
+
+#include <fizz/crypto/Hkdf.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+#include <fizz/server/AeadTokenCipher.h>
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+using TestTokenCipher =
+    AeadTokenCipher<OpenSSLEVPCipher<AESGCM128>, HkdfImpl<Sha256>>;
+
+static constexpr StringPiece kSeed{
+    "4e0f7c33b59b1c7a1d2c1a4b5d6e7f8091a2b3c4d5e6f708192a3b4c5d6e7f80"};
+
+class TestSecretRotator : public SecretRotator {
+ public:
+  using SecretRotator::SecretRotator;
+
+  void rotate() {
+    timeoutExpired();
+  }
+
+  std::chrono::system_clock::time_point now_;
+
+ protected:
+  std::chrono::system_clock::time_point now() const override {
+    return now_;
+  }
+};
+
+class SecretRotatorTest : public Test {
+ public:
+  void SetUp() override {
+    writeFile(kSeed, seedFile_.path().string().c_str());
+    options_.epochLength = std::chrono::hours(1);
+    options_.previousEpochs = 1;
+    rotator_ = std::make_unique<TestSecretRotator>(
+        &evb_,
+        seedFile_.path().string(),
+        "ticket",
+        [this](const std::vector<ByteRange>& secrets) {
+          publishes_++;
+          EXPECT_TRUE(cipher_.setSecrets(secrets));
+        },
+        options_);
+    rotator_->now_ = std::chrono::system_clock::time_point(
+        std::chrono::hours(1000) + std::chrono::minutes(30));
+  }
+
+ protected:
+  Buf encrypt() {
+    auto token = cipher_.encrypt(IOBuf::copyBuffer("plaintext"));
+    EXPECT_TRUE(token.hasValue());
+    return std::move(*token);
+  }
+
+  bool canDecrypt(const Buf& token) {
+    auto plaintext = cipher_.decrypt(token->clone());
+    if (!plaintext) {
+      return false;
+    }
+    EXPECT_TRUE(IOBufEqualTo()(*plaintext, IOBuf::copyBuffer("plaintext")));
+    return true;
+  }
+
+  EventBase evb_;
+  folly::test::TemporaryFile seedFile_;
+  SecretRotator::Options options_;
+  TestTokenCipher cipher_{std::vector<std::string>({"test"})};
+  std::unique_ptr<TestSecretRotator> rotator_;
+  size_t publishes_{0};
+};
+
+TEST_F(SecretRotatorTest, TestDeriveSecrets) {
+  auto seed = ByteRange(kSeed);
+  auto secrets = SecretRotator::deriveSecrets(seed, "ticket", 10, options_);
+  ASSERT_EQ(secrets.size(), 3);
+  EXPECT_EQ(
+      secrets, SecretRotator::deriveSecrets(seed, "ticket", 10, options_));
+  auto cookieSecrets =
+      SecretRotator::deriveSecrets(seed, "cookie", 10, options_);
+  EXPECT_NE(secrets[0], cookieSecrets[0]);
+
+  auto nextSecrets = SecretRotator::deriveSecrets(seed, "ticket", 11, options_);
+  // The next epoch is accepted early, and the current one is kept after.
+  EXPECT_EQ(nextSecrets[0], secrets[1]);
+  EXPECT_EQ(nextSecrets[2], secrets[0]);
+}
+
+TEST_F(SecretRotatorTest, TestMissingSeed) {
+  TestSecretRotator rotator(
+      &evb_, "/does/not/exist", "ticket", [](const std::vector<ByteRange>&) {
+        ADD_FAILURE();
+      });
+  EXPECT_THROW(rotator.start(), std::runtime_error);
+}
+
+TEST_F(SecretRotatorTest, TestShortSeed) {
+  writeFile(StringPiece("short"), seedFile_.path().string().c_str());
+  EXPECT_THROW(rotator_->start(), std::runtime_error);
+}
+
+TEST_F(SecretRotatorTest, TestResumeAcrossRotation) {
+  rotator_->start();
+  EXPECT_EQ(publishes_, 1);
+  auto token = encrypt();
+
+  rotator_->now_ += std::chrono::hours(1);
+  rotator_->rotate();
+  EXPECT_EQ(publishes_, 2);
+  EXPECT_TRUE(canDecrypt(token));
+  auto newToken = encrypt();
+
+  rotator_->now_ += std::chrono::hours(1);
+  rotator_->rotate();
+  EXPECT_FALSE(canDecrypt(token));
+  EXPECT_TRUE(canDecrypt(newToken));
+}
+
+TEST_F(SecretRotatorTest, TestClockAhead) {
+  rotator_->start();
+  auto token = encrypt();
+
+  // A server whose clock is an epoch behind still accepts the token.
+  TestTokenCipher behindCipher{std::vector<std::string>({"test"})};
+  auto secrets = SecretRotator::deriveSecrets(
+      ByteRange(kSeed), "ticket", 999, options_);
+  std::vector<ByteRange> ranges;
+  for (const auto& secret : secrets) {
+    ranges.push_back(range(secret));
+  }
+  EXPECT_TRUE(behindCipher.setSecrets(ranges));
+  EXPECT_TRUE(behindCipher.decrypt(token->clone()).hasValue());
+}
+
+TEST_F(SecretRotatorTest, TestRotateWhileInUse) {
+  // Keep every epoch this test passes through so that decryption never races
+  // with a secret being retired.
+  options_.previousEpochs = 200;
+  rotator_ = std::make_unique<TestSecretRotator>(
+      &evb_,
+      seedFile_.path().string(),
+      "ticket",
+      [this](const std::vector<ByteRange>& secrets) {
+        EXPECT_TRUE(cipher_.setSecrets(secrets));
+      },
+      options_);
+  rotator_->now_ = std::chrono::system_clock::time_point(
+      std::chrono::hours(1000) + std::chrono::minutes(30));
+  rotator_->start();
+  cipher_.setTokenFormat(TokenFormat::V2);
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      while (!done) {
+        EXPECT_TRUE(canDecrypt(encrypt()));
+      }
+    });
+  }
+  for (size_t i = 0; i < 100; ++i) {
+    rotator_->now_ += std::chrono::hours(1);
+    rotator_->rotate();
+  }
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
@@ -563,6 +563,7 @@ TEST_F(ServerProtocolTest, TestClientHelloFullHandshakeFlow) {
   EXPECT_EQ(state_.earlyDataType(), EarlyDataType::NotAttempted);
   EXPECT_EQ(state_.replayCacheResult(), ReplayCacheResult::NotChecked);
   EXPECT_FALSE(state_.clientClockSkew().hasValue());
+  EXPECT_FALSE(state_.resumedTicketIssueTime().hasValue());
   EXPECT_EQ(*state_.alpn(), "h2");
   EXPECT_TRUE(IOBufEqualTo()(
       *state_.clientHandshakeSecret(), IOBuf::copyBuffer("cht")));
@@ -951,6 +952,7 @@ TEST_F(ServerProtocolTest, TestClientHelloPskFlow) {
   EXPECT_EQ(state_.earlyDataType(), EarlyDataType::NotAttempted);
   EXPECT_EQ(state_.replayCacheResult(), ReplayCacheResult::NotChecked);
   EXPECT_TRUE(state_.clientClockSkew().hasValue());
+  EXPECT_TRUE(state_.resumedTicketIssueTime().hasValue());
   EXPECT_EQ(*state_.alpn(), "h2");
   EXPECT_TRUE(IOBufEqualTo()(
       *state_.clientHandshakeSecret(), IOBuf::copyBuffer("cht")));
@@ -2018,6 +2020,35 @@ TEST_F(ServerProtocolTest, TestClientHelloFullHandshake) {
   expectActions<MutateState, WriteToSocket>(actions);
 }
 
+TEST_F(ServerProtocolTest, TestClientHelloFullHandshakeSynchronous) {
+  setUpExpectingClientHello();
+  auto asyncActions = detail::processEvent(state_, TestMessages::clientHello());
+  auto actions = boost::get<Actions>(&asyncActions);
+  ASSERT_NE(actions, nullptr);
+  expectActions<MutateState, WriteToSocket>(*actions);
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloAsyncReplayCache) {
+  acceptEarlyData();
+  setUpExpectingClientHello();
+  Promise<ReplayCacheResult> replayPromise;
+  EXPECT_CALL(*replayCache_, check(_)).WillOnce(InvokeWithoutArgs([&] {
+    return replayPromise.getFuture();
+  }));
+  auto asyncActions =
+      detail::processEvent(state_, TestMessages::clientHelloPskEarly());
+  auto futureActions = boost::get<Future<Actions>>(&asyncActions);
+  ASSERT_NE(futureActions, nullptr);
+  while (executor_.run())
+    ;
+  EXPECT_FALSE(futureActions->isReady());
+
+  replayPromise.setValue(ReplayCacheResult::NotReplay);
+  auto actions = getActions(std::move(asyncActions));
+  expectActions<MutateState, WriteToSocket, ReportEarlyHandshakeSuccess>(
+      actions);
+}
+
 TEST_F(ServerProtocolTest, TestClientHelloPsk) {
   context_->setSupportedPskModes({PskKeyExchangeMode::psk_ke});
   setUpExpectingClientHello();
@@ -2026,6 +2057,113 @@ TEST_F(ServerProtocolTest, TestClientHelloPsk) {
   expectActions<MutateState, WriteToSocket>(actions);
 }
 
+TEST_F(ServerProtocolTest, TestClientHelloPskDecryptedTicketCacheHit) {
+  context_->setSupportedPskModes({PskKeyExchangeMode::psk_ke});
+  auto ticketCache = std::make_shared<DecryptedTicketCache>();
+  context_->setDecryptedTicketCache(ticketCache);
+  ResumptionState res;
+  res.version = TestProtocolVersion;
+  res.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+  res.resumptionSecret = IOBuf::copyBuffer("resumesecret");
+  res.alpn = "h2";
+  res.ticketAgeAdd = 0;
+  res.ticketIssueTime =
+      std::chrono::system_clock::now() - std::chrono::seconds(100);
+  ticketCache->put(*IOBuf::copyBuffer("ident"), res);
+  setUpExpectingClientHello();
+  EXPECT_CALL(*mockTicketCipher_, _decrypt(_)).Times(0);
+
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::clientHelloPsk()));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.pskType(), PskType::Resumption);
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloPskDecryptedTicketCacheMiss) {
+  context_->setSupportedPskModes({PskKeyExchangeMode::psk_ke});
+  auto ticketCache = std::make_shared<DecryptedTicketCache>();
+  context_->setDecryptedTicketCache(ticketCache);
+  setUpExpectingClientHello();
+  EXPECT_CALL(*mockTicketCipher_, _decrypt(_));
+
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::clientHelloPsk()));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.pskType(), PskType::Resumption);
+  EXPECT_TRUE(ticketCache->get(*IOBuf::copyBuffer("ident")).hasValue());
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloEarlyDataSkipsDecryptedTicketCache) {
+  acceptEarlyData();
+  auto ticketCache = std::make_shared<DecryptedTicketCache>();
+  context_->setDecryptedTicketCache(ticketCache);
+  setUpExpectingClientHello();
+  EXPECT_CALL(*mockTicketCipher_, _decrypt(_));
+
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::clientHelloPskEarly()));
+  expectActions<MutateState, WriteToSocket, ReportEarlyHandshakeSuccess>(
+      actions);
+  EXPECT_FALSE(ticketCache->get(*IOBuf::copyBuffer("ident")).hasValue());
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloExternalPsk) {
+  auto pskStore = std::make_shared<InMemoryExternalPskStore>();
+  ExternalPsk psk;
+  psk.secret = "externalsecret";
+  psk.clientIdentity = std::make_shared<IdentityCert>("peer-service");
+  pskStore->addPsk("ident", std::move(psk));
+  context_->setExternalPskStore(pskStore);
+  setUpExpectingClientHello();
+  EXPECT_CALL(*mockTicketCipher_, _decrypt(_)).Times(0);
+  EXPECT_CALL(*certManager_, getCert(_, _, _)).Times(0);
+
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::clientHelloPsk()));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+  EXPECT_EQ(state_.pskType(), PskType::External);
+  EXPECT_EQ(state_.serverCert(), nullptr);
+  EXPECT_EQ(state_.clientCert()->getIdentity(), "peer-service");
+  EXPECT_FALSE(state_.resumedTicketIssueTime().hasValue());
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloExternalPskUnknownIdentity) {
+  auto pskStore = std::make_shared<InMemoryExternalPskStore>();
+  ExternalPsk psk;
+  psk.secret = "externalsecret";
+  pskStore->addPsk("otherident", std::move(psk));
+  context_->setExternalPskStore(pskStore);
+  setUpExpectingClientHello();
+  EXPECT_CALL(*mockTicketCipher_, _decrypt(_));
+
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::clientHelloPsk()));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.pskType(), PskType::Resumption);
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloExternalPskRejectsEarlyData) {
+  acceptEarlyData();
+  auto pskStore = std::make_shared<InMemoryExternalPskStore>();
+  ExternalPsk psk;
+  psk.secret = "externalsecret";
+  pskStore->addPsk("ident", std::move(psk));
+  context_->setExternalPskStore(pskStore);
+  setUpExpectingClientHello();
+
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::clientHelloPskEarly()));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.pskType(), PskType::External);
+  EXPECT_EQ(state_.earlyDataType(), EarlyDataType::Rejected);
+}
+
 TEST_F(ServerProtocolTest, TestClientHelloPskDhe) {
   context_->setSupportedPskModes({PskKeyExchangeMode::psk_dhe_ke});
   setUpExpectingClientHello();
@@ -2237,6 +2375,72 @@ TEST_F(ServerProtocolTest, TestClientHelloAlpnMismatch) {
   EXPECT_FALSE(state_.alpn().hasValue());
 }
 
+TEST_F(ServerProtocolTest, TestClientHelloRawPublicKey) {
+  setUpExpectingClientHello();
+  auto rawPublicKeyCert = std::make_shared<MockSelfCert>();
+  auto rawPublicKeyCertManager = std::make_unique<MockCertManager>();
+  EXPECT_CALL(*rawPublicKeyCertManager, getCert(_, _, _))
+      .WillOnce(Return(CertManager::CertMatch(std::make_pair(
+          rawPublicKeyCert, SignatureScheme::ecdsa_secp256r1_sha256))));
+  EXPECT_CALL(*certManager_, getCert(_, _, _)).Times(0);
+  context_->setRawPublicKeyCertManager(std::move(rawPublicKeyCertManager));
+  auto chlo = TestMessages::clientHello();
+  ServerCertificateTypes serverTypes;
+  serverTypes.certificate_types = {CertificateType::RawPublicKey,
+                                   CertificateType::X509};
+  chlo.extensions.push_back(encodeExtension(std::move(serverTypes)));
+  auto actions = getActions(detail::processEvent(state_, std::move(chlo)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.serverCert(), rawPublicKeyCert);
+  EXPECT_EQ(state_.serverCertType(), CertificateType::RawPublicKey);
+  EXPECT_EQ(state_.clientCertType(), CertificateType::X509);
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloRawPublicKeyNotConfigured) {
+  setUpExpectingClientHello();
+  auto chlo = TestMessages::clientHello();
+  ServerCertificateTypes serverTypes;
+  serverTypes.certificate_types = {CertificateType::RawPublicKey,
+                                   CertificateType::X509};
+  chlo.extensions.push_back(encodeExtension(std::move(serverTypes)));
+  auto actions = getActions(detail::processEvent(state_, std::move(chlo)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.serverCert(), cert_);
+  EXPECT_EQ(state_.serverCertType(), CertificateType::X509);
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloCertificateTypeUnsupported) {
+  setUpExpectingClientHello();
+  auto chlo = TestMessages::clientHello();
+  ServerCertificateTypes serverTypes;
+  serverTypes.certificate_types = {CertificateType::RawPublicKey};
+  chlo.extensions.push_back(encodeExtension(std::move(serverTypes)));
+  auto actions = getActions(detail::processEvent(state_, std::move(chlo)));
+  expectError(
+      actions,
+      AlertDescription::unsupported_certificate,
+      "no supported certificate type");
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloClientCertificateType) {
+  setUpExpectingClientHello();
+  context_->setClientAuthMode(ClientAuthMode::Required);
+  context_->setSupportedClientCertTypes(
+      {CertificateType::RawPublicKey, CertificateType::X509});
+  auto chlo = TestMessages::clientHello();
+  ClientCertificateTypes clientTypes;
+  clientTypes.certificate_types = {CertificateType::RawPublicKey};
+  chlo.extensions.push_back(encodeExtension(std::move(clientTypes)));
+  auto actions = getActions(detail::processEvent(state_, std::move(chlo)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.serverCertType(), CertificateType::X509);
+  EXPECT_EQ(state_.clientCertType(), CertificateType::RawPublicKey);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificate);
+}
+
 TEST_F(ServerProtocolTest, TestClientHelloServerPref) {
   setUpExpectingClientHello();
   auto chlo = TestMessages::clientHello();
@@ -3076,6 +3280,10 @@ TEST_F(ServerProtocolTest, TestFinishedNoTicket) {
   expectActions<MutateState, ReportHandshakeSuccess>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::AcceptingData);
+  EXPECT_EQ(state_.handshakeContext(), nullptr);
+  EXPECT_FALSE(state_.clientHandshakeSecret().hasValue());
+  EXPECT_FALSE(state_.unverifiedCertChain().hasValue());
+  EXPECT_EQ(state_.appTokenValidator(), nullptr);
 }
 
 TEST_F(ServerProtocolTest, TestFinishedTicketEarly) {
@@ -3123,6 +3331,118 @@ TEST_F(ServerProtocolTest, TestFinishedNoAutomaticNewSessionTicket) {
   EXPECT_EQ(state_.state(), StateEnum::AcceptingData);
 }
 
+TEST_F(ServerProtocolTest, TestFinishedTicketPolicyNoTickets) {
+  setUpExpectingFinished();
+  context_->setTicketPolicy(std::make_shared<FixedTicketPolicy>(0));
+
+  EXPECT_CALL(*mockTicketCipher_, _encrypt(_)).Times(0);
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::finished()));
+  expectActions<MutateState, ReportHandshakeSuccess>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::AcceptingData);
+  EXPECT_EQ(state_.numTicketsIssued(), 0);
+}
+
+TEST_F(ServerProtocolTest, TestFinishedTicketPolicyMultipleTickets) {
+  setUpExpectingFinished();
+  context_->setTicketPolicy(std::make_shared<FixedTicketPolicy>(3));
+
+  EXPECT_CALL(*mockKeyScheduler_, getResumptionSecret(_, RangeMatches("")))
+      .WillOnce(InvokeWithoutArgs([]() { return IOBuf::copyBuffer("rs0"); }));
+  EXPECT_CALL(
+      *mockKeyScheduler_,
+      getResumptionSecret(_, RangeMatches(std::string("\0\0\0\1", 4))))
+      .WillOnce(InvokeWithoutArgs([]() { return IOBuf::copyBuffer("rs1"); }));
+  EXPECT_CALL(
+      *mockKeyScheduler_,
+      getResumptionSecret(_, RangeMatches(std::string("\0\0\0\2", 4))))
+      .WillOnce(InvokeWithoutArgs([]() { return IOBuf::copyBuffer("rs2"); }));
+  EXPECT_CALL(*mockTicketCipher_, _encrypt(_)).Times(3);
+  EXPECT_CALL(*mockWrite_, _write(_))
+      .Times(3)
+      .WillRepeatedly(InvokeWithoutArgs(
+          []() { return folly::IOBuf::copyBuffer("nst"); }));
+
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::finished()));
+  expectActions<MutateState, ReportHandshakeSuccess, WriteToSocket>(actions);
+  auto write = expectAction<WriteToSocket>(actions);
+  EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("nstnstnst")));
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::AcceptingData);
+  EXPECT_EQ(state_.numTicketsIssued(), 3);
+
+  EXPECT_CALL(
+      *mockKeyScheduler_,
+      getResumptionSecret(_, RangeMatches(std::string("\0\0\0\3", 4))))
+      .WillOnce(InvokeWithoutArgs([]() { return IOBuf::copyBuffer("rs3"); }));
+  auto nstActions =
+      getActions(detail::processEvent(state_, WriteNewSessionTicket()));
+  expectActions<MutateState, WriteToSocket>(nstActions);
+  processStateMutations(nstActions);
+  EXPECT_EQ(state_.numTicketsIssued(), 4);
+}
+
+TEST_F(ServerProtocolTest, TestFinishedResumptionAwarePolicyFreshTicket) {
+  setUpExpectingFinished();
+  context_->setTicketPolicy(std::make_shared<ResumptionAwareTicketPolicy>());
+  state_.pskType() = PskType::Resumption;
+  state_.resumedTicketIssueTime() =
+      std::chrono::system_clock::now() - std::chrono::minutes(10);
+
+  // A replacement for the ticket that was just used.
+  EXPECT_CALL(*mockTicketCipher_, _encrypt(_));
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::finished()));
+  expectActions<MutateState, ReportHandshakeSuccess, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.numTicketsIssued(), 1);
+}
+
+TEST_F(ServerProtocolTest, TestFinishedResumptionAwarePolicyFreshTicketReuse) {
+  setUpExpectingFinished();
+  ResumptionAwareTicketPolicy::Options options;
+  options.numTicketsOnResumption = 0;
+  context_->setTicketPolicy(
+      std::make_shared<ResumptionAwareTicketPolicy>(options));
+  state_.pskType() = PskType::Resumption;
+  state_.resumedTicketIssueTime() =
+      std::chrono::system_clock::now() - std::chrono::minutes(10);
+
+  EXPECT_CALL(*mockTicketCipher_, _encrypt(_)).Times(0);
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::finished()));
+  expectActions<MutateState, ReportHandshakeSuccess>(actions);
+}
+
+TEST_F(ServerProtocolTest, TestFinishedResumptionAwarePolicyOldTicket) {
+  setUpExpectingFinished();
+  context_->setTicketPolicy(std::make_shared<ResumptionAwareTicketPolicy>());
+  state_.pskType() = PskType::Resumption;
+  state_.resumedTicketIssueTime() =
+      std::chrono::system_clock::now() - std::chrono::minutes(45);
+
+  EXPECT_CALL(*mockTicketCipher_, _encrypt(_)).Times(2);
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::finished()));
+  expectActions<MutateState, ReportHandshakeSuccess, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.numTicketsIssued(), 2);
+}
+
+TEST_F(ServerProtocolTest, TestFinishedResumptionAwarePolicyFullHandshake) {
+  setUpExpectingFinished();
+  context_->setTicketPolicy(std::make_shared<ResumptionAwareTicketPolicy>());
+
+  EXPECT_CALL(*mockTicketCipher_, _encrypt(_)).Times(2);
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::finished()));
+  expectActions<MutateState, ReportHandshakeSuccess, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.numTicketsIssued(), 2);
+}
+
 TEST_F(ServerProtocolTest, TestFinishedMismatch) {
   setUpExpectingFinished();
   EXPECT_CALL(
@@ -3198,7 +3518,7 @@ TEST_F(ServerProtocolTest, TestWriteNewSessionTicket) {
 
   auto actions =
       getActions(detail::processEvent(state_, WriteNewSessionTicket()));
-  expectSingleAction<WriteToSocket>(std::move(actions));
+  expectActions<MutateState, WriteToSocket>(actions);
 }
 
 TEST_F(ServerProtocolTest, TestWriteNewSessionTicketWithTicketEarly) {
@@ -3218,7 +3538,7 @@ TEST_F(ServerProtocolTest, TestWriteNewSessionTicketWithTicketEarly) {
 
   auto actions =
       getActions(detail::processEvent(state_, WriteNewSessionTicket()));
-  expectSingleAction<WriteToSocket>(std::move(actions));
+  expectActions<MutateState, WriteToSocket>(actions);
 }
 
 TEST_F(ServerProtocolTest, TestWriteNewSessionTicketWithAppToken) {
@@ -3243,7 +3563,7 @@ TEST_F(ServerProtocolTest, TestWriteNewSessionTicketWithAppToken) {
   writeNewSessionTicket.appToken = IOBuf::copyBuffer(appToken);
   auto actions = getActions(
       detail::processEvent(state_, std::move(writeNewSessionTicket)));
-  expectSingleAction<WriteToSocket>(std::move(actions));
+  expectActions<MutateState, WriteToSocket>(actions);
 }
 
 TEST_F(
@@ -3286,7 +3606,7 @@ TEST_F(
   writeNewSessionTicket.appToken = IOBuf::copyBuffer(appToken);
   auto writeNewSessionTicketActions = getActions(
       detail::processEvent(state_, std::move(writeNewSessionTicket)));
-  expectSingleAction<WriteToSocket>(std::move(writeNewSessionTicketActions));
+  expectActions<MutateState, WriteToSocket>(writeNewSessionTicketActions);
 }
 
 TEST_F(ServerProtocolTest, TestWriteNewSessionTicketNoTicket) {
@@ -3439,6 +3759,44 @@ TEST_F(ServerProtocolTest, TestCertificate) {
   EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
 }
 
+TEST_F(ServerProtocolTest, TestCertificateRawPublicKey) {
+  setUpExpectingCertificate();
+  state_.clientCertType() = CertificateType::RawPublicKey;
+  clientLeafCert_ = std::make_shared<MockPeerCert>();
+  EXPECT_CALL(*factory_, _makePeerRawPublicKey(BufMatches("spki")))
+      .WillOnce(Return(clientLeafCert_));
+
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry;
+  entry.cert_data = folly::IOBuf::copyBuffer("spki");
+  certificate.certificate_list.push_back(std::move(entry));
+  auto actions =
+      getActions(detail::processEvent(state_, std::move(certificate)));
+
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.unverifiedCertChain()->size(), 1);
+  EXPECT_EQ(state_.unverifiedCertChain()->at(0), clientLeafCert_);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
+}
+
+TEST_F(ServerProtocolTest, TestCertificateRawPublicKeyMultiple) {
+  setUpExpectingCertificate();
+  state_.clientCertType() = CertificateType::RawPublicKey;
+
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry1;
+  entry1.cert_data = folly::IOBuf::copyBuffer("spki1");
+  certificate.certificate_list.push_back(std::move(entry1));
+  CertificateEntry entry2;
+  entry2.cert_data = folly::IOBuf::copyBuffer("spki2");
+  certificate.certificate_list.push_back(std::move(entry2));
+  auto actions =
+      getActions(detail::processEvent(state_, std::move(certificate)));
+  expectError(
+      actions, AlertDescription::illegal_parameter, "multiple entries");
+}
+
 TEST_F(ServerProtocolTest, TestCertificateNonemptyContext) {
   setUpExpectingCertificate();
   EXPECT_CALL(
@@ -3712,6 +4070,66 @@ TEST_F(ServerProtocolTest, TestCertificateVerifyVerifierGenericFailure) {
       "client certificate failure: oops");
 }
 
+TEST_F(ServerProtocolTest, TestCertificateVerifyAsyncVerifier) {
+  setUpExpectingCertificateVerify();
+  auto asyncVerifier = std::make_shared<MockAsyncCertificateVerifier>();
+  context_->setClientCertVerifier(asyncVerifier);
+  EXPECT_CALL(*mockHandshakeContext_, getHandshakeContext())
+      .WillRepeatedly(
+          Invoke([]() { return IOBuf::copyBuffer("certcontext"); }));
+  EXPECT_CALL(*clientLeafCert_, verify(_, _, _, _));
+
+  Promise<folly::Unit> verifyPromise;
+  EXPECT_CALL(*asyncVerifier, verify(_)).Times(0);
+  EXPECT_CALL(*asyncVerifier, verifyFuture(_))
+      .WillOnce(Invoke(
+          [this, &verifyPromise](
+              const std::vector<std::shared_ptr<const PeerCert>>& certs) {
+            EXPECT_EQ(certs.size(), 2);
+            EXPECT_EQ(certs[0], clientLeafCert_);
+            return verifyPromise.getFuture();
+          }));
+
+  auto actions =
+      detail::processEvent(state_, TestMessages::certificateVerify());
+  EXPECT_FALSE(boost::get<folly::Future<Actions>>(actions).isReady());
+
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      appendToTranscript(BufMatches("certverifyencoding")));
+  verifyPromise.setValue();
+  auto completed = getActions(std::move(actions), false);
+  expectActions<MutateState>(completed);
+  processStateMutations(completed);
+  EXPECT_EQ(state_.unverifiedCertChain(), folly::none);
+  EXPECT_EQ(state_.clientCert(), clientLeafCert_);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+}
+
+TEST_F(ServerProtocolTest, TestCertificateVerifyAsyncVerifierFailure) {
+  setUpExpectingCertificateVerify();
+  auto asyncVerifier = std::make_shared<MockAsyncCertificateVerifier>();
+  context_->setClientCertVerifier(asyncVerifier);
+  EXPECT_CALL(*mockHandshakeContext_, getHandshakeContext())
+      .WillRepeatedly(
+          Invoke([]() { return IOBuf::copyBuffer("certcontext"); }));
+  EXPECT_CALL(*clientLeafCert_, verify(_, _, _, _));
+
+  Promise<folly::Unit> verifyPromise;
+  EXPECT_CALL(*asyncVerifier, verifyFuture(_))
+      .WillOnce(InvokeWithoutArgs(
+          [&verifyPromise]() { return verifyPromise.getFuture(); }));
+
+  auto actions =
+      detail::processEvent(state_, TestMessages::certificateVerify());
+  verifyPromise.setException(std::runtime_error("revoked"));
+  auto completed = getActions(std::move(actions), false);
+  expectError(
+      completed,
+      AlertDescription::bad_certificate,
+      "client certificate failure: revoked");
+}
+
 TEST_F(ServerProtocolTest, TestEarlyWriteError) {
   setUpAcceptingData();
   auto actions = getActions(
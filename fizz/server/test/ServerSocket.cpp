@@ -20,6 +20,7 @@ DEFINE_string(cabundle, "", "CA certificate bundle to use for client auth");
 DEFINE_bool(clientauth, false, "require client authentication");
 DEFINE_bool(fallback, false, "enabled AsyncSSLSocket fallback");
 DEFINE_bool(early, false, "accept early data");
+DEFINE_bool(tfo, false, "enable TCP Fast Open");
 
 using namespace fizz;
 using namespace fizz::server;
@@ -189,7 +190,8 @@ int main(int argc, char** argv) {
 
   EventBase evb;
   TestCallbackFactory factory(&evb, sslContext);
-  fizz::server::test::FizzTestServer serv(evb, &factory, FLAGS_port);
+  fizz::server::test::FizzTestServer serv(
+      evb, &factory, FLAGS_port, FLAGS_tfo ? 1000 : 0);
 
   if (!FLAGS_cert.empty()) {
     std::string certBuf, keyBuf;
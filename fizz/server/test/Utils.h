@@ -27,7 +27,15 @@ class FizzTestServer : public folly::AsyncServerSocket::AcceptCallback {
         std::shared_ptr<AsyncFizzServer> server) = 0;
   };
 
-  FizzTestServer(folly::EventBase& evb, CallbackFactory* factory, int port = 0)
+  /**
+   * A non-zero tfoQueueSize enables TCP Fast Open on the listening socket,
+   * allowing that many pending TFO requests.
+   */
+  FizzTestServer(
+      folly::EventBase& evb,
+      CallbackFactory* factory,
+      int port = 0,
+      uint32_t tfoQueueSize = 0)
       : factory_(factory), evb_(evb) {
     auto certData =
         fizz::test::createCert("fizz-test-selfsign", false, nullptr);
@@ -41,6 +49,9 @@ class FizzTestServer : public folly::AsyncServerSocket::AcceptCallback {
     ctx_->setCertManager(std::move(certManager));
     socket_ = folly::AsyncServerSocket::UniquePtr(
         new folly::AsyncServerSocket(&evb_));
+    if (tfoQueueSize > 0) {
+      socket_->setTFOEnabled(true, tfoQueueSize);
+    }
     socket_->bind(port);
     socket_->listen(100);
     socket_->addAcceptCallback(this, &evb_);
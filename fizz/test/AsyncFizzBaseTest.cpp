@@ -303,6 +303,118 @@ TEST_F(AsyncFizzBaseTest, TestReadBufferPause) {
   setReadCB(&readCallback_);
 }
 
+TEST_F(AsyncFizzBaseTest, TestDecryptionBuffer) {
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(false));
+
+  setReadCB(&readCallback_);
+
+  auto provider = static_cast<DecryptionBufferProvider*>(this);
+  expectReadBufRequest(20);
+  auto buf = provider->getDecryptionBuffer(5);
+  ASSERT_TRUE(buf);
+  EXPECT_EQ(buf->writableTail(), readBuf_.data());
+  EXPECT_EQ(buf->length(), 0);
+  memcpy(buf->writableTail(), "hello", 5);
+  buf->append(5);
+
+  // No further getReadBuffer() call, the data is already in place.
+  expectReadData("hello");
+  deliverAppData(std::move(buf));
+  EXPECT_EQ(getAppBytesReceived(), 5);
+}
+
+TEST_F(AsyncFizzBaseTest, TestDecryptionBufferTooSmall) {
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(false));
+
+  setReadCB(&readCallback_);
+
+  auto provider = static_cast<DecryptionBufferProvider*>(this);
+  expectReadBufRequest(3);
+  EXPECT_FALSE(provider->getDecryptionBuffer(5));
+}
+
+TEST_F(AsyncFizzBaseTest, TestDecryptionBufferMovable) {
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(true));
+
+  setReadCB(&readCallback_);
+
+  auto provider = static_cast<DecryptionBufferProvider*>(this);
+  EXPECT_CALL(readCallback_, getReadBuffer(_, _)).Times(0);
+  EXPECT_FALSE(provider->getDecryptionBuffer(5));
+}
+
+TEST_F(AsyncFizzBaseTest, TestDecryptionBufferNoCallback) {
+  auto provider = static_cast<DecryptionBufferProvider*>(this);
+  EXPECT_FALSE(provider->getDecryptionBuffer(5));
+}
+
+TEST_F(AsyncFizzBaseTest, TestDecryptionBufferCallbackChanged) {
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(false));
+
+  setReadCB(&readCallback_);
+
+  auto provider = static_cast<DecryptionBufferProvider*>(this);
+  expectReadBufRequest(20);
+  auto buf = provider->getDecryptionBuffer(5);
+  ASSERT_TRUE(buf);
+  memcpy(buf->writableTail(), "hello", 5);
+  buf->append(5);
+
+  // The callback went away before the data was delivered, so the data is
+  // copied out of its buffer and delivered when a callback is set again.
+  setReadCB(nullptr);
+  deliverAppData(std::move(buf));
+  std::fill(readBuf_.begin(), readBuf_.end(), 0);
+
+  expectReadBufRequest(20);
+  expectReadData("hello");
+  setReadCB(&readCallback_);
+}
+
+TEST_F(AsyncFizzBaseTest, TestDecryptionBufferReleased) {
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(false));
+
+  setReadCB(&readCallback_);
+
+  auto provider = static_cast<DecryptionBufferProvider*>(this);
+  std::array<uint8_t, 20> memory;
+  EXPECT_CALL(readCallback_, getReadBuffer(_, _))
+      .InSequence(readBufSeq_)
+      .WillOnce(DoAll(
+          SetArgPointee<0>(memory.data()), SetArgPointee<1>(memory.size())));
+  ASSERT_TRUE(provider->getDecryptionBuffer(5));
+  provider->releaseDecryptionBuffer();
+
+  // Data that happens to sit at the same address is delivered as usual.
+  memcpy(memory.data(), "hello", 5);
+  expectReadBufRequest(20);
+  expectReadData("hello");
+  deliverAppData(IOBuf::wrapBuffer(memory.data(), 5));
+}
+
+TEST_F(AsyncFizzBaseTest, TestDecryptionBufferResetOnRequest) {
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(false));
+
+  setReadCB(&readCallback_);
+
+  auto provider = static_cast<DecryptionBufferProvider*>(this);
+  std::array<uint8_t, 20> memory;
+  EXPECT_CALL(readCallback_, getReadBuffer(_, _))
+      .InSequence(readBufSeq_)
+      .WillOnce(DoAll(
+          SetArgPointee<0>(memory.data()), SetArgPointee<1>(memory.size())));
+  ASSERT_TRUE(provider->getDecryptionBuffer(5));
+
+  // The next request is too big, which drops the earlier buffer too.
+  expectReadBufRequest(3);
+  EXPECT_FALSE(provider->getDecryptionBuffer(5));
+
+  memcpy(memory.data(), "hello", 5);
+  expectReadBufRequest(20);
+  expectReadData("hello");
+  deliverAppData(IOBuf::wrapBuffer(memory.data(), 5));
+}
+
 TEST_F(AsyncFizzBaseTest, TestTransportReadBufMovable) {
   expectTransportReadCallback();
   startTransportReads();
@@ -348,6 +460,68 @@ TEST_F(AsyncFizzBaseTest, TestTransportReadBufAvail) {
       eq(*IOBuf::copyBuffer("hellogoodbye"), *transportReadBuf_.front()));
 }
 
+TEST_F(AsyncFizzBaseTest, TestTransportReadBufRecordSized) {
+  void* buf;
+  size_t len;
+  IOBufEqualTo eq;
+  expectTransportReadCallback();
+  startTransportReads();
+
+  // Start of a 16000 byte application data record.
+  std::string record("\x17\x03\x03\x3e\x80", 5);
+  record.append(16000, 'a');
+
+  EXPECT_CALL(*this, transportDataAvailable()).Times(3);
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  std::memcpy(buf, record.data(), 100);
+  transportReadCallback_->readDataAvailable(100);
+
+  // The rest of the record fits in the same buffer as its start.
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_GE(len, record.size() - 100);
+  std::memcpy(buf, record.data() + 100, record.size() - 100);
+  transportReadCallback_->readDataAvailable(record.size() - 100);
+  EXPECT_FALSE(transportReadBuf_.front()->isChained());
+  EXPECT_TRUE(eq(*IOBuf::copyBuffer(record), *transportReadBuf_.front()));
+
+  // Nothing else was waiting, so the next read at the record boundary only
+  // gets a small buffer.
+  transportReadBuf_.trimStart(record.size());
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_LT(len, record.size());
+
+  // A record that exactly fills that read. More data is likely waiting, so
+  // the next read has room for a large record again.
+  ASSERT_GT(len, 5);
+  ASSERT_LE(len, 0xffff);
+  std::string small("\x17\x03\x03", 3);
+  small.push_back(static_cast<char>((len - 5) >> 8));
+  small.push_back(static_cast<char>((len - 5) & 0xff));
+  small.append(len - 5, 'b');
+  std::memcpy(buf, small.data(), small.size());
+  transportReadCallback_->readDataAvailable(small.size());
+  transportReadBuf_.trimStart(small.size());
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_GE(len, record.size() * 7 / 8);
+}
+
+TEST_F(AsyncFizzBaseTest, TestTransportReadBufOversizedRecord) {
+  void* buf;
+  size_t len;
+  expectTransportReadCallback();
+  startTransportReads();
+
+  // Header of a record longer than any a peer may send.
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  std::memcpy(buf, "\x17\x03\x03\xff\xff", 5);
+  transportReadCallback_->readDataAvailable(5);
+
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_LT(transportReadBuf_.front()->capacity(), 0xffff);
+  EXPECT_EQ(transportReadBuf_.front()->length(), 5);
+}
+
 TEST_F(AsyncFizzBaseTest, TestTransportReadError) {
   expectTransportReadCallback();
   startTransportReads();
@@ -383,6 +557,26 @@ TEST_F(AsyncFizzBaseTest, TestTransportReadBufPause) {
   EXPECT_NE(transportReadCallback_, nullptr);
 }
 
+TEST_F(AsyncFizzBaseTest, TestTransportReadBufPauseWithReadCallback) {
+  expectTransportReadCallback();
+  setReadCB(&readCallback_);
+
+  // Records can pile up while the state machine is busy, even though there
+  // is somewhere to deliver the app data.
+  auto bigBuf = IOBuf::create(1024 * 1024);
+  bigBuf->append(1024 * 1024);
+  expectTransportReadCallback();
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->readBufferAvailable(std::move(bigBuf));
+  EXPECT_EQ(transportReadCallback_, nullptr);
+  EXPECT_TRUE(transportReadsPaused());
+
+  expectTransportReadCallback();
+  startTransportReads();
+  EXPECT_NE(transportReadCallback_, nullptr);
+  EXPECT_FALSE(transportReadsPaused());
+}
+
 TEST_F(AsyncFizzBaseTest, TestAppReadBufPause) {
   EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(true));
   expectTransportReadCallback();
@@ -400,6 +594,62 @@ TEST_F(AsyncFizzBaseTest, TestAppReadBufPause) {
   EXPECT_NE(transportReadCallback_, nullptr);
 }
 
+TEST_F(AsyncFizzBaseTest, TestMemoryBudgetAccounting) {
+  auto budget = std::make_shared<MemoryBudget>(1024 * 1024);
+  budget->charge(100);
+  setMemoryBudget(budget);
+  expectTransportReadCallback();
+  startTransportReads();
+
+  // Buffers are charged for the memory they hold, not just their data.
+  auto hello = IOBuf::create(4096);
+  std::memcpy(hello->writableTail(), "hello", 5);
+  hello->append(5);
+  auto helloCapacity = hello->capacity();
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->readBufferAvailable(std::move(hello));
+  EXPECT_GE(helloCapacity, 4096);
+  EXPECT_EQ(budget->getUsage(), 100 + helloCapacity);
+
+  auto appData = IOBuf::copyBuffer("appdata");
+  auto appDataCapacity = appData->capacity();
+  deliverAppData(std::move(appData));
+  EXPECT_EQ(budget->getUsage(), 100 + helloCapacity + appDataCapacity);
+
+  transportReadBuf_.move();
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(true));
+  EXPECT_CALL(readCallback_, readBufferAvailable_(_));
+  expectTransportReadCallback();
+  setReadCB(&readCallback_);
+  EXPECT_EQ(budget->getUsage(), 100);
+
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->readBufferAvailable(IOBuf::copyBuffer("hello"));
+  setMemoryBudget(nullptr);
+  EXPECT_EQ(budget->getUsage(), 100);
+}
+
+TEST_F(AsyncFizzBaseTest, TestMemoryBudgetPause) {
+  auto budget = std::make_shared<MemoryBudget>(1024 * 1024);
+  setMemoryBudget(budget);
+  expectTransportReadCallback();
+  startTransportReads();
+
+  auto buf = IOBuf::create(32 * 1024);
+  buf->append(32 * 1024);
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->readBufferAvailable(buf->clone());
+  EXPECT_NE(transportReadCallback_, nullptr);
+
+  // With the budget exhausted, reads pause with much less buffered.
+  budget->charge(1024 * 1024);
+  expectTransportReadCallback();
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->readBufferAvailable(IOBuf::copyBuffer("more"));
+  EXPECT_EQ(transportReadCallback_, nullptr);
+  budget->release(1024 * 1024);
+}
+
 TEST_F(AsyncFizzBaseTest, TestWriteSuccess) {
   AsyncTransportWrapper::WriteCallback* writeCallback = this;
   writeCallback->writeSuccess();
@@ -411,6 +661,14 @@ TEST_F(AsyncFizzBaseTest, TestWriteError) {
   writeCallback->writeErr(0, ase_);
 }
 
+TEST_F(AsyncFizzBaseTest, TestZeroCopyWriteNotSocket) {
+  auto buf = IOBuf::copyBuffer(std::string(20000, 'x'));
+  EXPECT_FALSE(setZeroCopyWriteThreshold(16384));
+  EXPECT_EQ(getTransportWriteFlags(*buf, WriteFlags::CORK), WriteFlags::CORK);
+  EXPECT_TRUE(setZeroCopyWriteThreshold(0));
+  EXPECT_EQ(getTransportWriteFlags(*buf, WriteFlags::NONE), WriteFlags::NONE);
+}
+
 TEST_F(AsyncFizzBaseTest, TestHandshakeTimeout) {
   MockTimeoutManager manager;
   ON_CALL(manager, isInTimeoutManagerThread()).WillByDefault(Return(true));
@@ -428,6 +686,105 @@ TEST_F(AsyncFizzBaseTest, TestHandshakeTimeout) {
   timeout->timeoutExpired();
 }
 
+TEST_F(AsyncFizzBaseTest, TestIdleBufferTimeoutCompacts) {
+  void* buf;
+  size_t len;
+  IOBufEqualTo eq;
+  MockTimeoutManager manager;
+  ON_CALL(manager, isInTimeoutManagerThread()).WillByDefault(Return(true));
+  attachTimeoutManager(&manager);
+  expectTransportReadCallback();
+  startTransportReads();
+  AsyncTimeout* timeout;
+
+  EXPECT_CALL(manager, scheduleTimeout(_, std::chrono::milliseconds(10)))
+      .WillRepeatedly(DoAll(SaveArg<0>(&timeout), Return(true)));
+  setIdleBufferTimeout(std::chrono::milliseconds(10));
+
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  std::memcpy(buf, "hello", 5);
+  transportReadCallback_->readDataAvailable(5);
+  auto before = transportReadBuf_.front();
+  EXPECT_GE(before->capacity(), 1460);
+
+  // A read happened during the first period, so nothing is released yet.
+  timeout->timeoutExpired();
+  EXPECT_EQ(transportReadBuf_.front(), before);
+
+  timeout->timeoutExpired();
+  ASSERT_NE(transportReadBuf_.front(), nullptr);
+  EXPECT_LT(transportReadBuf_.front()->capacity(), 1460);
+  EXPECT_TRUE(eq(*IOBuf::copyBuffer("hello"), *transportReadBuf_.front()));
+
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  std::memcpy(buf, "world", 5);
+  transportReadCallback_->readDataAvailable(5);
+  EXPECT_TRUE(
+      eq(*IOBuf::copyBuffer("helloworld"), *transportReadBuf_.front()));
+}
+
+TEST_F(AsyncFizzBaseTest, TestIdleBufferTimeoutReleasesEmpty) {
+  void* buf;
+  size_t len;
+  MockTimeoutManager manager;
+  ON_CALL(manager, isInTimeoutManagerThread()).WillByDefault(Return(true));
+  attachTimeoutManager(&manager);
+  expectTransportReadCallback();
+  startTransportReads();
+  AsyncTimeout* timeout;
+
+  EXPECT_CALL(manager, scheduleTimeout(_, std::chrono::milliseconds(10)))
+      .WillOnce(DoAll(SaveArg<0>(&timeout), Return(true)));
+  setIdleBufferTimeout(std::chrono::milliseconds(10));
+
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_NE(transportReadBuf_.front(), nullptr);
+  timeout->timeoutExpired();
+  EXPECT_EQ(transportReadBuf_.front(), nullptr);
+}
+
+TEST_F(AsyncFizzBaseTest, TestIdleBufferTimeoutAppData) {
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(true));
+  MockTimeoutManager manager;
+  ON_CALL(manager, isInTimeoutManagerThread()).WillByDefault(Return(true));
+  attachTimeoutManager(&manager);
+  AsyncTimeout* timeout;
+
+  EXPECT_CALL(manager, scheduleTimeout(_, std::chrono::milliseconds(10)))
+      .WillOnce(DoAll(SaveArg<0>(&timeout), Return(true)));
+  setIdleBufferTimeout(std::chrono::milliseconds(10));
+
+  auto appData = IOBuf::create(4000);
+  appData->append(3);
+  std::memcpy(appData->writableData(), "sup", 3);
+  deliverAppData(std::move(appData));
+  timeout->timeoutExpired();
+
+  auto expected = IOBuf::copyBuffer("sup");
+  EXPECT_CALL(readCallback_, readBufferAvailable_(BufMatches(expected.get())))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf) {
+        EXPECT_LT(buf->capacity(), 4000);
+      }));
+  setReadCB(&readCallback_);
+}
+
+TEST_F(AsyncFizzBaseTest, TestIdleBufferTimeoutDisabled) {
+  void* buf;
+  size_t len;
+  MockTimeoutManager manager;
+  ON_CALL(manager, isInTimeoutManagerThread()).WillByDefault(Return(true));
+  attachTimeoutManager(&manager);
+  expectTransportReadCallback();
+  startTransportReads();
+
+  EXPECT_CALL(manager, scheduleTimeout(_, _)).Times(0);
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  transportReadCallback_->readDataAvailable(5);
+}
+
 TEST_F(AsyncFizzBaseTest, TestAttachEventBase) {
   EventBase evb;
   expectTransportReadCallback();
@@ -25,6 +25,10 @@
 #include <fizz/server/test/Mocks.h>
 #include <fizz/test/LocalTransport.h>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 using namespace folly;
 using namespace folly::test;
 using namespace fizz::client;
@@ -388,6 +392,48 @@ TEST_F(HandshakeTest, BasicHandshake) {
   sendAppData();
 }
 
+#ifdef __GLIBC__
+/**
+ * Bytes allocated from the main malloc arena, which is the one this single
+ * threaded test allocates from.
+ */
+static size_t heapInUse() {
+#if __GLIBC_PREREQ(2, 33)
+  return mallinfo2().uordblks;
+#else
+  return mallinfo().uordblks;
+#endif
+}
+
+TEST_F(HandshakeTest, EstablishedFootprint) {
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  evb_.loop();
+
+  // Tearing the endpoints down one at a time frees exactly what each one
+  // holds once established: its state, record layers, buffers and transport
+  // (a LocalTransport standing in for the socket). Closing a LocalTransport
+  // does not notify its peer.
+  auto established = heapInUse();
+  server_.reset();
+  evb_.loop();
+  auto withoutServer = heapInUse();
+  client_.reset();
+  evb_.loop();
+  auto withoutClient = heapInUse();
+
+  ASSERT_GT(established, withoutServer);
+  ASSERT_GT(withoutServer, withoutClient);
+  auto serverBytes = established - withoutServer;
+  auto clientBytes = withoutServer - withoutClient;
+  RecordProperty("ServerBytes", static_cast<int>(serverBytes));
+  RecordProperty("ClientBytes", static_cast<int>(clientBytes));
+  LOG(INFO) << "established connection heap footprint: server "
+            << serverBytes << " bytes, client " << clientBytes << " bytes";
+}
+#endif
+
 TEST_F(HandshakeTest, BasicHandshakeTrickle) {
   clientTransport_->setTrickle(true);
   serverTransport_->setTrickle(true);